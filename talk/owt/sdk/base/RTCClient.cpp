@@ -1,5 +1,12 @@
 #include "owt/base/RTCClient.h"
+#include <algorithm>
 #include "talk/owt/sdk/base/RTCConnectionChannel.h"
+#include "talk/owt/sdk/base/framebufferpool.h"
+#include "talk/owt/sdk/base/observereventqueue.h"
+#include "talk/owt/sdk/base/setuplatency.h"
+#include "talk/owt/sdk/base/statsaggregator.h"
+#include "talk/owt/sdk/base/threadlagmonitor.h"
+#include "talk/owt/sdk/base/tracing.h"
 
 namespace owt
 {
@@ -9,13 +16,43 @@ namespace owt
             RTCClientConfiguration config, 
             const std::string& id, 
             RTCClientObserver* observer) :
+            RTCClient(config, id, observer, true)
+        {
+        }
+
+        RTCClient::RTCClient(
+            RTCClientConfiguration config,
+            const std::string& id,
+            RTCClientObserver* observer,
+            bool initialize_peer_connection) :
             rtc_config_(config)
         {
-            pcc_ = std::make_shared<RTCConnectionChannel>(GetPeerConnectionChannelConfiguration(), id);
+            pcc_ = std::make_shared<RTCConnectionChannel>(GetPeerConnectionChannelConfiguration(rtc_config_), id,
+                initialize_peer_connection);
             pcc_->AddObserver(observer);
+            pcc_->SetCandidateOptions(config.candidate_batch_window_ms, config.max_pending_remote_candidates);
+            pcc_->SetStatsSamplingOptions(config.stats_sampling_interval_ms, config.stats_history_size);
+            pcc_->SetAdaptationMonitorOptions(config.adaptation_monitor_interval_ms);
+            pcc_->SetQualityScoringEnabled(config.quality_scoring_enabled);
             rtc::LogMessage::LogToDebug(rtc::LS_ERROR);
         }
 
+        void RTCClient::CreateAsync(
+            RTCClientConfiguration config,
+            const std::string& id,
+            RTCClientObserver* observer,
+            std::function<void(std::shared_ptr<RTCClient>)> on_created)
+        {
+            std::shared_ptr<RTCClient> client(new RTCClient(config, id, observer, false));
+            // |client| is kept alive by the callback until the PeerConnection is created.
+            client->pcc_->InitializePeerConnectionAsync([client, on_created](bool success) {
+                if (on_created)
+                {
+                    on_created(success ? client : nullptr);
+                }
+            });
+        }
+
         std::string RTCClient::id() const
         {
             return pcc_->id();
@@ -31,6 +68,19 @@ namespace owt
             pcc_->ClosePeerConnection();
         }
 
+        void RTCClient::CloseAsync(std::function<void()> on_closed)
+        {
+            // Keep the channel alive until PeerConnection is closed, as it is the
+            // PeerConnection's observer.
+            std::shared_ptr<RTCConnectionChannel> pcc = pcc_;
+            pcc_->ClosePeerConnectionAsync([pcc, on_closed]() {
+                if (on_closed)
+                {
+                    on_closed();
+                }
+            });
+        }
+
         void RTCClient::CreateOffer()
         {
             pcc_->CreateOffer();
@@ -61,11 +111,17 @@ namespace owt
             pcc_->SetRemoteICECandidate(sdp, sdp_mid, sdp_mline_index);
         }
 
-        PeerConnectionChannelConfiguration RTCClient::GetPeerConnectionChannelConfiguration()
+        void RTCClient::SetRemoteICECandidates(const std::vector<RTCCIceCandidate>& candidates)
+        {
+            pcc_->SetRemoteICECandidates(candidates);
+        }
+
+        PeerConnectionChannelConfiguration RTCClient::GetPeerConnectionChannelConfiguration(
+            const RTCClientConfiguration& rtc_config)
         {
             PeerConnectionChannelConfiguration config;
             std::vector<webrtc::PeerConnectionInterface::IceServer> ice_servers;
-            for (auto it = rtc_config_.ice_servers.begin(); it != rtc_config_.ice_servers.end(); ++it)
+            for (auto it = rtc_config.ice_servers.begin(); it != rtc_config.ice_servers.end(); ++it)
             {
                 webrtc::PeerConnectionInterface::IceServer ice_server;
                 ice_server.urls = (*it).urls;
@@ -78,11 +134,11 @@ namespace owt
             config.candidate_network_policy = webrtc::PeerConnectionInterface::CandidateNetworkPolicy::
             kCandidateNetworkPolicyAll;
 
-            for (auto codec : rtc_config_.video_encodings)
+            for (auto codec : rtc_config.video_encodings)
             {
                 config.video.push_back(VideoEncodingParameters(codec));
             }
-            for (auto codec : rtc_config_.audio_encodings)
+            for (auto codec : rtc_config.audio_encodings)
             {
                 config.audio.push_back(AudioEncodingParameters(codec));
             }
@@ -96,11 +152,135 @@ namespace owt
             pcc_->GetConnectionStats();
         }
 
+        void RTCClient::GetFlatConnectionStats(std::function<void(const FlatConnectionStats& stats)> on_complete)
+        {
+            pcc_->GetFlatConnectionStats(std::move(on_complete));
+        }
+
+        void RTCClient::GetStats(std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            pcc_->GetStats(std::move(on_success), std::move(on_failure));
+        }
+
+        void RTCClient::GetStats(uint32_t type_mask,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            pcc_->GetStats(type_mask, std::move(on_success), std::move(on_failure));
+        }
+
+        bool RTCClient::GetLatestStatsSample(RTCCStatsSample* sample) const
+        {
+            return pcc_->GetLatestStatsSample(sample);
+        }
+
+        std::vector<RTCCStatsSample> RTCClient::GetStatsSampleHistory() const
+        {
+            return pcc_->GetStatsSampleHistory();
+        }
+
+        RTCCSetupLatency RTCClient::GetSetupLatency() const
+        {
+            return pcc_->GetSetupLatency();
+        }
+
+        void RTCClient::GetSenderStats(const std::string& track_id,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            pcc_->GetSenderStats(track_id, std::move(on_success), std::move(on_failure));
+        }
+
+        void RTCClient::GetReceiverStats(const std::string& track_id,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            pcc_->GetReceiverStats(track_id, std::move(on_success), std::move(on_failure));
+        }
+
         void RTCClient::ResetPeerConnectionFactory()
         {
             RTCConnectionChannel::ResetPeerConnectionFactory();
         }
 
+        std::vector<FactoryShardLoad> RTCClient::GetFactoryShardLoads()
+        {
+            return PeerConnectionDependencyFactory::GetShardLoads();
+        }
+
+        std::vector<ThreadCpuTime> RTCClient::GetThreadCpuTimes()
+        {
+            return PeerConnectionDependencyFactory::GetThreadCpuTimes();
+        }
+
+        void RTCClient::WarmUpPeerConnectionPool(RTCClientConfiguration config, int size)
+        {
+            // Pooled PeerConnections must be created with the same configuration as channels.
+            PeerConnectionChannelConfiguration channel_config = GetPeerConnectionChannelConfiguration(config);
+            PeerConnectionChannel::ApplyCommonConfiguration(&channel_config);
+            PeerConnectionDependencyFactory::ConfigurePeerConnectionPools(channel_config,
+                static_cast<size_t>(std::max(size, 0)));
+        }
+
+        PeerConnectionPoolStats RTCClient::GetPeerConnectionPoolStats()
+        {
+            return PeerConnectionDependencyFactory::GetPeerConnectionPoolStats();
+        }
+
+        size_t RTCClient::DispatchObserverEvents()
+        {
+            ObserverEventQueue* queue = ObserverEventQueue::Get();
+            // Events are dispatched by SDK's own thread in other modes.
+            if (queue == nullptr || queue->HasDispatcherThread())
+            {
+                return 0;
+            }
+            return queue->Dispatch();
+        }
+
+        ObserverEventQueueStats RTCClient::GetObserverEventQueueStats()
+        {
+            ObserverEventQueue* queue = ObserverEventQueue::Get();
+            return queue ? queue->GetStats() : ObserverEventQueueStats();
+        }
+
+        std::string RTCClient::ExportAggregatedStats(StatsExportFormat format)
+        {
+            StatsAggregator* aggregator = StatsAggregator::Get();
+            if (aggregator == nullptr)
+                return "";
+            AggregatedStats stats = aggregator->Aggregate();
+            return format == StatsExportFormat::kJsonLines ? StatsAggregator::ToJson(stats)
+                                                           : StatsAggregator::ToPrometheus(stats);
+        }
+
+        std::vector<RTCCSetupLatencyHistogram> RTCClient::GetSetupLatencyHistograms()
+        {
+            return SetupLatencyHistograms::Get()->GetHistograms();
+        }
+
+        std::vector<ThreadLagHistogram> RTCClient::GetThreadLagHistograms()
+        {
+            ThreadLagMonitor* monitor = ThreadLagMonitor::Get();
+            return monitor ? monitor->GetHistograms() : std::vector<ThreadLagHistogram>();
+        }
+
+        void RTCClient::StartTracing()
+        {
+            Tracing::Start();
+        }
+
+        bool RTCClient::StopTracing(const std::string& output_path, TraceFormat format)
+        {
+            return Tracing::StopAndWrite(output_path, format);
+        }
+
+        FrameBufferPoolStats RTCClient::GetFrameBufferPoolStats()
+        {
+            return FrameBufferPool::GetTotalStats();
+        }
+
         void SetRTCLogLevel(RTCCLogLevel level) 
         {
             rtc::LogMessage::LogToDebug((rtc::LoggingSeverity)level);
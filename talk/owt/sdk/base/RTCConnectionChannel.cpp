@@ -1,23 +1,42 @@
 #include "talk/owt/sdk/base/RTCConnectionChannel.h"
+#include <algorithm>
 #include "webrtc/system_wrappers/include/field_trial.h"
 //#include "webrtc/api/task_queue/default_task_queue_factory.h"
+#include "talk/owt/sdk/base/flatstatsconverter.h"
+#include "talk/owt/sdk/base/observereventqueue.h"
 #include "talk/owt/sdk/base/sdputils.h"
+#include "talk/owt/sdk/base/tracing.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
 
 namespace owt
 {
 	namespace base
 	{
-        RTCConnectionChannel::RTCConnectionChannel(PeerConnectionChannelConfiguration config, const std::string& id) :
+        RTCConnectionChannel::RTCConnectionChannel(PeerConnectionChannelConfiguration config, const std::string& id,
+            bool initialize_peer_connection) :
             PeerConnectionChannel(config),
             id_(id),
             session_state_(kSessionStateReady),
             remote_stream_(nullptr),
+            events_observer_(nullptr),
+            observer_holder_(std::make_shared<ObserverHolder>()),
             is_creating_offer_(false),
+            remote_description_ready_(false),
+            max_pending_remote_candidates_(100),
+            candidate_batch_window_ms_(0),
+            candidate_batch_thread_(nullptr),
+            flat_stats_(std::make_shared<FlatStatsHolder>()),
+            stats_sampling_interval_ms_(0),
+            adaptation_monitor_interval_ms_(0),
+            stats_sampling_thread_(nullptr),
+            setup_latency_(SetupLatencyHistograms::Get()),
+            setup_latency_thread_(nullptr),
+            ice_connection_state_(PeerConnectionInterface::kIceConnectionNew),
             pending_remote_sdp_(std::make_tuple("", ""))
         {
-            /*auto task_queue_factory_ = webrtc::CreateDefaultTaskQueueFactory();
-            event_queue_ = std::make_unique<rtc::TaskQueue>(task_queue_factory_->CreateTaskQueue("ConnectionChannelEventQueue", webrtc::TaskQueueFactory::Priority::NORMAL));*/
-            InitializePeerConnection();
+            if (initialize_peer_connection)
+                InitializePeerConnection();
         }
 
         std::string RTCConnectionChannel::id() const
@@ -28,6 +47,36 @@ namespace owt
         RTCConnectionChannel::~RTCConnectionChannel()
         {
             RTC_LOG(LS_INFO) << "deinit.";
+            // Waits for a pushed change in progress.
+            VideoAdaptationNotifier::Get()->RemoveObserver(this);
+            if (StatsAggregator* aggregator = StatsAggregator::Get())
+                aggregator->RemoveSource(this);
+            {
+                // Waits for a queued callback in progress.
+                std::lock_guard<std::recursive_mutex> lock(observer_holder_->mutex);
+                observer_holder_->observer = nullptr;
+            }
+            // Cancel the batch timer, waiting for a flush in progress.
+            if (candidate_batch_thread_ != nullptr)
+            {
+                candidate_batch_thread_->Invoke<void>(RTC_FROM_HERE, [this] {
+                    candidate_batch_flag_->SetNotAlive();
+                });
+            }
+            if (stats_sampling_thread_ != nullptr)
+            {
+                stats_sampling_thread_->Invoke<void>(RTC_FROM_HERE, [this] {
+                    stats_sampling_flag_->SetNotAlive();
+                });
+            }
+            // No frame is delivered to the sink once it is removed.
+            RemoveFirstFrameSink();
+            if (setup_latency_thread_ != nullptr)
+            {
+                setup_latency_thread_->Invoke<void>(RTC_FROM_HERE, [this] {
+                    setup_latency_flag_->SetNotAlive();
+                });
+            }
             if (peer_connection_ != nullptr)
                 ClosePeerConnection();
         }
@@ -37,6 +86,8 @@ namespace owt
             RTC_LOG(LS_INFO) << "Close peer connection.";
             if (peer_connection_)
             {
+                for (const auto& receiver : peer_connection_->GetReceivers())
+                    receiver->SetObserver(nullptr);
                 peer_connection_->Close();
                 peer_connection_ = nullptr;
             }
@@ -45,11 +96,260 @@ namespace owt
         void RTCConnectionChannel::AddObserver(RTCClientObserver* observer)
         {
             events_observer_ = observer;
+            std::lock_guard<std::recursive_mutex> lock(observer_holder_->mutex);
+            observer_holder_->observer = observer;
+        }
+
+        void RTCConnectionChannel::PostObserverEvent(std::function<void(RTCClientObserver*)> event)
+        {
+            ObserverEventQueue* queue = ObserverEventQueue::Get();
+            if (queue == nullptr)
+            {
+                if (events_observer_ != nullptr)
+                    event(events_observer_);
+                return;
+            }
+            std::shared_ptr<ObserverHolder> holder = observer_holder_;
+            queue->Post([holder, event] {
+                std::lock_guard<std::recursive_mutex> lock(holder->mutex);
+                if (holder->observer != nullptr)
+                    event(holder->observer);
+            });
+        }
+
+        void RTCConnectionChannel::PostCallback(std::function<void()> callback)
+        {
+            ObserverEventQueue* queue = ObserverEventQueue::Get();
+            if (queue == nullptr)
+            {
+                callback();
+                return;
+            }
+            queue->Post(std::move(callback));
+        }
+
+        void RTCConnectionChannel::SetCandidateOptions(int batch_window_ms, size_t max_pending_remote_candidates)
+        {
+            candidate_batch_window_ms_ = batch_window_ms;
+            std::lock_guard<std::mutex> lock(pending_remote_icecandidates_mutex_);
+            max_pending_remote_candidates_ = max_pending_remote_candidates;
+        }
+
+        void RTCConnectionChannel::SetStatsSamplingOptions(int interval_ms, size_t history_size)
+        {
+            // The aggregator reads samples, so they are taken at its interval unless set.
+            StatsAggregator* aggregator = StatsAggregator::Get();
+            if (interval_ms <= 0 && aggregator != nullptr)
+                interval_ms = aggregator->interval_ms();
+            stats_sampling_interval_ms_ = interval_ms;
+            if (interval_ms > 0)
+                stats_sampler_ = std::make_unique<StatsSampler>(history_size);
+            // Registered once the sampler is set, the aggregator reads it from its own thread.
+            if (aggregator != nullptr)
+                aggregator->AddSource(this);
+        }
+
+        void RTCConnectionChannel::SetQualityScoringEnabled(bool enabled)
+        {
+            if (enabled)
+                quality_scorer_ = std::make_unique<QualityScorer>();
+            else
+                quality_scorer_.reset();
+        }
+
+        bool RTCConnectionChannel::GetLatestStatsSample(RTCCStatsSample* sample) const
+        {
+            return stats_sampler_ && stats_sampler_->GetLatest(sample);
+        }
+
+        std::vector<RTCCStatsSample> RTCConnectionChannel::GetStatsSampleHistory() const
+        {
+            return stats_sampler_ ? stats_sampler_->GetHistory() : std::vector<RTCCStatsSample>();
+        }
+
+        void RTCConnectionChannel::SetAdaptationMonitorOptions(int interval_ms)
+        {
+            adaptation_monitor_interval_ms_ = interval_ms;
+            if (interval_ms <= 0)
+                return;
+            {
+                std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                adaptation_monitor_ = std::make_unique<AdaptationMonitor>();
+            }
+            VideoAdaptationNotifier::Get()->AddObserver(this);
+        }
+
+        void RTCConnectionChannel::OnVideoSourceAdapted(const std::string& track_id, int width, int height,
+            int max_fps)
+        {
+            AdaptationChanges changes;
+            {
+                std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                if (adaptation_monitor_ == nullptr || published_video_tracks_.count(track_id) == 0)
+                    return;
+                adaptation_monitor_->OnVideoSourceAdapted(track_id, width, height, max_fps, &changes);
+            }
+            PostAdaptationChanges(changes);
+        }
+
+        void RTCConnectionChannel::OnVideoEncoderBitrateChanged(const std::string& track_id, uint64_t bitrate_bps)
+        {
+            AdaptationChanges changes;
+            {
+                std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                if (adaptation_monitor_ == nullptr || published_video_tracks_.count(track_id) == 0)
+                    return;
+                adaptation_monitor_->OnEncoderBitrate(bitrate_bps, &changes);
+            }
+            PostAdaptationChanges(changes);
+        }
+
+        void RTCConnectionChannel::PostAdaptationChanges(const AdaptationChanges& changes)
+        {
+            std::string id = id_;
+            if (changes.target_bitrate_changed)
+            {
+                uint64_t target_bitrate_bps = changes.target_bitrate_bps;
+                PostObserverEvent([id, target_bitrate_bps](RTCClientObserver* observer) {
+                    observer->OnTargetBitrateChanged(id, target_bitrate_bps);
+                });
+            }
+            for (const auto& adaptation : changes.quality_limitation_changes)
+            {
+                PostObserverEvent([id, adaptation](RTCClientObserver* observer) {
+                    observer->OnQualityLimitationChanged(id, adaptation);
+                });
+            }
+            for (const auto& adaptation : changes.video_adaptation_changes)
+            {
+                PostObserverEvent([id, adaptation](RTCClientObserver* observer) {
+                    observer->OnVideoAdaptationChanged(id, adaptation);
+                });
+            }
+        }
+
+        void RTCConnectionChannel::GetStatsAggregatorInput(StatsAggregatorInput* input)
+        {
+            input->ice_connection_state = ice_connection_state_.load();
+            input->has_sample = GetLatestStatsSample(&input->sample);
+        }
+
+        void RTCConnectionChannel::StartStatsSampling()
+        {
+            if ((stats_sampler_ == nullptr && adaptation_monitor_ == nullptr) || stats_sampling_thread_ != nullptr)
+                return;
+            stats_sampling_thread_ = rtc::Thread::Current();
+            stats_sampling_flag_ = webrtc::PendingTaskSafetyFlag::Create();
+            SampleStats();
+        }
+
+        void RTCConnectionChannel::SampleStats()
+        {
+            if (peer_connection_ == nullptr)
+                return;
+            rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> flag = stats_sampling_flag_;
+            peer_connection_->GetStats(FunctionalStandardRTCStatsCollectorCallback::Create(
+                [this, flag](std::shared_ptr<RTCStatsReport> report) {
+                    // Delivered on the signaling thread, after this channel may be destroyed.
+                    if (!flag->alive())
+                        return;
+                    if (stats_sampler_ != nullptr)
+                    {
+                        stats_sampler_->AddReport(*report, rtc::TimeMillis());
+                        if (quality_scorer_ != nullptr && stats_sampler_->GetLatest(&quality_sample_))
+                        {
+                            quality_scorer_->Update(*report, quality_sample_, &quality_scores_);
+                            std::string id = id_;
+                            RTCCQualityScores scores = quality_scores_;
+                            PostObserverEvent([id, scores](RTCClientObserver* observer) {
+                                observer->OnQualityScoresUpdated(id, scores);
+                            });
+                        }
+                    }
+                    AdaptationChanges changes;
+                    {
+                        std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                        if (adaptation_monitor_ != nullptr)
+                            adaptation_monitor_->Update(*report, &changes);
+                    }
+                    PostAdaptationChanges(changes);
+                    // Adaptation checks share the samples if sampling is enabled.
+                    int interval_ms = stats_sampler_ != nullptr ? stats_sampling_interval_ms_
+                                                                : adaptation_monitor_interval_ms_;
+                    stats_sampling_thread_->PostDelayedTask(
+                        webrtc::ToQueuedTask(flag, [this] { SampleStats(); }), interval_ms);
+                }));
+        }
+
+        RTCCSetupLatency RTCConnectionChannel::GetSetupLatency() const
+        {
+            return setup_latency_.GetLatency();
+        }
+
+        void RTCConnectionChannel::MarkSetupPhase(SetupPhase phase)
+        {
+            setup_latency_.Mark(phase, rtc::TimeMillis());
+        }
+
+        void RTCConnectionChannel::ReportSetupLatency()
+        {
+            std::string id = id_;
+            RTCCSetupLatency latency = setup_latency_.GetLatency();
+            PostObserverEvent([id, latency](RTCClientObserver* observer) {
+                observer->OnSetupLatency(id, latency);
+            });
+        }
+
+        void RTCConnectionChannel::RemoveFirstFrameSink()
+        {
+            if (first_frame_track_ == nullptr)
+                return;
+            first_frame_track_->RemoveSink(first_frame_sink_.get());
+            first_frame_track_ = nullptr;
+        }
+
+        RTCConnectionChannel::ShardTrackMirror::ShardTrackMirror(
+            rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track,
+            rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> shard_track) :
+            track_(track),
+            shard_track_(shard_track)
+        {
+            track_->RegisterObserver(this);
+        }
+
+        RTCConnectionChannel::ShardTrackMirror::~ShardTrackMirror()
+        {
+            // Marshaled to the signaling thread of |track_|, where changes are mirrored, so none is in
+            // progress once it returns.
+            track_->UnregisterObserver(this);
+        }
+
+        void RTCConnectionChannel::ShardTrackMirror::OnChanged()
+        {
+            shard_track_->set_enabled(track_->enabled());
+        }
+
+        RTCConnectionChannel::FirstFrameSink::FirstFrameSink(std::function<void(int64_t, int64_t)> on_first_frame) :
+            received_(false),
+            on_first_frame_(std::move(on_first_frame))
+        {
+        }
+
+        void RTCConnectionChannel::FirstFrameSink::OnFrame(const webrtc::VideoFrame& frame)
+        {
+            if (received_.exchange(true))
+                return;
+            // Frames are delivered to sinks once decoded. Renderers are owned by the application, so
+            // the render time set by the jitter buffer is only an estimate of when it is shown.
+            int64_t delivered_ms = rtc::TimeMillis();
+            on_first_frame_(delivered_ms, std::max(delivered_ms, frame.render_time_ms()));
         }
 
         void RTCConnectionChannel::CreateOffer()
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::CreateOffer");
             RTC_LOG(LS_INFO) << "Creating offer...";
+            MarkSetupPhase(SetupPhase::kCreateOfferStart);
             scoped_refptr<FunctionalCreateSessionDescriptionObserver> observer =
                 FunctionalCreateSessionDescriptionObserver::Create(
                     std::bind(
@@ -66,7 +366,9 @@ namespace owt
 
         void RTCConnectionChannel::CreateAnswer()
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::CreateAnswer");
             RTC_LOG(LS_INFO) << "Creating answer...";
+            MarkSetupPhase(SetupPhase::kCreateOfferStart);
             scoped_refptr<FunctionalCreateSessionDescriptionObserver> observer =
                 FunctionalCreateSessionDescriptionObserver::Create(
                     std::bind(
@@ -97,13 +399,33 @@ namespace owt
             RTC_CHECK(stream->MediaStream());
 
             scoped_refptr<webrtc::MediaStreamInterface> media_stream = stream->MediaStream();
+            // Local tracks belong to the default factory, the connection may be on another shard.
+            PeerConnectionDependencyFactory* shard = factory();
             for (const auto& track : media_stream->GetAudioTracks())
             {
-                peer_connection_->AddTrack(track, { media_stream->id() });
+                scoped_refptr<webrtc::AudioTrackInterface> shard_track = shard->CreateShardAudioTrack(track);
+                if (!shard_track)
+                {
+                    RTC_LOG(LS_ERROR) << "Failed to create track " << track->id() << " on the connection's factory.";
+                    continue;
+                }
+                if (shard_track.get() != track.get())
+                    shard_track_mirrors_.push_back(std::make_unique<ShardTrackMirror>(track, shard_track));
+                peer_connection_->AddTrack(shard_track, { media_stream->id() });
             }
             for (const auto& track : media_stream->GetVideoTracks())
             {
-                peer_connection_->AddTrack(track, { media_stream->id() });
+                scoped_refptr<webrtc::VideoTrackInterface> shard_track = shard->CreateShardVideoTrack(track);
+                if (!shard_track)
+                {
+                    RTC_LOG(LS_ERROR) << "Failed to create track " << track->id() << " on the connection's factory.";
+                    continue;
+                }
+                if (shard_track.get() != track.get())
+                    shard_track_mirrors_.push_back(std::make_unique<ShardTrackMirror>(track, shard_track));
+                peer_connection_->AddTrack(shard_track, { media_stream->id() });
+                std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                published_video_tracks_.insert(track->id());
             }
 
             // auto create local sdp, callback will emit at `RTCClient::OnCreateSessionDescriptionSuccess`
@@ -149,6 +471,11 @@ namespace owt
                     }
                 }
             }
+            {
+                std::lock_guard<std::mutex> lock(adaptation_mutex_);
+                published_video_tracks_.clear();
+            }
+            shard_track_mirrors_.clear();
 
             local_stream_.reset();
             local_stream_ = nullptr;
@@ -156,6 +483,7 @@ namespace owt
 
         void RTCConnectionChannel::SetRemoteSDP(const std::string& sdp, const std::string& type)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::SetRemoteSDP");
             if (type == "offer" && SignalingState() != webrtc::PeerConnectionInterface::kStable) 
             {
                 RTC_LOG(LS_INFO) << "Signaling state is " << SignalingState()
@@ -163,6 +491,8 @@ namespace owt
                 pending_remote_sdp_ = std::make_tuple(sdp, type);
                 return;
             }
+            // Answering side starts the setup with the remote offer.
+            setup_latency_.Start(rtc::TimeMillis());
 
             scoped_refptr<FunctionalSetRemoteDescriptionObserver> observer =
                 FunctionalSetRemoteDescriptionObserver::Create(std::bind(
@@ -174,20 +504,54 @@ namespace owt
 
         void RTCConnectionChannel::SetRemoteICECandidate(const std::string& sdp, const std::string& sdp_mid, int sdp_mline_index)
         {
-            webrtc::IceCandidateInterface* ice_candidate = webrtc::CreateIceCandidate(
-                sdp_mid, sdp_mline_index, sdp, nullptr);
-            if (peer_connection_->remote_description()) {
-                if (!peer_connection_->AddIceCandidate(ice_candidate)) 
+            RTCCIceCandidate candidate = { sdp_mid, sdp_mline_index, sdp };
+            SetRemoteICECandidates({ candidate });
+        }
+
+        void RTCConnectionChannel::SetRemoteICECandidates(const std::vector<RTCCIceCandidate>& candidates)
+        {
+            OWT_TRACE_EVENT("RTCConnectionChannel::SetRemoteICECandidates");
+            {
+                std::lock_guard<std::mutex> lock(pending_remote_icecandidates_mutex_);
+                if (!remote_description_ready_)
                 {
-                    RTC_LOG(LS_WARNING) << "Failed to add remote candidate.";
+                    for (const auto& candidate : candidates)
+                    {
+                        if (pending_remote_icecandidates_.size() >= max_pending_remote_candidates_)
+                        {
+                            RTC_LOG(LS_WARNING) << "Too many remote candidates before remote "
+                                "session description, candidate dropped.";
+                            break;
+                        }
+                        pending_remote_icecandidates_.push_back(candidate);
+                    }
+                    RTC_LOG(LS_VERBOSE) << "Remote candidates are stored because remote "
+                        "session description is missing.";
+                    return;
                 }
             }
-            else
+            // Not holding the lock, AddIceCandidate blocks on signaling thread.
+            AddRemoteCandidates(candidates);
+        }
+
+        void RTCConnectionChannel::AddRemoteCandidates(const std::vector<RTCCIceCandidate>& candidates)
+        {
+            if (!peer_connection_)
+                return;
+            for (const auto& candidate : candidates)
             {
-                std::lock_guard<std::mutex> lock(pending_remote_icecandidates_mutex_);
-                pending_remote_icecandidates_.push_back(std::make_tuple(sdp, sdp_mid, sdp_mline_index));
-                RTC_LOG(LS_VERBOSE) << "Remote candidate is stored because remote "
-                    "session description is missing.";
+                webrtc::SdpParseError error;
+                std::unique_ptr<webrtc::IceCandidateInterface> ice_candidate(webrtc::CreateIceCandidate(
+                    candidate.sdp_mid, candidate.sdp_mline_index, candidate.sdp, &error));
+                if (!ice_candidate)
+                {
+                    RTC_LOG(LS_WARNING) << "Failed to parse remote candidate: " << error.description;
+                    continue;
+                }
+                if (!peer_connection_->AddIceCandidate(ice_candidate.get()))
+                {
+                    RTC_LOG(LS_WARNING) << "Failed to add remote candidate.";
+                }
             }
         }
 
@@ -198,6 +562,7 @@ namespace owt
 
         void RTCConnectionChannel::OnSignalingChange(PeerConnectionInterface::SignalingState new_state)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnSignalingChange");
             RTC_LOG(LS_INFO) << "Signaling state changed: " << new_state;
             
             if (new_state == PeerConnectionInterface::SignalingState::kStable)
@@ -223,38 +588,62 @@ namespace owt
             std::string remote_id = id();
             std::shared_ptr<RemoteStream> remote_stream(new RemoteStream(stream, remote_id));
             remote_stream_ = remote_stream;
-            if (events_observer_ != nullptr)
+            PostObserverEvent([remote_id, remote_stream](RTCClientObserver* observer) {
+                observer->OnRemoteStreamAdded(remote_id, remote_stream);
+            });
+            if (first_frame_sink_ == nullptr && !stream->GetVideoTracks().empty())
             {
-                events_observer_->OnRemoteStreamAdded(remote_id, remote_stream);
+                setup_latency_thread_ = rtc::Thread::Current();
+                setup_latency_flag_ = webrtc::PendingTaskSafetyFlag::Create();
+                rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> flag = setup_latency_flag_;
+                rtc::Thread* thread = setup_latency_thread_;
+                first_frame_sink_.reset(new FirstFrameSink([this, flag, thread](int64_t delivered_ms, int64_t render_estimate_ms) {
+                    setup_latency_.Mark(SetupPhase::kFirstFrameDelivered, delivered_ms);
+                    setup_latency_.Mark(SetupPhase::kFirstFrameRenderEstimate, render_estimate_ms);
+                    thread->PostTask(webrtc::ToQueuedTask(flag, [this] { ReportSetupLatency(); }));
+                }));
+                first_frame_track_ = stream->GetVideoTracks()[0];
+                first_frame_track_->AddOrUpdateSink(first_frame_sink_.get(), rtc::VideoSinkWants());
             }
         }
 
         void RTCConnectionChannel::OnRemoveStream(rtc::scoped_refptr<MediaStreamInterface> stream)
         {
             RTC_LOG(LS_INFO) << "Remote stream removed";
+            if (first_frame_track_ != nullptr && stream->FindVideoTrack(first_frame_track_->id()) != nullptr)
+                RemoveFirstFrameSink();
             std::string remote_id = id();
-            if (events_observer_ != nullptr)
-            {
-                events_observer_->OnRemoteStreamRemoved(remote_id, remote_stream_);
-            }
+            std::shared_ptr<RemoteStream> remote_stream = remote_stream_;
+            PostObserverEvent([remote_id, remote_stream](RTCClientObserver* observer) {
+                observer->OnRemoteStreamRemoved(remote_id, remote_stream);
+            });
         }
 
         void RTCConnectionChannel::OnDataChannel(rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel) {}
 
         void RTCConnectionChannel::OnIceConnectionChange(PeerConnectionInterface::IceConnectionState new_state)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnIceConnectionChange");
             RTC_LOG(LS_INFO) << "Ice connection state changed: " << new_state;
+            ice_connection_state_ = new_state;
 
-            if (events_observer_ != nullptr)
-            {
-                RTCCIceConnectionState state = (RTCCIceConnectionState)new_state;
-                events_observer_->OnICEConnectionStateChanged(id_, state);
-            }
+            RTCCIceConnectionState state = (RTCCIceConnectionState)new_state;
+            std::string id = id_;
+            PostObserverEvent([id, state](RTCClientObserver* observer) {
+                observer->OnICEConnectionStateChanged(id, state);
+            });
+
+            if (new_state == webrtc::PeerConnectionInterface::kIceConnectionChecking)
+                MarkSetupPhase(SetupPhase::kIceChecking);
+            else if (new_state == webrtc::PeerConnectionInterface::kIceConnectionConnected ||
+                new_state == webrtc::PeerConnectionInterface::kIceConnectionCompleted)
+                MarkSetupPhase(SetupPhase::kIceConnected);
 
             switch (new_state) {
             case webrtc::PeerConnectionInterface::kIceConnectionConnected:
             case webrtc::PeerConnectionInterface::kIceConnectionCompleted:
                 ChangeSessionState(kSessionStateConnected);
+                StartStatsSampling();
                 // reset |last_disconnect_|.
                 // last_disconnect_ = std::chrono::time_point<std::chrono::system_clock>::max();
                 break;
@@ -288,12 +677,36 @@ namespace owt
 
         void RTCConnectionChannel::OnIceGatheringChange(PeerConnectionInterface::IceGatheringState new_state)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnIceGatheringChange");
             RTC_LOG(LS_INFO) << "Ice gathering state changed: " << new_state;
+            if (new_state == PeerConnectionInterface::kIceGatheringComplete)
+            {
+                MarkSetupPhase(SetupPhase::kIceGatheringComplete);
+                FlushLocalCandidates();
+            }
+        }
+
+        void RTCConnectionChannel::OnConnectionChange(PeerConnectionInterface::PeerConnectionState new_state)
+        {
+            RTC_LOG(LS_INFO) << "Peer connection state changed: " << static_cast<int>(new_state);
+            // Connected once both ICE and DTLS transports are connected.
+            if (new_state == PeerConnectionInterface::PeerConnectionState::kConnected)
+            {
+                MarkSetupPhase(SetupPhase::kDtlsConnected);
+                ReportSetupLatency();
+            }
+        }
+
+        void RTCConnectionChannel::OnFirstPacketReceived(cricket::MediaType media_type)
+        {
+            MarkSetupPhase(SetupPhase::kFirstPacketReceived);
         }
 
         void RTCConnectionChannel::OnIceCandidate(const webrtc::IceCandidateInterface* candidate)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnIceCandidate");
             RTC_LOG(LS_INFO) << "On ice candidate";
+            MarkSetupPhase(SetupPhase::kFirstLocalCandidate);
             if (events_observer_ != nullptr)
             {
                 std::string sdp;
@@ -302,13 +715,46 @@ namespace owt
                     return;
                 }
                 RTCCIceCandidate ice_candidate = { candidate->sdp_mid(), candidate->sdp_mline_index(), sdp };
-                events_observer_->OnDiscoverLocalCandidate(id_, ice_candidate);
+                if (candidate_batch_window_ms_ <= 0)
+                {
+                    std::string id = id_;
+                    PostObserverEvent([id, ice_candidate](RTCClientObserver* observer) {
+                        observer->OnDiscoverLocalCandidate(id, ice_candidate);
+                    });
+                    return;
+                }
+                pending_local_candidates_.push_back(ice_candidate);
+                if (pending_local_candidates_.size() > 1)
+                    return;
+                // First candidate of a batch starts the window.
+                if (candidate_batch_thread_ == nullptr)
+                {
+                    candidate_batch_thread_ = rtc::Thread::Current();
+                    candidate_batch_flag_ = webrtc::PendingTaskSafetyFlag::Create();
+                }
+                candidate_batch_thread_->PostDelayedTask(
+                    webrtc::ToQueuedTask(candidate_batch_flag_, [this] { FlushLocalCandidates(); }),
+                    candidate_batch_window_ms_);
             }
         }
 
+        void RTCConnectionChannel::FlushLocalCandidates()
+        {
+            if (pending_local_candidates_.empty() || events_observer_ == nullptr)
+                return;
+            std::vector<RTCCIceCandidate> candidates;
+            candidates.swap(pending_local_candidates_);
+            std::string id = id_;
+            PostObserverEvent([id, candidates](RTCClientObserver* observer) {
+                observer->OnDiscoverLocalCandidates(id, candidates);
+            });
+        }
+
         void RTCConnectionChannel::OnCreateSessionDescriptionSuccess(webrtc::SessionDescriptionInterface* desc)
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnCreateSessionDescriptionSuccess");
             RTC_LOG(LS_INFO) << "Create sdp success.";
+            MarkSetupPhase(SetupPhase::kCreateOfferEnd);
             scoped_refptr<FunctionalSetSessionDescriptionObserver> observer =
                 FunctionalSetSessionDescriptionObserver::Create(
                     std::bind(
@@ -329,14 +775,13 @@ namespace owt
             {
                 audio_codecs.push_back(audio_enc_param.codec.name);
             }
-            sdp_string = SdpUtils::SetPreferAudioCodecs(sdp_string, audio_codecs);
-           
             std::vector<VideoCodec> video_codecs;
             for (auto& video_enc_param : configuration_.video)
             {
                 video_codecs.push_back(video_enc_param.codec.name);
             }
-            sdp_string = SdpUtils::SetPreferVideoCodecs(sdp_string, video_codecs);
+            // Parse once, update all m-sections and serialize once.
+            sdp_string = SdpUtils::SetPreferCodecs(sdp_string, audio_codecs, video_codecs);
             webrtc::SessionDescriptionInterface* new_desc(webrtc::CreateSessionDescription(desc->type(), sdp_string, nullptr));
             peer_connection_->SetLocalDescription(observer, new_desc);
         }
@@ -349,7 +794,9 @@ namespace owt
 
         void RTCConnectionChannel::OnSetLocalSessionDescriptionSuccess()
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnSetLocalSessionDescriptionSuccess");
             RTC_LOG(LS_INFO) << "Set local sdp success.";
+            MarkSetupPhase(SetupPhase::kSetLocalDescription);
             {
                 std::lock_guard<std::mutex> lock(is_creating_offer_mutex_);
                 if (is_creating_offer_)
@@ -363,11 +810,11 @@ namespace owt
             std::string sdp;
             desc->ToString(&sdp);
 
-            if (events_observer_ != nullptr)
-            {
-                RTC_LOG(LS_INFO) << "Local SDP is:\n" << sdp;
-                events_observer_->OnDidCreateLocalSDP(id_, sdp);
-            }
+            RTC_LOG(LS_INFO) << "Local SDP is:\n" << sdp;
+            std::string id = id_;
+            PostObserverEvent([id, sdp](RTCClientObserver* observer) {
+                observer->OnDidCreateLocalSDP(id, sdp);
+            });
         }
 
         void RTCConnectionChannel::OnSetLocalSessionDescriptionFailure(const std::string& error)
@@ -378,11 +825,16 @@ namespace owt
 
         void RTCConnectionChannel::OnSetRemoteSessionDescriptionSuccess()
         {
+            OWT_TRACE_EVENT("RTCConnectionChannel::OnSetRemoteSessionDescriptionSuccess");
+            MarkSetupPhase(SetupPhase::kSetRemoteDescription);
+            // Receivers are created by the remote description, and report their first packet.
+            for (const auto& receiver : peer_connection_->GetReceivers())
+                receiver->SetObserver(this);
             PeerConnectionChannel::OnSetRemoteSessionDescriptionSuccess();
-            if (events_observer_ != nullptr)
-            {
-                events_observer_->OnDidSetRemoteSDP(id_);
-            }
+            std::string id = id_;
+            PostObserverEvent([id](RTCClientObserver* observer) {
+                observer->OnDidSetRemoteSDP(id);
+            });
         }
 
         void RTCConnectionChannel::OnSetRemoteSessionDescriptionFailure(const std::string& error)
@@ -426,34 +878,139 @@ namespace owt
 
         void RTCConnectionChannel::DrainPendingRemoteCandidates()
         {
-            std::lock_guard<std::mutex> lock(pending_remote_icecandidates_mutex_);
-            for (const auto& tuple : pending_remote_icecandidates_)
+            if (!peer_connection_ || !peer_connection_->remote_description())
+                return;
+            std::vector<RTCCIceCandidate> candidates;
             {
-                std::string sdp = std::get<0>(tuple);
-                std::string sdp_mid = std::get<1>(tuple);
-                int sdp_mline_index = std::get<2>(tuple);
-                webrtc::IceCandidateInterface* ice_candidate = webrtc::CreateIceCandidate(sdp_mid, sdp_mline_index, sdp, nullptr);
-                if (!peer_connection_->AddIceCandidate(ice_candidate))
-                {
-                    RTC_LOG(LS_WARNING) << "Failed to add remote candidate.";
-                }
+                std::lock_guard<std::mutex> lock(pending_remote_icecandidates_mutex_);
+                remote_description_ready_ = true;
+                candidates.swap(pending_remote_icecandidates_);
             }
+            AddRemoteCandidates(candidates);
         }
 
         void RTCConnectionChannel::GetConnectionStats()
         {
             RTC_LOG(LS_INFO) << "GetConnectionStats";
             std::function<void(std::shared_ptr<ConnectionStats>)> callback = [this](std::shared_ptr<ConnectionStats> s) {
-                if (events_observer_ != nullptr)
-                {
-                    events_observer_->OnDidGetConnectionStats(id_, *s);
-                }
+                std::string id = id_;
+                PostObserverEvent([id, s](RTCClientObserver* observer) {
+                    observer->OnDidGetConnectionStats(id, *s);
+                });
             };
 
             rtc::scoped_refptr<FunctionalStatsObserver> observer = FunctionalStatsObserver::Create(std::move(callback));
             peer_connection_->GetStats(observer, nullptr, webrtc::PeerConnectionInterface::kStatsOutputLevelDebug);
         }
 
+        void RTCConnectionChannel::GetFlatConnectionStats(std::function<void(const FlatConnectionStats&)> on_complete)
+        {
+            if (peer_connection_ == nullptr)
+                return;
+            if (!on_complete)
+                return;
+            std::shared_ptr<FlatStatsHolder> holder = flat_stats_;
+            rtc::scoped_refptr<FunctionalNativeStatsObserver> observer = FunctionalNativeStatsObserver::Create(
+                [holder, on_complete](const webrtc::StatsReports& reports) {
+                    {
+                        std::lock_guard<std::mutex> lock(holder->mutex);
+                        FlatStatsConverter::Convert(reports, &holder->stats);
+                    }
+                    // A queued callback may see a later fill of the buffer, which is still a
+                    // complete snapshot.
+                    PostCallback([holder, on_complete] {
+                        std::lock_guard<std::mutex> lock(holder->mutex);
+                        on_complete(holder->stats);
+                    });
+                });
+            peer_connection_->GetStats(observer, nullptr, webrtc::PeerConnectionInterface::kStatsOutputLevelStandard);
+        }
+
+        rtc::scoped_refptr<webrtc::RTCStatsCollectorCallback> RTCConnectionChannel::CreateStatsCallback(
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success, uint32_t type_mask)
+        {
+            return FunctionalStandardRTCStatsCollectorCallback::Create(
+                [on_success](std::shared_ptr<RTCStatsReport> report) {
+                    if (on_success)
+                        PostCallback([on_success, report] { on_success(report); });
+                },
+                type_mask);
+        }
+
+        void RTCConnectionChannel::ReportStatsFailure(std::function<void(std::unique_ptr<Exception>)> on_failure,
+            const std::string& message)
+        {
+            RTC_LOG(LS_WARNING) << message;
+            if (!on_failure)
+                return;
+            PostCallback([on_failure, message] {
+                on_failure(std::make_unique<Exception>(ExceptionType::kUnknown, message));
+            });
+        }
+
+        void RTCConnectionChannel::GetStats(std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            if (peer_connection_ == nullptr)
+            {
+                ReportStatsFailure(on_failure, "PeerConnection is not available.");
+                return;
+            }
+            peer_connection_->GetStats(CreateStatsCallback(std::move(on_success)));
+        }
+
+        void RTCConnectionChannel::GetStats(uint32_t type_mask,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            if (peer_connection_ == nullptr)
+            {
+                ReportStatsFailure(on_failure, "PeerConnection is not available.");
+                return;
+            }
+            peer_connection_->GetStats(CreateStatsCallback(std::move(on_success), type_mask));
+        }
+
+        void RTCConnectionChannel::GetSenderStats(const std::string& track_id,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            if (peer_connection_ == nullptr)
+            {
+                ReportStatsFailure(on_failure, "PeerConnection is not available.");
+                return;
+            }
+            for (const auto& sender : peer_connection_->GetSenders())
+            {
+                if (sender->id() == track_id || (sender->track() && sender->track()->id() == track_id))
+                {
+                    peer_connection_->GetStats(sender, CreateStatsCallback(std::move(on_success)));
+                    return;
+                }
+            }
+            ReportStatsFailure(on_failure, "No sender for track " + track_id + ".");
+        }
+
+        void RTCConnectionChannel::GetReceiverStats(const std::string& track_id,
+            std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+            std::function<void(std::unique_ptr<Exception>)> on_failure)
+        {
+            if (peer_connection_ == nullptr)
+            {
+                ReportStatsFailure(on_failure, "PeerConnection is not available.");
+                return;
+            }
+            for (const auto& receiver : peer_connection_->GetReceivers())
+            {
+                if (receiver->id() == track_id || (receiver->track() && receiver->track()->id() == track_id))
+                {
+                    peer_connection_->GetStats(receiver, CreateStatsCallback(std::move(on_success)));
+                    return;
+                }
+            }
+            ReportStatsFailure(on_failure, "No receiver for track " + track_id + ".");
+        }
+
         void RTCConnectionChannel::ResetPeerConnectionFactory() 
         {
             PeerConnectionDependencyFactory::Reset();
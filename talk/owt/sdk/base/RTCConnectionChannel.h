@@ -1,7 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 #include "talk/owt/sdk/include/cpp/owt/base/RTCClientObserver.h"
+#include "talk/owt/sdk/base/adaptationmonitor.h"
 #include "talk/owt/sdk/base/peerconnectionchannel.h"
+#include "talk/owt/sdk/base/qualityscorer.h"
+#include "talk/owt/sdk/base/setuplatency.h"
+#include "talk/owt/sdk/base/statsaggregator.h"
+#include "talk/owt/sdk/base/statssampler.h"
+#include "talk/owt/sdk/base/videoadaptationnotifier.h"
+#include "webrtc/api/media_stream_interface.h"
+#include "webrtc/api/rtp_receiver_interface.h"
+#include "webrtc/rtc_base/task_utils/pending_task_safety_flag.h"
 
 namespace owt
 {
@@ -26,10 +42,14 @@ namespace owt
             kSessionStateConnected,
         };
 
-        class RTCConnectionChannel : public PeerConnectionChannel
+        class RTCConnectionChannel : public PeerConnectionChannel, public StatsAggregatorSource,
+            public webrtc::RtpReceiverObserverInterface, public VideoAdaptationObserver
         {
         public:
-            explicit RTCConnectionChannel(PeerConnectionChannelConfiguration config, const std::string& id);
+            // If |initialize_peer_connection| is false, the PeerConnection is not
+            // created in the constructor, call `InitializePeerConnectionAsync` instead.
+            explicit RTCConnectionChannel(PeerConnectionChannelConfiguration config, const std::string& id,
+                bool initialize_peer_connection = true);
             virtual ~RTCConnectionChannel();
             // Unique id
             std::string id() const;
@@ -47,12 +67,62 @@ namespace owt
             void SetRemoteSDP(const std::string& sdp, const std::string& type);
             // Set ICE candidates
             void SetRemoteICECandidate(const std::string& sdp, const std::string& sdp_mid, int sdp_mline_index);
+            void SetRemoteICECandidates(const std::vector<RTCCIceCandidate>& candidates);
+            // Report local candidates gathered within |batch_window_ms| together, 0 to report each
+            // one immediately. Keep at most |max_pending_remote_candidates| remote candidates
+            // received before the remote description.
+            void SetCandidateOptions(int batch_window_ms, size_t max_pending_remote_candidates);
+            // Sample stats every |interval_ms| once ICE is connected, keeping |history_size|
+            // samples. 0 disables sampling. Also registers with StatsAggregator if it is enabled.
+            void SetStatsSamplingOptions(int interval_ms, size_t history_size);
+            // Score the media quality of each stats sample and report it to the observer.
+            // Requires stats sampling.
+            void SetQualityScoringEnabled(bool enabled);
+            // Returns false if sampling is disabled or no sample is taken yet.
+            bool GetLatestStatsSample(RTCCStatsSample* sample) const;
+            std::vector<RTCCStatsSample> GetStatsSampleHistory() const;
+            // Report bandwidth estimation and encoder adaptation changes to the observer. They are
+            // pushed by sources and encoders supporting it, and checked in stats sampled every
+            // |interval_ms| once ICE is connected otherwise, at the sampling interval if sampling
+            // is enabled. 0 disables the reports.
+            void SetAdaptationMonitorOptions(int interval_ms);
+            // Latency of each setup phase so far. Thread safe.
+            RTCCSetupLatency GetSetupLatency() const;
+
+            // StatsAggregatorSource
+            virtual void GetStatsAggregatorInput(StatsAggregatorInput* input) override;
+            // VideoAdaptationObserver, for tracks published by this channel.
+            void OnVideoSourceAdapted(const std::string& track_id, int width, int height, int max_fps) override;
+            void OnVideoEncoderBitrateChanged(const std::string& track_id, uint64_t bitrate_bps) override;
             // Close PC
             void ClosePeerConnection();
+            // Create PC on the factory thread, `on_complete` is invoked there when done.
+            using PeerConnectionChannel::InitializePeerConnectionAsync;
+            // Close PC on the factory thread without blocking the caller.
+            using PeerConnectionChannel::ClosePeerConnectionAsync;
             // Add `RTCClientObserver` observer
             void AddObserver(RTCClientObserver* observer);
             // Get connection stats: fps, resolution, bps etc.
             void GetConnectionStats();
+            // Get connection stats into a buffer reused by each call. |on_complete| is invoked on
+            // the same thread as observer events, the stats are valid only during the call.
+            void GetFlatConnectionStats(std::function<void(const FlatConnectionStats&)> on_complete);
+            // Get standard stats of the whole connection.
+            void GetStats(std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+            // Get standard stats of the types in |type_mask|, a combination of RTCStatsTypeMask.
+            // Stats of other types are not converted.
+            void GetStats(uint32_t type_mask,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+            // Get standard stats of the sender or receiver of |track_id| only. Stats of other
+            // streams are not collected.
+            void GetSenderStats(const std::string& track_id,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+            void GetReceiverStats(const std::string& track_id,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
 
             // PeerConnectionObserver
             virtual void OnSignalingChange(PeerConnectionInterface::SignalingState new_state) override;
@@ -62,6 +132,10 @@ namespace owt
             virtual void OnIceConnectionChange(PeerConnectionInterface::IceConnectionState new_state) override;
             virtual void OnIceGatheringChange(PeerConnectionInterface::IceGatheringState new_state) override;
             virtual void OnIceCandidate(const webrtc::IceCandidateInterface* candidate) override;
+            virtual void OnConnectionChange(PeerConnectionInterface::PeerConnectionState new_state) override;
+
+            // RtpReceiverObserverInterface
+            virtual void OnFirstPacketReceived(cricket::MediaType media_type) override;
 
             // CreateSessionDescriptionObserver
             virtual void OnCreateSessionDescriptionSuccess(webrtc::SessionDescriptionInterface* desc) override;
@@ -84,7 +158,15 @@ namespace owt
 
             RTCClientObserver* events_observer_;
 
-            // std::shared_ptr<rtc::TaskQueue> event_queue_;
+            // Observer used by queued events. It is reset when the channel is destroyed, so
+            // pending events are dropped.
+            struct ObserverHolder
+            {
+                // Recursive so a callback can destroy its own RTCClient.
+                std::recursive_mutex mutex;
+                RTCClientObserver* observer = nullptr;
+            };
+            std::shared_ptr<ObserverHolder> observer_holder_;
 
             // Last time |peer_connection_| changes its state to "disconnect".
             // std::chrono::time_point<std::chrono::system_clock>
@@ -94,10 +176,90 @@ namespace owt
             bool is_creating_offer_;
             std::mutex is_creating_offer_mutex_;
 
-            std::vector<std::tuple<std::string, std::string, int>>
-                pending_remote_icecandidates_;
+            // Remote candidates received before the remote description is set.
+            std::vector<RTCCIceCandidate> pending_remote_icecandidates_;
+            // Set on signaling thread once the remote description is applied, candidates are
+            // added directly afterwards. Protected by |pending_remote_icecandidates_mutex_|.
+            bool remote_description_ready_;
+            size_t max_pending_remote_candidates_;
             std::mutex pending_remote_icecandidates_mutex_;
 
+            // Local candidates waiting for the batch window to end. Signaling thread only.
+            std::vector<RTCCIceCandidate> pending_local_candidates_;
+            int candidate_batch_window_ms_;
+            // Thread batch timers are posted to, and the flag cancelling them.
+            rtc::Thread* candidate_batch_thread_;
+            rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> candidate_batch_flag_;
+
+            // Filled by GetFlatConnectionStats() on the signaling thread and read by its callbacks,
+            // which may run on the observer event queue.
+            struct FlatStatsHolder
+            {
+                std::mutex mutex;
+                FlatConnectionStats stats;
+            };
+            std::shared_ptr<FlatStatsHolder> flat_stats_;
+
+            // Null if sampling is disabled.
+            std::unique_ptr<StatsSampler> stats_sampler_;
+            int stats_sampling_interval_ms_;
+            // Null if quality scoring is disabled. Signaling thread only.
+            std::unique_ptr<QualityScorer> quality_scorer_;
+            RTCCStatsSample quality_sample_;
+            RTCCQualityScores quality_scores_;
+            // Null if adaptation checks are disabled. Updated on the signaling thread by sampled
+            // stats, and on capturing and encoding threads by pushed changes.
+            std::unique_ptr<AdaptationMonitor> adaptation_monitor_;
+            int adaptation_monitor_interval_ms_;
+            std::mutex adaptation_mutex_;
+            // IDs of published video tracks, whose pushed changes are reported. Guarded by
+            // |adaptation_mutex_|.
+            std::set<std::string> published_video_tracks_;
+            // Signaling thread, set when sampling starts. Samples are taken on it.
+            rtc::Thread* stats_sampling_thread_;
+            rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> stats_sampling_flag_;
+            // Keeps the enabled state of a track created on this connection's factory shard in sync
+            // with the local track it is created from.
+            class ShardTrackMirror : public webrtc::ObserverInterface
+            {
+            public:
+                ShardTrackMirror(rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track,
+                    rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> shard_track);
+                ~ShardTrackMirror() override;
+                // Called on the signaling thread of the default factory.
+                void OnChanged() override;
+
+            private:
+                rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track_;
+                rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> shard_track_;
+            };
+
+            // Empty if the connection is on the default factory, whose tracks are published directly.
+            std::vector<std::unique_ptr<ShardTrackMirror>> shard_track_mirrors_;
+            // Records the first remote video frame, on the decoding thread.
+            class FirstFrameSink : public rtc::VideoSinkInterface<webrtc::VideoFrame>
+            {
+            public:
+                // |on_first_frame| is invoked with the delivery time and the estimated render time of the
+                // first frame.
+                explicit FirstFrameSink(std::function<void(int64_t, int64_t)> on_first_frame);
+                void OnFrame(const webrtc::VideoFrame& frame) override;
+
+            private:
+                std::atomic<bool> received_;
+                std::function<void(int64_t, int64_t)> on_first_frame_;
+            };
+
+            SetupLatencyTracker setup_latency_;
+            // Remote video track |first_frame_sink_| is added to.
+            rtc::scoped_refptr<webrtc::VideoTrackInterface> first_frame_track_;
+            std::unique_ptr<FirstFrameSink> first_frame_sink_;
+            // Signaling thread, and the flag cancelling tasks posted by |first_frame_sink_|.
+            rtc::Thread* setup_latency_thread_;
+            rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> setup_latency_flag_;
+            // Latest PeerConnectionInterface::IceConnectionState, read by StatsAggregator.
+            std::atomic<int> ice_connection_state_;
+
             std::tuple<std::string, std::string> pending_remote_sdp_;
 
             SessionState session_state_;
@@ -107,6 +269,28 @@ namespace owt
             void CleanLastPeerConnection();
 
             void DrainPendingRemoteCandidates();
+            void AddRemoteCandidates(const std::vector<RTCCIceCandidate>& candidates);
+            void FlushLocalCandidates();
+            void StartStatsSampling();
+            // Query stats, sample them and check adaptation changes, and schedule the next sample
+            // when they are delivered.
+            void SampleStats();
+            void PostAdaptationChanges(const AdaptationChanges& changes);
+            // Record |phase| of the setup at current time.
+            void MarkSetupPhase(SetupPhase phase);
+            void ReportSetupLatency();
+            void RemoveFirstFrameSink();
+            // Invoke |event| with the observer, on current thread or through
+            // ObserverEventQueue depending on GlobalConfiguration::SetObserverEventDispatchMode().
+            void PostObserverEvent(std::function<void(RTCClientObserver*)> event);
+            // Run |callback| on current thread or through ObserverEventQueue, as observer events.
+            static void PostCallback(std::function<void()> callback);
+            // Returns a stats collector callback delivering stats in |type_mask| to |on_success|.
+            static rtc::scoped_refptr<webrtc::RTCStatsCollectorCallback> CreateStatsCallback(
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                uint32_t type_mask = RTCStatsTypeMask::kAll);
+            static void ReportStatsFailure(std::function<void(std::unique_ptr<Exception>)> on_failure,
+                const std::string& message);
         };
     }
 	
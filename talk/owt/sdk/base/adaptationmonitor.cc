@@ -0,0 +1,173 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/adaptationmonitor.h"
+#include <algorithm>
+#include <cmath>
+namespace owt {
+namespace base {
+namespace {
+// Relative changes smaller than these are fluctuations, not adaptations.
+const double kTargetBitrateChangeThreshold = 0.1;
+const double kFrameRateChangeThreshold = 0.2;
+
+RTCCQualityLimitationReason ToQualityLimitationReason(
+    const std::string& reason) {
+  if (reason == RTCQualityLimitationReason::kCpu)
+    return kQualityLimitationCpu;
+  if (reason == RTCQualityLimitationReason::kBandwidth)
+    return kQualityLimitationBandwidth;
+  if (reason == RTCQualityLimitationReason::kOther)
+    return kQualityLimitationOther;
+  return kQualityLimitationNone;
+}
+
+bool ChangedBeyond(double previous, double current, double threshold) {
+  return std::abs(current - previous) > previous * threshold;
+}
+}
+
+AdaptationMonitor::AdaptationMonitor()
+    : target_bitrate_bps_(0), target_bitrate_pushed_(false) {}
+
+void AdaptationMonitor::Update(const RTCStatsReport& report,
+                               AdaptationChanges* changes) {
+  ClearChanges(changes);
+  if (!target_bitrate_pushed_)
+    UpdateTargetBitrate(GetTargetBitrate(report), changes);
+
+  std::map<uint32_t, RTCCVideoSenderAdaptation> senders;
+  for (const RTCStats& stats : report) {
+    if (stats.type != RTCStatsType::kOutboundRTP)
+      continue;
+    const auto& outbound = stats.cast_to<RTCOutboundRTPStreamStats>();
+    if (outbound.kind != RTCMediaStreamTrackKind::kVideo)
+      continue;
+    RTCCVideoSenderAdaptation sender;
+    GetVideoSender(report, outbound, &sender);
+    auto previous = senders_.find(sender.ssrc);
+    if (previous == senders_.end()) {
+      // A new sender only reports that it starts limited.
+      if (sender.quality_limitation_reason != kQualityLimitationNone)
+        changes->quality_limitation_changes.push_back(sender);
+      senders[sender.ssrc] = sender;
+      continue;
+    }
+    const RTCCVideoSenderAdaptation& last = previous->second;
+    bool quality_limitation_changed =
+        sender.quality_limitation_reason != last.quality_limitation_reason;
+    // The first encoded frame sets the resolution, it is not an adaptation.
+    bool started = last.frame_width == 0 || last.frame_rate == 0;
+    bool video_adapted =
+        !started && sources_.count(sender.track_id) == 0 &&
+        (sender.resolution_changes != last.resolution_changes ||
+         sender.frame_width != last.frame_width ||
+         sender.frame_height != last.frame_height ||
+         ChangedBeyond(last.frame_rate, sender.frame_rate,
+                       kFrameRateChangeThreshold));
+    if (quality_limitation_changed)
+      changes->quality_limitation_changes.push_back(sender);
+    if (video_adapted)
+      changes->video_adaptation_changes.push_back(sender);
+    // Frame rate is compared with the last reported one, so a slow drift is
+    // eventually reported.
+    senders[sender.ssrc] =
+        quality_limitation_changed || video_adapted || started ? sender
+                                                               : last;
+  }
+  // Senders missing from |report| are removed.
+  senders_.swap(senders);
+}
+
+void AdaptationMonitor::OnEncoderBitrate(uint64_t bitrate_bps,
+                                         AdaptationChanges* changes) {
+  ClearChanges(changes);
+  target_bitrate_pushed_ = true;
+  UpdateTargetBitrate(bitrate_bps, changes);
+}
+
+void AdaptationMonitor::OnVideoSourceAdapted(const std::string& track_id,
+                                             int width,
+                                             int height,
+                                             int max_fps,
+                                             AdaptationChanges* changes) {
+  ClearChanges(changes);
+  RTCCVideoSenderAdaptation source;
+  // Other fields come from the last stats report.
+  for (const auto& sender : senders_) {
+    if (sender.second.track_id == track_id) {
+      source = sender.second;
+      break;
+    }
+  }
+  source.track_id = track_id;
+  source.frame_width = width;
+  source.frame_height = height;
+  source.frame_rate = max_fps;
+  auto previous = sources_.find(track_id);
+  // The first frame sets the resolution, it is not an adaptation.
+  if (previous != sources_.end() &&
+      (previous->second.frame_width != source.frame_width ||
+       previous->second.frame_height != source.frame_height ||
+       previous->second.frame_rate != source.frame_rate)) {
+    changes->video_adaptation_changes.push_back(source);
+  }
+  sources_[track_id] = source;
+}
+
+void AdaptationMonitor::ClearChanges(AdaptationChanges* changes) {
+  changes->target_bitrate_changed = false;
+  changes->target_bitrate_bps = 0;
+  changes->quality_limitation_changes.clear();
+  changes->video_adaptation_changes.clear();
+}
+
+void AdaptationMonitor::UpdateTargetBitrate(uint64_t target_bitrate_bps,
+                                            AdaptationChanges* changes) {
+  if (target_bitrate_bps > 0 &&
+      (target_bitrate_bps_ == 0 ||
+       ChangedBeyond(static_cast<double>(target_bitrate_bps_),
+                     static_cast<double>(target_bitrate_bps),
+                     kTargetBitrateChangeThreshold))) {
+    target_bitrate_bps_ = target_bitrate_bps;
+    changes->target_bitrate_changed = true;
+    changes->target_bitrate_bps = target_bitrate_bps;
+  }
+}
+
+uint64_t AdaptationMonitor::GetTargetBitrate(const RTCStatsReport& report) {
+  double bitrate = 0;
+  for (const RTCStats& stats : report) {
+    if (stats.type != RTCStatsType::kTransport)
+      continue;
+    const auto& transport = stats.cast_to<RTCTransportStats>();
+    const RTCStats* pair = report.Get(transport.selected_candidate_pair_id);
+    if (pair == nullptr || pair->type != RTCStatsType::kCandidatePair)
+      continue;
+    // Transports share the estimation of the call, it is reported on each.
+    bitrate = std::max(bitrate, pair->cast_to<RTCIceCandidatePairStats>()
+                                    .available_outgoing_bitrate);
+  }
+  return static_cast<uint64_t>(bitrate);
+}
+
+void AdaptationMonitor::GetVideoSender(
+    const RTCStatsReport& report,
+    const RTCOutboundRTPStreamStats& outbound,
+    RTCCVideoSenderAdaptation* sender) {
+  sender->ssrc = outbound.ssrc;
+  sender->quality_limitation_reason =
+      ToQualityLimitationReason(outbound.quality_limitation_reason);
+  sender->resolution_changes = outbound.quality_limitation_resolution_changes;
+  sender->target_bitrate_bps = outbound.target_bitrate;
+  const RTCStats* track = report.Get(outbound.track_id);
+  if (track == nullptr || track->type != RTCStatsType::kTrack)
+    return;
+  const auto& track_stats = track->cast_to<RTCMediaStreamTrackStats>();
+  sender->track_id = track_stats.track_identifier;
+  sender->frame_width = track_stats.frame_width;
+  sender->frame_height = track_stats.frame_height;
+  sender->frame_rate = track_stats.frames_per_second;
+}
+}
+}
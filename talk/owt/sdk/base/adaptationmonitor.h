@@ -0,0 +1,68 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_ADAPTATIONMONITOR_H_
+#define OWT_BASE_ADAPTATIONMONITOR_H_
+#include <map>
+#include <string>
+#include <vector>
+#include "owt/base/RTCClientObserver.h"
+#include "owt/base/connectionstats.h"
+namespace owt {
+namespace base {
+// Changes found by AdaptationMonitor::Update().
+struct AdaptationChanges {
+  bool target_bitrate_changed = false;
+  uint64_t target_bitrate_bps = 0;
+  // Video senders whose quality limitation reason changed.
+  std::vector<RTCCVideoSenderAdaptation> quality_limitation_changes;
+  // Video senders whose resolution or frame rate changed.
+  std::vector<RTCCVideoSenderAdaptation> video_adaptation_changes;
+};
+
+// Detects bandwidth estimation and encoder adaptation changes of a connection.
+// Changes are pushed by sources and encoders of sent tracks when they support
+// it, and found by comparing consecutive stats reports otherwise. Small
+// fluctuations of the target bitrate and the frame rate are not reported. Not
+// thread safe.
+class AdaptationMonitor {
+ public:
+  AdaptationMonitor();
+  // Compare |report| with the previous one, |changes| is cleared first.
+  // Target bitrate and video adaptation already pushed are not compared.
+  void Update(const RTCStatsReport& report, AdaptationChanges* changes);
+  // Bitrate allocated to the encoder of a sent track. Once it is pushed, the
+  // target bitrate of stats reports is ignored.
+  void OnEncoderBitrate(uint64_t bitrate_bps, AdaptationChanges* changes);
+  // Frames of sent track |track_id| are adapted to |width|x|height| and at
+  // most |max_fps| frames per second, 0 if not limited. Once it is pushed,
+  // resolution and frame rate of the track in stats reports are ignored.
+  void OnVideoSourceAdapted(const std::string& track_id,
+                            int width,
+                            int height,
+                            int max_fps,
+                            AdaptationChanges* changes);
+
+ private:
+  // Available outgoing bitrate of the selected candidate pairs, 0 if unknown.
+  static uint64_t GetTargetBitrate(const RTCStatsReport& report);
+  static void GetVideoSender(const RTCStatsReport& report,
+                             const RTCOutboundRTPStreamStats& outbound,
+                             RTCCVideoSenderAdaptation* sender);
+  static void ClearChanges(AdaptationChanges* changes);
+  // Report |target_bitrate_bps| if it changes beyond the threshold.
+  void UpdateTargetBitrate(uint64_t target_bitrate_bps,
+                           AdaptationChanges* changes);
+
+  // Last reported target bitrate, 0 if none is reported yet.
+  uint64_t target_bitrate_bps_;
+  // True once a target bitrate is pushed by an encoder.
+  bool target_bitrate_pushed_;
+  // Last reported state of each video sender, by SSRC.
+  std::map<uint32_t, RTCCVideoSenderAdaptation> senders_;
+  // Last pushed state of each video source, by track ID.
+  std::map<std::string, RTCCVideoSenderAdaptation> sources_;
+};
+}
+}
+#endif  // OWT_BASE_ADAPTATIONMONITOR_H_
@@ -0,0 +1,171 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/adaptationmonitor.h"
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+namespace {
+const uint32_t kVideoSsrc = 3333;
+
+struct VideoSenderState {
+  double available_outgoing_bitrate = 1000000;
+  std::string quality_limitation_reason = RTCQualityLimitationReason::kNone;
+  uint32_t resolution_changes = 0;
+  uint32_t frame_width = 1280;
+  uint32_t frame_height = 720;
+  double frames_per_second = 30;
+};
+
+std::unique_ptr<RTCStatsReport> CreateReport(const VideoSenderState& state) {
+  auto report = std::make_unique<RTCStatsReport>();
+  report->AddStats(std::make_unique<RTCTransportStats>(
+      "transport", 0, 0, 0, "", "connected", "pair", "", "", "", "", "", 1));
+  report->AddStats(std::make_unique<RTCIceCandidatePairStats>(
+      "pair", 0, "transport", "local", "remote", "succeeded", 0, true, true,
+      true, 0, 0, 0, 0, state.available_outgoing_bitrate, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0));
+  report->AddStats(std::make_unique<RTCMediaStreamTrackStats>(
+      "track", 0, "camera", "source", false, false, false,
+      RTCMediaStreamTrackKind::kVideo, 0, 0, state.frame_width,
+      state.frame_height, state.frames_per_second, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  report->AddStats(std::make_unique<RTCOutboundRTPStreamStats>(
+      "outbound", 0, kVideoSsrc, false, "video",
+      RTCMediaStreamTrackKind::kVideo, "track", "transport", "", 0, 0, 0, 0, 0,
+      "source", "", 0, 0, 0, 0, 0, 800000, 0, 0, 0, 0, 0,
+      state.quality_limitation_reason, state.resolution_changes, "", ""));
+  return report;
+}
+}  // namespace
+
+TEST(AdaptationMonitorTest, ReportsInitialTargetBitrate) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  monitor.Update(*CreateReport(VideoSenderState()), &changes);
+  EXPECT_TRUE(changes.target_bitrate_changed);
+  EXPECT_EQ(1000000u, changes.target_bitrate_bps);
+  EXPECT_TRUE(changes.quality_limitation_changes.empty());
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+
+  monitor.Update(*CreateReport(VideoSenderState()), &changes);
+  EXPECT_FALSE(changes.target_bitrate_changed);
+}
+
+TEST(AdaptationMonitorTest, IgnoresSmallTargetBitrateChanges) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  VideoSenderState state;
+  monitor.Update(*CreateReport(state), &changes);
+  state.available_outgoing_bitrate = 1050000;
+  monitor.Update(*CreateReport(state), &changes);
+  EXPECT_FALSE(changes.target_bitrate_changed);
+  // Compared with the last reported value, not the last seen one.
+  state.available_outgoing_bitrate = 1150000;
+  monitor.Update(*CreateReport(state), &changes);
+  EXPECT_TRUE(changes.target_bitrate_changed);
+  EXPECT_EQ(1150000u, changes.target_bitrate_bps);
+}
+
+TEST(AdaptationMonitorTest, ReportsQualityLimitationChange) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  VideoSenderState state;
+  monitor.Update(*CreateReport(state), &changes);
+  state.quality_limitation_reason = RTCQualityLimitationReason::kBandwidth;
+  monitor.Update(*CreateReport(state), &changes);
+  ASSERT_EQ(1u, changes.quality_limitation_changes.size());
+  const RTCCVideoSenderAdaptation& sender =
+      changes.quality_limitation_changes[0];
+  EXPECT_EQ(kVideoSsrc, sender.ssrc);
+  EXPECT_EQ("camera", sender.track_id);
+  EXPECT_EQ(kQualityLimitationBandwidth, sender.quality_limitation_reason);
+  EXPECT_DOUBLE_EQ(800000, sender.target_bitrate_bps);
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+}
+
+TEST(AdaptationMonitorTest, ReportsResolutionAdaptation) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  VideoSenderState state;
+  monitor.Update(*CreateReport(state), &changes);
+  state.quality_limitation_reason = RTCQualityLimitationReason::kCpu;
+  state.resolution_changes = 1;
+  state.frame_width = 960;
+  state.frame_height = 540;
+  monitor.Update(*CreateReport(state), &changes);
+  ASSERT_EQ(1u, changes.video_adaptation_changes.size());
+  EXPECT_EQ(960u, changes.video_adaptation_changes[0].frame_width);
+  EXPECT_EQ(1u, changes.video_adaptation_changes[0].resolution_changes);
+  ASSERT_EQ(1u, changes.quality_limitation_changes.size());
+  EXPECT_EQ(kQualityLimitationCpu,
+            changes.quality_limitation_changes[0].quality_limitation_reason);
+}
+
+TEST(AdaptationMonitorTest, ReportsFrameRateSteps) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  VideoSenderState state;
+  monitor.Update(*CreateReport(state), &changes);
+  state.frames_per_second = 28;
+  monitor.Update(*CreateReport(state), &changes);
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+  state.frames_per_second = 15;
+  monitor.Update(*CreateReport(state), &changes);
+  ASSERT_EQ(1u, changes.video_adaptation_changes.size());
+  EXPECT_DOUBLE_EQ(15, changes.video_adaptation_changes[0].frame_rate);
+}
+
+TEST(AdaptationMonitorTest, FirstFrameIsNotAdaptation) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  VideoSenderState state;
+  state.frame_width = 0;
+  state.frame_height = 0;
+  state.frames_per_second = 0;
+  monitor.Update(*CreateReport(state), &changes);
+  monitor.Update(*CreateReport(VideoSenderState()), &changes);
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+  state = VideoSenderState();
+  state.frame_width = 640;
+  state.frame_height = 360;
+  monitor.Update(*CreateReport(state), &changes);
+  EXPECT_EQ(1u, changes.video_adaptation_changes.size());
+}
+
+TEST(AdaptationMonitorTest, PushedEncoderBitrateReplacesEstimation) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  monitor.OnEncoderBitrate(500000, &changes);
+  EXPECT_TRUE(changes.target_bitrate_changed);
+  EXPECT_EQ(500000u, changes.target_bitrate_bps);
+  monitor.OnEncoderBitrate(520000, &changes);
+  EXPECT_FALSE(changes.target_bitrate_changed);
+  // Estimation of stats reports is ignored once a bitrate is pushed.
+  monitor.Update(*CreateReport(VideoSenderState()), &changes);
+  EXPECT_FALSE(changes.target_bitrate_changed);
+}
+
+TEST(AdaptationMonitorTest, ReportsPushedSourceAdaptation) {
+  AdaptationMonitor monitor;
+  AdaptationChanges changes;
+  monitor.Update(*CreateReport(VideoSenderState()), &changes);
+  monitor.OnVideoSourceAdapted("camera", 1280, 720, 0, &changes);
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+  monitor.OnVideoSourceAdapted("camera", 640, 360, 15, &changes);
+  ASSERT_EQ(1u, changes.video_adaptation_changes.size());
+  const RTCCVideoSenderAdaptation& source = changes.video_adaptation_changes[0];
+  EXPECT_EQ(kVideoSsrc, source.ssrc);
+  EXPECT_EQ("camera", source.track_id);
+  EXPECT_EQ(640u, source.frame_width);
+  EXPECT_EQ(360u, source.frame_height);
+  EXPECT_DOUBLE_EQ(15, source.frame_rate);
+  // Resolution of stats reports is not compared for pushed tracks.
+  VideoSenderState state;
+  state.frame_width = 640;
+  state.frame_height = 360;
+  monitor.Update(*CreateReport(state), &changes);
+  EXPECT_TRUE(changes.video_adaptation_changes.empty());
+}
+}
+}
@@ -0,0 +1,87 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/certificatecache.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/rtc_certificate_generator.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+CertificateCache::CertificateCache(const CertificateCacheConfiguration& config)
+    : config_(config),
+      thread_(rtc::Thread::Create()),
+      generation_time_ms_(0),
+      generation_pending_(false) {
+  thread_->SetName("certificate_generation_thread", nullptr);
+  thread_->Start();
+}
+
+CertificateCache::~CertificateCache() {
+  // Waits for the generation in progress. Queued ones are dropped.
+  thread_->Stop();
+}
+
+void CertificateCache::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ScheduleGeneration();
+}
+
+rtc::KeyParams CertificateCache::KeyParamsForType(CertificateKeyType key_type) {
+  switch (key_type) {
+    case CertificateKeyType::kRsa:
+      return rtc::KeyParams::RSA(rtc::kRsaDefaultModSize);
+    case CertificateKeyType::kEcdsa:
+    default:
+      return rtc::KeyParams::ECDSA(rtc::EC_NIST_P256);
+  }
+}
+
+rtc::scoped_refptr<rtc::RTCCertificate> CertificateCache::GetCertificate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!certificate_) {
+    // Retry if the last generation failed.
+    ScheduleGeneration();
+    return nullptr;
+  }
+  if (rtc::TimeMillis() - generation_time_ms_ >= config_.rotation_interval_ms)
+    ScheduleGeneration();
+  if (certificate_->HasExpired(rtc::TimeUTCMillis()))
+    return nullptr;
+  return certificate_;
+}
+
+bool CertificateCache::WaitForCertificate(int timeout_ms) {
+  int64_t deadline_ms = rtc::TimeMillis() + timeout_ms;
+  while (!GetCertificate()) {
+    if (rtc::TimeMillis() >= deadline_ms)
+      return false;
+    rtc::Thread::SleepMs(1);
+  }
+  return true;
+}
+
+void CertificateCache::ScheduleGeneration() {
+  if (generation_pending_)
+    return;
+  generation_pending_ = true;
+  thread_->PostTask(RTC_FROM_HERE, [this] { Generate(); });
+}
+
+void CertificateCache::Generate() {
+  int64_t start_ms = rtc::TimeMillis();
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate =
+      rtc::RTCCertificateGenerator::GenerateCertificate(
+          KeyParamsForType(config_.key_type), config_.lifetime_ms);
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_pending_ = false;
+  if (!certificate) {
+    RTC_LOG(LS_ERROR) << "Failed to generate DTLS certificate.";
+    return;
+  }
+  RTC_LOG(LS_INFO) << "Generated DTLS certificate in "
+                   << rtc::TimeMillis() - start_ms << " ms.";
+  certificate_ = certificate;
+  generation_time_ms_ = rtc::TimeMillis();
+}
+}
+}
@@ -0,0 +1,47 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_CERTIFICATECACHE_H_
+#define OWT_BASE_CERTIFICATECACHE_H_
+#include <memory>
+#include <mutex>
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/api/scoped_refptr.h"
+#include "webrtc/rtc_base/rtc_certificate.h"
+#include "webrtc/rtc_base/ssl_identity.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// Generates DTLS certificates on its own thread and hands out the latest one,
+// so PeerConnections don't generate a certificate each. Thread safe.
+class CertificateCache {
+ public:
+  explicit CertificateCache(const CertificateCacheConfiguration& config);
+  ~CertificateCache();
+  // Start generating the first certificate.
+  void Start();
+  // Returns the cached certificate, or nullptr if it is not generated yet or
+  // has expired. A new certificate is generated in background if the cached
+  // one is older than the rotation interval.
+  rtc::scoped_refptr<rtc::RTCCertificate> GetCertificate();
+  // Block until a certificate is available or |timeout_ms| elapsed. For tests
+  // and benchmarks.
+  bool WaitForCertificate(int timeout_ms);
+  static rtc::KeyParams KeyParamsForType(CertificateKeyType key_type);
+
+ private:
+  // Must be called with |mutex_| held.
+  void ScheduleGeneration();
+  void Generate();
+
+  const CertificateCacheConfiguration config_;
+  std::unique_ptr<rtc::Thread> thread_;
+  std::mutex mutex_;
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
+  // rtc::TimeMillis() when |certificate_| was generated.
+  int64_t generation_time_ms_;
+  bool generation_pending_;
+};
+}
+}
+#endif  // OWT_BASE_CERTIFICATECACHE_H_
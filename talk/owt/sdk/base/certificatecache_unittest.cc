@@ -0,0 +1,184 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/certificatecache.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include "talk/owt/sdk/base/functionalobserver.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "webrtc/api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "webrtc/api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "webrtc/api/create_peerconnection_factory.h"
+#include "webrtc/api/task_queue/default_task_queue_factory.h"
+#include "webrtc/api/video_codecs/builtin_video_decoder_factory.h"
+#include "webrtc/api/video_codecs/builtin_video_encoder_factory.h"
+#include "webrtc/modules/audio_device/include/audio_device.h"
+#include "webrtc/rtc_base/event.h"
+#include "webrtc/rtc_base/ssl_adapter.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const int kGenerationTimeoutMs = 10000;
+const int kConnections = 20;
+
+class NullPeerConnectionObserver : public webrtc::PeerConnectionObserver {
+ public:
+  void OnSignalingChange(
+      webrtc::PeerConnectionInterface::SignalingState new_state) override {}
+  void OnDataChannel(
+      rtc::scoped_refptr<webrtc::DataChannelInterface> channel) override {}
+  void OnRenegotiationNeeded() override {}
+  void OnIceGatheringChange(
+      webrtc::PeerConnectionInterface::IceGatheringState new_state) override {}
+  void OnIceCandidate(const webrtc::IceCandidateInterface* candidate) override {
+  }
+};
+
+// Returns time from creating a connection until its first local description
+// is set. The connection generates a certificate if |certificate| is null.
+int64_t MeasureConnectionSetupUs(
+    webrtc::PeerConnectionFactoryInterface* factory,
+    rtc::scoped_refptr<rtc::RTCCertificate> certificate) {
+  webrtc::PeerConnectionInterface::RTCConfiguration config;
+  config.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
+  if (certificate)
+    config.certificates.push_back(certificate);
+  NullPeerConnectionObserver observer;
+  rtc::Event done;
+  auto on_failure = [&done](const std::string& error) {
+    ADD_FAILURE() << error;
+    done.Set();
+  };
+  int64_t start_us = rtc::TimeMicros();
+  rtc::scoped_refptr<webrtc::PeerConnectionInterface> pc =
+      factory->CreatePeerConnection(config, nullptr, nullptr, &observer);
+  EXPECT_TRUE(pc);
+  if (!pc)
+    return 0;
+  // A data channel is negotiated over DTLS, so the offer needs the
+  // certificate.
+  pc->CreateDataChannel("benchmark", nullptr);
+  webrtc::PeerConnectionInterface* connection = pc.get();
+  pc->CreateOffer(
+      FunctionalCreateSessionDescriptionObserver::Create(
+          [connection, &done,
+           on_failure](webrtc::SessionDescriptionInterface* desc) {
+            connection->SetLocalDescription(
+                FunctionalSetSessionDescriptionObserver::Create(
+                    [&done] { done.Set(); }, on_failure),
+                desc);
+          },
+          on_failure),
+      webrtc::PeerConnectionInterface::RTCOfferAnswerOptions());
+  EXPECT_TRUE(done.Wait(kGenerationTimeoutMs));
+  int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  pc->Close();
+  return elapsed_us;
+}
+}  // namespace
+
+class CertificateCacheTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { rtc::InitializeSSL(); }
+  static void TearDownTestSuite() { rtc::CleanupSSL(); }
+};
+
+TEST_F(CertificateCacheTest, KeyParamsMatchKeyType) {
+  EXPECT_EQ(rtc::KT_ECDSA,
+            CertificateCache::KeyParamsForType(CertificateKeyType::kEcdsa)
+                .type());
+  EXPECT_EQ(rtc::KT_RSA,
+            CertificateCache::KeyParamsForType(CertificateKeyType::kRsa)
+                .type());
+}
+
+TEST_F(CertificateCacheTest, GeneratesCertificateInBackground) {
+  CertificateCacheConfiguration config;
+  config.enabled = true;
+  config.lifetime_ms = 60 * 60 * 1000;
+  CertificateCache cache(config);
+  cache.Start();
+  ASSERT_TRUE(cache.WaitForCertificate(kGenerationTimeoutMs));
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate = cache.GetCertificate();
+  ASSERT_TRUE(certificate);
+  EXPECT_FALSE(certificate->HasExpired(rtc::TimeUTCMillis()));
+  EXPECT_TRUE(certificate->HasExpired(rtc::TimeUTCMillis() +
+                                      config.lifetime_ms + 60 * 1000));
+  // Same certificate before rotation.
+  EXPECT_EQ(certificate, cache.GetCertificate());
+}
+
+TEST_F(CertificateCacheTest, RotatesCertificate) {
+  CertificateCacheConfiguration config;
+  config.enabled = true;
+  config.rotation_interval_ms = 0;
+  CertificateCache cache(config);
+  cache.Start();
+  ASSERT_TRUE(cache.WaitForCertificate(kGenerationTimeoutMs));
+  rtc::scoped_refptr<rtc::RTCCertificate> first = cache.GetCertificate();
+  int64_t deadline_ms = rtc::TimeMillis() + kGenerationTimeoutMs;
+  rtc::scoped_refptr<rtc::RTCCertificate> current = first;
+  while (current == first && rtc::TimeMillis() < deadline_ms) {
+    rtc::Thread::SleepMs(1);
+    current = cache.GetCertificate();
+  }
+  ASSERT_TRUE(current);
+  EXPECT_NE(first, current);
+}
+
+// Compares setup time of connections with and without the cache, from
+// creating a connection until its first local description is set, which waits
+// for its certificate. Run with --gtest_also_run_disabled_tests.
+TEST_F(CertificateCacheTest, DISABLED_BenchmarkConnectionSetup) {
+  std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory =
+      webrtc::CreateDefaultTaskQueueFactory();
+  std::unique_ptr<rtc::Thread> network_thread =
+      rtc::Thread::CreateWithSocketServer();
+  std::unique_ptr<rtc::Thread> worker_thread = rtc::Thread::Create();
+  std::unique_ptr<rtc::Thread> signaling_thread = rtc::Thread::Create();
+  ASSERT_TRUE(network_thread->Start() && worker_thread->Start() &&
+              signaling_thread->Start());
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> adm =
+      worker_thread->Invoke<rtc::scoped_refptr<webrtc::AudioDeviceModule>>(
+          RTC_FROM_HERE, [&task_queue_factory] {
+            return webrtc::AudioDeviceModule::Create(
+                webrtc::AudioDeviceModule::kDummyAudio,
+                task_queue_factory.get());
+          });
+  rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> factory =
+      webrtc::CreatePeerConnectionFactory(
+          network_thread.get(), worker_thread.get(), signaling_thread.get(),
+          adm, webrtc::CreateBuiltinAudioEncoderFactory(),
+          webrtc::CreateBuiltinAudioDecoderFactory(),
+          webrtc::CreateBuiltinVideoEncoderFactory(),
+          webrtc::CreateBuiltinVideoDecoderFactory(), nullptr, nullptr);
+  ASSERT_TRUE(factory);
+
+  int64_t generated_us = 0;
+  for (int i = 0; i < kConnections; i++)
+    generated_us += MeasureConnectionSetupUs(factory.get(), nullptr);
+
+  CertificateCacheConfiguration config;
+  config.enabled = true;
+  CertificateCache cache(config);
+  cache.Start();
+  ASSERT_TRUE(cache.WaitForCertificate(kGenerationTimeoutMs));
+  int64_t cached_us = 0;
+  for (int i = 0; i < kConnections; i++) {
+    cached_us +=
+        MeasureConnectionSetupUs(factory.get(), cache.GetCertificate());
+  }
+
+  std::cout << kConnections << " connections to first local description: "
+            << generated_us / kConnections << " us each generating a "
+            << "certificate, " << cached_us / kConnections
+            << " us each with the cache." << std::endl;
+  EXPECT_LT(cached_us, generated_us);
+  factory = nullptr;
+  worker_thread->Invoke<void>(RTC_FROM_HERE, [&adm] { adm = nullptr; });
+}
+}
+}
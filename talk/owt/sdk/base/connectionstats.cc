@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <string.h>
 #include <map>
 #include <type_traits>
 #include <utility>
@@ -78,6 +79,37 @@ const char* const RTCStatsType::kRemoteCandidate = "remote-candidate";
 const char* const RTCStatsType::kCertificate = "certificate";
 const char* const RTCStatsType::kIceServer = "ice-server";
 
+constexpr uint32_t RTCStatsTypeMask::kCodec;
+constexpr uint32_t RTCStatsTypeMask::kInboundRTP;
+constexpr uint32_t RTCStatsTypeMask::kOutboundRTP;
+constexpr uint32_t RTCStatsTypeMask::kRemoteInboundRTP;
+constexpr uint32_t RTCStatsTypeMask::kDataChannel;
+constexpr uint32_t RTCStatsTypeMask::kTrack;
+constexpr uint32_t RTCStatsTypeMask::kTransport;
+constexpr uint32_t RTCStatsTypeMask::kCandidatePair;
+constexpr uint32_t RTCStatsTypeMask::kLocalCandidate;
+constexpr uint32_t RTCStatsTypeMask::kRemoteCandidate;
+constexpr uint32_t RTCStatsTypeMask::kAll;
+
+uint32_t RTCStatsTypeMask::FromType(const char* type) {
+  static const std::pair<const char*, uint32_t> kMasks[] = {
+      {RTCStatsType::kCodec, kCodec},
+      {RTCStatsType::kInboundRTP, kInboundRTP},
+      {RTCStatsType::kOutboundRTP, kOutboundRTP},
+      {RTCStatsType::kRemoteInboundRTP, kRemoteInboundRTP},
+      {RTCStatsType::kDataChannel, kDataChannel},
+      {RTCStatsType::kTrack, kTrack},
+      {RTCStatsType::kTransport, kTransport},
+      {RTCStatsType::kCandidatePair, kCandidatePair},
+      {RTCStatsType::kLocalCandidate, kLocalCandidate},
+      {RTCStatsType::kRemoteCandidate, kRemoteCandidate}};
+  for (const auto& mask : kMasks) {
+    if (strcmp(type, mask.first) == 0)
+      return mask.second;
+  }
+  return 0;
+}
+
 RTCStatsReport::ConstIterator::ConstIterator(
     owt::base::RTCStatsReport* report,
     StatsMap::const_iterator it)
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "talk/owt/sdk/base/customizedaudiocapturer.h"
+#include "talk/owt/sdk/base/tracing.h"
 #include "webrtc/rtc_base/checks.h"
 #include "webrtc/rtc_base/logging.h"
 #include "webrtc/system_wrappers/include/sleep.h"
@@ -266,6 +267,7 @@ bool CustomizedAudioCapturer::RecThreadProcess() {
     }
     if (last_call_record_millis_ == 0 ||
         (int64_t)(current_time - last_call_record_millis_) >= need_sleep_ms_) {
+      OWT_TRACE_EVENT("CustomizedAudioCapturer::RecThreadProcess");
       if (frame_generator_->GenerateFramesForNext10Ms(
               recording_buffer_.get(),
               static_cast<uint32_t>(recording_buffer_size_)) !=
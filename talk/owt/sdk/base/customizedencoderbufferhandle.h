@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef OWT_BASE_CUSTOMIZEDENCODER_BUFFER_HANDLE_H
 #define OWT_BASE_CUSTOMIZEDENCODER_BUFFER_HANDLE_H
+#include <string>
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/ref_count.h"
 #include "talk/owt/sdk/base/nativehandlebuffer.h"
@@ -18,6 +19,8 @@ class CustomizedEncoderBufferHandle{
   size_t height;
   uint32_t fps;
   uint32_t bitrate_kbps;
+  // Track the frame is sent on, empty if unknown.
+  std::string track_id;
   virtual ~CustomizedEncoderBufferHandle() {}
 };
 class EncodedFrameBuffer : public VideoFrameBuffer {
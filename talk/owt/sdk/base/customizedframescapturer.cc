@@ -2,70 +2,85 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
 #include "webrtc/common_video/include/video_frame_buffer.h"
 #include "webrtc/media/base/video_common.h"
 #include "webrtc/rtc_base/logging.h"
 #include "webrtc/rtc_base/memory/aligned_malloc.h"
+#include "webrtc/rtc_base/platform_thread.h"
 #include "webrtc/rtc_base/thread.h"
+#include "webrtc/rtc_base/time_utils.h"
 #include "webrtc/system_wrappers/include/clock.h"
 #include "talk/owt/sdk/base/customizedframescapturer.h"
 #include "talk/owt/sdk/base/customizedencoderbufferhandle.h"
+#include "talk/owt/sdk/base/framepacer.h"
 #include "talk/owt/sdk/base/nativehandlebuffer.h"
+#include "talk/owt/sdk/base/rawframebuffer.h"
+#include "talk/owt/sdk/base/threadutils.h"
+#include "talk/owt/sdk/base/tracing.h"
 
 using namespace rtc;
 namespace owt {
 namespace base {
+// Frames in flight of one resolution, e.g. queued for encoding and rendering.
+static const size_t kMaxPooledFrameBuffers = 8;
+// Resolutions kept, so switching between a few sizes does not allocate.
+static const size_t kMaxPooledFrameResolutions = 3;
 ///////////////////////////////////////////////////////////////////////
 // Definition of private class CustomizedFramesThread that periodically
-// generates frames.
-// TODO: should use rtc::PlatformThread instead as we need to increase
-// the priority of the capture thread.
+// generates frames. Frames are read on deadlines of FramePacer, the thread
+// sleeps until each deadline instead of posting delayed messages.
 ///////////////////////////////////////////////////////////////////////
-class CustomizedFramesCapturer::CustomizedFramesThread
-    : public rtc::Thread,
-      public rtc::MessageHandler {
+class CustomizedFramesCapturer::CustomizedFramesThread {
  public:
-  explicit CustomizedFramesThread(CustomizedFramesCapturer* capturer, int fps)
-      : rtc::Thread(SocketServer::CreateDefault()),
-        capturer_(capturer) {
-    finished_ = false;
-    waiting_time_ms = 1000 / fps;
+  CustomizedFramesThread(CustomizedFramesCapturer* capturer,
+                         int fps_numerator,
+                         int fps_denominator,
+                         const FramePacingConfiguration& config)
+      : capturer_(capturer),
+        settings_(config.thread),
+        spin_us_(config.spin_us),
+        pacer_(fps_numerator, fps_denominator, config.late_policy),
+        thread_(&CustomizedFramesThread::Run,
+                this,
+                "owt_customized_frames_capture_thread") {}
+  ~CustomizedFramesThread() { Stop(); }
+  bool Start() {
+    thread_.Start();
+    return thread_.IsRunning();
   }
-  virtual ~CustomizedFramesThread() { Stop(); }
-  // Override virtual method of parent Thread. Context: Worker Thread.
-  virtual void Run() {
-    // Read the first frame and start the message pump. The pump runs until
-    // Stop() is called externally or Quit() is called by OnMessage().
-    // Before returning, cleanup any thread-sensitive resources.
-    if (capturer_) {
-      capturer_->ReadFrame();
-      rtc::Thread::Current()->Post(RTC_FROM_HERE, this);
-      rtc::Thread::Current()->ProcessMessages(kForever);
-      capturer_->CleanupGenerator();
-    }
-    webrtc::MutexLock lock(&crit_);
-    finished_ = true;
+  // Wait for the frame being read, if any.
+  void Stop() {
+    stop_.Set();
+    thread_.Stop();
+  }
+
+ private:
+  static void Run(void* obj) {
+    static_cast<CustomizedFramesThread*>(obj)->PaceFrames();
   }
-  // Override virtual method of parent MessageHandler. Context: Worker Thread.
-  virtual void OnMessage(rtc::Message* /*pmsg*/) {
-    if (capturer_) {
+  void PaceFrames() {
+    if (!ApplyCurrentThreadSettings(settings_)) {
+      RTC_LOG(LS_WARNING) << "Capture thread settings are not fully applied.";
+    }
+    pacer_.Start(rtc::TimeMicros());
+    do {
       capturer_->ReadFrame();
-      rtc::Thread::Current()->PostDelayed(RTC_FROM_HERE, waiting_time_ms, this);
-    } else {
-      rtc::Thread::Current()->Quit();
+    } while (FramePacer::WaitUntil(pacer_.OnFrameProduced(rtc::TimeMicros()),
+                                   spin_us_, &stop_));
+    if (pacer_.skipped_frames() > 0) {
+      RTC_LOG(LS_INFO) << pacer_.skipped_frames()
+                       << " frames were skipped for being late.";
     }
-  }
-  // Check if Run() is finished.
-  bool Finished() const {
-    webrtc::MutexLock lock(&crit_);
-    return finished_;
+    capturer_->CleanupGenerator();
   }
 
- private:
   CustomizedFramesCapturer* capturer_;
-  mutable webrtc::Mutex crit_;
-  bool finished_;
-  int waiting_time_ms;
+  const ThreadSettings settings_;
+  const int64_t spin_us_;
+  FramePacer pacer_;
+  rtc::Event stop_;
+  rtc::PlatformThread thread_;
   RTC_DISALLOW_COPY_AND_ASSIGN(CustomizedFramesThread);
 };
 
@@ -82,7 +97,10 @@ CustomizedFramesCapturer::CustomizedFramesCapturer(
       bitrate_kbps_(0),
       frame_type_(frame_generator_->GetType()),
       frame_buffer_capacity_(0),
-      frame_buffer_(nullptr) {}
+      frame_buffer_(nullptr),
+      frame_buffer_pool_(kMaxPooledFrameBuffers,
+                         kMaxPooledFrameResolutions,
+                         true) {}
 CustomizedFramesCapturer::CustomizedFramesCapturer(
     int width,
     int height,
@@ -96,7 +114,10 @@ CustomizedFramesCapturer::CustomizedFramesCapturer(
       fps_(fps),
       bitrate_kbps_(bitrate_kbps),
       frame_buffer_capacity_(0),
-      frame_buffer_(nullptr) {}
+      frame_buffer_(nullptr),
+      frame_buffer_pool_(kMaxPooledFrameBuffers,
+                         kMaxPooledFrameResolutions,
+                         true) {}
 CustomizedFramesCapturer::~CustomizedFramesCapturer() {
   DeRegisterCaptureDataCallback();
   StopCapture();
@@ -126,7 +147,13 @@ int32_t CustomizedFramesCapturer::StartCapture(
   webrtc::MutexLock lock(&capture_lock_);
   if (!frames_generator_thread_) {
     quit_ = false;
-    frames_generator_thread_.reset(new CustomizedFramesThread(this, fps_));
+    int fps_numerator = fps_;
+    int fps_denominator = 1;
+    if (frame_generator_)
+      frame_generator_->GetFrameRate(&fps_numerator, &fps_denominator);
+    frames_generator_thread_.reset(new CustomizedFramesThread(
+        this, fps_numerator, fps_denominator,
+        GlobalConfiguration::GetFramePacingConfiguration()));
 
     bool ret = frames_generator_thread_->Start();
     if (!ret) {
@@ -144,13 +171,25 @@ int32_t CustomizedFramesCapturer::StopCapture() {
       webrtc::MutexLock lock(&capture_lock_);
       quit_ = true;
     }
-    frames_generator_thread_->Quit();
+    frames_generator_thread_->Stop();
     frames_generator_thread_.reset();
   }
   capture_started_ = false;
   return 0;
 }
 
+void CustomizedFramesCapturer::OnAdaptationChanged(int max_pixel_count,
+                                                   int max_fps) {
+  webrtc::MutexLock lock(&lock_);
+  if (frame_generator_)
+    frame_generator_->OnAdaptationChanged(max_pixel_count, max_fps);
+}
+
+void CustomizedFramesCapturer::SetTrackId(const std::string& track_id) {
+  webrtc::MutexLock lock(&lock_);
+  track_id_ = track_id;
+}
+
 void CustomizedFramesCapturer::CleanupGenerator() {
   if (frame_generator_) {
     frame_generator_->Cleanup();
@@ -185,25 +224,31 @@ int CustomizedFramesCapturer::I420DataSize(int height,
 }
 
 void CustomizedFramesCapturer::AdjustFrameBuffer(uint32_t size) {
-  if (size > frame_buffer_capacity_ || !frame_buffer_) {
-    RTC_LOG(LS_VERBOSE) << "Allocate new memory for frame buffer.";
-    width_ = frame_generator_->GetWidth();
-    height_ = frame_generator_->GetHeight();
-    int stride_y = width_;
-    int stride_uv = (width_ + 1) / 2;
-    frame_buffer_ = webrtc::I420Buffer::Create(width_, height_, stride_y,
-                                               stride_uv, stride_uv);
-    frame_buffer_capacity_ =
-        I420DataSize(height_, stride_y, stride_uv, stride_uv);
-    if (frame_buffer_capacity_ < size) {
-      RTC_LOG(LS_ERROR) << "User provides invalid data size. Expected size: "
-                        << frame_buffer_capacity_ << ", user wants: " << size;
-    }
+  // Previous frames may still be queued downstream, so each frame takes its
+  // own buffer. Released buffers are recycled by the pool.
+  width_ = frame_generator_->GetWidth();
+  height_ = frame_generator_->GetHeight();
+  // Frames of other raw formats are generated into the memory of an I420
+  // buffer whose luma stride is widened to hold them.
+  int stride_uv = (width_ + 1) / 2;
+  int chroma_size = stride_uv * ((height_ + 1) / 2) * 2;
+  int packed_size = PackedRawFrameSize(frame_type_, width_, height_);
+  int stride_y =
+      std::max(width_, (packed_size - chroma_size + height_ - 1) / height_);
+  frame_buffer_ =
+      frame_buffer_pool_.CreateBuffer(width_, height_, stride_y, stride_uv);
+  frame_buffer_capacity_ =
+      I420DataSize(height_, frame_buffer_->StrideY(), frame_buffer_->StrideU(),
+                   frame_buffer_->StrideV());
+  if (frame_buffer_capacity_ < size) {
+    RTC_LOG(LS_ERROR) << "User provides invalid data size. Expected size: "
+                      << frame_buffer_capacity_ << ", user wants: " << size;
   }
 }
 
 // Executed in the context of CustomizedFramesThread.
 void CustomizedFramesCapturer::ReadFrame() {
+  OWT_TRACE_EVENT("CustomizedFramesCapturer::ReadFrame");
   // Signal the previously read frame to downstream in worker_thread.
   webrtc::MutexLock lock(&lock_);
   if (!data_callback_)
@@ -216,12 +261,30 @@ void CustomizedFramesCapturer::ReadFrame() {
         frame_size) {
       RTC_DCHECK(false);
       RTC_LOG(LS_ERROR) << "Failed to get video frame.";
+      frame_buffer_ = nullptr;
       return;
     }
 
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer = frame_buffer_;
+    if (frame_type_ != VideoFrameGeneratorInterface::I420 &&
+        PackedRawFrameSize(frame_type_, width_, height_) > 0) {
+      const uint8_t* data[3];
+      int stride[3];
+      GetPackedRawFramePlanes(frame_type_, width_, height_,
+                              frame_buffer_->DataY(), data, stride);
+      // The wrapper keeps the pooled buffer in use until it is destroyed.
+      rtc::scoped_refptr<webrtc::I420Buffer> memory = frame_buffer_;
+      buffer = WrapRawFrameBuffer(frame_type_, width_, height_, data, stride,
+                                  [memory] {});
+      if (!buffer) {
+        RTC_LOG(LS_ERROR) << "Invalid video frame of type " << frame_type_;
+        frame_buffer_ = nullptr;
+        return;
+      }
+    }
     webrtc::VideoFrame capture_frame =
         webrtc::VideoFrame::Builder()
-            .set_video_frame_buffer(frame_buffer_)
+            .set_video_frame_buffer(buffer)
             .set_timestamp_rtp(0)
             .set_timestamp_ms(rtc::TimeMillis())
             .set_rotation(webrtc::kVideoRotation_0)
@@ -229,6 +292,7 @@ void CustomizedFramesCapturer::ReadFrame() {
 
     capture_frame.set_ntp_time_ms(0);
     data_callback_->OnFrame(capture_frame);
+    frame_buffer_ = nullptr;
   } else if (encoder_ != nullptr) {  // video encoder interface used. Pass the
                                      // encoder information.
     CustomizedEncoderBufferHandle* encoder_context =
@@ -238,6 +302,7 @@ void CustomizedFramesCapturer::ReadFrame() {
     encoder_context->height = height_;
     encoder_context->fps = fps_;
     encoder_context->bitrate_kbps = bitrate_kbps_;
+    encoder_context->track_id = track_id_;
     rtc::scoped_refptr<owt::base::EncodedFrameBuffer> buffer =
         new rtc::RefCountedObject<owt::base::EncodedFrameBuffer>(
             encoder_context);
@@ -28,6 +28,7 @@
 #include "webrtc/rtc_base/constructor_magic.h"
 #include "owt/base/framegeneratorinterface.h"
 #include "owt/base/videoencoderinterface.h"
+#include "talk/owt/sdk/base/framebufferpool.h"
 
 namespace owt {
 namespace base {
@@ -63,10 +64,14 @@ class CustomizedFramesCapturer : public webrtc::VideoCaptureModule {
   virtual bool GetApplyRotation() override {
     return false;
   }
+  // Forward the adaptation requested by sinks to the frame generator.
+  void OnAdaptationChanged(int max_pixel_count, int max_fps);
+  // ID of the track encoded frames are sent on.
+  void SetTrackId(const std::string& track_id);
  protected:
   // Read a frame and determine how long to wait for the next frame.
   virtual void ReadFrame();
-  // Adjust |frame_buffer_|'s capacity to store frame data. |frame_buffer_|'s
+  // Take a buffer from |frame_buffer_pool_| for next frame. |frame_buffer_|'s
   // capacity should be greater or equal to |size|.
   virtual void AdjustFrameBuffer(uint32_t size);
 
@@ -86,10 +91,13 @@ class CustomizedFramesCapturer : public webrtc::VideoCaptureModule {
   int fps_;
   int bitrate_kbps_;
   bool capture_started_ = false;
+  std::string track_id_ RTC_GUARDED_BY(lock_);
   VideoFrameGeneratorInterface::VideoFrameCodec frame_type_;
   uint32_t frame_buffer_capacity_;
-  rtc::scoped_refptr<webrtc::I420Buffer>
-      frame_buffer_;  // Reuseable buffer for video frames.
+  // Buffer of the frame being read. Released once the frame is delivered, so
+  // it is only reused after downstream drops the frame.
+  rtc::scoped_refptr<webrtc::I420Buffer> frame_buffer_;
+  FrameBufferPool frame_buffer_pool_;
 
   webrtc::Mutex lock_;
   webrtc::Mutex capture_lock_;
@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 #include "talk/owt/sdk/base/customizedvideodecoderproxy.h"
+#include "talk/owt/sdk/base/tracing.h"
 #include "talk/owt/sdk/include/cpp/owt/base/commontypes.h"
 #include "talk/owt/sdk/include/cpp/owt/base/videodecoderinterface.h"
 namespace owt {
@@ -43,6 +44,7 @@ int32_t CustomizedVideoDecoderProxy::InitDecode(const webrtc::VideoCodec* codec_
 int32_t CustomizedVideoDecoderProxy::Decode(const EncodedImage& input_image,
                                             bool missing_frames,
                                             int64_t render_time_ms) {
+  OWT_TRACE_EVENT("CustomizedVideoDecoderProxy::Decode");
   if (!decoded_image_callback_) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
@@ -13,6 +13,8 @@
 #include "webrtc/rtc_base/logging.h"
 #include "talk/owt/sdk/base/customizedencoderbufferhandle.h"
 #include "talk/owt/sdk/base/customizedvideoencoderproxy.h"
+#include "talk/owt/sdk/base/tracing.h"
+#include "talk/owt/sdk/base/videoadaptationnotifier.h"
 #include "talk/owt/sdk/base/mediautils.h"
 #include "talk/owt/sdk/base/nativehandlebuffer.h"
 #include "talk/owt/sdk/include/cpp/owt/base/commontypes.h"
@@ -24,7 +26,10 @@ using namespace rtc;
 namespace owt {
 namespace base {
 CustomizedVideoEncoderProxy::CustomizedVideoEncoderProxy()
-    : callback_(nullptr), external_encoder_(nullptr) {
+    : callback_(nullptr),
+      external_encoder_(nullptr),
+      target_bitrate_bps_(0),
+      notified_bitrate_bps_(0) {
   picture_id_ = 0;
 }
 CustomizedVideoEncoderProxy::~CustomizedVideoEncoderProxy() {
@@ -51,6 +56,7 @@ int CustomizedVideoEncoderProxy::InitEncode(
 int32_t CustomizedVideoEncoderProxy::Encode(
     const webrtc::VideoFrame& input_image,
     const std::vector<webrtc::VideoFrameType>* frame_types) {
+  OWT_TRACE_EVENT("CustomizedVideoEncoderProxy::Encode");
   // Get the videoencoderinterface instance from the input video frame.
   CustomizedEncoderBufferHandle* encoder_buffer_handle =
       reinterpret_cast<CustomizedEncoderBufferHandle*>(
@@ -59,6 +65,8 @@ int32_t CustomizedVideoEncoderProxy::Encode(
               ->native_handle());
   if (external_encoder_ == nullptr && encoder_buffer_handle != nullptr &&
       encoder_buffer_handle->encoder != nullptr) {
+    track_id_ = encoder_buffer_handle->track_id;
+    NotifyTargetBitrate();
     // First time we get passed in encoder impl. Initialize it. Use codec
     // settings in the natvie handle instead of that passed uplink.
     external_encoder_ = encoder_buffer_handle->encoder->Copy();
@@ -230,12 +238,25 @@ int CustomizedVideoEncoderProxy::RegisterEncodeCompleteCallback(
 
 void CustomizedVideoEncoderProxy::SetRates(
     const RateControlParameters& parameters) {
+  // The external encoder picks its own rate, the allocation is reported to
+  // the application.
+  target_bitrate_bps_ = parameters.bitrate.get_sum_bps();
+  NotifyTargetBitrate();
   if (parameters.framerate_fps < 1.0) {
     RTC_LOG(LS_WARNING) << "Unsupported framerate (must be >= 1.0";
     return;
   }
 }
 
+void CustomizedVideoEncoderProxy::NotifyTargetBitrate() {
+  if (track_id_.empty() || target_bitrate_bps_ == 0 ||
+      target_bitrate_bps_ == notified_bitrate_bps_)
+    return;
+  notified_bitrate_bps_ = target_bitrate_bps_;
+  VideoAdaptationNotifier::Get()->NotifyVideoEncoderBitrateChanged(
+      track_id_, target_bitrate_bps_);
+}
+
 void CustomizedVideoEncoderProxy::OnPacketLossRateUpdate(
     float packet_loss_rate) {
   // Currently not handled.
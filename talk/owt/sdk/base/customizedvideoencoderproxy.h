@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef OWT_BASE_ENCODEDVIDEOENCODER_H_
 #define OWT_BASE_ENCODEDVIDEOENCODER_H_
+#include <string>
 #include <vector>
 #include "webrtc/api/video_codecs/video_encoder.h"
 #include "webrtc/media/base/codec.h"
@@ -31,6 +32,8 @@ class CustomizedVideoEncoderProxy : public webrtc::VideoEncoder {
  private:
   // Search for H.264 start codes.
   int32_t NextNaluPosition(uint8_t* buffer, size_t buffer_size, size_t* sc_length);
+  // Report |target_bitrate_bps_| to VideoAdaptationNotifier if it changed.
+  void NotifyTargetBitrate();
   webrtc::EncodedImageCallback* callback_;
   int32_t bitrate_;  // Bitrate in bits per second.
   int32_t width_;
@@ -41,6 +44,11 @@ class CustomizedVideoEncoderProxy : public webrtc::VideoEncoder {
   VideoEncoderInterface* external_encoder_;
   uint8_t gof_idx_;
   webrtc::GofInfoVP9 gof_;
+  // Track of encoded frames, known after the first frame.
+  std::string track_id_;
+  // Bitrate allocated by SetRates(), and the one last reported.
+  uint64_t target_bitrate_bps_;
+  uint64_t notified_bitrate_bps_;
 };
 }
 }
@@ -2,12 +2,22 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <limits>
 #include "talk/owt/sdk/base/customizedframescapturer.h"
 #include "talk/owt/sdk/base/desktopcapturer.h"
 #include "talk/owt/sdk/base/customizedvideosource.h"
+#include "talk/owt/sdk/base/rawframebuffer.h"
+#include "talk/owt/sdk/base/tracing.h"
+#include "talk/owt/sdk/base/videoadaptationnotifier.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/time_utils.h"
 
 namespace owt {
 namespace base {
+// Scaled frames in flight, e.g. queued for encoding and rendering.
+static const size_t kMaxPooledScaledBuffers = 8;
+// Sinks usually request a single resolution, which changes stepwise.
+static const size_t kMaxPooledScaledResolutions = 2;
 
 rtc::scoped_refptr<webrtc::VideoCaptureModule>
 CustomizedVideoCapturerFactory::Create(
@@ -42,13 +52,63 @@ CustomizedVideoCapturerFactory::Create(
 }
 #endif
 
-  CustomizedVideoSource::CustomizedVideoSource() = default;
+  CustomizedVideoSource::CustomizedVideoSource()
+      : scaled_buffer_pool_(kMaxPooledScaledBuffers,
+                            kMaxPooledScaledResolutions,
+                            false),
+        max_pixel_count_(std::numeric_limits<int>::max()),
+        max_fps_(std::numeric_limits<int>::max()),
+        wanted_max_fps_(std::numeric_limits<int>::max()),
+        wants_changed_(false),
+        adapted_width_(0),
+        adapted_height_(0) {}
   CustomizedVideoSource::~CustomizedVideoSource() = default;
 
   void CustomizedVideoSource::OnFrame(const webrtc::VideoFrame& frame) {
-    // TODO(johny): We need to adapt frame for yuv input here, but not for
-    // encoded input.
-    broadcaster_.OnFrame(frame);
+    // Encoded input is passed as native buffers, which cannot be adapted.
+    if (frame.video_frame_buffer()->type() ==
+        webrtc::VideoFrameBuffer::Type::kNative) {
+      broadcaster_.OnFrame(frame);
+      return;
+    }
+    int cropped_width = 0;
+    int cropped_height = 0;
+    int out_width = 0;
+    int out_height = 0;
+    if (!video_adapter_.AdaptFrameResolution(
+            frame.width(), frame.height(),
+            frame.timestamp_us() * rtc::kNumNanosecsPerMicrosec,
+            &cropped_width, &cropped_height, &out_width, &out_height)) {
+      // Dropped to meet the requested frame rate.
+      return;
+    }
+    bool wants_changed = wants_changed_.exchange(false);
+    if (wants_changed || out_width != adapted_width_ ||
+        out_height != adapted_height_) {
+      adapted_width_ = out_width;
+      adapted_height_ = out_height;
+      ReportAdaptation(out_width, out_height);
+    }
+    if (out_width == frame.width() && out_height == frame.height()) {
+      broadcaster_.OnFrame(frame);
+      return;
+    }
+    OWT_TRACE_EVENT("CustomizedVideoSource::ScaleFrame");
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled_buffer =
+        scaled_buffer_pool_.CreateBuffer(out_width, out_height);
+    // Crop the center if the requested aspect ratio differs.
+    scaled_buffer->CropAndScaleFrom(*frame.video_frame_buffer()->ToI420(),
+                                    (frame.width() - cropped_width) / 2,
+                                    (frame.height() - cropped_height) / 2,
+                                    cropped_width, cropped_height);
+    broadcaster_.OnFrame(webrtc::VideoFrame::Builder()
+                             .set_video_frame_buffer(scaled_buffer)
+                             .set_timestamp_rtp(frame.timestamp())
+                             .set_timestamp_us(frame.timestamp_us())
+                             .set_ntp_time_ms(frame.ntp_time_ms())
+                             .set_rotation(frame.rotation())
+                             .set_id(frame.id())
+                             .build());
   }
 
   void CustomizedVideoSource::AddOrUpdateSink(
@@ -68,7 +128,62 @@ CustomizedVideoCapturerFactory::Create(
   }
 
   void CustomizedVideoSource::UpdateVideoAdapter() {
-    // NOT Implemented.
+    rtc::VideoSinkWants wants = broadcaster_.wants();
+    video_adapter_.OnSinkWants(wants);
+    // Reported under the lock, so concurrent updates are reported in order.
+    webrtc::MutexLock lock(&adaptation_lock_);
+    if (wants.max_pixel_count == max_pixel_count_ &&
+        wants.max_framerate_fps == max_fps_)
+      return;
+    max_pixel_count_ = wants.max_pixel_count;
+    max_fps_ = wants.max_framerate_fps;
+    wanted_max_fps_ = max_fps_;
+    wants_changed_ = true;
+    OnAdaptationChanged(max_pixel_count_, max_fps_);
+  }
+
+  void CustomizedVideoSource::SetTrackId(const std::string& track_id) {
+    webrtc::MutexLock lock(&track_id_lock_);
+    track_id_ = track_id;
+  }
+
+  void CustomizedVideoSource::ReportAdaptation(int width, int height) {
+    std::string track_id;
+    {
+      webrtc::MutexLock lock(&track_id_lock_);
+      track_id = track_id_;
+    }
+    if (track_id.empty())
+      return;
+    int max_fps = wanted_max_fps_;
+    VideoAdaptationNotifier::Get()->NotifyVideoSourceAdapted(
+        track_id, width, height,
+        max_fps == std::numeric_limits<int>::max() ? 0 : max_fps);
+  }
+
+  bool CustomizedPushedFrameSource::PushFrame(const PushedVideoFrame& frame) {
+    OWT_TRACE_EVENT("CustomizedPushedFrameSource::PushFrame");
+    // The release callback is invoked when the last frame referring to the
+    // wrapped buffer is destroyed.
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+        WrapRawFrameBuffer(frame.format, frame.width, frame.height, frame.data,
+                           frame.stride, frame.release_callback);
+    if (!buffer) {
+      RTC_LOG(LS_ERROR) << "Invalid pushed video frame of type "
+                        << frame.format << ", " << frame.width << "x"
+                        << frame.height << ".";
+      return false;
+    }
+    webrtc::VideoFrame video_frame =
+        webrtc::VideoFrame::Builder()
+            .set_video_frame_buffer(buffer)
+            .set_timestamp_rtp(0)
+            .set_timestamp_us(frame.timestamp_us > 0 ? frame.timestamp_us
+                                                     : rtc::TimeMicros())
+            .set_rotation(webrtc::kVideoRotation_0)
+            .build();
+    OnFrame(video_frame);
+    return true;
   }
 
   CustomizedCapturer* CustomizedCapturer::Create(
@@ -100,7 +215,8 @@ CustomizedVideoCapturerFactory::Create(
   }
 #endif
 
-  CustomizedCapturer::CustomizedCapturer() : vcm_(nullptr) {}
+  CustomizedCapturer::CustomizedCapturer()
+      : vcm_(nullptr), frames_capturer_(nullptr) {}
 
   bool CustomizedCapturer::Init(
       std::shared_ptr<LocalCustomizedStreamParameters> parameters,
@@ -110,6 +226,7 @@ CustomizedVideoCapturerFactory::Create(
 
     if (!vcm_)
       return false;
+    frames_capturer_ = static_cast<CustomizedFramesCapturer*>(vcm_.get());
 
     vcm_->RegisterCaptureDataCallback(this);
     capability_.width = parameters->ResolutionWidth();
@@ -134,6 +251,7 @@ CustomizedVideoCapturerFactory::Create(
 
     if (!vcm_)
       return false;
+    frames_capturer_ = static_cast<CustomizedFramesCapturer*>(vcm_.get());
 
     vcm_->RegisterCaptureDataCallback(this);
     capability_.width = parameters->ResolutionWidth();
@@ -180,6 +298,7 @@ CustomizedVideoCapturerFactory::Create(
     vcm_->StopCapture();
     vcm_->DeRegisterCaptureDataCallback();
     vcm_ = nullptr;
+    frames_capturer_ = nullptr;
   }
 
   CustomizedCapturer::~CustomizedCapturer() { Destroy(); }
@@ -188,5 +307,18 @@ CustomizedVideoCapturerFactory::Create(
     CustomizedVideoSource::OnFrame(frame);
   }
 
+  void CustomizedCapturer::SetTrackId(const std::string& track_id) {
+    CustomizedVideoSource::SetTrackId(track_id);
+    // Encoders of encoded frames report their bitrate for the track.
+    if (frames_capturer_)
+      frames_capturer_->SetTrackId(track_id);
+  }
+
+  void CustomizedCapturer::OnAdaptationChanged(int max_pixel_count,
+                                               int max_fps) {
+    if (frames_capturer_)
+      frames_capturer_->OnAdaptationChanged(max_pixel_count, max_fps);
+  }
+
 }  // namespace base
 }  // namespace base
\ No newline at end of file
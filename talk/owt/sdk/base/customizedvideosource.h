@@ -5,6 +5,8 @@
 #ifndef OWT_BASE_CUSTOMIZEDVIDEOSOURCE_H
 #define OWT_BASE_CUSTOMIZEDVIDEOSOURCE_H
 
+#include <atomic>
+#include <string>
 #include "api/video/video_frame.h"
 #include "api/video/video_rotation.h"
 #include "api/video/video_sink_interface.h"
@@ -16,13 +18,16 @@
 #include "owt/base/stream.h"
 #include "owt/base/videoencoderinterface.h"
 #include "pc/video_track_source.h"
+#include "talk/owt/sdk/base/framebufferpool.h"
 #include "third_party/webrtc/api/media_stream_interface.h"
 #include "third_party/webrtc/api/scoped_refptr.h"
 #include "webrtc/api/scoped_refptr.h"
+#include "webrtc/rtc_base/synchronization/mutex.h"
 
 namespace owt {
 namespace base {
 using namespace cricket;
+class CustomizedFramesCapturer;
 
 // Factory class for different customized capturers
 class CustomizedVideoCapturerFactory {
@@ -40,6 +45,8 @@ class CustomizedVideoCapturerFactory {
 #endif
 };
 
+// Drops and scales raw frames to the resolution and frame rate requested by
+// sinks. Encoded frames are passed as they are.
 class CustomizedVideoSource
     : public rtc::VideoSourceInterface<webrtc::VideoFrame> {
  public:
@@ -49,16 +56,46 @@ class CustomizedVideoSource
   void AddOrUpdateSink(rtc::VideoSinkInterface<webrtc::VideoFrame>* sink,
                        const rtc::VideoSinkWants& wants) override;
   void RemoveSink(rtc::VideoSinkInterface<webrtc::VideoFrame>* sink) override;
+  // Adaptation of frames is reported to VideoAdaptationNotifier for
+  // |track_id|, nothing is reported if it is empty.
+  virtual void SetTrackId(const std::string& track_id);
 
  protected:
   void OnFrame(const webrtc::VideoFrame& frame);
   rtc::VideoSinkWants GetSinkWants();
+  // Called when the maximum resolution or frame rate requested by sinks
+  // changes, so frames may be produced smaller at the source.
+  virtual void OnAdaptationChanged(int max_pixel_count, int max_fps) {}
 
  private:
   void UpdateVideoAdapter();
+  void ReportAdaptation(int width, int height);
 
   rtc::VideoBroadcaster broadcaster_;
   cricket::VideoAdapter video_adapter_;
+  // Not added to FrameBufferPool::GetTotalStats(), which reports the pools of
+  // captured frames only.
+  FrameBufferPool scaled_buffer_pool_;
+  webrtc::Mutex adaptation_lock_;
+  int max_pixel_count_ RTC_GUARDED_BY(adaptation_lock_);
+  int max_fps_ RTC_GUARDED_BY(adaptation_lock_);
+  // Read on the frame thread, which must not take |adaptation_lock_| since
+  // OnAdaptationChanged() locks the capturer delivering frames.
+  std::atomic<int> wanted_max_fps_;
+  std::atomic<bool> wants_changed_;
+  // Resolution of the last delivered raw frame. Accessed on the frame thread.
+  int adapted_width_;
+  int adapted_height_;
+  webrtc::Mutex track_id_lock_;
+  std::string track_id_ RTC_GUARDED_BY(track_id_lock_);
+};
+
+// Source of frames pushed by application. Frames wrap application's memory
+// and are delivered on the pushing thread.
+class CustomizedPushedFrameSource : public CustomizedVideoSource {
+ public:
+  // Returns false without taking the frame if it is invalid.
+  bool PushFrame(const PushedVideoFrame& frame);
 };
 
 // The proxy capturer to actual VideoCaptureModule implementation.
@@ -80,6 +117,10 @@ class CustomizedCapturer : public CustomizedVideoSource,
 
   // VideoSinkInterfaceImpl
   void OnFrame(const webrtc::VideoFrame& frame) override;
+  void SetTrackId(const std::string& track_id) override;
+
+ protected:
+  void OnAdaptationChanged(int max_pixel_count, int max_fps) override;
 
  private:
   CustomizedCapturer();
@@ -94,6 +135,9 @@ class CustomizedCapturer : public CustomizedVideoSource,
   void Destroy();
 
   rtc::scoped_refptr<webrtc::VideoCaptureModule> vcm_;
+  // |vcm_| if it reads frames from a VideoFrameGeneratorInterface or an
+  // encoder.
+  CustomizedFramesCapturer* frames_capturer_;
   webrtc::VideoCaptureCapability capability_;
 };
 
@@ -114,6 +158,10 @@ class LocalRawCaptureTrackSource : public webrtc::VideoTrackSource {
     return nullptr;
   }
 
+  void SetTrackId(const std::string& track_id) {
+    capturer_->SetTrackId(track_id);
+  }
+
  protected:
   explicit LocalRawCaptureTrackSource(
       std::unique_ptr<CustomizedCapturer> capturer)
@@ -142,6 +190,10 @@ class LocalDesktopCaptureTrackSource : public webrtc::VideoTrackSource {
     return nullptr;
   }
 
+  void SetTrackId(const std::string& track_id) {
+    capturer_->SetTrackId(track_id);
+  }
+
  protected:
   explicit LocalDesktopCaptureTrackSource(
       std::unique_ptr<CustomizedCapturer> capturer)
@@ -155,6 +207,26 @@ class LocalDesktopCaptureTrackSource : public webrtc::VideoTrackSource {
   std::unique_ptr<CustomizedCapturer> capturer_;
 };
 #endif
+class LocalPushedFrameTrackSource : public webrtc::VideoTrackSource {
+ public:
+  static rtc::scoped_refptr<LocalPushedFrameTrackSource> Create() {
+    return new rtc::RefCountedObject<LocalPushedFrameTrackSource>();
+  }
+
+  bool PushFrame(const PushedVideoFrame& frame) {
+    return source_.PushFrame(frame);
+  }
+  void SetTrackId(const std::string& track_id) { source_.SetTrackId(track_id); }
+
+ protected:
+  LocalPushedFrameTrackSource() : VideoTrackSource(/*remote=*/false) {}
+
+ private:
+  rtc::VideoSourceInterface<webrtc::VideoFrame>* source() override {
+    return &source_;
+  }
+  CustomizedPushedFrameSource source_;
+};
 class LocalEncodedCaptureTrackSource : public webrtc::VideoTrackSource {
  public:
   static rtc::scoped_refptr<LocalEncodedCaptureTrackSource> Create(
@@ -171,6 +243,10 @@ class LocalEncodedCaptureTrackSource : public webrtc::VideoTrackSource {
     return nullptr;
   }
 
+  void SetTrackId(const std::string& track_id) {
+    capturer_->SetTrackId(track_id);
+  }
+
  protected:
   explicit LocalEncodedCaptureTrackSource(
       std::unique_ptr<CustomizedCapturer> capturer)
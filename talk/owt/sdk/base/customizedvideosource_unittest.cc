@@ -0,0 +1,159 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/customizedvideosource.h"
+#include <limits>
+#include <utility>
+#include <vector>
+#include "absl/types/optional.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const int kWidth = 64;
+const int kHeight = 48;
+
+class FrameSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    frame_ = frame;
+    frames_++;
+  }
+  absl::optional<webrtc::VideoFrame> frame_;
+  int frames_ = 0;
+};
+
+// Records adaptations reported to the source.
+class AdaptedFrameSource : public CustomizedPushedFrameSource {
+ public:
+  std::vector<std::pair<int, int>> adaptations_;
+
+ protected:
+  void OnAdaptationChanged(int max_pixel_count, int max_fps) override {
+    adaptations_.emplace_back(max_pixel_count, max_fps);
+  }
+};
+
+class CustomizedPushedFrameSourceTest : public testing::Test {
+ protected:
+  CustomizedPushedFrameSourceTest()
+      : y_(kWidth * kHeight),
+        u_(kWidth * kHeight / 4),
+        v_(kWidth * kHeight / 4) {
+    frame_.width = kWidth;
+    frame_.height = kHeight;
+    frame_.data[0] = y_.data();
+    frame_.data[1] = u_.data();
+    frame_.data[2] = v_.data();
+    frame_.stride[0] = kWidth;
+    frame_.stride[1] = kWidth / 2;
+    frame_.stride[2] = kWidth / 2;
+    frame_.release_callback = [this] { ++released_; };
+  }
+
+  std::vector<uint8_t> y_;
+  std::vector<uint8_t> u_;
+  std::vector<uint8_t> v_;
+  PushedVideoFrame frame_;
+  int released_ = 0;
+  AdaptedFrameSource source_;
+};
+}  // namespace
+
+TEST_F(CustomizedPushedFrameSourceTest, DeliversFrameWithoutCopy) {
+  FrameSink sink;
+  source_.AddOrUpdateSink(&sink, rtc::VideoSinkWants());
+  frame_.timestamp_us = 1234567;
+  ASSERT_TRUE(source_.PushFrame(frame_));
+  ASSERT_TRUE(sink.frame_);
+  EXPECT_EQ(1234567, sink.frame_->timestamp_us());
+  rtc::scoped_refptr<webrtc::I420BufferInterface> buffer =
+      sink.frame_->video_frame_buffer()->ToI420();
+  EXPECT_EQ(kWidth, buffer->width());
+  EXPECT_EQ(kHeight, buffer->height());
+  EXPECT_EQ(y_.data(), buffer->DataY());
+  EXPECT_EQ(u_.data(), buffer->DataU());
+  EXPECT_EQ(v_.data(), buffer->DataV());
+  source_.RemoveSink(&sink);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, ReleasesWhenLastConsumerDropsFrame) {
+  FrameSink sink;
+  source_.AddOrUpdateSink(&sink, rtc::VideoSinkWants());
+  ASSERT_TRUE(source_.PushFrame(frame_));
+  webrtc::VideoFrame copy = *sink.frame_;
+  sink.frame_.reset();
+  EXPECT_EQ(0, released_);
+  copy = webrtc::VideoFrame::Builder()
+             .set_video_frame_buffer(webrtc::I420Buffer::Create(2, 2))
+             .build();
+  EXPECT_EQ(1, released_);
+  source_.RemoveSink(&sink);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, ReleasesFrameWithoutSink) {
+  ASSERT_TRUE(source_.PushFrame(frame_));
+  EXPECT_EQ(1, released_);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, RejectsInvalidFrame) {
+  frame_.stride[1] = kWidth / 2 - 1;
+  EXPECT_FALSE(source_.PushFrame(frame_));
+  frame_.stride[1] = kWidth / 2;
+  frame_.data[2] = nullptr;
+  EXPECT_FALSE(source_.PushFrame(frame_));
+  EXPECT_EQ(0, released_);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, ScalesFrameToRequestedPixelCount) {
+  FrameSink sink;
+  rtc::VideoSinkWants wants;
+  wants.max_pixel_count = kWidth * kHeight / 2;
+  source_.AddOrUpdateSink(&sink, wants);
+  frame_.timestamp_us = 1234567;
+  ASSERT_TRUE(source_.PushFrame(frame_));
+  ASSERT_TRUE(sink.frame_);
+  EXPECT_LT(sink.frame_->width(), kWidth);
+  EXPECT_LE(sink.frame_->width() * sink.frame_->height(),
+            wants.max_pixel_count);
+  EXPECT_EQ(1234567, sink.frame_->timestamp_us());
+  EXPECT_NE(y_.data(), sink.frame_->video_frame_buffer()->ToI420()->DataY());
+  // Application's frame is released once scaled.
+  EXPECT_EQ(1, released_);
+  source_.RemoveSink(&sink);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, DropsFramesAboveRequestedFrameRate) {
+  FrameSink sink;
+  rtc::VideoSinkWants wants;
+  wants.max_framerate_fps = 15;
+  source_.AddOrUpdateSink(&sink, wants);
+  const int kFrames = 60;
+  for (int i = 0; i < kFrames; i++) {
+    frame_.timestamp_us = rtc::kNumMicrosecsPerSec + i * 33333;
+    ASSERT_TRUE(source_.PushFrame(frame_));
+  }
+  EXPECT_NEAR(kFrames / 2, sink.frames_, 2);
+  // Passed frames are not copied.
+  EXPECT_EQ(y_.data(), sink.frame_->video_frame_buffer()->ToI420()->DataY());
+  source_.RemoveSink(&sink);
+}
+
+TEST_F(CustomizedPushedFrameSourceTest, ReportsAdaptationWhenChanged) {
+  FrameSink sink;
+  rtc::VideoSinkWants wants;
+  source_.AddOrUpdateSink(&sink, wants);
+  EXPECT_TRUE(source_.adaptations_.empty());
+  wants.max_pixel_count = 640 * 360;
+  wants.max_framerate_fps = 15;
+  source_.AddOrUpdateSink(&sink, wants);
+  source_.AddOrUpdateSink(&sink, wants);
+  source_.RemoveSink(&sink);
+  const int kUnlimited = std::numeric_limits<int>::max();
+  ASSERT_EQ(2u, source_.adaptations_.size());
+  EXPECT_EQ(std::make_pair(640 * 360, 15), source_.adaptations_[0]);
+  EXPECT_EQ(std::make_pair(kUnlimited, kUnlimited), source_.adaptations_[1]);
+}
+}
+}
@@ -0,0 +1,370 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/flatstatsconverter.h"
+#include <stdlib.h>
+#include <string.h>
+namespace owt {
+namespace base {
+namespace {
+int64_t NumberValue(const webrtc::StatsReport::Value& value) {
+  switch (value.type()) {
+    case webrtc::StatsReport::Value::kInt:
+      return value.int_val();
+    case webrtc::StatsReport::Value::kInt64:
+      return value.int64_val();
+    case webrtc::StatsReport::Value::kFloat:
+      return static_cast<int64_t>(value.float_val());
+    default:
+      return 0;
+  }
+}
+
+const char* StringValue(const webrtc::StatsReport::Value& value) {
+  switch (value.type()) {
+    case webrtc::StatsReport::Value::kString:
+      return value.string_val().c_str();
+    case webrtc::StatsReport::Value::kStaticString:
+      return value.static_string_val();
+    default:
+      return nullptr;
+  }
+}
+
+// Same mapping as FunctionalStatsObserver, without converting to strings.
+IceCandidateType CandidateType(const char* type) {
+  if (type == nullptr)
+    return IceCandidateType::kUnknown;
+  if (strcmp(type, "host") == 0)
+    return IceCandidateType::kHost;
+  if (strcmp(type, "serverreflexive") == 0)
+    return IceCandidateType::kSrflx;
+  if (strcmp(type, "peerreflexive") == 0)
+    return IceCandidateType::kPrflx;
+  if (strcmp(type, "relayed") == 0)
+    return IceCandidateType::kRelay;
+  return IceCandidateType::kUnknown;
+}
+
+TransportProtocolType ProtocolType(const char* protocol) {
+  if (protocol == nullptr)
+    return TransportProtocolType::kUnknown;
+  if (strcmp(protocol, "udp") == 0)
+    return TransportProtocolType::kUdp;
+  if (strcmp(protocol, "tcp") == 0)
+    return TransportProtocolType::kTcp;
+  return TransportProtocolType::kUnknown;
+}
+
+template <size_t N>
+void CopyString(const char* source, char (&destination)[N]) {
+  if (source == nullptr)
+    source = "";
+  strncpy(destination, source, N - 1);
+  destination[N - 1] = '\0';
+}
+
+// Values of an SSRC report, sender and receiver fields together.
+struct SsrcValues {
+  uint32_t ssrc = 0;
+  bool sending = false;
+  bool video = false;
+  int64_t bytes = 0;
+  int32_t packets = 0;
+  int32_t packets_lost = 0;
+  int32_t fir_count = 0;
+  int32_t pli_count = 0;
+  int32_t nack_count = 0;
+  int32_t frame_width = 0;
+  int32_t frame_height = 0;
+  int32_t framerate = 0;
+  int32_t framerate_output = 0;
+  int32_t delay = 0;
+  int32_t jitter = 0;
+  bool cpu_limited = false;
+  bool bandwidth_limited = false;
+  int32_t adapt_changes = 0;
+  int64_t round_trip_time = 0;
+  const char* codec_name = nullptr;
+};
+}
+
+void FlatStatsConverter::Convert(const webrtc::StatsReports& reports,
+                                 FlatConnectionStats* stats) {
+  stats->Clear();
+  stats->time_stamp = std::chrono::system_clock::now();
+  for (const auto* report : reports) {
+    switch (report->type()) {
+      case webrtc::StatsReport::kStatsReportTypeSsrc:
+        ConvertSsrcReport(*report, stats);
+        break;
+      case webrtc::StatsReport::kStatsReportTypeBwe:
+        ConvertBweReport(*report, stats);
+        break;
+      case webrtc::StatsReport::kStatsReportTypeIceLocalCandidate:
+        ConvertCandidateReport(*report, &stats->local_ice_candidate_reports);
+        break;
+      case webrtc::StatsReport::kStatsReportTypeIceRemoteCandidate:
+        ConvertCandidateReport(*report, &stats->remote_ice_candidate_reports);
+        break;
+      case webrtc::StatsReport::kStatsReportTypeCandidatePair:
+        ConvertCandidatePairReport(*report, reports, stats);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+FlatCodecIndex FlatStatsConverter::InternCodecName(
+    const char* name,
+    FlatConnectionStats* stats) {
+  if (name == nullptr || *name == '\0')
+    return -1;
+  for (size_t i = 0; i < stats->codec_names.size(); i++) {
+    if (stats->codec_names[i] == name)
+      return static_cast<FlatCodecIndex>(i);
+  }
+  stats->codec_names.push_back(name);
+  return static_cast<FlatCodecIndex>(stats->codec_names.size() - 1);
+}
+
+FlatCandidateIndex FlatStatsConverter::FindCandidate(
+    const webrtc::StatsReport::Value& id,
+    webrtc::StatsReport::StatsType type,
+    const webrtc::StatsReports& reports) {
+  if (id.type() != webrtc::StatsReport::Value::kId)
+    return -1;
+  FlatCandidateIndex index = 0;
+  for (const auto* report : reports) {
+    if (report->type() != type)
+      continue;
+    if (report->id()->Equals(id.id_val()))
+      return index;
+    index++;
+  }
+  return -1;
+}
+
+void FlatStatsConverter::ConvertSsrcReport(const webrtc::StatsReport& report,
+                                           FlatConnectionStats* stats) {
+  SsrcValues v;
+  for (const auto& entry : report.values()) {
+    const webrtc::StatsReport::Value& value = *entry.second;
+    switch (value.name) {
+      case webrtc::StatsReport::kStatsValueNameSsrc: {
+        const char* ssrc = StringValue(value);
+        v.ssrc = ssrc ? static_cast<uint32_t>(strtoul(ssrc, nullptr, 10))
+                      : static_cast<uint32_t>(NumberValue(value));
+        break;
+      }
+      case webrtc::StatsReport::kStatsValueNameBytesSent:
+        v.sending = true;
+        v.bytes = NumberValue(value);
+        break;
+      case webrtc::StatsReport::kStatsValueNameBytesReceived:
+        v.bytes = NumberValue(value);
+        break;
+      case webrtc::StatsReport::kStatsValueNamePacketsSent:
+      case webrtc::StatsReport::kStatsValueNamePacketsReceived:
+        v.packets = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNamePacketsLost:
+        v.packets_lost = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameFirsSent:
+      case webrtc::StatsReport::kStatsValueNameFirsReceived:
+        v.fir_count = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNamePlisSent:
+      case webrtc::StatsReport::kStatsValueNamePlisReceived:
+        v.pli_count = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameNacksSent:
+      case webrtc::StatsReport::kStatsValueNameNacksReceived:
+        v.nack_count = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameFrameWidthSent:
+      case webrtc::StatsReport::kStatsValueNameFrameWidthReceived:
+        v.video = true;
+        v.frame_width = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameFrameHeightSent:
+      case webrtc::StatsReport::kStatsValueNameFrameHeightReceived:
+        v.frame_height = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameFrameRateSent:
+      case webrtc::StatsReport::kStatsValueNameFrameRateReceived:
+        v.framerate = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameFrameRateOutput:
+        v.framerate_output = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameCurrentDelayMs:
+        v.delay = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameJitterBufferMs:
+        v.jitter = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameCpuLimitedResolution:
+        v.cpu_limited = value.type() == webrtc::StatsReport::Value::kBool &&
+                        value.bool_val();
+        break;
+      case webrtc::StatsReport::kStatsValueNameBandwidthLimitedResolution:
+        v.bandwidth_limited =
+            value.type() == webrtc::StatsReport::Value::kBool &&
+            value.bool_val();
+        break;
+      case webrtc::StatsReport::kStatsValueNameAdaptationChanges:
+        v.adapt_changes = static_cast<int32_t>(NumberValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameRtt:
+        v.round_trip_time = NumberValue(value);
+        break;
+      case webrtc::StatsReport::kStatsValueNameCodecName:
+        v.codec_name = StringValue(value);
+        break;
+      default:
+        break;
+    }
+  }
+  FlatCodecIndex codec = InternCodecName(v.codec_name, stats);
+  if (v.sending && !v.video) {
+    stats->audio_sender_reports.push_back({v.ssrc, v.bytes, v.packets,
+                                           v.packets_lost, v.round_trip_time,
+                                           codec});
+  } else if (!v.sending && !v.video) {
+    stats->audio_receiver_reports.push_back(
+        {v.ssrc, v.bytes, v.packets, v.packets_lost, v.delay, codec});
+  } else if (v.sending) {
+    // Same precedence as FunctionalStatsObserver.
+    int32_t adapt_reason =
+        static_cast<int32_t>(VideoSenderReport::AdaptReason::kUnknown);
+    if (v.cpu_limited)
+      adapt_reason =
+          static_cast<int32_t>(VideoSenderReport::AdaptReason::kCpuLimitation);
+    else if (v.bandwidth_limited)
+      adapt_reason = static_cast<int32_t>(
+          VideoSenderReport::AdaptReason::kBandwidthLimitation);
+    stats->video_sender_reports.push_back(
+        {v.ssrc, v.bytes, v.packets, v.packets_lost, v.fir_count, v.pli_count,
+         v.nack_count, v.frame_width, v.frame_height, v.framerate,
+         adapt_reason, v.adapt_changes, v.round_trip_time, codec});
+  } else {
+    stats->video_receiver_reports.push_back(
+        {v.ssrc, v.bytes, v.packets, v.packets_lost, v.fir_count, v.pli_count,
+         v.nack_count, v.frame_width, v.frame_height, v.framerate,
+         v.framerate_output, v.delay, v.jitter, codec});
+  }
+}
+
+void FlatStatsConverter::ConvertBweReport(const webrtc::StatsReport& report,
+                                          FlatConnectionStats* stats) {
+  VideoBandwidthStats& bwe = stats->video_bandwidth_stats;
+  for (const auto& entry : report.values()) {
+    const webrtc::StatsReport::Value& value = *entry.second;
+    int32_t number = static_cast<int32_t>(NumberValue(value));
+    switch (value.name) {
+      case webrtc::StatsReport::kStatsValueNameAvailableSendBandwidth:
+        bwe.available_send_bandwidth = number;
+        break;
+      case webrtc::StatsReport::kStatsValueNameAvailableReceiveBandwidth:
+        bwe.available_receive_bandwidth = number;
+        break;
+      case webrtc::StatsReport::kStatsValueNameTransmitBitrate:
+        bwe.transmit_bitrate = number;
+        break;
+      case webrtc::StatsReport::kStatsValueNameRetransmitBitrate:
+        bwe.retransmit_bitrate = number;
+        break;
+      case webrtc::StatsReport::kStatsValueNameTargetEncBitrate:
+        bwe.target_encoding_bitrate = number;
+        break;
+      case webrtc::StatsReport::kStatsValueNameActualEncBitrate:
+        bwe.actual_encoding_bitrate = number;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void FlatStatsConverter::ConvertCandidateReport(
+    const webrtc::StatsReport& report,
+    std::vector<FlatIceCandidateReport>* candidates) {
+  FlatIceCandidateReport candidate = {};
+  // IDs are only available as strings. Candidate IDs are "Cand-" and 8
+  // random characters, short enough not to be allocated on the heap.
+  CopyString(report.id()->ToString().c_str(), candidate.id);
+  candidate.protocol = TransportProtocolType::kUnknown;
+  candidate.candidate_type = IceCandidateType::kUnknown;
+  for (const auto& entry : report.values()) {
+    const webrtc::StatsReport::Value& value = *entry.second;
+    switch (value.name) {
+      case webrtc::StatsReport::kStatsValueNameCandidateIPAddress:
+        CopyString(StringValue(value), candidate.ip);
+        break;
+      case webrtc::StatsReport::kStatsValueNameCandidatePortNumber: {
+        const char* port = StringValue(value);
+        candidate.port = port
+                             ? static_cast<uint16_t>(strtoul(port, nullptr, 10))
+                             : static_cast<uint16_t>(NumberValue(value));
+        break;
+      }
+      case webrtc::StatsReport::kStatsValueNameCandidateTransportType:
+        candidate.protocol = ProtocolType(StringValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameCandidateType:
+        candidate.candidate_type = CandidateType(StringValue(value));
+        break;
+      case webrtc::StatsReport::kStatsValueNameCandidatePriority:
+        candidate.priority = static_cast<int32_t>(NumberValue(value));
+        break;
+      default:
+        break;
+    }
+  }
+  candidates->push_back(candidate);
+}
+
+void FlatStatsConverter::ConvertCandidatePairReport(
+    const webrtc::StatsReport& report,
+    const webrtc::StatsReports& reports,
+    FlatConnectionStats* stats) {
+  FlatIceCandidatePairReport pair = {};
+  pair.local_ice_candidate = -1;
+  pair.remote_ice_candidate = -1;
+  for (const auto& entry : report.values()) {
+    const webrtc::StatsReport::Value& value = *entry.second;
+    switch (value.name) {
+      case webrtc::StatsReport::kStatsValueNameActiveConnection:
+        pair.is_active = value.type() == webrtc::StatsReport::Value::kBool &&
+                         value.bool_val();
+        break;
+      case webrtc::StatsReport::kStatsValueNameLocalCandidateId:
+        pair.local_ice_candidate = FindCandidate(
+            value, webrtc::StatsReport::kStatsReportTypeIceLocalCandidate,
+            reports);
+        break;
+      case webrtc::StatsReport::kStatsValueNameRemoteCandidateId:
+        pair.remote_ice_candidate = FindCandidate(
+            value, webrtc::StatsReport::kStatsReportTypeIceRemoteCandidate,
+            reports);
+        break;
+      case webrtc::StatsReport::kStatsValueNameBytesSent:
+        pair.bytes_sent = NumberValue(value);
+        break;
+      case webrtc::StatsReport::kStatsValueNameBytesReceived:
+        pair.bytes_rcvd = NumberValue(value);
+        break;
+      case webrtc::StatsReport::kStatsValueNameRtt:
+        pair.round_trip_time = NumberValue(value);
+        break;
+      default:
+        break;
+    }
+  }
+  stats->ice_candidate_pair_reports.push_back(pair);
+}
+}
+}
@@ -0,0 +1,45 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_FLATSTATSCONVERTER_H_
+#define OWT_BASE_FLATSTATSCONVERTER_H_
+#include <vector>
+#include "owt/base/connectionstats.h"
+#include "webrtc/api/stats_types.h"
+namespace owt {
+namespace base {
+// Converts legacy stats reports into FlatConnectionStats. Each report is
+// classified and converted in a single walk over its values, instead of a
+// lookup per field.
+class FlatStatsConverter {
+ public:
+  // Replace the content of |stats| with |reports|. Storage of |stats| is
+  // reused.
+  static void Convert(const webrtc::StatsReports& reports,
+                      FlatConnectionStats* stats);
+
+ private:
+  // Returns the index of |name| in |stats|, adding it if not found.
+  static FlatCodecIndex InternCodecName(const char* name,
+                                        FlatConnectionStats* stats);
+  static void ConvertSsrcReport(const webrtc::StatsReport& report,
+                                FlatConnectionStats* stats);
+  static void ConvertBweReport(const webrtc::StatsReport& report,
+                               FlatConnectionStats* stats);
+  static void ConvertCandidateReport(
+      const webrtc::StatsReport& report,
+      std::vector<FlatIceCandidateReport>* candidates);
+  static void ConvertCandidatePairReport(const webrtc::StatsReport& report,
+                                         const webrtc::StatsReports& reports,
+                                         FlatConnectionStats* stats);
+  // Returns the index of the candidate of |type| whose ID is the kId value
+  // |id|, or -1. Indices count candidates of |type| in |reports|, which are
+  // converted in order. IDs are compared without converting to strings.
+  static FlatCandidateIndex FindCandidate(
+      const webrtc::StatsReport::Value& id,
+      webrtc::StatsReport::StatsType type,
+      const webrtc::StatsReports& reports);
+};
+}
+}
+#endif  // OWT_BASE_FLATSTATSCONVERTER_H_
@@ -0,0 +1,280 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/flatstatsconverter.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "talk/owt/sdk/base/functionalobserver.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const int kBenchmarkIterations = 100000;
+
+// Legacy reports of one audio and one video stream in each direction, plus
+// bandwidth estimation.
+class LegacyReports {
+ public:
+  LegacyReports() {
+    auto audio_send = NewSsrcReport("1001", webrtc::StatsReport::kSend);
+    audio_send->AddString(webrtc::StatsReport::kStatsValueNameSsrc, "1001");
+    audio_send->AddInt64(webrtc::StatsReport::kStatsValueNameBytesSent, 1000);
+    audio_send->AddInt(webrtc::StatsReport::kStatsValueNamePacketsSent, 10);
+    audio_send->AddInt(webrtc::StatsReport::kStatsValueNamePacketsLost, 1);
+    audio_send->AddInt64(webrtc::StatsReport::kStatsValueNameRtt, 30);
+    audio_send->AddString(webrtc::StatsReport::kStatsValueNameCodecName,
+                          "opus");
+    auto audio_recv = NewSsrcReport("1002", webrtc::StatsReport::kReceive);
+    audio_recv->AddString(webrtc::StatsReport::kStatsValueNameSsrc, "1002");
+    audio_recv->AddInt64(webrtc::StatsReport::kStatsValueNameBytesReceived,
+                         2000);
+    audio_recv->AddInt(webrtc::StatsReport::kStatsValueNamePacketsReceived,
+                       20);
+    audio_recv->AddInt(webrtc::StatsReport::kStatsValueNamePacketsLost, 2);
+    audio_recv->AddInt(webrtc::StatsReport::kStatsValueNameCurrentDelayMs,
+                       40);
+    audio_recv->AddString(webrtc::StatsReport::kStatsValueNameCodecName,
+                          "opus");
+    auto video_send = NewSsrcReport("2001", webrtc::StatsReport::kSend);
+    video_send->AddString(webrtc::StatsReport::kStatsValueNameSsrc, "2001");
+    video_send->AddInt64(webrtc::StatsReport::kStatsValueNameBytesSent, 3000);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNamePacketsSent, 30);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNamePacketsLost, 3);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameFirsReceived, 1);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNamePlisReceived, 2);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameNacksReceived, 3);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameFrameWidthSent,
+                       1280);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameFrameHeightSent,
+                       720);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameFrameRateSent, 30);
+    video_send->AddBoolean(
+        webrtc::StatsReport::kStatsValueNameCpuLimitedResolution, true);
+    video_send->AddBoolean(
+        webrtc::StatsReport::kStatsValueNameBandwidthLimitedResolution, true);
+    video_send->AddInt(webrtc::StatsReport::kStatsValueNameAdaptationChanges,
+                       4);
+    video_send->AddInt64(webrtc::StatsReport::kStatsValueNameRtt, 50);
+    video_send->AddString(webrtc::StatsReport::kStatsValueNameCodecName,
+                          "VP8");
+    auto video_recv = NewSsrcReport("2002", webrtc::StatsReport::kReceive);
+    video_recv->AddString(webrtc::StatsReport::kStatsValueNameSsrc, "2002");
+    video_recv->AddInt64(webrtc::StatsReport::kStatsValueNameBytesReceived,
+                         4000);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNamePacketsReceived,
+                       40);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNamePacketsLost, 4);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameFirsSent, 5);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNamePlisSent, 6);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameNacksSent, 7);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameFrameWidthReceived,
+                       640);
+    video_recv->AddInt(
+        webrtc::StatsReport::kStatsValueNameFrameHeightReceived, 360);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameFrameRateReceived,
+                       25);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameFrameRateOutput,
+                       24);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameCurrentDelayMs,
+                       60);
+    video_recv->AddInt(webrtc::StatsReport::kStatsValueNameJitterBufferMs, 15);
+    video_recv->AddString(webrtc::StatsReport::kStatsValueNameCodecName,
+                          "VP8");
+    reports_.push_back(std::make_unique<webrtc::StatsReport>(
+        webrtc::StatsReport::NewBandwidthEstimationId()));
+    auto* bwe = reports_.back().get();
+    bwe->AddInt(webrtc::StatsReport::kStatsValueNameAvailableSendBandwidth,
+                1000000);
+    bwe->AddInt(webrtc::StatsReport::kStatsValueNameAvailableReceiveBandwidth,
+                2000000);
+    bwe->AddInt(webrtc::StatsReport::kStatsValueNameTransmitBitrate, 900000);
+    bwe->AddInt(webrtc::StatsReport::kStatsValueNameRetransmitBitrate, 10000);
+    for (const auto& report : reports_)
+      pointers_.push_back(report.get());
+  }
+  const webrtc::StatsReports& reports() const { return pointers_; }
+
+ private:
+  webrtc::StatsReport* NewSsrcReport(const std::string& ssrc,
+                                     webrtc::StatsReport::Direction direction) {
+    reports_.push_back(std::make_unique<webrtc::StatsReport>(
+        webrtc::StatsReport::NewIdWithDirection(
+            webrtc::StatsReport::kStatsReportTypeSsrc, ssrc, direction)));
+    return reports_.back().get();
+  }
+  std::vector<std::unique_ptr<webrtc::StatsReport>> reports_;
+  webrtc::StatsReports pointers_;
+};
+}  // namespace
+
+TEST(FlatStatsConverterTest, ConvertsSsrcReports) {
+  LegacyReports legacy;
+  FlatConnectionStats stats;
+  FlatStatsConverter::Convert(legacy.reports(), &stats);
+
+  ASSERT_EQ(1u, stats.audio_sender_reports.size());
+  const FlatAudioSenderReport& audio_send = stats.audio_sender_reports[0];
+  EXPECT_EQ(1001u, audio_send.ssrc);
+  EXPECT_EQ(1000, audio_send.bytes_sent);
+  EXPECT_EQ(10, audio_send.packets_sent);
+  EXPECT_EQ(1, audio_send.packets_lost);
+  EXPECT_EQ(30, audio_send.round_trip_time);
+  EXPECT_EQ("opus", stats.codec_name(audio_send.codec));
+
+  ASSERT_EQ(1u, stats.audio_receiver_reports.size());
+  const FlatAudioReceiverReport& audio_recv = stats.audio_receiver_reports[0];
+  EXPECT_EQ(2000, audio_recv.bytes_rcvd);
+  EXPECT_EQ(40, audio_recv.estimated_delay);
+  EXPECT_EQ(audio_send.codec, audio_recv.codec);
+
+  ASSERT_EQ(1u, stats.video_sender_reports.size());
+  const FlatVideoSenderReport& video_send = stats.video_sender_reports[0];
+  EXPECT_EQ(3000, video_send.bytes_sent);
+  EXPECT_EQ(3, video_send.nack_count);
+  EXPECT_EQ(1280, video_send.frame_width_sent);
+  EXPECT_EQ(720, video_send.frame_height_sent);
+  EXPECT_EQ(30, video_send.framerate_sent);
+  EXPECT_EQ(
+      static_cast<int32_t>(VideoSenderReport::AdaptReason::kCpuLimitation),
+      video_send.last_adapt_reason);
+  EXPECT_EQ(4, video_send.adapt_changes);
+  EXPECT_EQ("VP8", stats.codec_name(video_send.codec));
+
+  ASSERT_EQ(1u, stats.video_receiver_reports.size());
+  const FlatVideoReceiverReport& video_recv = stats.video_receiver_reports[0];
+  EXPECT_EQ(2002u, video_recv.ssrc);
+  EXPECT_EQ(6, video_recv.pli_count);
+  EXPECT_EQ(640, video_recv.frame_width_rcvd);
+  EXPECT_EQ(25, video_recv.framerate_rcvd);
+  EXPECT_EQ(24, video_recv.framerate_output);
+  EXPECT_EQ(15, video_recv.jitter);
+  EXPECT_EQ(video_send.codec, video_recv.codec);
+
+  EXPECT_EQ(2u, stats.codec_names.size());
+  EXPECT_EQ(1000000, stats.video_bandwidth_stats.available_send_bandwidth);
+  EXPECT_EQ(10000, stats.video_bandwidth_stats.retransmit_bitrate);
+}
+
+TEST(FlatStatsConverterTest, ReusesStorage) {
+  LegacyReports legacy;
+  FlatConnectionStats stats;
+  FlatStatsConverter::Convert(legacy.reports(), &stats);
+  const FlatVideoSenderReport* video_send = stats.video_sender_reports.data();
+  FlatCodecIndex codec = video_send->codec;
+  FlatStatsConverter::Convert(legacy.reports(), &stats);
+  ASSERT_EQ(1u, stats.video_sender_reports.size());
+  EXPECT_EQ(video_send, stats.video_sender_reports.data());
+  EXPECT_EQ(codec, stats.video_sender_reports[0].codec);
+  EXPECT_EQ(2u, stats.codec_names.size());
+}
+
+TEST(FlatStatsConverterTest, ConvertsCandidatePairs) {
+  std::vector<std::unique_ptr<webrtc::StatsReport>> owned;
+  // The pair comes first, candidates are found by their IDs.
+  owned.push_back(std::make_unique<webrtc::StatsReport>(
+      webrtc::StatsReport::NewCandidatePairId("audio", 1, 0)));
+  webrtc::StatsReport* pair = owned.back().get();
+  owned.push_back(std::make_unique<webrtc::StatsReport>(
+      webrtc::StatsReport::NewCandidateId(true, "other")));
+  owned.push_back(std::make_unique<webrtc::StatsReport>(
+      webrtc::StatsReport::NewCandidateId(true, "local")));
+  webrtc::StatsReport* local = owned.back().get();
+  local->AddString(webrtc::StatsReport::kStatsValueNameCandidateIPAddress,
+                   "192.168.1.2");
+  local->AddString(webrtc::StatsReport::kStatsValueNameCandidatePortNumber,
+                   "50000");
+  local->AddString(webrtc::StatsReport::kStatsValueNameCandidateTransportType,
+                   "udp");
+  local->AddString(webrtc::StatsReport::kStatsValueNameCandidateType, "host");
+  local->AddInt(webrtc::StatsReport::kStatsValueNameCandidatePriority, 100);
+  owned.push_back(std::make_unique<webrtc::StatsReport>(
+      webrtc::StatsReport::NewCandidateId(false, "remote")));
+  webrtc::StatsReport* remote = owned.back().get();
+  remote->AddString(webrtc::StatsReport::kStatsValueNameCandidateIPAddress,
+                    "10.0.0.1");
+  remote->AddString(webrtc::StatsReport::kStatsValueNameCandidatePortNumber,
+                    "3478");
+  remote->AddString(
+      webrtc::StatsReport::kStatsValueNameCandidateTransportType, "tcp");
+  remote->AddString(webrtc::StatsReport::kStatsValueNameCandidateType,
+                    "relayed");
+  pair->AddId(webrtc::StatsReport::kStatsValueNameLocalCandidateId,
+              local->id());
+  pair->AddId(webrtc::StatsReport::kStatsValueNameRemoteCandidateId,
+              remote->id());
+  pair->AddBoolean(webrtc::StatsReport::kStatsValueNameActiveConnection, true);
+  pair->AddInt64(webrtc::StatsReport::kStatsValueNameBytesSent, 500);
+  pair->AddInt64(webrtc::StatsReport::kStatsValueNameRtt, 20);
+  webrtc::StatsReports reports;
+  for (const auto& report : owned)
+    reports.push_back(report.get());
+
+  FlatConnectionStats stats;
+  FlatStatsConverter::Convert(reports, &stats);
+  ASSERT_EQ(2u, stats.local_ice_candidate_reports.size());
+  const FlatIceCandidateReport& local_candidate =
+      stats.local_ice_candidate_reports[1];
+  EXPECT_STREQ(local->id()->ToString().c_str(), local_candidate.id);
+  EXPECT_STREQ("192.168.1.2", local_candidate.ip);
+  EXPECT_EQ(50000, local_candidate.port);
+  EXPECT_EQ(TransportProtocolType::kUdp, local_candidate.protocol);
+  EXPECT_EQ(IceCandidateType::kHost, local_candidate.candidate_type);
+  EXPECT_EQ(100, local_candidate.priority);
+  ASSERT_EQ(1u, stats.remote_ice_candidate_reports.size());
+  EXPECT_EQ(TransportProtocolType::kTcp,
+            stats.remote_ice_candidate_reports[0].protocol);
+  EXPECT_EQ(IceCandidateType::kRelay,
+            stats.remote_ice_candidate_reports[0].candidate_type);
+
+  ASSERT_EQ(1u, stats.ice_candidate_pair_reports.size());
+  const FlatIceCandidatePairReport& candidate_pair =
+      stats.ice_candidate_pair_reports[0];
+  EXPECT_TRUE(candidate_pair.is_active);
+  EXPECT_EQ(1, candidate_pair.local_ice_candidate);
+  EXPECT_EQ(0, candidate_pair.remote_ice_candidate);
+  EXPECT_EQ(500, candidate_pair.bytes_sent);
+  EXPECT_EQ(20, candidate_pair.round_trip_time);
+}
+
+TEST(FlatStatsConverterTest, UnknownCodec) {
+  FlatConnectionStats stats;
+  EXPECT_EQ("", stats.codec_name(-1));
+  EXPECT_EQ("", stats.codec_name(0));
+}
+
+TEST(FlatStatsConverterTest, DISABLED_BenchmarkConversionsPerSecond) {
+  LegacyReports legacy;
+  size_t reports = 0;
+  rtc::scoped_refptr<FunctionalStatsObserver> observer =
+      FunctionalStatsObserver::Create(
+          [&reports](std::shared_ptr<ConnectionStats> stats) {
+            reports += stats->video_sender_reports.size();
+          });
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kBenchmarkIterations; i++)
+    observer->OnComplete(legacy.reports());
+  int64_t connection_stats_us = rtc::TimeMicros() - start_us;
+
+  FlatConnectionStats stats;
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kBenchmarkIterations; i++) {
+    FlatStatsConverter::Convert(legacy.reports(), &stats);
+    reports += stats.video_sender_reports.size();
+  }
+  int64_t flat_stats_us = rtc::TimeMicros() - start_us;
+
+  EXPECT_EQ(2u * kBenchmarkIterations, reports);
+  std::cout << "ConnectionStats: "
+            << kBenchmarkIterations * 1000000LL / std::max<int64_t>(
+                                                       connection_stats_us, 1)
+            << " conversions/s, FlatConnectionStats: "
+            << kBenchmarkIterations * 1000000LL /
+                   std::max<int64_t>(flat_stats_us, 1)
+            << " conversions/s." << std::endl;
+  EXPECT_LT(flat_stats_us, connection_stats_us);
+}
+}
+}
@@ -0,0 +1,101 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/framebufferpool.h"
+namespace owt {
+namespace base {
+std::atomic<uint64_t> FrameBufferPool::total_hits_(0);
+std::atomic<uint64_t> FrameBufferPool::total_misses_(0);
+std::atomic<int64_t> FrameBufferPool::total_pooled_buffers_(0);
+
+FrameBufferPool::FrameBufferPool(size_t max_buffers_per_resolution,
+                                 size_t max_resolutions,
+                                 bool add_to_total_stats)
+    : max_buffers_per_resolution_(max_buffers_per_resolution),
+      max_resolutions_(max_resolutions),
+      add_to_total_stats_(add_to_total_stats) {}
+
+FrameBufferPool::~FrameBufferPool() {
+  // Buffers still in use are freed when their frames are released.
+  if (add_to_total_stats_)
+    total_pooled_buffers_ -= stats_.pooled_buffers;
+}
+
+rtc::scoped_refptr<webrtc::I420Buffer> FrameBufferPool::CreateBuffer(
+    int width,
+    int height) {
+  // Same layout as webrtc::I420Buffer::Create(width, height).
+  return CreateBuffer(width, height, width, (width + 1) / 2);
+}
+
+rtc::scoped_refptr<webrtc::I420Buffer> FrameBufferPool::CreateBuffer(
+    int width,
+    int height,
+    int stride_y,
+    int stride_uv) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto resolution = resolutions_.begin();
+  while (resolution != resolutions_.end() &&
+         (resolution->width != width || resolution->height != height ||
+          resolution->stride_y != stride_y ||
+          resolution->stride_uv != stride_uv)) {
+    ++resolution;
+  }
+  if (resolution == resolutions_.end()) {
+    resolutions_.push_front(
+        Resolution{width, height, stride_y, stride_uv, {}});
+    if (resolutions_.size() > max_resolutions_) {
+      int64_t evicted = resolutions_.back().buffers.size();
+      AddCounters(0, 0, -evicted);
+      resolutions_.pop_back();
+    }
+  } else if (resolution != resolutions_.begin()) {
+    resolutions_.splice(resolutions_.begin(), resolutions_, resolution);
+  }
+  std::vector<rtc::scoped_refptr<PooledBuffer>>& buffers =
+      resolutions_.front().buffers;
+  for (const auto& buffer : buffers) {
+    // Only the pool refers to a released buffer.
+    if (buffer->HasOneRef()) {
+      AddCounters(1, 0, 0);
+      return buffer;
+    }
+  }
+  rtc::scoped_refptr<PooledBuffer> buffer =
+      new PooledBuffer(width, height, stride_y, stride_uv, stride_uv);
+  if (buffers.size() < max_buffers_per_resolution_) {
+    buffers.push_back(buffer);
+    AddCounters(0, 1, 1);
+  } else {
+    AddCounters(0, 1, 0);
+  }
+  return buffer;
+}
+
+FrameBufferPoolStats FrameBufferPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+FrameBufferPoolStats FrameBufferPool::GetTotalStats() {
+  FrameBufferPoolStats stats;
+  stats.hits = total_hits_.load();
+  stats.misses = total_misses_.load();
+  stats.pooled_buffers = total_pooled_buffers_.load();
+  return stats;
+}
+
+void FrameBufferPool::AddCounters(uint64_t hits,
+                                  uint64_t misses,
+                                  int64_t pooled_buffers) {
+  stats_.hits += hits;
+  stats_.misses += misses;
+  stats_.pooled_buffers += pooled_buffers;
+  if (!add_to_total_stats_)
+    return;
+  total_hits_ += hits;
+  total_misses_ += misses;
+  total_pooled_buffers_ += pooled_buffers;
+}
+}
+}
@@ -0,0 +1,65 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_FRAMEBUFFERPOOL_H_
+#define OWT_BASE_FRAMEBUFFERPOOL_H_
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/api/scoped_refptr.h"
+#include "webrtc/api/video/i420_buffer.h"
+#include "webrtc/rtc_base/ref_counted_object.h"
+namespace owt {
+namespace base {
+// Pool of I420 buffers of the most recently used resolutions. A buffer is
+// reused once every frame referring to it is released, so each frame owns its
+// memory without an allocation per frame. Thread safe.
+class FrameBufferPool {
+ public:
+  // Keeps at most |max_buffers_per_resolution| buffers of each of the last
+  // |max_resolutions| resolutions. Counters of the pool are added to
+  // GetTotalStats() if |add_to_total_stats| is true.
+  FrameBufferPool(size_t max_buffers_per_resolution,
+                  size_t max_resolutions,
+                  bool add_to_total_stats);
+  ~FrameBufferPool();
+  // Returns a released buffer of the resolution, or a new one. Buffers
+  // allocated while all pooled ones are in use are not kept.
+  rtc::scoped_refptr<webrtc::I420Buffer> CreateBuffer(int width, int height);
+  // Same as above with the given strides. Buffers of different strides are
+  // pooled separately.
+  rtc::scoped_refptr<webrtc::I420Buffer> CreateBuffer(int width,
+                                                      int height,
+                                                      int stride_y,
+                                                      int stride_uv);
+  FrameBufferPoolStats GetStats() const;
+  // Counters of all pools in the process which add to total stats.
+  static FrameBufferPoolStats GetTotalStats();
+
+ private:
+  using PooledBuffer = rtc::RefCountedObject<webrtc::I420Buffer>;
+  struct Resolution {
+    int width;
+    int height;
+    int stride_y;
+    int stride_uv;
+    std::vector<rtc::scoped_refptr<PooledBuffer>> buffers;
+  };
+  void AddCounters(uint64_t hits, uint64_t misses, int64_t pooled_buffers);
+
+  const size_t max_buffers_per_resolution_;
+  const size_t max_resolutions_;
+  const bool add_to_total_stats_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Resolution> resolutions_;
+  FrameBufferPoolStats stats_;
+  static std::atomic<uint64_t> total_hits_;
+  static std::atomic<uint64_t> total_misses_;
+  static std::atomic<int64_t> total_pooled_buffers_;
+};
+}
+}
+#endif  // OWT_BASE_FRAMEBUFFERPOOL_H_
@@ -0,0 +1,89 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/framebufferpool.h"
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+
+TEST(FrameBufferPoolTest, ReusesReleasedBuffer) {
+  FrameBufferPool pool(2, 1, true);
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer = pool.CreateBuffer(64, 48);
+  const uint8_t* data = buffer->DataY();
+  buffer = nullptr;
+  buffer = pool.CreateBuffer(64, 48);
+  EXPECT_EQ(data, buffer->DataY());
+  FrameBufferPoolStats stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1, stats.pooled_buffers);
+}
+
+TEST(FrameBufferPoolTest, DoesNotReuseBufferInUse) {
+  FrameBufferPool pool(2, 1, true);
+  rtc::scoped_refptr<webrtc::I420Buffer> first = pool.CreateBuffer(64, 48);
+  rtc::scoped_refptr<webrtc::I420Buffer> second = pool.CreateBuffer(64, 48);
+  EXPECT_NE(first->DataY(), second->DataY());
+  // The pool is full, so the third buffer is not kept.
+  rtc::scoped_refptr<webrtc::I420Buffer> third = pool.CreateBuffer(64, 48);
+  EXPECT_NE(first->DataY(), third->DataY());
+  EXPECT_NE(second->DataY(), third->DataY());
+  FrameBufferPoolStats stats = pool.GetStats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(2, stats.pooled_buffers);
+  // Unpooled buffers are freed once released.
+  third = nullptr;
+  third = pool.CreateBuffer(64, 48);
+  EXPECT_EQ(4u, pool.GetStats().misses);
+}
+
+TEST(FrameBufferPoolTest, KeepsRecentlyUsedResolutions) {
+  FrameBufferPool pool(1, 2, true);
+  const uint8_t* vga = pool.CreateBuffer(640, 480)->DataY();
+  pool.CreateBuffer(320, 240);
+  // Switching back to a pooled resolution does not allocate.
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer = pool.CreateBuffer(640, 480);
+  EXPECT_EQ(vga, buffer->DataY());
+  EXPECT_EQ(640, buffer->width());
+  EXPECT_EQ(480, buffer->height());
+  EXPECT_EQ(640, buffer->StrideY());
+  EXPECT_EQ(320, buffer->StrideU());
+  buffer = nullptr;
+  // 320x240 is least recently used and evicted by a third resolution.
+  pool.CreateBuffer(1280, 720);
+  EXPECT_EQ(2, pool.GetStats().pooled_buffers);
+  pool.CreateBuffer(320, 240);
+  FrameBufferPoolStats stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(4u, stats.misses);
+}
+
+TEST(FrameBufferPoolTest, AddsToTotalStats) {
+  FrameBufferPoolStats before = FrameBufferPool::GetTotalStats();
+  {
+    FrameBufferPool pool(2, 1, true);
+    pool.CreateBuffer(64, 48);
+    pool.CreateBuffer(64, 48);
+    FrameBufferPoolStats total = FrameBufferPool::GetTotalStats();
+    EXPECT_EQ(before.hits + 1, total.hits);
+    EXPECT_EQ(before.misses + 1, total.misses);
+    EXPECT_EQ(before.pooled_buffers + 1, total.pooled_buffers);
+  }
+  EXPECT_EQ(before.pooled_buffers,
+            FrameBufferPool::GetTotalStats().pooled_buffers);
+}
+
+TEST(FrameBufferPoolTest, KeepsOutOfTotalStats) {
+  FrameBufferPoolStats before = FrameBufferPool::GetTotalStats();
+  FrameBufferPool pool(2, 1, false);
+  pool.CreateBuffer(64, 48);
+  pool.CreateBuffer(64, 48);
+  EXPECT_EQ(1u, pool.GetStats().hits);
+  FrameBufferPoolStats total = FrameBufferPool::GetTotalStats();
+  EXPECT_EQ(before.hits, total.hits);
+  EXPECT_EQ(before.misses, total.misses);
+  EXPECT_EQ(before.pooled_buffers, total.pooled_buffers);
+}
+}
+}
@@ -0,0 +1,79 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/framepacer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+// Event timeouts are in milliseconds and may wake late, so the last part of a
+// wait sleeps for a precise duration instead, without checking for stop.
+const int64_t kSleepUs = 2000;
+}
+
+FramePacer::FramePacer(int fps, FramePacingLatePolicy late_policy)
+    : FramePacer(fps, 1, late_policy) {}
+
+FramePacer::FramePacer(int fps_numerator,
+                       int fps_denominator,
+                       FramePacingLatePolicy late_policy)
+    : fps_numerator_(std::max(fps_numerator, 1)),
+      fps_denominator_(std::max(fps_denominator, 1)),
+      late_policy_(late_policy),
+      start_us_(0),
+      frame_index_(0),
+      skipped_frames_(0) {}
+
+void FramePacer::Start(int64_t now_us) {
+  start_us_ = now_us;
+  frame_index_ = 0;
+}
+
+int64_t FramePacer::OnFrameProduced(int64_t now_us) {
+  frame_index_++;
+  if (now_us <= DeadlineOf(frame_index_))
+    return DeadlineOf(frame_index_);
+  // Index of the latest frame which is due.
+  int64_t due_index = (now_us - start_us_) * fps_numerator_ /
+                      (rtc::kNumMicrosecsPerSec * fps_denominator_);
+  int64_t late_frames = due_index - frame_index_;
+  // More than a second behind.
+  if (late_policy_ == FramePacingLatePolicy::kSkip ||
+      late_frames * fps_denominator_ > fps_numerator_) {
+    skipped_frames_ += late_frames;
+    frame_index_ = due_index;
+  }
+  return DeadlineOf(frame_index_);
+}
+
+int64_t FramePacer::DeadlineOf(int64_t frame_index) const {
+  return start_us_ + frame_index * rtc::kNumMicrosecsPerSec * fps_denominator_ /
+                        fps_numerator_;
+}
+
+bool FramePacer::WaitUntil(int64_t deadline_us,
+                           int64_t spin_us,
+                           rtc::Event* stop) {
+  spin_us = std::max<int64_t>(spin_us, 0);
+  int64_t remaining_us = deadline_us - rtc::TimeMicros();
+  while (remaining_us > kSleepUs + spin_us) {
+    int64_t wait_ms = (remaining_us - kSleepUs - spin_us +
+                       rtc::kNumMicrosecsPerMillisec - 1) /
+                      rtc::kNumMicrosecsPerMillisec;
+    if (stop->Wait(static_cast<int>(wait_ms)))
+      return false;
+    remaining_us = deadline_us - rtc::TimeMicros();
+  }
+  if (remaining_us > spin_us) {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(remaining_us - spin_us));
+  }
+  while (rtc::TimeMicros() < deadline_us)
+    std::this_thread::yield();
+  return true;
+}
+}
+}
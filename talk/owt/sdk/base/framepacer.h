@@ -0,0 +1,50 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_FRAMEPACER_H_
+#define OWT_BASE_FRAMEPACER_H_
+#include <stdint.h>
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/rtc_base/event.h"
+namespace owt {
+namespace base {
+// Schedules frames at a rate of |fps_numerator| / |fps_denominator| on
+// absolute deadlines, so the time spent on a frame and rounding of the interval
+// do not accumulate. Deadline of frame n is start + n / rate, in microseconds.
+// Not thread safe.
+class FramePacer {
+ public:
+  FramePacer(int fps, FramePacingLatePolicy late_policy);
+  // Fractional rates, e.g. 30000 / 1001 for 29.97 fps.
+  FramePacer(int fps_numerator,
+             int fps_denominator,
+             FramePacingLatePolicy late_policy);
+  // Start the schedule, the first frame is due at |now_us|.
+  void Start(int64_t now_us);
+  // Called once the frame due at deadline_us() is produced. Returns the
+  // deadline of next frame, which is not later than |now_us| if it is late.
+  int64_t OnFrameProduced(int64_t now_us);
+  int64_t deadline_us() const { return DeadlineOf(frame_index_); }
+  // Frames dropped because they were too late.
+  uint64_t skipped_frames() const { return skipped_frames_; }
+
+  // Wait until |deadline_us| of rtc::TimeMicros(), or until |stop| is set.
+  // Sleeps until |spin_us| before the deadline, and yields for the rest.
+  // Returns false if |stop| is set.
+  static bool WaitUntil(int64_t deadline_us,
+                        int64_t spin_us,
+                        rtc::Event* stop);
+
+ private:
+  int64_t DeadlineOf(int64_t frame_index) const;
+
+  const int64_t fps_numerator_;
+  const int64_t fps_denominator_;
+  const FramePacingLatePolicy late_policy_;
+  int64_t start_us_;
+  int64_t frame_index_;
+  uint64_t skipped_frames_;
+};
+}
+}
+#endif  // OWT_BASE_FRAMEPACER_H_
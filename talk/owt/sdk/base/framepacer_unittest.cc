@@ -0,0 +1,126 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/framepacer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+TEST(FramePacerTest, DeadlinesDoNotAccumulateRounding) {
+  FramePacer pacer(30, FramePacingLatePolicy::kSkip);
+  pacer.Start(1000000);
+  int64_t deadline = 0;
+  // Producing each frame right at its deadline.
+  for (int i = 0; i < 30; i++)
+    deadline = pacer.OnFrameProduced(pacer.deadline_us());
+  // 30 frames later is exactly one second, not 30 * 33 ms.
+  EXPECT_EQ(2000000, deadline);
+  EXPECT_EQ(0u, pacer.skipped_frames());
+}
+
+TEST(FramePacerTest, FractionalRateDeadlines) {
+  FramePacer pacer(30000, 1001, FramePacingLatePolicy::kSkip);
+  pacer.Start(0);
+  int64_t deadline = 0;
+  for (int i = 0; i < 30000; i++)
+    deadline = pacer.OnFrameProduced(pacer.deadline_us());
+  // 30000 frames at 29.97 fps take 1001 seconds.
+  EXPECT_EQ(1001000000, deadline);
+  EXPECT_EQ(33366, FramePacer(30000, 1001, FramePacingLatePolicy::kSkip)
+                       .OnFrameProduced(0));
+}
+
+TEST(FramePacerTest, TimeSpentOnFrameDoesNotDelayNext) {
+  FramePacer pacer(60, FramePacingLatePolicy::kSkip);
+  pacer.Start(0);
+  // Reading the first frame takes 10 ms.
+  EXPECT_EQ(16666, pacer.OnFrameProduced(10000));
+}
+
+TEST(FramePacerTest, SkipPolicyDropsMissedFrames) {
+  FramePacer pacer(100, FramePacingLatePolicy::kSkip);
+  pacer.Start(0);
+  // First frame took 35 ms, frames due at 10 and 20 ms are skipped. The one
+  // due at 30 ms is read right away.
+  EXPECT_EQ(30000, pacer.OnFrameProduced(35000));
+  EXPECT_EQ(2u, pacer.skipped_frames());
+  // Schedule is kept afterwards.
+  EXPECT_EQ(40000, pacer.OnFrameProduced(36000));
+}
+
+TEST(FramePacerTest, CatchUpPolicyReadsMissedFrames) {
+  FramePacer pacer(100, FramePacingLatePolicy::kCatchUp);
+  pacer.Start(0);
+  EXPECT_EQ(10000, pacer.OnFrameProduced(35000));
+  EXPECT_EQ(20000, pacer.OnFrameProduced(35100));
+  EXPECT_EQ(30000, pacer.OnFrameProduced(35200));
+  EXPECT_EQ(40000, pacer.OnFrameProduced(35300));
+  EXPECT_EQ(0u, pacer.skipped_frames());
+}
+
+TEST(FramePacerTest, CatchUpPolicyDropsFramesMoreThanSecondBehind) {
+  FramePacer pacer(10, FramePacingLatePolicy::kCatchUp);
+  pacer.Start(0);
+  // Stalled for 5 seconds.
+  EXPECT_EQ(5000000, pacer.OnFrameProduced(5000000));
+  EXPECT_EQ(49u, pacer.skipped_frames());
+}
+
+TEST(FramePacerTest, WaitUntilStops) {
+  rtc::Event stop;
+  int64_t start_us = rtc::TimeMicros();
+  EXPECT_TRUE(FramePacer::WaitUntil(start_us + 5000, 200, &stop));
+  EXPECT_GE(rtc::TimeMicros(), start_us + 5000);
+  // Without a spin window the deadline is still not missed.
+  start_us = rtc::TimeMicros();
+  EXPECT_TRUE(FramePacer::WaitUntil(start_us + 5000, 0, &stop));
+  EXPECT_GE(rtc::TimeMicros(), start_us + 5000);
+  stop.Set();
+  EXPECT_FALSE(
+      FramePacer::WaitUntil(rtc::TimeMicros() + 10000000, 200, &stop));
+}
+
+// Measures inter-frame interval jitter of the pacing loop, as run by
+// CustomizedFramesCapturer, with a frame taking a third of its interval.
+TEST(FramePacerTest, DISABLED_BenchmarkInterFrameJitter) {
+  const int kFrames = 240;
+  for (int fps : {30, 60, 120}) {
+    FramePacer pacer(fps, FramePacingLatePolicy::kSkip);
+    rtc::Event stop;
+    std::vector<int64_t> frame_times_us;
+    pacer.Start(rtc::TimeMicros());
+    while (frame_times_us.size() < kFrames) {
+      frame_times_us.push_back(rtc::TimeMicros());
+      int64_t busy_until_us =
+          frame_times_us.back() + rtc::kNumMicrosecsPerSec / fps / 3;
+      while (rtc::TimeMicros() < busy_until_us) {
+      }
+      FramePacer::WaitUntil(pacer.OnFrameProduced(rtc::TimeMicros()),
+                            FramePacingConfiguration().spin_us, &stop);
+    }
+    double interval_us = static_cast<double>(rtc::kNumMicrosecsPerSec) / fps;
+    double sum_squares = 0;
+    double max_deviation_us = 0;
+    for (size_t i = 1; i < frame_times_us.size(); i++) {
+      double deviation =
+          (frame_times_us[i] - frame_times_us[i - 1]) - interval_us;
+      sum_squares += deviation * deviation;
+      max_deviation_us = std::max(max_deviation_us, std::abs(deviation));
+    }
+    double duration_s = (frame_times_us.back() - frame_times_us.front()) /
+                        static_cast<double>(rtc::kNumMicrosecsPerSec);
+    std::cout << fps << " fps: measured "
+              << (frame_times_us.size() - 1) / duration_s
+              << " fps, interval jitter "
+              << std::sqrt(sum_squares / (frame_times_us.size() - 1))
+              << " us rms, " << max_deviation_us << " us max, "
+              << pacer.skipped_frames() << " skipped." << std::endl;
+    EXPECT_NEAR(fps, (frame_times_us.size() - 1) / duration_s, fps * 0.02);
+  }
+}
+}
+}
@@ -365,9 +365,10 @@ void FunctionalNativeStatsObserver::OnComplete(
 rtc::scoped_refptr<FunctionalStandardRTCStatsCollectorCallback>
 FunctionalStandardRTCStatsCollectorCallback::Create(
     std::function<void(std::shared_ptr<owt::base::RTCStatsReport>)>
-        on_stats_delivered) {
+        on_stats_delivered,
+    uint32_t type_mask) {
   return new rtc::RefCountedObject<FunctionalStandardRTCStatsCollectorCallback>(
-      std::move(on_stats_delivered));
+      std::move(on_stats_delivered), type_mask);
 }
 
 void FunctionalStandardRTCStatsCollectorCallback::OnStatsDelivered(
@@ -381,6 +382,11 @@ void FunctionalStandardRTCStatsCollectorCallback::OnStatsDelivered(
   // Create the owt version of RTCStatsReport and send to the
   // owt_stats_delivered_ callback.
   for (const auto& stats : *report) {
+    // Filtered stats are skipped before any member is converted.
+    if (type_mask_ != RTCStatsTypeMask::kAll &&
+        (RTCStatsTypeMask::FromType(stats.type()) & type_mask_) == 0) {
+      continue;
+    }
     if (strcmp(stats.type(), RTCStatsType::kDataChannel) == 0) {
       auto& webrtc_stats = stats.cast_to<webrtc::RTCDataChannelStats>();
       std::unique_ptr<owt::base::RTCDataChannelStats> stat =
@@ -697,11 +703,128 @@ void FunctionalStandardRTCStatsCollectorCallback::OnStatsDelivered(
                   ? webrtc_stats.encoder_implementation.ValueToString()
                   : "");
       reports->AddStats(std::move(stat));
+    } else if (strcmp(stats.type(), RTCStatsType::kRemoteInboundRTP) == 0) {
+      auto& webrtc_stats =
+          stats.cast_to<webrtc::RTCRemoteInboundRtpStreamStats>();
+      std::unique_ptr<owt::base::RTCRemoteInboundRtpStreamStats> stat =
+          std::make_unique<owt::base::RTCRemoteInboundRtpStreamStats>(
+              webrtc_stats.id(), webrtc_stats.timestamp_us(),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, ssrc, uint32_t, 0),
+              webrtc_stats.kind.is_defined() ? webrtc_stats.kind.ValueToString()
+                                             : "",
+              webrtc_stats.transport_id.is_defined()
+                  ? webrtc_stats.transport_id.ValueToString()
+                  : "",
+              webrtc_stats.codec_id.is_defined()
+                  ? webrtc_stats.codec_id.ValueToString()
+                  : "",
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, packets_lost, int32_t,
+                                         0),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, jitter, double, -1),
+              webrtc_stats.local_id.is_defined()
+                  ? webrtc_stats.local_id.ValueToString()
+                  : "",
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, round_trip_time, double,
+                                         -1));
+      reports->AddStats(std::move(stat));
+    } else if (strcmp(stats.type(), RTCStatsType::kTransport) == 0) {
+      auto& webrtc_stats = stats.cast_to<webrtc::RTCTransportStats>();
+      std::unique_ptr<owt::base::RTCTransportStats> stat =
+          std::make_unique<owt::base::RTCTransportStats>(
+              webrtc_stats.id(), webrtc_stats.timestamp_us(),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, bytes_sent, uint64_t, 0),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, bytes_received, uint64_t,
+                                         0),
+              webrtc_stats.rtcp_transport_stats_id.is_defined()
+                  ? webrtc_stats.rtcp_transport_stats_id.ValueToString()
+                  : "",
+              webrtc_stats.dtls_state.is_defined()
+                  ? webrtc_stats.dtls_state.ValueToString()
+                  : "",
+              webrtc_stats.selected_candidate_pair_id.is_defined()
+                  ? webrtc_stats.selected_candidate_pair_id.ValueToString()
+                  : "",
+              webrtc_stats.local_certificate_id.is_defined()
+                  ? webrtc_stats.local_certificate_id.ValueToString()
+                  : "",
+              webrtc_stats.remote_certificate_id.is_defined()
+                  ? webrtc_stats.remote_certificate_id.ValueToString()
+                  : "",
+              webrtc_stats.tls_version.is_defined()
+                  ? webrtc_stats.tls_version.ValueToString()
+                  : "",
+              webrtc_stats.dtls_cipher.is_defined()
+                  ? webrtc_stats.dtls_cipher.ValueToString()
+                  : "",
+              webrtc_stats.srtp_cipher.is_defined()
+                  ? webrtc_stats.srtp_cipher.ValueToString()
+                  : "",
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats,
+                                         selected_candidate_pair_changes,
+                                         uint32_t, 0));
+      reports->AddStats(std::move(stat));
+    } else if (strcmp(stats.type(), RTCStatsType::kLocalCandidate) == 0 ||
+               strcmp(stats.type(), RTCStatsType::kRemoteCandidate) == 0) {
+      auto& webrtc_stats = stats.cast_to<webrtc::RTCIceCandidateStats>();
+      std::string transport_id = webrtc_stats.transport_id.is_defined()
+                                     ? webrtc_stats.transport_id.ValueToString()
+                                     : "";
+      std::string network_type = webrtc_stats.network_type.is_defined()
+                                     ? webrtc_stats.network_type.ValueToString()
+                                     : "";
+      std::string ip =
+          webrtc_stats.ip.is_defined() ? webrtc_stats.ip.ValueToString() : "";
+      std::string protocol = webrtc_stats.protocol.is_defined()
+                                 ? webrtc_stats.protocol.ValueToString()
+                                 : "";
+      std::string relay_protocol =
+          webrtc_stats.relay_protocol.is_defined()
+              ? webrtc_stats.relay_protocol.ValueToString()
+              : "";
+      std::string candidate_type =
+          webrtc_stats.candidate_type.is_defined()
+              ? webrtc_stats.candidate_type.ValueToString()
+              : "";
+      std::string url =
+          webrtc_stats.url.is_defined() ? webrtc_stats.url.ValueToString() : "";
+      int32_t port = OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, port, int32_t, 0);
+      int32_t priority =
+          OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, priority, int32_t, 0);
+      bool deleted =
+          OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, deleted, bool, false);
+      if (strcmp(stats.type(), RTCStatsType::kLocalCandidate) == 0) {
+        reports->AddStats(std::make_unique<owt::base::RTCLocalIceCandidateStats>(
+            webrtc_stats.id(), webrtc_stats.timestamp_us(), transport_id,
+            false, network_type, ip, port, protocol, relay_protocol,
+            candidate_type, priority, url, deleted));
+      } else {
+        reports->AddStats(
+            std::make_unique<owt::base::RTCRemoteIceCandidateStats>(
+                webrtc_stats.id(), webrtc_stats.timestamp_us(), transport_id,
+                true, network_type, ip, port, protocol, relay_protocol,
+                candidate_type, priority, url, deleted));
+      }
+    } else if (strcmp(stats.type(), RTCStatsType::kCodec) == 0) {
+      auto& webrtc_stats = stats.cast_to<webrtc::RTCCodecStats>();
+      std::unique_ptr<owt::base::RTCCodecStats> stat =
+          std::make_unique<owt::base::RTCCodecStats>(
+              webrtc_stats.id(), webrtc_stats.timestamp_us(),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, payload_type, uint32_t,
+                                         0),
+              webrtc_stats.mime_type.is_defined()
+                  ? webrtc_stats.mime_type.ValueToString()
+                  : "",
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, clock_rate, uint32_t, 0),
+              OWT_STATS_VALUE_OR_DEFAULT(webrtc_stats, channels, uint32_t, 0),
+              webrtc_stats.sdp_fmtp_line.is_defined()
+                  ? webrtc_stats.sdp_fmtp_line.ValueToString()
+                  : "");
+      reports->AddStats(std::move(stat));
     }
   }
-  if (reports->size() > 0) {
-    on_stats_delivered_(reports);
-  }
+  // An empty report is delivered too, e.g. when a selector matches no
+  // stream, so callers are always answered.
+  on_stats_delivered_(reports);
 }
 
 } // namespace base
@@ -26,9 +26,12 @@ namespace base {
 class FunctionalStandardRTCStatsCollectorCallback
     : public webrtc::RTCStatsCollectorCallback {
  public:
+  // Only stats of types in |type_mask|, a combination of RTCStatsTypeMask, are
+  // converted and delivered.
   static rtc::scoped_refptr<FunctionalStandardRTCStatsCollectorCallback> Create(
       std::function<void(std::shared_ptr<owt::base::RTCStatsReport>)>
-          on_stats_delivered);
+          on_stats_delivered,
+      uint32_t type_mask = RTCStatsTypeMask::kAll);
 
   void OnStatsDelivered(
       const rtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override;
@@ -36,12 +39,14 @@ class FunctionalStandardRTCStatsCollectorCallback
  protected:
   FunctionalStandardRTCStatsCollectorCallback(
       std::function<void(std::shared_ptr<owt::base::RTCStatsReport>)>
-          on_stats_delivered)
-      : on_stats_delivered_(on_stats_delivered) {}
+          on_stats_delivered,
+      uint32_t type_mask)
+      : on_stats_delivered_(on_stats_delivered), type_mask_(type_mask) {}
 
  private:
   std::function<void(std::shared_ptr<owt::base::RTCStatsReport>)>
       on_stats_delivered_;
+  uint32_t type_mask_;
 };
 
 // A webrtc::CreateSessionDescriptionObserver implementation used to invoke user
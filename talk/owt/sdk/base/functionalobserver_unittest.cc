@@ -0,0 +1,154 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/functionalobserver.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/api/stats/rtcstats_objects.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const int kBenchmarkIterations = 1000;
+
+// A report of a connection with |candidates| local and remote candidates, a
+// pair for each of them, and |streams| inbound and outbound video streams.
+rtc::scoped_refptr<webrtc::RTCStatsReport> CreateReport(int candidates,
+                                                        int streams) {
+  rtc::scoped_refptr<webrtc::RTCStatsReport> report =
+      webrtc::RTCStatsReport::Create(0);
+  report->AddStats(std::make_unique<webrtc::RTCCertificateStats>("cert", 0));
+  auto transport = std::make_unique<webrtc::RTCTransportStats>("transport", 0);
+  transport->selected_candidate_pair_id = "pair-0";
+  report->AddStats(std::move(transport));
+  for (int i = 0; i < candidates; i++) {
+    std::string index = std::to_string(i);
+    auto local = std::make_unique<webrtc::RTCLocalIceCandidateStats>(
+        "local-" + index, 0);
+    local->transport_id = "transport";
+    local->ip = "192.168.1." + index;
+    local->port = 50000 + i;
+    local->candidate_type = "host";
+    report->AddStats(std::move(local));
+    auto remote = std::make_unique<webrtc::RTCRemoteIceCandidateStats>(
+        "remote-" + index, 0);
+    remote->transport_id = "transport";
+    remote->ip = "10.0.0." + index;
+    remote->port = 40000 + i;
+    remote->candidate_type = "srflx";
+    report->AddStats(std::move(remote));
+    auto pair =
+        std::make_unique<webrtc::RTCIceCandidatePairStats>("pair-" + index, 0);
+    pair->transport_id = "transport";
+    pair->local_candidate_id = "local-" + index;
+    pair->remote_candidate_id = "remote-" + index;
+    pair->state = "succeeded";
+    pair->current_round_trip_time = 0.05;
+    report->AddStats(std::move(pair));
+  }
+  report->AddStats(std::make_unique<webrtc::RTCCodecStats>("codec", 0));
+  for (int i = 0; i < streams; i++) {
+    std::string index = std::to_string(i);
+    auto track = std::make_unique<webrtc::RTCMediaStreamTrackStats>(
+        "track-" + index, 0, webrtc::RTCMediaStreamTrackKind::kVideo);
+    track->frame_width = 1280;
+    track->frame_height = 720;
+    report->AddStats(std::move(track));
+    auto inbound =
+        std::make_unique<webrtc::RTCInboundRTPStreamStats>("in-" + index, 0);
+    inbound->ssrc = 1000 + i;
+    inbound->kind = "video";
+    inbound->track_id = "track-" + index;
+    inbound->bytes_received = 100000;
+    inbound->frames_decoded = 300;
+    report->AddStats(std::move(inbound));
+    auto outbound =
+        std::make_unique<webrtc::RTCOutboundRTPStreamStats>("out-" + index, 0);
+    outbound->ssrc = 2000 + i;
+    outbound->kind = "video";
+    outbound->bytes_sent = 100000;
+    report->AddStats(std::move(outbound));
+  }
+  return report;
+}
+
+// Converts |report| with |type_mask|, returns the number of stats delivered.
+size_t Convert(const rtc::scoped_refptr<webrtc::RTCStatsReport>& report,
+               uint32_t type_mask) {
+  size_t size = 0;
+  rtc::scoped_refptr<FunctionalStandardRTCStatsCollectorCallback> callback =
+      FunctionalStandardRTCStatsCollectorCallback::Create(
+          [&size](std::shared_ptr<RTCStatsReport> converted) {
+            size = converted->size();
+          },
+          type_mask);
+  callback->OnStatsDelivered(report);
+  return size;
+}
+}  // namespace
+
+TEST(FunctionalStatsCollectorCallbackTest, MasksOfTypes) {
+  EXPECT_EQ(RTCStatsTypeMask::kInboundRTP,
+            RTCStatsTypeMask::FromType(RTCStatsType::kInboundRTP));
+  EXPECT_EQ(RTCStatsTypeMask::kCandidatePair,
+            RTCStatsTypeMask::FromType(RTCStatsType::kCandidatePair));
+  EXPECT_EQ(0u, RTCStatsTypeMask::FromType(RTCStatsType::kCertificate));
+}
+
+TEST(FunctionalStatsCollectorCallbackTest, ConvertsAllTypesByDefault) {
+  // Certificates are not converted.
+  EXPECT_EQ(1u + 3 * 2 + 1 + 3 * 1,
+            Convert(CreateReport(2, 1), RTCStatsTypeMask::kAll));
+}
+
+TEST(FunctionalStatsCollectorCallbackTest, DeliversOnlyMaskedTypes) {
+  size_t inbound = 0;
+  size_t pairs = 0;
+  rtc::scoped_refptr<FunctionalStandardRTCStatsCollectorCallback> callback =
+      FunctionalStandardRTCStatsCollectorCallback::Create(
+          [&inbound, &pairs](std::shared_ptr<RTCStatsReport> converted) {
+            for (const RTCStats& stats : *converted) {
+              if (stats.type == RTCStatsType::kInboundRTP)
+                inbound++;
+              else if (stats.type == RTCStatsType::kCandidatePair)
+                pairs++;
+              else
+                ADD_FAILURE() << "Unexpected stats " << stats.type;
+            }
+          },
+          RTCStatsTypeMask::kInboundRTP | RTCStatsTypeMask::kCandidatePair);
+  callback->OnStatsDelivered(CreateReport(4, 2));
+  EXPECT_EQ(2u, inbound);
+  EXPECT_EQ(4u, pairs);
+}
+
+TEST(FunctionalStatsCollectorCallbackTest,
+     DISABLED_BenchmarkFilteredConversionsPerSecond) {
+  rtc::scoped_refptr<webrtc::RTCStatsReport> report = CreateReport(20, 4);
+  size_t delivered = 0;
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kBenchmarkIterations; i++)
+    delivered += Convert(report, RTCStatsTypeMask::kAll);
+  int64_t full_us = rtc::TimeMicros() - start_us;
+
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kBenchmarkIterations; i++) {
+    delivered += Convert(report, RTCStatsTypeMask::kInboundRTP |
+                                     RTCStatsTypeMask::kCandidatePair);
+  }
+  int64_t filtered_us = rtc::TimeMicros() - start_us;
+
+  EXPECT_GT(delivered, 0u);
+  std::cout << "All types: "
+            << kBenchmarkIterations * 1000000LL / std::max<int64_t>(full_us, 1)
+            << " conversions/s, inbound-rtp and candidate-pair: "
+            << kBenchmarkIterations * 1000000LL /
+                   std::max<int64_t>(filtered_us, 1)
+            << " conversions/s." << std::endl;
+  EXPECT_LT(filtered_us, full_us);
+}
+}
+}
@@ -8,6 +8,9 @@ namespace base {
 // Enable hardware acceleration by default is on.
 bool GlobalConfiguration::hardware_acceleration_enabled_ = true;
 #endif
+#if defined(WEBRTC_LINUX)
+bool GlobalConfiguration::batched_udp_socket_enabled_ = false;
+#endif
 bool GlobalConfiguration::encoded_frame_ = false;
 std::unique_ptr<AudioFrameGeneratorInterface>
     GlobalConfiguration::audio_frame_generator_ = nullptr;
@@ -26,6 +29,21 @@ IcePortRanges GlobalConfiguration::ice_port_ranges_ = {
     {0, 0},
     {0, 0},
     {0, 0}};
+int GlobalConfiguration::factory_shards_ = 1;
+FactoryShardPolicy GlobalConfiguration::factory_shard_policy_ =
+    FactoryShardPolicy::kRoundRobin;
+ThreadModelConfiguration GlobalConfiguration::thread_model_configuration_;
+CertificateCacheConfiguration
+    GlobalConfiguration::certificate_cache_configuration_;
+ObserverEventDispatchMode GlobalConfiguration::observer_event_dispatch_mode_ =
+    ObserverEventDispatchMode::kDirect;
+StatsAggregatorConfiguration
+    GlobalConfiguration::stats_aggregator_configuration_;
+ThreadLagMonitorConfiguration
+    GlobalConfiguration::thread_lag_monitor_configuration_;
+FramePacingConfiguration GlobalConfiguration::frame_pacing_configuration_;
+bool GlobalConfiguration::udp_mux_enabled_ = false;
+uint16_t GlobalConfiguration::udp_mux_port_ = 0;
 bool GlobalConfiguration::pre_decode_dump_enabled_ = false;
 bool GlobalConfiguration::post_encode_dump_enabled_ = false;
 bool GlobalConfiguration::video_super_resolution_enabled_ = false;
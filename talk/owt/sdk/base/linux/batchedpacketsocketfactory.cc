@@ -0,0 +1,300 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/linux/batchedpacketsocketfactory.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+// Read at most this number of batches for one read event, so a busy socket
+// does not starve other sockets on the network thread.
+const int kMaxBatchesPerEvent = 4;
+}  // namespace
+
+BatchedAsyncUdpSocket* BatchedAsyncUdpSocket::Create(
+    rtc::Thread* thread,
+    const rtc::SocketAddress& bind_address,
+    uint16_t min_port,
+    uint16_t max_port,
+    std::shared_ptr<UdpBatchReceiver> receiver) {
+  int fd = socket(bind_address.family(), SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  if (fd < 0) {
+    RTC_LOG(LS_ERROR) << "Failed to create UDP socket, errno " << errno;
+    return nullptr;
+  }
+  rtc::SocketAddress address(bind_address);
+  bool bound = false;
+  if (min_port == 0 && max_port == 0) {
+    sockaddr_storage storage;
+    size_t length = address.ToSockAddrStorage(&storage);
+    bound = bind(fd, reinterpret_cast<sockaddr*>(&storage),
+                 static_cast<socklen_t>(length)) == 0;
+  } else {
+    for (uint32_t port = min_port; !bound && port <= max_port; port++) {
+      address.SetPort(port);
+      sockaddr_storage storage;
+      size_t length = address.ToSockAddrStorage(&storage);
+      bound = bind(fd, reinterpret_cast<sockaddr*>(&storage),
+                   static_cast<socklen_t>(length)) == 0;
+    }
+  }
+  if (!bound) {
+    RTC_LOG(LS_WARNING) << "Failed to bind UDP socket to "
+                        << bind_address.ToSensitiveString() << ", errno "
+                        << errno;
+    close(fd);
+    return nullptr;
+  }
+  sockaddr_storage storage;
+  socklen_t length = sizeof(storage);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&storage), &length);
+  rtc::SocketAddress local_address;
+  rtc::SocketAddressFromSockAddrStorage(storage, &local_address);
+  return new BatchedAsyncUdpSocket(thread, fd, local_address,
+                                   std::move(receiver));
+}
+
+BatchedAsyncUdpSocket::BatchedAsyncUdpSocket(
+    rtc::Thread* thread,
+    int fd,
+    const rtc::SocketAddress& local_address,
+    std::shared_ptr<UdpBatchReceiver> receiver)
+    : thread_(thread),
+      socket_server_(
+          static_cast<rtc::PhysicalSocketServer*>(thread->socketserver())),
+      fd_(fd),
+      local_address_(local_address),
+      error_(0),
+      receiver_(std::move(receiver)),
+      sender_(UdpBatchSender::IsGsoSupported(fd)),
+      flush_scheduled_(false) {
+  socket_server_->Add(this);
+}
+
+BatchedAsyncUdpSocket::~BatchedAsyncUdpSocket() {
+  Close();
+}
+
+rtc::SocketAddress BatchedAsyncUdpSocket::GetLocalAddress() const {
+  return local_address_;
+}
+
+rtc::SocketAddress BatchedAsyncUdpSocket::GetRemoteAddress() const {
+  return rtc::SocketAddress();
+}
+
+int BatchedAsyncUdpSocket::Send(const void* pv,
+                                size_t cb,
+                                const rtc::PacketOptions& options) {
+  // UDP sockets created by the factory are never connected.
+  error_ = ENOTCONN;
+  return -1;
+}
+
+int BatchedAsyncUdpSocket::SendTo(const void* pv,
+                                  size_t cb,
+                                  const rtc::SocketAddress& addr,
+                                  const rtc::PacketOptions& options) {
+  if (fd_ < 0) {
+    error_ = EBADF;
+    return -1;
+  }
+  sockaddr_storage storage;
+  size_t length = local_address_.family() == AF_INET6
+                      ? addr.ToDualStackSockAddrStorage(&storage)
+                      : addr.ToSockAddrStorage(&storage);
+  if (length == 0) {
+    error_ = EINVAL;
+    return -1;
+  }
+  sender_.Queue(pv, cb, storage, static_cast<socklen_t>(length));
+  rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis(),
+                              options.info_signaled_after_sent);
+  CopySocketInformationToPacketInfo(cb, *this, true, &sent_packet.info);
+  pending_sent_packets_.push_back(sent_packet);
+  if (sender_.full()) {
+    FlushPackets();
+  } else if (!flush_scheduled_) {
+    // Packets sent by tasks already queued on this thread join the batch.
+    flush_scheduled_ = true;
+    thread_->PostTask(
+        webrtc::ToQueuedTask(task_safety_.flag(), [this] { FlushPackets(); }));
+  }
+  return static_cast<int>(cb);
+}
+
+int BatchedAsyncUdpSocket::Close() {
+  if (fd_ < 0)
+    return 0;
+  FlushPackets();
+  socket_server_->Remove(this);
+  int result = close(fd_);
+  fd_ = -1;
+  return result;
+}
+
+rtc::AsyncPacketSocket::State BatchedAsyncUdpSocket::GetState() const {
+  return fd_ < 0 ? STATE_CLOSED : STATE_BOUND;
+}
+
+bool BatchedAsyncUdpSocket::TranslateOption(rtc::Socket::Option opt,
+                                            int* level,
+                                            int* name,
+                                            int* value) {
+  bool ipv6 = local_address_.family() == AF_INET6;
+  switch (opt) {
+    case rtc::Socket::OPT_RCVBUF:
+      *level = SOL_SOCKET;
+      *name = SO_RCVBUF;
+      return true;
+    case rtc::Socket::OPT_SNDBUF:
+      *level = SOL_SOCKET;
+      *name = SO_SNDBUF;
+      return true;
+    case rtc::Socket::OPT_DONTFRAGMENT:
+      *level = ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+      *name = ipv6 ? IPV6_MTU_DISCOVER : IP_MTU_DISCOVER;
+      if (value)
+        *value = *value ? IP_PMTUDISC_DO : IP_PMTUDISC_DONT;
+      return true;
+    case rtc::Socket::OPT_DSCP:
+      *level = ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+      *name = ipv6 ? IPV6_TCLASS : IP_TOS;
+      // DSCP is the upper 6 bits of TOS/traffic class.
+      if (value)
+        *value <<= 2;
+      return true;
+    default:
+      return false;
+  }
+}
+
+int BatchedAsyncUdpSocket::GetOption(rtc::Socket::Option opt, int* value) {
+  int level, name;
+  if (!TranslateOption(opt, &level, &name, nullptr)) {
+    error_ = ENOTSUP;
+    return -1;
+  }
+  socklen_t length = sizeof(*value);
+  int result = getsockopt(fd_, level, name, value, &length);
+  if (result != 0) {
+    error_ = errno;
+    return result;
+  }
+  if (opt == rtc::Socket::OPT_DONTFRAGMENT)
+    *value = (*value != IP_PMTUDISC_DONT) ? 1 : 0;
+  else if (opt == rtc::Socket::OPT_DSCP)
+    *value >>= 2;
+  return 0;
+}
+
+int BatchedAsyncUdpSocket::SetOption(rtc::Socket::Option opt, int value) {
+  int level, name;
+  if (!TranslateOption(opt, &level, &name, &value)) {
+    error_ = ENOTSUP;
+    return -1;
+  }
+  int result = setsockopt(fd_, level, name, &value, sizeof(value));
+  if (result != 0)
+    error_ = errno;
+  return result;
+}
+
+int BatchedAsyncUdpSocket::GetError() const {
+  return error_;
+}
+
+void BatchedAsyncUdpSocket::SetError(int error) {
+  error_ = error;
+}
+
+uint32_t BatchedAsyncUdpSocket::GetRequestedEvents() {
+  return rtc::DE_READ;
+}
+
+void BatchedAsyncUdpSocket::OnEvent(uint32_t ff, int err) {
+  if (ff & rtc::DE_READ)
+    ReadPackets();
+}
+
+void BatchedAsyncUdpSocket::ReadPackets() {
+  // Handlers may close or destroy this socket. The receiver and the flag are
+  // held locally so the rest of the batch can be dropped safely.
+  rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> alive = task_safety_.flag();
+  std::shared_ptr<UdpBatchReceiver> receiver = receiver_;
+  for (int batch = 0; batch < kMaxBatchesPerEvent && fd_ >= 0; batch++) {
+    int received = receiver->Receive(fd_);
+    if (received < 0) {
+      error_ = errno;
+      RTC_LOG(LS_VERBOSE) << "recvmmsg failed, errno " << error_;
+      return;
+    }
+    int64_t packet_time_us = rtc::TimeMicros();
+    for (int i = 0; i < received; i++) {
+      if (receiver->size(i) == 0) {
+        RTC_LOG(LS_WARNING) << "Dropped truncated or empty UDP datagram.";
+        continue;
+      }
+      rtc::SocketAddress remote_address;
+      rtc::SocketAddressFromSockAddrStorage(receiver->address(i),
+                                            &remote_address);
+      SignalReadPacket(this, receiver->data(i), receiver->size(i),
+                       remote_address, packet_time_us);
+      if (!alive->alive() || fd_ < 0)
+        return;
+    }
+    if (static_cast<size_t>(received) < receiver->batch_size())
+      return;
+  }
+}
+
+void BatchedAsyncUdpSocket::FlushPackets() {
+  flush_scheduled_ = false;
+  if (sender_.queued() == 0 || fd_ < 0)
+    return;
+  size_t queued = sender_.queued();
+  std::vector<int> errors;
+  size_t sent = sender_.Flush(fd_, &errors);
+  RTC_DCHECK_EQ(queued, pending_sent_packets_.size());
+  // Signal handlers may send more packets.
+  std::vector<rtc::SentPacket> sent_packets;
+  sent_packets.swap(pending_sent_packets_);
+  int64_t now = rtc::TimeMillis();
+  for (size_t i = 0; i < sent_packets.size(); i++) {
+    // Datagrams that were not sent are reported by GetError(), as a failed
+    // sendto would be, and are not signaled as sent.
+    if (i < errors.size() && errors[i] != 0) {
+      error_ = errors[i];
+      continue;
+    }
+    sent_packets[i].send_time_ms = now;
+    SignalSentPacket(this, sent_packets[i]);
+  }
+  if (sent < queued) {
+    RTC_LOG(LS_VERBOSE) << "Dropped " << queued - sent
+                        << " UDP datagrams, errno " << error_;
+  }
+}
+
+BatchedPacketSocketFactory::BatchedPacketSocketFactory(rtc::Thread* thread)
+    : rtc::BasicPacketSocketFactory(thread),
+      thread_(thread),
+      receiver_(std::make_shared<UdpBatchReceiver>()) {}
+
+BatchedPacketSocketFactory::~BatchedPacketSocketFactory() {}
+
+rtc::AsyncPacketSocket* BatchedPacketSocketFactory::CreateUdpSocket(
+    const rtc::SocketAddress& address,
+    uint16_t min_port,
+    uint16_t max_port) {
+  return BatchedAsyncUdpSocket::Create(thread_, address, min_port, max_port,
+                                       receiver_);
+}
+}
+}
@@ -0,0 +1,101 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_LINUX_BATCHEDPACKETSOCKETFACTORY_H_
+#define OWT_BASE_LINUX_BATCHEDPACKETSOCKETFACTORY_H_
+#include <memory>
+#include "talk/owt/sdk/base/linux/udpbatchio.h"
+#include "webrtc/p2p/base/basic_packet_socket_factory.h"
+#include "webrtc/rtc_base/async_packet_socket.h"
+#include "webrtc/rtc_base/physical_socket_server.h"
+#include "webrtc/rtc_base/task_utils/pending_task_safety_flag.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// A UDP AsyncPacketSocket which reads all pending datagrams with recvmmsg on
+// every read event, and sends datagrams queued during one message loop task
+// with a single sendmmsg (UDP GSO if available). It must be created and used on
+// a thread with a PhysicalSocketServer.
+class BatchedAsyncUdpSocket : public rtc::AsyncPacketSocket,
+                              public rtc::Dispatcher {
+ public:
+  // Create a socket bound to |bind_address|. If |min_port| and |max_port| are
+  // not 0, port is picked from the range. Returns nullptr on failure.
+  static BatchedAsyncUdpSocket* Create(
+      rtc::Thread* thread,
+      const rtc::SocketAddress& bind_address,
+      uint16_t min_port,
+      uint16_t max_port,
+      std::shared_ptr<UdpBatchReceiver> receiver);
+  ~BatchedAsyncUdpSocket() override;
+
+  // rtc::AsyncPacketSocket
+  rtc::SocketAddress GetLocalAddress() const override;
+  rtc::SocketAddress GetRemoteAddress() const override;
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override;
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override;
+  int Close() override;
+  State GetState() const override;
+  int GetOption(rtc::Socket::Option opt, int* value) override;
+  int SetOption(rtc::Socket::Option opt, int value) override;
+  int GetError() const override;
+  void SetError(int error) override;
+
+  // rtc::Dispatcher
+  uint32_t GetRequestedEvents() override;
+  void OnPreEvent(uint32_t ff) override {}
+  void OnEvent(uint32_t ff, int err) override;
+  int GetDescriptor() override { return fd_; }
+  bool IsDescriptorClosed() override { return false; }
+
+ private:
+  BatchedAsyncUdpSocket(rtc::Thread* thread,
+                        int fd,
+                        const rtc::SocketAddress& local_address,
+                        std::shared_ptr<UdpBatchReceiver> receiver);
+  // Translate |opt| to setsockopt level and name. Returns false if not
+  // supported.
+  bool TranslateOption(rtc::Socket::Option opt,
+                       int* level,
+                       int* name,
+                       int* value);
+  void ReadPackets();
+  void FlushPackets();
+
+  rtc::Thread* thread_;
+  rtc::PhysicalSocketServer* socket_server_;
+  int fd_;
+  rtc::SocketAddress local_address_;
+  int error_;
+  std::shared_ptr<UdpBatchReceiver> receiver_;
+  UdpBatchSender sender_;
+  // SentPacket of datagrams queued in |sender_|.
+  std::vector<rtc::SentPacket> pending_sent_packets_;
+  bool flush_scheduled_;
+  webrtc::ScopedTaskSafety task_safety_;
+};
+
+// A packet socket factory creating BatchedAsyncUdpSocket for UDP. TCP sockets
+// are created by rtc::BasicPacketSocketFactory.
+class BatchedPacketSocketFactory : public rtc::BasicPacketSocketFactory {
+ public:
+  // |thread| is the network thread. It must have a PhysicalSocketServer.
+  explicit BatchedPacketSocketFactory(rtc::Thread* thread);
+  ~BatchedPacketSocketFactory() override;
+  rtc::AsyncPacketSocket* CreateUdpSocket(const rtc::SocketAddress& address,
+                                          uint16_t min_port,
+                                          uint16_t max_port) override;
+
+ private:
+  rtc::Thread* thread_;
+  // Receive buffers shared by all UDP sockets on |thread_|.
+  std::shared_ptr<UdpBatchReceiver> receiver_;
+};
+}
+}
+#endif  // OWT_BASE_LINUX_BATCHEDPACKETSOCKETFACTORY_H_
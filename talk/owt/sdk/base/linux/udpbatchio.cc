@@ -0,0 +1,205 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/linux/udpbatchio.h"
+#include <errno.h>
+#include <netinet/udp.h>
+#include <stdint.h>
+#include <string.h>
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+namespace owt {
+namespace base {
+namespace {
+// Kernel limit of segments in one GSO send.
+const size_t kMaxGsoSegments = 64;
+// Maximum UDP payload of an IPv4 datagram.
+const size_t kMaxGsoBytes = 65507;
+}  // namespace
+
+UdpBatchReceiver::UdpBatchReceiver(size_t batch_size, size_t buffer_size)
+    : batch_size_(batch_size),
+      buffer_size_(buffer_size),
+      buffers_(batch_size * buffer_size),
+      sizes_(batch_size),
+      addresses_(batch_size),
+      iovecs_(batch_size),
+      messages_(batch_size) {
+  for (size_t i = 0; i < batch_size_; i++) {
+    iovecs_[i].iov_base = &buffers_[i * buffer_size_];
+    iovecs_[i].iov_len = buffer_size_;
+    memset(&messages_[i], 0, sizeof(mmsghdr));
+    messages_[i].msg_hdr.msg_name = &addresses_[i];
+    messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+    messages_[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+int UdpBatchReceiver::Receive(int fd) {
+  for (auto& message : messages_) {
+    message.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    message.msg_hdr.msg_flags = 0;
+    message.msg_len = 0;
+  }
+  int received;
+  do {
+    received = recvmmsg(fd, messages_.data(), batch_size_, MSG_DONTWAIT,
+                        nullptr);
+  } while (received < 0 && errno == EINTR);
+  if (received < 0)
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  for (int i = 0; i < received; i++) {
+    sizes_[i] = (messages_[i].msg_hdr.msg_flags & MSG_TRUNC)
+                    ? 0
+                    : messages_[i].msg_len;
+  }
+  return received;
+}
+
+UdpBatchSender::UdpBatchSender(bool gso_enabled, size_t batch_size)
+    : gso_enabled_(gso_enabled), batch_size_(batch_size), count_(0) {
+  datagrams_.reserve(batch_size_);
+}
+
+bool UdpBatchSender::IsGsoSupported(int fd) {
+  // Setting segment size to 0 keeps GSO disabled for normal sends.
+  int segment_size = 0;
+  return setsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment_size,
+                    sizeof(segment_size)) == 0;
+}
+
+void UdpBatchSender::Queue(const void* data,
+                           size_t size,
+                           const sockaddr_storage& address,
+                           socklen_t address_length) {
+  if (count_ == datagrams_.size())
+    datagrams_.emplace_back();
+  Datagram& datagram = datagrams_[count_++];
+  const char* bytes = static_cast<const char*>(data);
+  datagram.data.assign(bytes, bytes + size);
+  memcpy(&datagram.address, &address, address_length);
+  datagram.address_length = address_length;
+}
+
+size_t UdpBatchSender::Flush(int fd, std::vector<int>* errors) {
+  size_t sent = 0;
+  if (errors)
+    errors->assign(count_, 0);
+  if (count_ > 0)
+    sent = SendRange(fd, 0, count_, gso_enabled_, errors);
+  count_ = 0;
+  return sent;
+}
+
+size_t UdpBatchSender::GsoSegmentCount(size_t begin) const {
+  const Datagram& first = datagrams_[begin];
+  const size_t segment_size = first.data.size();
+  size_t segments = 1;
+  size_t bytes = segment_size;
+  for (size_t i = begin + 1; i < count_ && segments < kMaxGsoSegments; i++) {
+    const Datagram& datagram = datagrams_[i];
+    if (datagram.address_length != first.address_length ||
+        memcmp(&datagram.address, &first.address, first.address_length) !=
+            0 ||
+        datagram.data.size() > segment_size || datagram.data.empty() ||
+        bytes + datagram.data.size() > kMaxGsoBytes)
+      break;
+    segments++;
+    bytes += datagram.data.size();
+    // Only the last segment may be shorter.
+    if (datagram.data.size() < segment_size)
+      break;
+  }
+  return segments;
+}
+
+size_t UdpBatchSender::SendRange(int fd,
+                                 size_t begin,
+                                 size_t end,
+                                 bool use_gso,
+                                 std::vector<int>* errors) {
+  const size_t control_size = CMSG_SPACE(sizeof(uint16_t));
+  iovecs_.resize(end - begin);
+  messages_.clear();
+  message_datagrams_.clear();
+  controls_.assign((end - begin) * control_size, 0);
+  for (size_t i = begin; i < end;) {
+    size_t segments = use_gso ? GsoSegmentCount(i) : 1;
+    if (i + segments > end)
+      segments = end - i;
+    for (size_t j = 0; j < segments; j++) {
+      iovec& iov = iovecs_[i - begin + j];
+      iov.iov_base = datagrams_[i + j].data.data();
+      iov.iov_len = datagrams_[i + j].data.size();
+    }
+    mmsghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_hdr.msg_name = &datagrams_[i].address;
+    message.msg_hdr.msg_namelen = datagrams_[i].address_length;
+    message.msg_hdr.msg_iov = &iovecs_[i - begin];
+    message.msg_hdr.msg_iovlen = segments;
+    if (segments > 1) {
+      message.msg_hdr.msg_control =
+          &controls_[messages_.size() * control_size];
+      message.msg_hdr.msg_controllen = control_size;
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&message.msg_hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      uint16_t segment_size =
+          static_cast<uint16_t>(datagrams_[i].data.size());
+      memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+    }
+    messages_.push_back(message);
+    message_datagrams_.push_back(segments);
+    i += segments;
+  }
+  size_t sent = 0;
+  // Index of first datagram of |messages_[message]|.
+  size_t datagram = begin;
+  size_t message = 0;
+  while (message < messages_.size()) {
+    int result = sendmmsg(fd, &messages_[message],
+                          messages_.size() - message, MSG_DONTWAIT);
+    if (result < 0) {
+      int error = errno;
+      if (error == EINTR)
+        continue;
+      if (use_gso && message_datagrams_[message] > 1 &&
+          (error == EIO || error == EINVAL)) {
+        // GSO is not usable on the egress device. Send remaining datagrams
+        // one by one from now on.
+        gso_enabled_ = false;
+        return sent + SendRange(fd, datagram, end, false, errors);
+      }
+      if (error == EAGAIN || error == EWOULDBLOCK) {
+        if (errors) {
+          for (size_t i = datagram; i < end; i++)
+            (*errors)[i] = error;
+        }
+        break;
+      }
+      // Drop the failed message, e.g. unreachable destination, and go on
+      // with the rest.
+      if (errors) {
+        for (size_t i = 0; i < message_datagrams_[message]; i++)
+          (*errors)[datagram + i] = error;
+      }
+      datagram += message_datagrams_[message];
+      message++;
+      continue;
+    }
+    for (int i = 0; i < result; i++) {
+      sent += message_datagrams_[message];
+      datagram += message_datagrams_[message];
+      message++;
+    }
+  }
+  return sent;
+}
+}
+}
@@ -0,0 +1,95 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_LINUX_UDPBATCHIO_H_
+#define OWT_BASE_LINUX_UDPBATCHIO_H_
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <stddef.h>
+#include <vector>
+namespace owt {
+namespace base {
+// Receives UDP datagrams with recvmmsg. Buffers are allocated once and reused,
+// so one receiver can be shared by all sockets served by the same thread.
+class UdpBatchReceiver {
+ public:
+  static const size_t kDefaultBatchSize = 32;
+  // Large enough for any UDP datagram.
+  static const size_t kMaxDatagramSize = 65536;
+  explicit UdpBatchReceiver(size_t batch_size = kDefaultBatchSize,
+                            size_t buffer_size = kMaxDatagramSize);
+  // Receive up to batch size datagrams from |fd| without blocking. Returns the
+  // number of datagrams received, 0 if no datagram is available, or -1 on
+  // error with errno set. Truncated datagrams are counted but have size 0.
+  int Receive(int fd);
+  const char* data(int index) const { return &buffers_[index * buffer_size_]; }
+  size_t size(int index) const { return sizes_[index]; }
+  const sockaddr_storage& address(int index) const {
+    return addresses_[index];
+  }
+  size_t batch_size() const { return batch_size_; }
+
+ private:
+  const size_t batch_size_;
+  const size_t buffer_size_;
+  std::vector<char> buffers_;
+  std::vector<size_t> sizes_;
+  std::vector<sockaddr_storage> addresses_;
+  std::vector<iovec> iovecs_;
+  std::vector<mmsghdr> messages_;
+};
+
+// Queues UDP datagrams and sends them with sendmmsg. Consecutive datagrams of
+// the same size to the same destination are coalesced into one UDP GSO send
+// when |gso_enabled| is true and the kernel supports it.
+class UdpBatchSender {
+ public:
+  static const size_t kDefaultBatchSize = 32;
+  UdpBatchSender(bool gso_enabled, size_t batch_size = kDefaultBatchSize);
+  // Returns true if UDP GSO can be used on |fd|.
+  static bool IsGsoSupported(int fd);
+  // Copy a datagram into the queue.
+  void Queue(const void* data,
+             size_t size,
+             const sockaddr_storage& address,
+             socklen_t address_length);
+  // Send all queued datagrams to |fd| without blocking. Datagrams that cannot
+  // be sent are dropped, like a single sendto on a full socket buffer. Returns
+  // the number of datagrams sent. If |errors| is not null, it receives the
+  // errno of each queued datagram in queue order, 0 if it was sent. Queue is
+  // empty after this call.
+  size_t Flush(int fd, std::vector<int>* errors = nullptr);
+  size_t queued() const { return count_; }
+  // Queue reached batch size and should be flushed.
+  bool full() const { return count_ >= batch_size_; }
+  bool gso_enabled() const { return gso_enabled_; }
+
+ private:
+  struct Datagram {
+    std::vector<char> data;
+    sockaddr_storage address;
+    socklen_t address_length;
+  };
+  // Number of datagrams starting from |begin| that can be sent by a single
+  // GSO send.
+  size_t GsoSegmentCount(size_t begin) const;
+  // Send datagrams in [begin, end) with sendmmsg. Returns number of datagrams
+  // sent. errno of datagrams not sent is stored in |errors| if not null.
+  size_t SendRange(int fd,
+                   size_t begin,
+                   size_t end,
+                   bool use_gso,
+                   std::vector<int>* errors);
+  bool gso_enabled_;
+  const size_t batch_size_;
+  // Datagrams are kept after Flush to reuse their buffers.
+  std::vector<Datagram> datagrams_;
+  size_t count_;
+  std::vector<iovec> iovecs_;
+  std::vector<mmsghdr> messages_;
+  std::vector<size_t> message_datagrams_;
+  std::vector<char> controls_;
+};
+}
+}
+#endif  // OWT_BASE_LINUX_UDPBATCHIO_H_
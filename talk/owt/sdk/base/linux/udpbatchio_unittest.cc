@@ -0,0 +1,244 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/linux/udpbatchio.h"
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "talk/owt/sdk/base/threadutils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+namespace owt {
+namespace base {
+namespace {
+// A UDP socket bound to an ephemeral port on loopback.
+class LoopbackSocket {
+ public:
+  LoopbackSocket() : fd_(socket(AF_INET, SOCK_DGRAM, 0)) {
+    memset(&address_, 0, sizeof(address_));
+    sockaddr_in* address = reinterpret_cast<sockaddr_in*>(&address_);
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd_, reinterpret_cast<sockaddr*>(address), sizeof(sockaddr_in));
+    socklen_t length = sizeof(sockaddr_in);
+    getsockname(fd_, reinterpret_cast<sockaddr*>(address), &length);
+    int buffer_size = 8 * 1024 * 1024;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+  }
+  ~LoopbackSocket() { close(fd_); }
+  int fd() const { return fd_; }
+  const sockaddr_storage& address() const { return address_; }
+  bool WaitReadable(int timeout_ms) const {
+    pollfd poll_fd = {fd_, POLLIN, 0};
+    return poll(&poll_fd, 1, timeout_ms) > 0;
+  }
+
+ private:
+  int fd_;
+  sockaddr_storage address_;
+};
+
+int ReceiveAll(UdpBatchReceiver& receiver,
+               const LoopbackSocket& socket,
+               std::vector<std::string>* datagrams) {
+  int total = 0;
+  while (socket.WaitReadable(100)) {
+    int received = receiver.Receive(socket.fd());
+    if (received <= 0)
+      break;
+    for (int i = 0; i < received; i++)
+      datagrams->emplace_back(receiver.data(i), receiver.size(i));
+    total += received;
+  }
+  return total;
+}
+
+struct ThroughputResult {
+  uint64_t received = 0;
+  double packets_per_second = 0;
+  int64_t sender_cpu_us = 0;
+  int64_t receiver_cpu_us = 0;
+};
+
+// Send |count| datagrams of |size| bytes over loopback and receive them on
+// another thread. Batched I/O is used if |batched| is true, otherwise one
+// sendto/recvfrom per datagram.
+ThroughputResult RunLoopbackThroughput(bool batched,
+                                       size_t count,
+                                       size_t size) {
+  LoopbackSocket sender_socket;
+  LoopbackSocket receiver_socket;
+  ThroughputResult result;
+  std::atomic<bool> sending(true);
+  std::thread receiver_thread([&] {
+    UdpBatchReceiver receiver;
+    std::vector<char> buffer(UdpBatchReceiver::kMaxDatagramSize);
+    int64_t cpu_begin = CurrentThreadCpuTimeUs();
+    auto begin = std::chrono::steady_clock::now();
+    auto last = begin;
+    while (receiver_socket.WaitReadable(sending ? 1000 : 100)) {
+      if (batched) {
+        int received = receiver.Receive(receiver_socket.fd());
+        if (received > 0)
+          result.received += received;
+      } else if (recvfrom(receiver_socket.fd(), buffer.data(), buffer.size(),
+                          MSG_DONTWAIT, nullptr, nullptr) >= 0) {
+        result.received++;
+      }
+      last = std::chrono::steady_clock::now();
+    }
+    result.receiver_cpu_us = CurrentThreadCpuTimeUs() - cpu_begin;
+    double seconds = std::chrono::duration<double>(last - begin).count();
+    if (seconds > 0)
+      result.packets_per_second = result.received / seconds;
+  });
+  std::vector<char> payload(size, 'x');
+  UdpBatchSender sender(false);
+  int64_t cpu_begin = CurrentThreadCpuTimeUs();
+  for (size_t i = 0; i < count; i++) {
+    if (batched) {
+      sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+                   sizeof(sockaddr_in));
+      if (sender.full())
+        sender.Flush(sender_socket.fd());
+    } else {
+      sendto(sender_socket.fd(), payload.data(), payload.size(), 0,
+             reinterpret_cast<const sockaddr*>(&receiver_socket.address()),
+             sizeof(sockaddr_in));
+    }
+    // Give receiver a chance to drain socket buffer.
+    if (i % 256 == 255)
+      std::this_thread::yield();
+  }
+  sender.Flush(sender_socket.fd());
+  result.sender_cpu_us = CurrentThreadCpuTimeUs() - cpu_begin;
+  sending = false;
+  receiver_thread.join();
+  return result;
+}
+}  // namespace
+
+TEST(UdpBatchIoTest, SendAndReceiveBatch) {
+  LoopbackSocket sender_socket;
+  LoopbackSocket receiver_socket;
+  UdpBatchSender sender(false);
+  for (int i = 0; i < 10; i++) {
+    std::string payload = "packet" + std::to_string(i);
+    sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+                 sizeof(sockaddr_in));
+  }
+  EXPECT_EQ(10u, sender.queued());
+  EXPECT_EQ(10u, sender.Flush(sender_socket.fd()));
+  EXPECT_EQ(0u, sender.queued());
+  UdpBatchReceiver receiver;
+  std::vector<std::string> datagrams;
+  EXPECT_EQ(10, ReceiveAll(receiver, receiver_socket, &datagrams));
+  ASSERT_EQ(10u, datagrams.size());
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ("packet" + std::to_string(i), datagrams[i]);
+  const sockaddr_in& from =
+      reinterpret_cast<const sockaddr_in&>(receiver.address(0));
+  EXPECT_EQ(reinterpret_cast<const sockaddr_in&>(sender_socket.address())
+                .sin_port,
+            from.sin_port);
+}
+
+TEST(UdpBatchIoTest, FlushReportsErrorOfEachDatagram) {
+  LoopbackSocket sender_socket;
+  LoopbackSocket receiver_socket;
+  UdpBatchSender sender(false);
+  // An IPv6 destination cannot be reached from an IPv4 socket.
+  sockaddr_storage ipv6_address;
+  memset(&ipv6_address, 0, sizeof(ipv6_address));
+  sockaddr_in6* ipv6 = reinterpret_cast<sockaddr_in6*>(&ipv6_address);
+  ipv6->sin6_family = AF_INET6;
+  ipv6->sin6_addr = in6addr_loopback;
+  ipv6->sin6_port = htons(9);
+  std::string payload = "packet";
+  sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+               sizeof(sockaddr_in));
+  sender.Queue(payload.data(), payload.size(), ipv6_address,
+               sizeof(sockaddr_in6));
+  sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+               sizeof(sockaddr_in));
+  std::vector<int> errors;
+  EXPECT_EQ(2u, sender.Flush(sender_socket.fd(), &errors));
+  ASSERT_EQ(3u, errors.size());
+  EXPECT_EQ(0, errors[0]);
+  EXPECT_NE(0, errors[1]);
+  EXPECT_EQ(0, errors[2]);
+  UdpBatchReceiver receiver;
+  std::vector<std::string> datagrams;
+  EXPECT_EQ(2, ReceiveAll(receiver, receiver_socket, &datagrams));
+}
+
+TEST(UdpBatchIoTest, ReceiveReturnsZeroWhenEmpty) {
+  LoopbackSocket socket;
+  UdpBatchReceiver receiver;
+  EXPECT_EQ(0, receiver.Receive(socket.fd()));
+}
+
+TEST(UdpBatchIoTest, TruncatedDatagramHasZeroSize) {
+  LoopbackSocket sender_socket;
+  LoopbackSocket receiver_socket;
+  UdpBatchSender sender(false);
+  std::string payload(100, 'a');
+  sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+               sizeof(sockaddr_in));
+  sender.Flush(sender_socket.fd());
+  UdpBatchReceiver receiver(4, 10);
+  ASSERT_TRUE(receiver_socket.WaitReadable(100));
+  ASSERT_EQ(1, receiver.Receive(receiver_socket.fd()));
+  EXPECT_EQ(0u, receiver.size(0));
+}
+
+TEST(UdpBatchIoTest, GsoSplitsIntoOriginalDatagrams) {
+  LoopbackSocket sender_socket;
+  LoopbackSocket receiver_socket;
+  UdpBatchSender sender(UdpBatchSender::IsGsoSupported(sender_socket.fd()));
+  // Three full segments followed by a shorter one, then a different size.
+  std::vector<std::string> payloads = {std::string(1000, 'a'),
+                                       std::string(1000, 'b'),
+                                       std::string(1000, 'c'),
+                                       std::string(300, 'd'),
+                                       std::string(1200, 'e')};
+  for (const auto& payload : payloads) {
+    sender.Queue(payload.data(), payload.size(), receiver_socket.address(),
+                 sizeof(sockaddr_in));
+  }
+  EXPECT_EQ(payloads.size(), sender.Flush(sender_socket.fd()));
+  UdpBatchReceiver receiver;
+  std::vector<std::string> datagrams;
+  ReceiveAll(receiver, receiver_socket, &datagrams);
+  EXPECT_EQ(payloads, datagrams);
+}
+
+TEST(UdpBatchIoTest, DISABLED_BenchmarkLoopbackThroughput) {
+  const size_t kPacketCount = 500000;
+  const size_t kPacketSize = 1200;
+  ThroughputResult plain = RunLoopbackThroughput(false, kPacketCount,
+                                                 kPacketSize);
+  ThroughputResult batched = RunLoopbackThroughput(true, kPacketCount,
+                                                   kPacketSize);
+  for (const auto& result : {std::make_pair("sendto/recvfrom", plain),
+                             std::make_pair("sendmmsg/recvmmsg", batched)}) {
+    const ThroughputResult& r = result.second;
+    std::cout << result.first << ": " << r.received << " received, "
+              << static_cast<uint64_t>(r.packets_per_second)
+              << " packets/s, sender CPU "
+              << (r.sender_cpu_us * 1000.0 / kPacketCount)
+              << " us/1k packets, receiver CPU "
+              << (r.received ? r.receiver_cpu_us * 1000.0 / r.received : 0)
+              << " us/1k packets" << std::endl;
+  }
+  EXPECT_GT(batched.received, 0u);
+}
+}
+}
@@ -0,0 +1,81 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_MPSCQUEUE_H_
+#define OWT_BASE_MPSCQUEUE_H_
+#include <atomic>
+#include <utility>
+namespace owt {
+namespace base {
+// Unbounded lock-free queue with multiple producers and a single consumer.
+// Push() is wait-free and can be called on any thread. Pop() must be called
+// on one thread at a time. Items pushed by the same thread are popped in the
+// order they were pushed.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) { stub_.next = nullptr; }
+  ~MpscQueue() {
+    T item;
+    while (Pop(&item)) {
+    }
+  }
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void Push(T item) {
+    Node* node = new Node(std::move(item));
+    Link(node);
+  }
+  // Returns false if the queue is empty, or the only item is still being
+  // pushed by another thread.
+  bool Pop(T* item) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr)
+        return false;
+      // Skip the stub.
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      *item = std::move(tail->value);
+      delete tail;
+      return true;
+    }
+    if (tail != head_.load(std::memory_order_acquire))
+      return false;
+    // |tail| is the last item. Put the stub behind it so it can be removed.
+    Link(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+      return false;
+    tail_ = next;
+    *item = std::move(tail->value);
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    explicit Node(T item) : next(nullptr), value(std::move(item)) {}
+    std::atomic<Node*> next;
+    T value;
+  };
+  void Link(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+  // Producers append after |head_|, the consumer removes from |tail_|.
+  std::atomic<Node*> head_;
+  Node* tail_;
+  Node stub_;
+};
+}
+}
+#endif  // OWT_BASE_MPSCQUEUE_H_
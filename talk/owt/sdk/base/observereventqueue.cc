@@ -0,0 +1,110 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/observereventqueue.h"
+#include <thread>
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+std::unique_ptr<ObserverEventQueue> ObserverEventQueue::queue_instance_;
+std::mutex ObserverEventQueue::queue_instance_mutex_;
+
+ObserverEventQueue* ObserverEventQueue::Get() {
+  ObserverEventDispatchMode mode =
+      GlobalConfiguration::GetObserverEventDispatchMode();
+  if (mode == ObserverEventDispatchMode::kDirect)
+    return nullptr;
+  std::lock_guard<std::mutex> lock(queue_instance_mutex_);
+  if (!queue_instance_) {
+    queue_instance_.reset(new ObserverEventQueue(
+        mode == ObserverEventDispatchMode::kDispatcherThread));
+  }
+  return queue_instance_.get();
+}
+
+ObserverEventQueue::ObserverEventQueue(bool own_thread)
+    : depth_(0),
+      max_handler_latency_us_(0),
+      max_queue_delay_us_(0),
+      dispatched_events_(0),
+      stopped_(false),
+      wakeup_(false, false) {
+  if (own_thread) {
+    thread_.reset(new rtc::PlatformThread(DispatcherThreadFunc, this,
+                                          "owt_observer_event_thread",
+                                          rtc::kNormalPriority));
+    thread_->Start();
+  }
+}
+
+ObserverEventQueue::~ObserverEventQueue() {
+  if (thread_) {
+    stopped_ = true;
+    wakeup_.Set();
+    thread_->Stop();
+  }
+}
+
+void ObserverEventQueue::Post(Event event) {
+  Entry entry;
+  entry.event = std::move(event);
+  entry.post_time_us = rtc::TimeMicros();
+  bool was_empty = depth_.fetch_add(1) == 0;
+  queue_.Push(std::move(entry));
+  if (was_empty)
+    wakeup_.Set();
+}
+
+size_t ObserverEventQueue::Dispatch() {
+  size_t count = 0;
+  Entry entry;
+  while (depth_.load() > 0) {
+    if (!queue_.Pop(&entry)) {
+      // A producer is in the middle of pushing.
+      std::this_thread::yield();
+      continue;
+    }
+    int64_t start_us = rtc::TimeMicros();
+    UpdateMax(&max_queue_delay_us_, start_us - entry.post_time_us);
+    entry.event();
+    UpdateMax(&max_handler_latency_us_, rtc::TimeMicros() - start_us);
+    entry.event = nullptr;
+    depth_--;
+    dispatched_events_++;
+    count++;
+  }
+  return count;
+}
+
+ObserverEventQueueStats ObserverEventQueue::GetStats() const {
+  ObserverEventQueueStats stats;
+  stats.depth = depth_.load();
+  stats.max_handler_latency_us = max_handler_latency_us_.load();
+  stats.max_queue_delay_us = max_queue_delay_us_.load();
+  stats.dispatched_events = dispatched_events_.load();
+  return stats;
+}
+
+void ObserverEventQueue::DispatcherThreadFunc(void* queue) {
+  static_cast<ObserverEventQueue*>(queue)->RunDispatcherThread();
+}
+
+void ObserverEventQueue::RunDispatcherThread() {
+  while (!stopped_) {
+    Dispatch();
+    // Post() sets |wakeup_| when |depth_| leaves 0, so an event posted after
+    // Dispatch() returned is not missed.
+    wakeup_.Wait(rtc::Event::kForever);
+  }
+  // Run events posted before stopping, they may release resources.
+  Dispatch();
+}
+
+void ObserverEventQueue::UpdateMax(std::atomic<int64_t>* max, int64_t value) {
+  int64_t current = max->load();
+  while (value > current && !max->compare_exchange_weak(current, value)) {
+  }
+}
+}
+}
@@ -0,0 +1,63 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_OBSERVEREVENTQUEUE_H_
+#define OWT_BASE_OBSERVEREVENTQUEUE_H_
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "owt/base/globalconfiguration.h"
+#include "talk/owt/sdk/base/mpscqueue.h"
+#include "webrtc/rtc_base/event.h"
+#include "webrtc/rtc_base/platform_thread.h"
+namespace owt {
+namespace base {
+// Runs observer callbacks posted from WebRTC threads on a dispatcher thread,
+// so slow handlers do not block signaling. Events are run in the order they
+// are posted by each thread, so events of one connection keep their order.
+class ObserverEventQueue {
+ public:
+  typedef std::function<void()> Event;
+  // Returns the process wide queue for the mode set by
+  // GlobalConfiguration::SetObserverEventDispatchMode(), or nullptr if events
+  // are dispatched directly.
+  static ObserverEventQueue* Get();
+  // If |own_thread| is true, events are run on a thread owned by this queue.
+  // Otherwise they are run by Dispatch().
+  explicit ObserverEventQueue(bool own_thread);
+  ~ObserverEventQueue();
+  // Can be called on any thread.
+  void Post(Event event);
+  // Run pending events on the calling thread and return the number of events
+  // run. Must not be called on more than one thread at a time.
+  size_t Dispatch();
+  ObserverEventQueueStats GetStats() const;
+  bool HasDispatcherThread() const { return thread_ != nullptr; }
+
+ private:
+  struct Entry {
+    Event event;
+    // rtc::TimeMicros() when the event was posted.
+    int64_t post_time_us = 0;
+  };
+  static void DispatcherThreadFunc(void* queue);
+  void RunDispatcherThread();
+  static void UpdateMax(std::atomic<int64_t>* max, int64_t value);
+
+  MpscQueue<Entry> queue_;
+  // Number of events posted but not run yet. Incremented before an event is
+  // pushed, so it is never smaller than the number of events in |queue_|.
+  std::atomic<int64_t> depth_;
+  std::atomic<int64_t> max_handler_latency_us_;
+  std::atomic<int64_t> max_queue_delay_us_;
+  std::atomic<uint64_t> dispatched_events_;
+  std::atomic<bool> stopped_;
+  rtc::Event wakeup_;
+  std::unique_ptr<rtc::PlatformThread> thread_;
+  static std::unique_ptr<ObserverEventQueue> queue_instance_;
+  static std::mutex queue_instance_mutex_;
+};
+}
+}
+#endif  // OWT_BASE_OBSERVEREVENTQUEUE_H_
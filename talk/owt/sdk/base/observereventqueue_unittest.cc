@@ -0,0 +1,89 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/observereventqueue.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "talk/owt/sdk/base/mpscqueue.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+namespace owt {
+namespace base {
+TEST(MpscQueueTest, PopsInPushOrder) {
+  MpscQueue<int> queue;
+  int item = 0;
+  EXPECT_FALSE(queue.Pop(&item));
+  for (int i = 0; i < 3; i++)
+    queue.Push(i);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(queue.Pop(&item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_FALSE(queue.Pop(&item));
+  // Reusable after being drained.
+  queue.Push(7);
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(7, item);
+}
+
+TEST(MpscQueueTest, KeepsOrderOfEachProducer) {
+  const int kProducers = 4;
+  const int kItemsPerProducer = 10000;
+  MpscQueue<std::pair<int, int>> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < kItemsPerProducer; i++)
+        queue.Push(std::make_pair(p, i));
+    });
+  }
+  std::vector<int> next(kProducers, 0);
+  int popped = 0;
+  std::pair<int, int> item;
+  while (popped < kProducers * kItemsPerProducer) {
+    if (!queue.Pop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(next[item.first], item.second);
+    next[item.first]++;
+    popped++;
+  }
+  for (auto& producer : producers)
+    producer.join();
+  EXPECT_FALSE(queue.Pop(&item));
+}
+
+TEST(ObserverEventQueueTest, DispatchRunsEventsOnCallingThread) {
+  ObserverEventQueue queue(false);
+  EXPECT_FALSE(queue.HasDispatcherThread());
+  std::vector<int> events;
+  for (int i = 0; i < 3; i++)
+    queue.Post([&events, i] { events.push_back(i); });
+  EXPECT_EQ(3, queue.GetStats().depth);
+  EXPECT_TRUE(events.empty());
+  EXPECT_EQ(3u, queue.Dispatch());
+  EXPECT_THAT(events, ::testing::ElementsAre(0, 1, 2));
+  ObserverEventQueueStats stats = queue.GetStats();
+  EXPECT_EQ(0, stats.depth);
+  EXPECT_EQ(3u, stats.dispatched_events);
+  EXPECT_EQ(0u, queue.Dispatch());
+}
+
+TEST(ObserverEventQueueTest, DispatcherThreadRunsEvents) {
+  ObserverEventQueue queue(true);
+  EXPECT_TRUE(queue.HasDispatcherThread());
+  rtc::Event done;
+  std::thread::id handler_thread;
+  queue.Post([&handler_thread] {
+    handler_thread = std::this_thread::get_id();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  });
+  queue.Post([&done] { done.Set(); });
+  ASSERT_TRUE(done.Wait(5000));
+  EXPECT_NE(std::this_thread::get_id(), handler_thread);
+  EXPECT_GE(queue.GetStats().max_handler_latency_us, 10000);
+}
+}
+}
@@ -23,23 +23,38 @@ PeerConnectionChannel::~PeerConnectionChannel() {
     peer_connection_->Close();
     peer_connection_ = nullptr;
   }
+  if (factory_ != nullptr)
+    factory_->ReleaseConnection();
 }
-bool PeerConnectionChannel::InitializePeerConnection() {
-  RTC_LOG(LS_INFO) << "Initialize PeerConnection.";
-  if (factory_.get() == nullptr)
-    factory_ = PeerConnectionDependencyFactory::Get();
-  audio_transceiver_direction_ = webrtc::RtpTransceiverDirection::kSendRecv;
-  video_transceiver_direction_ = webrtc::RtpTransceiverDirection::kSendRecv;
-  configuration_.enable_dtls_srtp = true;
-  configuration_.sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
-  configuration_.media_config.enable_dscp = true;
+void PeerConnectionChannel::ApplyCommonConfiguration(
+    webrtc::PeerConnectionInterface::RTCConfiguration* configuration) {
+  configuration->enable_dtls_srtp = true;
+  configuration->sdp_semantics = webrtc::SdpSemantics::kUnifiedPlan;
+  configuration->media_config.enable_dscp = true;
   // Johny: This must not be set if we use seperate AV channels.
   if (!webrtc::field_trial::IsEnabled("OWT-IceUnbundle")) {
-     configuration_.bundle_policy =
+     configuration->bundle_policy =
        webrtc::PeerConnectionInterface::BundlePolicy::kBundlePolicyMaxBundle;
   }
+}
+void PeerConnectionChannel::PrepareInitialization() {
+  // A channel stays on the same factory shard for its whole lifetime.
+  if (factory_.get() == nullptr)
+    factory_ = PeerConnectionDependencyFactory::AcquireForNewConnection();
+  audio_transceiver_direction_ = webrtc::RtpTransceiverDirection::kSendRecv;
+  video_transceiver_direction_ = webrtc::RtpTransceiverDirection::kSendRecv;
+  ApplyCommonConfiguration(&configuration_);
+}
+bool PeerConnectionChannel::InitializePeerConnection() {
+  RTC_LOG(LS_INFO) << "Initialize PeerConnection.";
+  PrepareInitialization();
   peer_connection_ =
-      (factory_->CreatePeerConnection(configuration_, this)).get();
+      factory_->TakePooledPeerConnection(configuration_, this,
+                                         &pooled_observer_);
+  if (!peer_connection_.get()) {
+    peer_connection_ =
+        (factory_->CreatePeerConnection(configuration_, this)).get();
+  }
   if (!peer_connection_.get()) {
     RTC_LOG(LS_ERROR) << "Failed to initialize PeerConnection.";
     RTC_DCHECK(false);
@@ -48,6 +63,53 @@ bool PeerConnectionChannel::InitializePeerConnection() {
   RTC_CHECK(peer_connection_);
   return true;
 }
+void PeerConnectionChannel::InitializePeerConnectionAsync(
+    std::function<void(bool)> on_complete) {
+  RTC_LOG(LS_INFO) << "Initialize PeerConnection asynchronously.";
+  PrepareInitialization();
+  auto on_created =
+      [this, on_complete](
+          rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection) {
+        peer_connection_ = peer_connection;
+        if (!peer_connection_.get()) {
+          RTC_LOG(LS_ERROR) << "Failed to initialize PeerConnection.";
+        }
+        if (on_complete)
+          on_complete(peer_connection_.get() != nullptr);
+      };
+  factory_->TakePooledPeerConnectionAsync(
+      configuration_, this,
+      [this, on_created](
+          rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection,
+          std::unique_ptr<PooledPeerConnectionObserver> pooled_observer) {
+        if (peer_connection.get()) {
+          pooled_observer_ = std::move(pooled_observer);
+          on_created(peer_connection);
+          return;
+        }
+        // Pool is empty or disabled.
+        factory_->CreatePeerConnectionAsync(configuration_, this, on_created);
+      });
+}
+void PeerConnectionChannel::ClosePeerConnectionAsync(
+    std::function<void()> on_closed) {
+  if (!peer_connection_.get() || !factory_.get()) {
+    if (on_closed)
+      on_closed();
+    return;
+  }
+  rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection =
+      peer_connection_;
+  peer_connection_ = nullptr;
+  // Events raised during closing still go through the pooled observer.
+  std::shared_ptr<PooledPeerConnectionObserver> pooled_observer(
+      std::move(pooled_observer_));
+  factory_->ClosePeerConnectionAsync(
+      peer_connection, [pooled_observer, on_closed] {
+        if (on_closed)
+          on_closed();
+      });
+}
 void PeerConnectionChannel::ApplyBitrateSettings() {
   RTC_CHECK(peer_connection_);
   std::vector<rtc::scoped_refptr<webrtc::RtpSenderInterface>> senders =
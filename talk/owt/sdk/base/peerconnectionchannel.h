@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef WOOGEEN_BASE_PEERCONNECTIONCHANNEL_H_
 #define WOOGEEN_BASE_PEERCONNECTIONCHANNEL_H_
+#include <functional>
 #include <vector>
 #include "webrtc/rtc_base/message_handler.h"
 #include "webrtc/rtc_base/third_party/sigslot/sigslot.h"
@@ -61,11 +62,24 @@ class PeerConnectionChannel : public webrtc::PeerConnectionObserver,
                               public sigslot::has_slots<> {
  public:
   PeerConnectionChannel(PeerConnectionChannelConfiguration configuration);
+  // Apply settings required by all PeerConnectionChannels to |configuration|.
+  // PeerConnections created with other configurations are not used.
+  static void ApplyCommonConfiguration(
+      webrtc::PeerConnectionInterface::RTCConfiguration* configuration);
  protected:
   virtual ~PeerConnectionChannel();
   bool InitializePeerConnection();
+  // Asynchronous version of InitializePeerConnection. |on_complete| is invoked
+  // on the factory thread with the result. |peer_connection_| must not be
+  // used before |on_complete| is invoked.
+  void InitializePeerConnectionAsync(std::function<void(bool)> on_complete);
+  // Close |peer_connection_| on the factory thread without blocking the
+  // caller. |peer_connection_| is reset immediately.
+  void ClosePeerConnectionAsync(std::function<void()> on_closed);
   const webrtc::SessionDescriptionInterface* LocalDescription();
   PeerConnectionInterface::SignalingState SignalingState() const;
+  // Factory of |peer_connection_|, null before it is initialized.
+  PeerConnectionDependencyFactory* factory() const { return factory_.get(); }
   // Apply the bitrate settings on all tracks available. Failing to set any of them
   // will result in a false return, with remaining settings applicable still applied.
   // Subclasses can override this to implementation specific bitrate allocation policies.
@@ -130,9 +144,15 @@ class PeerConnectionChannel : public webrtc::PeerConnectionObserver,
   virtual void OnMessage(const webrtc::DataBuffer& buffer) override {
     OnDataChannelMessage(buffer);
   }
-  // |factory_| is got from PeerConnectionDependencyFactory::Get() which is
-  // shared among all PeerConnectionChannels.
+  // Set up |factory_| and |configuration_| before creating a PeerConnection.
+  void PrepareInitialization();
+  // |factory_| is got from
+  // PeerConnectionDependencyFactory::AcquireForNewConnection(). It is shared
+  // among all PeerConnectionChannels unless factory sharding is enabled.
   rtc::scoped_refptr<PeerConnectionDependencyFactory> factory_;
+  // Forwards events of a PeerConnection taken from the pool to this channel.
+  // Null if |peer_connection_| is not from the pool.
+  std::unique_ptr<PooledPeerConnectionObserver> pooled_observer_;
 };
 }
 }
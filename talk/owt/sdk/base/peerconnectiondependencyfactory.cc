@@ -7,9 +7,16 @@
 #endif
 #include "talk/owt/sdk/base/encodedvideoencoderfactory.h"
 #include "talk/owt/sdk/base/peerconnectiondependencyfactory.h"
+#if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
+#include "talk/owt/sdk/base/sharedaudiodevicemodule.h"
+#endif
+#include "talk/owt/sdk/base/threadlagmonitor.h"
+#include "talk/owt/sdk/base/threadutils.h"
+#include "talk/owt/sdk/base/udpmuxsocketfactory.h"
 #include "webrtc/api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "webrtc/api/audio_codecs/builtin_audio_encoder_factory.h"
 #include "webrtc/api/create_peerconnection_factory.h"
+#include "webrtc/api/video_track_source_proxy.h"
 #include "webrtc/api/video_codecs/builtin_video_decoder_factory.h"
 #include "webrtc/api/video_codecs/builtin_video_encoder_factory.h"
 #include "webrtc/media/base/media_channel.h"
@@ -28,6 +35,7 @@
 #include "talk/owt/sdk/base/win/msdkvideoencoderfactory.h"
 #endif
 #elif defined(WEBRTC_LINUX)
+#include "talk/owt/sdk/base/linux/batchedpacketsocketfactory.h"
 #include "talk/owt/sdk/base/linux/msdkvideodecoderfactory.h"
 #elif defined(WEBRTC_IOS)
 #include "talk/owt/sdk/base/objc/ObjcVideoCodecFactory.h"
@@ -79,10 +87,28 @@ PeerConnectionThread::~PeerConnectionThread() {
 }
 rtc::scoped_refptr<PeerConnectionDependencyFactory>
     PeerConnectionDependencyFactory::dependency_factory_;
+std::vector<rtc::scoped_refptr<PeerConnectionDependencyFactory>>
+    PeerConnectionDependencyFactory::shards_;
+std::mutex PeerConnectionDependencyFactory::shards_mutex_;
+size_t PeerConnectionDependencyFactory::next_shard_ = 0;
+webrtc::PeerConnectionInterface::RTCConfiguration
+    PeerConnectionDependencyFactory::pool_configuration_;
+size_t PeerConnectionDependencyFactory::pool_size_ = 0;
+std::mutex PeerConnectionDependencyFactory::pool_mutex_;
 
-PeerConnectionDependencyFactory::PeerConnectionDependencyFactory()
+// Append shard index to thread names except for the default factory.
+static std::string ShardThreadName(const std::string& name, int shard_index) {
+  if (shard_index == 0)
+    return name;
+  return name + "_" + std::to_string(shard_index);
+}
+
+PeerConnectionDependencyFactory::PeerConnectionDependencyFactory(
+    int shard_index)
     : pc_thread_(rtc::Thread::CreateWithSocketServer()),
-      callback_thread_(rtc::Thread::CreateWithSocketServer()),
+      shard_index_(shard_index),
+      active_connections_(0),
+      total_connections_(0),
       field_trial_("WebRTC-H264HighProfile/Enabled/") {
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
   if (GlobalConfiguration::GetVideoHardwareAccelerationEnabled()) {
@@ -92,10 +118,25 @@ PeerConnectionDependencyFactory::PeerConnectionDependencyFactory()
   }
 #endif
   encoded_frame_ = GlobalConfiguration::GetEncodedVideoFrameEnabled();
-  pc_thread_->SetName("peerconnection_dependency_factory_thread", nullptr);
+  pc_thread_->SetName(
+      ShardThreadName("peerconnection_dependency_factory_thread", shard_index_),
+      nullptr);
   pc_thread_->Start();
+  if (ThreadLagMonitor* monitor = ThreadLagMonitor::Get())
+    monitor->AddThread(pc_thread_.get(), pc_thread_->name());
 }
 PeerConnectionDependencyFactory::~PeerConnectionDependencyFactory() {
+  // Pooled PeerConnections need signaling and worker threads to close.
+  if (pc_thread_ != nullptr && pool_ != nullptr) {
+    pc_thread_->Invoke<void>(RTC_FROM_HERE, [this] { pool_.reset(); });
+  }
+  if (ThreadLagMonitor* monitor = ThreadLagMonitor::Get()) {
+    for (rtc::Thread* thread : {pc_thread_.get(), worker_thread.get(),
+                                signaling_thread.get(), network_thread.get()}) {
+      if (thread != nullptr)
+        monitor->RemoveThread(thread);
+    }
+  }
   if (worker_thread != nullptr) {
     worker_thread->Stop();
   }
@@ -108,9 +149,6 @@ PeerConnectionDependencyFactory::~PeerConnectionDependencyFactory() {
   if (pc_thread_ != nullptr) {
     pc_thread_->Stop();
   }
-  if (callback_thread_ != nullptr) {
-    callback_thread_->Stop();
-  }
 
   printf("[PeerConnectionDependencyFactory] deinit\n");
 }
@@ -135,13 +173,204 @@ PeerConnectionDependencyFactory* PeerConnectionDependencyFactory::Get() {
   return dependency_factory_.get();
 }
 
+PeerConnectionDependencyFactory*
+PeerConnectionDependencyFactory::AcquireForNewConnection() {
+  PeerConnectionDependencyFactory* factory = nullptr;
+  size_t shard_count = static_cast<size_t>(
+      GlobalConfiguration::GetPeerConnectionFactoryShards());
+  if (shard_count <= 1) {
+    factory = Get();
+  } else {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    if (shards_.empty())
+      shards_.push_back(Get());
+    size_t index = 0;
+    if (GlobalConfiguration::GetPeerConnectionFactoryShardPolicy() ==
+        FactoryShardPolicy::kLeastLoaded) {
+      // Prefer creating a new shard over sharing a loaded one.
+      index = shards_.size();
+      for (size_t i = 0; i < shards_.size(); i++) {
+        if (shards_[i]->active_connections_ == 0) {
+          index = i;
+          break;
+        }
+      }
+      if (index == shards_.size() && index >= shard_count) {
+        index = 0;
+        for (size_t i = 1; i < shards_.size(); i++) {
+          if (shards_[i]->active_connections_ <
+              shards_[index]->active_connections_)
+            index = i;
+        }
+      }
+    } else {
+      index = next_shard_++ % shard_count;
+    }
+    while (shards_.size() <= index) {
+      rtc::scoped_refptr<PeerConnectionDependencyFactory> shard =
+          new rtc::RefCountedObject<PeerConnectionDependencyFactory>(
+              static_cast<int>(shards_.size()));
+      shard->CreatePeerConnectionFactory();
+      shards_.push_back(shard);
+    }
+    factory = shards_[index].get();
+  }
+  factory->active_connections_++;
+  factory->total_connections_++;
+  return factory;
+}
+
+void PeerConnectionDependencyFactory::ReleaseConnection() {
+  RTC_DCHECK_GT(active_connections_.load(), 0);
+  active_connections_--;
+}
+
+std::vector<FactoryShardLoad> PeerConnectionDependencyFactory::GetShardLoads() {
+  std::vector<FactoryShardLoad> loads;
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  if (shards_.empty() && dependency_factory_ != nullptr) {
+    loads.push_back({0, dependency_factory_->active_connections_,
+                     dependency_factory_->total_connections_});
+  }
+  for (const auto& shard : shards_) {
+    loads.push_back({shard->shard_index_, shard->active_connections_,
+                     shard->total_connections_});
+  }
+  return loads;
+}
+
+std::vector<ThreadCpuTime> PeerConnectionDependencyFactory::GetThreadCpuTimes() {
+  std::vector<rtc::scoped_refptr<PeerConnectionDependencyFactory>> factories;
+  {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    if (shards_.empty() && dependency_factory_ != nullptr)
+      factories.push_back(dependency_factory_);
+    factories.insert(factories.end(), shards_.begin(), shards_.end());
+  }
+  std::vector<ThreadCpuTime> cpu_times;
+  for (const auto& factory : factories) {
+    for (rtc::Thread* thread :
+         {factory->pc_thread_.get(), factory->signaling_thread.get(),
+          factory->worker_thread.get(), factory->network_thread.get()}) {
+      if (thread == nullptr)
+        continue;
+      ThreadCpuTime cpu_time;
+      cpu_time.thread_name = thread->name();
+      cpu_time.cpu_time_us = thread->Invoke<int64_t>(
+          RTC_FROM_HERE, [] { return CurrentThreadCpuTimeUs(); });
+      cpu_times.push_back(cpu_time);
+    }
+  }
+  return cpu_times;
+}
+
+void PeerConnectionDependencyFactory::ConfigurePeerConnectionPools(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+    size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    pool_configuration_ = config;
+    pool_size_ = size;
+  }
+  // Shards created later apply the configuration when they are created.
+  std::vector<rtc::scoped_refptr<PeerConnectionDependencyFactory>> factories;
+  factories.push_back(Get());
+  {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (size_t i = 1; i < shards_.size(); i++)
+      factories.push_back(shards_[i]);
+  }
+  for (const auto& factory : factories) {
+    factory->pc_thread_->PostTask(RTC_FROM_HERE, [factory, config, size] {
+      factory->pool_->Configure(config, size);
+    });
+  }
+}
+
+PeerConnectionPoolStats
+PeerConnectionDependencyFactory::GetPeerConnectionPoolStats() {
+  std::vector<rtc::scoped_refptr<PeerConnectionDependencyFactory>> factories;
+  {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    if (shards_.empty() && dependency_factory_ != nullptr)
+      factories.push_back(dependency_factory_);
+    factories.insert(factories.end(), shards_.begin(), shards_.end());
+  }
+  PeerConnectionPoolStats stats;
+  for (const auto& factory : factories) {
+    PeerConnectionPoolStats shard_stats =
+        factory->pc_thread_->Invoke<PeerConnectionPoolStats>(
+            RTC_FROM_HERE, [&factory] { return factory->pool_->GetStats(); });
+    stats.available += shard_stats.available;
+    stats.hits += shard_stats.hits;
+    stats.misses += shard_stats.misses;
+    stats.create_call_time_ms += shard_stats.create_call_time_ms;
+    stats.head_start_time_ms += shard_stats.head_start_time_ms;
+  }
+  return stats;
+}
+
+rtc::scoped_refptr<webrtc::PeerConnectionInterface>
+PeerConnectionDependencyFactory::TakePooledPeerConnection(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+    webrtc::PeerConnectionObserver* observer,
+    std::unique_ptr<PooledPeerConnectionObserver>* pooled_observer) {
+  RTC_CHECK(pc_thread_);
+  return pc_thread_->Invoke<scoped_refptr<webrtc::PeerConnectionInterface>>(
+      RTC_FROM_HERE, [this, &config, observer, pooled_observer] {
+        return pool_->Take(config, observer, pooled_observer);
+      });
+}
+
+void PeerConnectionDependencyFactory::TakePooledPeerConnectionAsync(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+    webrtc::PeerConnectionObserver* observer,
+    std::function<void(rtc::scoped_refptr<webrtc::PeerConnectionInterface>,
+                       std::unique_ptr<PooledPeerConnectionObserver>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, config, observer, on_complete] {
+    std::unique_ptr<PooledPeerConnectionObserver> pooled_observer;
+    auto peer_connection =
+        self->pool_->Take(config, observer, &pooled_observer);
+    if (on_complete)
+      on_complete(peer_connection, std::move(pooled_observer));
+  });
+}
+
+void PeerConnectionDependencyFactory::ApplyThreadSettings(
+    rtc::Thread* thread,
+    const ThreadSettings& settings) {
+  bool result = thread->Invoke<bool>(RTC_FROM_HERE, [settings] {
+    return ApplyCurrentThreadSettings(settings);
+  });
+  if (!result) {
+    RTC_LOG(LS_WARNING) << "Thread settings are not fully applied to "
+                        << thread->name();
+  }
+}
+
+rtc::Thread* PeerConnectionDependencyFactory::GetSignalingThread() {
+  return signaling_thread ? signaling_thread.get() : pc_thread_.get();
+}
+
 void PeerConnectionDependencyFactory::Reset() {
+  {
+    // Shards other than |dependency_factory_| are released here.
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    shards_.clear();
+    next_shard_ = 0;
+  }
   if (dependency_factory_ == nullptr)
     return;
 
   MediaCapabilities::Reset();
   MSDKFactory::Reset();
 
+  PeerConnectionDependencyFactory* factory = dependency_factory_.get();
+  factory->pc_thread_->Invoke<void>(RTC_FROM_HERE,
+                                    [factory] { factory->pool_.reset(); });
   dependency_factory_->pc_factory_->Release();
   dependency_factory_->pc_factory_.release();
 
@@ -192,28 +421,82 @@ void PeerConnectionDependencyFactory::
   int h264_temporal_layers = GlobalConfiguration::GetH264TemporalLayers();
   field_trial_ +=
       "OWT-H264TemporalLayers/" + std::to_string(h264_temporal_layers) + std::string("/");
-  webrtc::field_trial::InitFieldTrialsFromString(field_trial_.c_str());
-  if (!rtc::InitializeSSL()) {
-    RTC_LOG(LS_ERROR) << "Failed to initialize SSL.";
-    RTC_NOTREACHED();
-    return;
+  // Field trials and SSL are process wide, they are initialized by the
+  // default factory only.
+  if (shard_index_ == 0) {
+    webrtc::field_trial::InitFieldTrialsFromString(field_trial_.c_str());
+    if (!rtc::InitializeSSL()) {
+      RTC_LOG(LS_ERROR) << "Failed to initialize SSL.";
+      RTC_NOTREACHED();
+      return;
+    }
+  }
+  const CertificateCacheConfiguration& certificate_cache_configuration =
+      GlobalConfiguration::GetCertificateCacheConfiguration();
+  if (certificate_cache_configuration.enabled) {
+    if (shard_index_ == 0) {
+      certificate_cache_ =
+          std::make_shared<CertificateCache>(certificate_cache_configuration);
+      certificate_cache_->Start();
+    } else {
+      certificate_cache_ = dependency_factory_->certificate_cache_;
+    }
   }
+  const ThreadModelConfiguration& thread_model =
+      GlobalConfiguration::GetThreadModelConfiguration();
   worker_thread = rtc::Thread::CreateWithSocketServer();
 
-  worker_thread->SetName("worker_thread", nullptr);
-  signaling_thread = rtc::Thread::CreateWithSocketServer();
+  worker_thread->SetName(ShardThreadName("worker_thread", shard_index_),
+                         nullptr);
+  // When signaling is merged, this method is running on the thread that
+  // becomes the signaling thread.
+  if (!thread_model.merge_signaling_thread) {
+    signaling_thread = rtc::Thread::CreateWithSocketServer();
 
-  signaling_thread->SetName("signaling_thread", nullptr);
+    signaling_thread->SetName(
+        ShardThreadName("signaling_thread", shard_index_), nullptr);
+  }
   network_thread = rtc::Thread::CreateWithSocketServer();
 
-  network_thread->SetName("network_thread", nullptr);
-  RTC_CHECK(worker_thread->Start() && signaling_thread->Start() &&
+  network_thread->SetName(ShardThreadName("network_thread", shard_index_),
+                          nullptr);
+  RTC_CHECK(worker_thread->Start() &&
+            (!signaling_thread || signaling_thread->Start()) &&
             network_thread->Start())
       << "Failed to start threads";
+  ApplyThreadSettings(worker_thread.get(), thread_model.worker_thread);
+  ApplyThreadSettings(network_thread.get(), thread_model.network_thread);
+  if (signaling_thread)
+    ApplyThreadSettings(signaling_thread.get(), thread_model.signaling_thread);
+  if (ThreadLagMonitor* monitor = ThreadLagMonitor::Get()) {
+    for (rtc::Thread* thread : {worker_thread.get(), signaling_thread.get(),
+                                network_thread.get()}) {
+      if (thread != nullptr)
+        monitor->AddThread(thread, thread->name());
+    }
+  }
 
   network_manager_ = std::make_shared<rtc::BasicNetworkManager>();
-  packet_socket_factory_ =
-      std::make_shared<rtc::BasicPacketSocketFactory>(network_thread.get());
+  // Factory of UDP sockets. Null means rtc::BasicPacketSocketFactory.
+  std::unique_ptr<rtc::BasicPacketSocketFactory> udp_socket_factory;
+#if defined(WEBRTC_LINUX)
+  if (GlobalConfiguration::GetBatchedUdpSocketEnabled()) {
+    udp_socket_factory =
+        std::make_unique<BatchedPacketSocketFactory>(network_thread.get());
+  }
+#endif
+  if (GlobalConfiguration::GetUdpMuxEnabled()) {
+    uint16_t mux_port = GlobalConfiguration::GetUdpMuxPort();
+    if (mux_port != 0)
+      mux_port += static_cast<uint16_t>(shard_index_);
+    packet_socket_factory_ = std::make_shared<UdpMuxSocketFactory>(
+        network_thread.get(), mux_port, std::move(udp_socket_factory));
+  } else if (udp_socket_factory) {
+    packet_socket_factory_ = std::move(udp_socket_factory);
+  } else {
+    packet_socket_factory_ =
+        std::make_shared<rtc::BasicPacketSocketFactory>(network_thread.get());
+  }
 
   // Use webrtc::VideoEn(De)coderFactory on iOS.
   std::unique_ptr<webrtc::VideoEncoderFactory> encoder_factory;
@@ -259,45 +542,47 @@ void PeerConnectionDependencyFactory::
 #error "Unsupported platform."
 #endif
   rtc::scoped_refptr<AudioDeviceModule> adm;
-
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
-  // Raw audio frame
-  // if adm is nullptr, voe_base will initilize it with the default internal
-  // adm.
-  if (GlobalConfiguration::GetCustomizedAudioInputEnabled()) {
-    // Create ADM on worker thread as RegisterAudioCallback is invoked there.
-    adm = worker_thread->Invoke<rtc::scoped_refptr<AudioDeviceModule>>(
-        RTC_FROM_HERE,
-        Bind(&PeerConnectionDependencyFactory::
-                 CreateCustomizedAudioDeviceModuleOnCurrentThread,
-             this));
-  } else {
-#if defined(WEBRTC_WIN)
-    // For Widnows we create the audio device with non audio_device_impl
-    // dependent factory to facilitate switching of playback devices.
-    task_queue_factory_ = CreateDefaultTaskQueueFactory();
-    com_initializer_ = std::make_unique<webrtc::ScopedCOMInitializer>(
-        webrtc::ScopedCOMInitializer::kMTA);
-    if (com_initializer_->Succeeded()) {
-      // Ensures that the adm is used on the same thread as it is constructed
-      adm = worker_thread->Invoke<rtc::scoped_refptr<AudioDeviceModule>>(
-          RTC_FROM_HERE, [&] {
-            return CreateWindowsCoreAudioAudioDeviceModule(
-                task_queue_factory_.get(), true);
-          });
+  // With sharded factories, all shards capture and play audio through the
+  // device module of the default factory. Local tracks are created by the
+  // default factory and may be added to connections of any shard, as audio of
+  // local tracks is captured by the shared device.
+  if (shard_index_ == 0 &&
+      GlobalConfiguration::GetPeerConnectionFactoryShards() > 1) {
+    shared_audio_device_ = std::make_shared<SharedAudioDevice>();
+    if (!shared_audio_device_->SetDeviceModule(
+            CreateAudioDeviceModule(shared_audio_device_->thread()))) {
+      shared_audio_device_.reset();
     }
-#endif
+  } else if (shard_index_ > 0) {
+    shared_audio_device_ = dependency_factory_->shared_audio_device_;
+  }
+  if (shared_audio_device_) {
+    adm = shared_audio_device_->CreateShardModule();
+    adm_ = shared_audio_device_->DeviceModule();
+  } else {
+    adm = CreateAudioDeviceModule(worker_thread.get());
+    adm_ = adm;
   }
 #endif
 
-  adm_ = adm;
-
   pc_factory_ = webrtc::CreatePeerConnectionFactory(
-      network_thread.get(), worker_thread.get(), signaling_thread.get(), adm,
+      network_thread.get(), worker_thread.get(), GetSignalingThread(), adm,
       webrtc::CreateBuiltinAudioEncoderFactory(),
       webrtc::CreateBuiltinAudioDecoderFactory(), std::move(encoder_factory),
       std::move(decoder_factory), nullptr, nullptr);
   // pc_factory_->AddRef();
+  pool_ = std::make_unique<PeerConnectionPool>(
+      pc_thread_.get(),
+      [this](const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+             webrtc::PeerConnectionObserver* observer) {
+        return CreatePeerConnectionOnCurrentThread(config, observer);
+      });
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (pool_size_ > 0)
+      pool_->Configure(pool_configuration_, pool_size_);
+  }
   RTC_LOG(LS_INFO) << "CreatePeerConnectionOnCurrentThread finished.";
 }
 
@@ -331,7 +616,16 @@ PeerConnectionDependencyFactory::CreatePeerConnectionOnCurrentThread(
     port_allocator->SetDataPortRange(ice_port_ranges.data.min,
                                      ice_port_ranges.data.max);
   }
-  return (pc_factory_->CreatePeerConnection(config, std::move(port_allocator),
+  webrtc::PeerConnectionInterface::RTCConfiguration pc_config(config);
+  // Without a certificate, PeerConnection generates one by itself.
+  if (certificate_cache_ && pc_config.certificates.empty()) {
+    rtc::scoped_refptr<rtc::RTCCertificate> certificate =
+        certificate_cache_->GetCertificate();
+    if (certificate)
+      pc_config.certificates.push_back(certificate);
+  }
+  return (pc_factory_->CreatePeerConnection(pc_config,
+                                            std::move(port_allocator),
                                             nullptr, observer))
       .get();
 }
@@ -367,6 +661,47 @@ PeerConnectionDependencyFactory::CreateLocalVideoTrack(
 }
 scoped_refptr<AudioTrackInterface>
 PeerConnectionDependencyFactory::CreateLocalAudioTrack(const std::string& id) {
+  return pc_thread_
+      ->Invoke<scoped_refptr<AudioTrackInterface>>(
+          RTC_FROM_HERE,
+          Bind(&PeerConnectionDependencyFactory::
+                   CreateLocalAudioTrackOnCurrentThread,
+               this, id))
+      .get();
+}
+scoped_refptr<AudioTrackInterface>
+PeerConnectionDependencyFactory::CreateShardAudioTrack(
+    AudioTrackInterface* track) {
+  if (shard_index_ == 0)
+    return track;
+  // Audio is captured by the device module shared by all shards, the source
+  // only carries options.
+  scoped_refptr<AudioTrackInterface> shard_track =
+      CreateLocalAudioTrack(track->id(), track->GetSource());
+  if (shard_track)
+    shard_track->set_enabled(track->enabled());
+  return shard_track;
+}
+scoped_refptr<VideoTrackInterface>
+PeerConnectionDependencyFactory::CreateShardVideoTrack(
+    VideoTrackInterface* track) {
+  if (shard_index_ == 0)
+    return track;
+  // Sources expect sinks to be added on one worker thread.
+  PeerConnectionDependencyFactory* default_factory = Get();
+  scoped_refptr<VideoTrackSourceInterface> source =
+      webrtc::VideoTrackSourceProxy::Create(
+          default_factory->GetSignalingThread(),
+          default_factory->worker_thread.get(), track->GetSource());
+  scoped_refptr<VideoTrackInterface> shard_track =
+      CreateLocalVideoTrack(track->id(), source);
+  if (shard_track)
+    shard_track->set_enabled(track->enabled());
+  return shard_track;
+}
+scoped_refptr<AudioTrackInterface>
+PeerConnectionDependencyFactory::CreateLocalAudioTrackOnCurrentThread(
+    const std::string& id) {
   bool aec_enabled, agc_enabled, ns_enabled;
   aec_enabled = GlobalConfiguration::GetAECEnabled();
   agc_enabled = GlobalConfiguration::GetAGCEnabled();
@@ -381,20 +716,10 @@ PeerConnectionDependencyFactory::CreateLocalAudioTrack(const std::string& id) {
     options.residual_echo_detector =
         absl::optional<bool>(aec_enabled ? true : false);
     scoped_refptr<webrtc::AudioSourceInterface> audio_source =
-        CreateAudioSource(options);
-    return pc_thread_
-        ->Invoke<scoped_refptr<AudioTrackInterface>>(
-            RTC_FROM_HERE,
-            Bind(&PeerConnectionFactoryInterface::CreateAudioTrack,
-                 pc_factory_.get(), id, audio_source.get()))
-        .get();
+        pc_factory_->CreateAudioSource(options);
+    return pc_factory_->CreateAudioTrack(id, audio_source.get());
   } else {
-    return pc_thread_
-        ->Invoke<scoped_refptr<AudioTrackInterface>>(
-            RTC_FROM_HERE,
-            Bind(&PeerConnectionFactoryInterface::CreateAudioTrack,
-                 pc_factory_.get(), id, nullptr))
-        .get();
+    return pc_factory_->CreateAudioTrack(id, nullptr);
   }
 }
 scoped_refptr<AudioTrackInterface>
@@ -420,6 +745,96 @@ PeerConnectionDependencyFactory::CreateAudioSource(
                pc_factory_.get(), options))
       .get();
 }
+void PeerConnectionDependencyFactory::CreatePeerConnectionAsync(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+    webrtc::PeerConnectionObserver* observer,
+    std::function<void(rtc::scoped_refptr<webrtc::PeerConnectionInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, config, observer, on_complete] {
+    auto peer_connection =
+        self->CreatePeerConnectionOnCurrentThread(config, observer);
+    if (on_complete)
+      on_complete(peer_connection);
+  });
+}
+void PeerConnectionDependencyFactory::CreateLocalMediaStreamAsync(
+    const std::string& label,
+    std::function<void(rtc::scoped_refptr<MediaStreamInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, label, on_complete] {
+    auto stream = self->pc_factory_->CreateLocalMediaStream(label);
+    if (on_complete)
+      on_complete(stream);
+  });
+}
+void PeerConnectionDependencyFactory::CreateLocalAudioTrackAsync(
+    const std::string& id,
+    std::function<void(rtc::scoped_refptr<AudioTrackInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, id, on_complete] {
+    auto track = self->CreateLocalAudioTrackOnCurrentThread(id);
+    if (on_complete)
+      on_complete(track);
+  });
+}
+void PeerConnectionDependencyFactory::CreateLocalAudioTrackAsync(
+    const std::string& id,
+    webrtc::AudioSourceInterface* audio_source,
+    std::function<void(rtc::scoped_refptr<AudioTrackInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  rtc::scoped_refptr<webrtc::AudioSourceInterface> source(audio_source);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, id, source, on_complete] {
+    auto track = self->pc_factory_->CreateAudioTrack(id, source.get());
+    if (on_complete)
+      on_complete(track);
+  });
+}
+void PeerConnectionDependencyFactory::CreateLocalVideoTrackAsync(
+    const std::string& id,
+    webrtc::VideoTrackSourceInterface* video_source,
+    std::function<void(rtc::scoped_refptr<VideoTrackInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  rtc::scoped_refptr<webrtc::VideoTrackSourceInterface> source(video_source);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, id, source, on_complete] {
+    auto track = self->pc_factory_->CreateVideoTrack(id, source.get());
+    if (on_complete)
+      on_complete(track);
+  });
+}
+void PeerConnectionDependencyFactory::CreateAudioSourceAsync(
+    const cricket::AudioOptions& options,
+    std::function<void(rtc::scoped_refptr<AudioSourceInterface>)>
+        on_complete) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, options, on_complete] {
+    auto source = self->pc_factory_->CreateAudioSource(options);
+    if (on_complete)
+      on_complete(source);
+  });
+}
+void PeerConnectionDependencyFactory::ClosePeerConnectionAsync(
+    rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection,
+    std::function<void()> on_closed) {
+  RTC_CHECK(pc_thread_);
+  rtc::scoped_refptr<PeerConnectionDependencyFactory> self(this);
+  pc_thread_->PostTask(RTC_FROM_HERE, [self, peer_connection, on_closed] {
+    if (peer_connection)
+      peer_connection->Close();
+    if (on_closed)
+      on_closed();
+  });
+}
 rtc::scoped_refptr<PeerConnectionFactoryInterface>
 PeerConnectionDependencyFactory::PeerConnectionFactory() const {
   return pc_factory_;
@@ -433,8 +848,44 @@ scoped_refptr<webrtc::AudioDeviceModule> PeerConnectionDependencyFactory::
 }
 #endif
 
+rtc::scoped_refptr<AudioDeviceModule>
+PeerConnectionDependencyFactory::CreateAudioDeviceModule(rtc::Thread* thread) {
+  rtc::scoped_refptr<AudioDeviceModule> adm;
+  // Raw audio frame
+  // if adm is nullptr, voe_base will initilize it with the default internal
+  // adm.
+  if (GlobalConfiguration::GetCustomizedAudioInputEnabled()) {
+    // Create ADM on |thread| as RegisterAudioCallback is invoked there.
+    adm = thread->Invoke<rtc::scoped_refptr<AudioDeviceModule>>(
+        RTC_FROM_HERE,
+        Bind(&PeerConnectionDependencyFactory::
+                 CreateCustomizedAudioDeviceModuleOnCurrentThread,
+             this));
+  } else {
+#if defined(WEBRTC_WIN)
+    // For Widnows we create the audio device with non audio_device_impl
+    // dependent factory to facilitate switching of playback devices.
+    task_queue_factory_ = CreateDefaultTaskQueueFactory();
+    com_initializer_ = std::make_unique<webrtc::ScopedCOMInitializer>(
+        webrtc::ScopedCOMInitializer::kMTA);
+    if (com_initializer_->Succeeded()) {
+      // Ensures that the adm is used on the same thread as it is constructed
+      adm = thread->Invoke<rtc::scoped_refptr<AudioDeviceModule>>(
+          RTC_FROM_HERE, [&] {
+            return CreateWindowsCoreAudioAudioDeviceModule(
+                task_queue_factory_.get(), true);
+          });
+    }
+#endif
+  }
+  return adm;
+}
+
 int PeerConnectionDependencyFactory::SelectRecordingDevice(int index) {
-  int r = worker_thread->Invoke<int>(
+  // The shared device module is only used on its own thread.
+  rtc::Thread* thread = shared_audio_device_ ? shared_audio_device_->thread()
+                                             : worker_thread.get();
+  int r = thread->Invoke<int>(
       RTC_FROM_HERE, Bind(&PeerConnectionDependencyFactory::SelectRecordingDeviceOnWorkThread,
                           this, index));
   return r;
@@ -3,7 +3,10 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef OWT_BASE_PEERCONNECTIONDEPENDENCYFACTORY_H_
 #define OWT_BASE_PEERCONNECTIONDEPENDENCYFACTORY_H_
+#include <atomic>
+#include <functional>
 #include <mutex>
+#include <vector>
 #include "webrtc/api/peer_connection_interface.h"
 #include "webrtc/api/media_stream_interface.h"
 #if defined(WEBRTC_WIN)
@@ -14,6 +17,9 @@
 #include "webrtc/rtc_base/bind.h"
 #include "webrtc/rtc_base/network.h"
 #include "webrtc/p2p/base/basic_packet_socket_factory.h"
+#include "owt/base/globalconfiguration.h"
+#include "talk/owt/sdk/base/certificatecache.h"
+#include "talk/owt/sdk/base/peerconnectionpool.h"
 namespace owt {
 namespace base {
 using webrtc::MediaStreamInterface;
@@ -27,6 +33,7 @@ using webrtc::MediaConstraints;
 using rtc::scoped_refptr;
 using rtc::Thread;
 using rtc::Bind;
+class SharedAudioDevice;
 // PeerConnectionThread allows blocking calls so other thread can invoke
 // synchronized methods on this thread.
 class PeerConnectionThread : public rtc::Thread {
@@ -40,8 +47,28 @@ class PeerConnectionDependencyFactory : public rtc::RefCountInterface {
   // Get a PeerConnectionDependencyFactory instance. It doesn't create a new
   // instance. It always return the same instance.
   static PeerConnectionDependencyFactory* Get();
-  // Reset this singleton instance
+  // Reset this singleton instance and all factory shards.
   static void Reset();
+  // Get a factory for a new connection. If sharding is enabled by
+  // GlobalConfiguration::SetPeerConnectionFactoryShards, a shard is picked by
+  // the configured policy, otherwise Get() is returned. The connection count
+  // of returned factory is increased, call ReleaseConnection() when the
+  // connection is closed.
+  static PeerConnectionDependencyFactory* AcquireForNewConnection();
+  // Decrease connection count increased by AcquireForNewConnection().
+  void ReleaseConnection();
+  // Load counters of all factory shards created so far.
+  static std::vector<FactoryShardLoad> GetShardLoads();
+  // CPU time of threads owned by all factory shards. Blocks until each thread
+  // has processed the query.
+  static std::vector<ThreadCpuTime> GetThreadCpuTimes();
+  // Keep |size| PeerConnections created with |config| in the pool of every
+  // factory shard. Size 0 disables the pool.
+  static void ConfigurePeerConnectionPools(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+      size_t size);
+  // Sum of pool counters of all factory shards.
+  static PeerConnectionPoolStats GetPeerConnectionPoolStats();
 
   rtc::scoped_refptr<webrtc::PeerConnectionInterface> CreatePeerConnection(
       const webrtc::PeerConnectionInterface::RTCConfiguration& config,
@@ -59,6 +86,64 @@ class PeerConnectionDependencyFactory : public rtc::RefCountInterface {
       webrtc::VideoTrackSourceInterface* video_source);
   rtc::scoped_refptr<AudioSourceInterface> CreateAudioSource(
       const cricket::AudioOptions& options);
+  // Local tracks are created by the default factory. These return a track of
+  // this factory with the ID, source and enabled state of |track|, so a shard
+  // does not drive tracks of another shard's threads. |track| is returned if
+  // this is the default factory. Sinks of a video source are still added on
+  // the worker thread of the default factory, as they are for |track|.
+  rtc::scoped_refptr<AudioTrackInterface> CreateShardAudioTrack(
+      AudioTrackInterface* track);
+  rtc::scoped_refptr<VideoTrackInterface> CreateShardVideoTrack(
+      VideoTrackInterface* track);
+  // Asynchronous versions of the methods above. They return immediately and
+  // |on_complete| is invoked on the factory thread once the object is
+  // created, so callers are never blocked behind other callers. Callbacks
+  // should not block as they delay other requests queued on this factory.
+  void CreatePeerConnectionAsync(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+      webrtc::PeerConnectionObserver* observer,
+      std::function<void(rtc::scoped_refptr<webrtc::PeerConnectionInterface>)>
+          on_complete);
+  void CreateLocalMediaStreamAsync(
+      const std::string& label,
+      std::function<void(rtc::scoped_refptr<MediaStreamInterface>)>
+          on_complete);
+  void CreateLocalAudioTrackAsync(
+      const std::string& id,
+      std::function<void(rtc::scoped_refptr<AudioTrackInterface>)>
+          on_complete);
+  void CreateLocalAudioTrackAsync(
+      const std::string& id,
+      webrtc::AudioSourceInterface* audio_source,
+      std::function<void(rtc::scoped_refptr<AudioTrackInterface>)>
+          on_complete);
+  void CreateLocalVideoTrackAsync(
+      const std::string& id,
+      webrtc::VideoTrackSourceInterface* video_source,
+      std::function<void(rtc::scoped_refptr<VideoTrackInterface>)>
+          on_complete);
+  void CreateAudioSourceAsync(
+      const cricket::AudioOptions& options,
+      std::function<void(rtc::scoped_refptr<AudioSourceInterface>)>
+          on_complete);
+  // Take a pre-created PeerConnection matching |config| from the pool and
+  // direct its events to |observer|. Returns nullptr if none is available.
+  // |pooled_observer| must outlive the returned PeerConnection.
+  rtc::scoped_refptr<webrtc::PeerConnectionInterface> TakePooledPeerConnection(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+      webrtc::PeerConnectionObserver* observer,
+      std::unique_ptr<PooledPeerConnectionObserver>* pooled_observer);
+  void TakePooledPeerConnectionAsync(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& config,
+      webrtc::PeerConnectionObserver* observer,
+      std::function<void(rtc::scoped_refptr<webrtc::PeerConnectionInterface>,
+                         std::unique_ptr<PooledPeerConnectionObserver>)>
+          on_complete);
+  // Close |peer_connection| without blocking the caller. |on_closed| is
+  // invoked on the factory thread after the PeerConnection is closed.
+  void ClosePeerConnectionAsync(
+      rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection,
+      std::function<void()> on_closed);
   // Returns current |pc_factory_|.
   rtc::scoped_refptr<PeerConnectionFactoryInterface> PeerConnectionFactory()
       const;
@@ -68,7 +153,7 @@ class PeerConnectionDependencyFactory : public rtc::RefCountInterface {
 
   ~PeerConnectionDependencyFactory();
  protected:
-  explicit PeerConnectionDependencyFactory();
+  explicit PeerConnectionDependencyFactory(int shard_index = 0);
   virtual const rtc::scoped_refptr<PeerConnectionFactoryInterface>&
   GetPeerConnectionFactory();
  private:
@@ -76,24 +161,56 @@ class PeerConnectionDependencyFactory : public rtc::RefCountInterface {
   // static rtc::scoped_refptr<PeerConnectionDependencyFactory> Create();
   void CreatePeerConnectionFactory();
   void CreatePeerConnectionFactoryOnCurrentThread();
+  // Apply |settings| on |thread|. Failures are logged.
+  static void ApplyThreadSettings(rtc::Thread* thread,
+                                  const ThreadSettings& settings);
+  // Returns |signaling_thread|, or |pc_thread_| if signaling is merged.
+  rtc::Thread* GetSignalingThread();
   rtc::scoped_refptr<webrtc::PeerConnectionInterface>
   CreatePeerConnectionOnCurrentThread(
       const webrtc::PeerConnectionInterface::RTCConfiguration& config,
       webrtc::PeerConnectionObserver* observer);
+  rtc::scoped_refptr<AudioTrackInterface> CreateLocalAudioTrackOnCurrentThread(
+      const std::string& id);
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
   rtc::scoped_refptr<webrtc::AudioDeviceModule> CreateCustomizedAudioDeviceModuleOnCurrentThread();
   int SelectRecordingDeviceOnWorkThread(int index);
+  // Creates the device module on |thread|. Returns nullptr if WebRTC's default
+  // module should be used.
+  rtc::scoped_refptr<AudioDeviceModule> CreateAudioDeviceModule(
+      rtc::Thread* thread);
 #endif
   scoped_refptr<PeerConnectionFactoryInterface> pc_factory_;
   static scoped_refptr<PeerConnectionDependencyFactory>
       dependency_factory_;  // Get() always return this instance.
-  // Export adm instance to select audio device.
+  // Factory shards. |shards_[0]| is |dependency_factory_|.
+  static std::vector<scoped_refptr<PeerConnectionDependencyFactory>> shards_;
+  static std::mutex shards_mutex_;
+  static size_t next_shard_;
+  const int shard_index_;
+  std::atomic<int> active_connections_;
+  std::atomic<uint64_t> total_connections_;
+  // Pool configuration applied to every factory shard.
+  static webrtc::PeerConnectionInterface::RTCConfiguration pool_configuration_;
+  static size_t pool_size_;
+  static std::mutex pool_mutex_;
+  // Created and used on |pc_thread_|.
+  std::unique_ptr<PeerConnectionPool> pool_;
+  // Created by the default factory and shared by all shards. Null if the
+  // certificate cache is disabled.
+  std::shared_ptr<CertificateCache> certificate_cache_;
+  // Export adm instance to select audio device. With sharded factories, this
+  // is the module shared by all shards.
   rtc::scoped_refptr<AudioDeviceModule> adm_;
+#if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
+  // Created by the default factory if sharding is enabled, and shared by all
+  // shards.
+  std::shared_ptr<SharedAudioDevice> shared_audio_device_;
+#endif
   // This thread performs all operations on pcfactory and pc.
   std::unique_ptr<Thread> pc_thread_;
-  // This thread performs all callbacks.
-  std::unique_ptr<Thread> callback_thread_;
   std::unique_ptr<rtc::Thread> worker_thread;
+  // Null if signaling is merged into |pc_thread_|.
   std::unique_ptr<rtc::Thread> signaling_thread;
   std::unique_ptr<rtc::Thread> network_thread;
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
@@ -0,0 +1,210 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/peerconnectionpool.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+void PooledPeerConnectionObserver::OnSignalingChange(
+    webrtc::PeerConnectionInterface::SignalingState new_state) {
+  if (auto* target = target_.load())
+    target->OnSignalingChange(new_state);
+}
+
+void PooledPeerConnectionObserver::OnAddStream(
+    rtc::scoped_refptr<webrtc::MediaStreamInterface> stream) {
+  if (auto* target = target_.load())
+    target->OnAddStream(stream);
+}
+
+void PooledPeerConnectionObserver::OnRemoveStream(
+    rtc::scoped_refptr<webrtc::MediaStreamInterface> stream) {
+  if (auto* target = target_.load())
+    target->OnRemoveStream(stream);
+}
+
+void PooledPeerConnectionObserver::OnDataChannel(
+    rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel) {
+  if (auto* target = target_.load())
+    target->OnDataChannel(data_channel);
+}
+
+void PooledPeerConnectionObserver::OnRenegotiationNeeded() {
+  if (auto* target = target_.load())
+    target->OnRenegotiationNeeded();
+}
+
+void PooledPeerConnectionObserver::OnIceConnectionChange(
+    webrtc::PeerConnectionInterface::IceConnectionState new_state) {
+  if (auto* target = target_.load())
+    target->OnIceConnectionChange(new_state);
+}
+
+void PooledPeerConnectionObserver::OnStandardizedIceConnectionChange(
+    webrtc::PeerConnectionInterface::IceConnectionState new_state) {
+  if (auto* target = target_.load())
+    target->OnStandardizedIceConnectionChange(new_state);
+}
+
+void PooledPeerConnectionObserver::OnConnectionChange(
+    webrtc::PeerConnectionInterface::PeerConnectionState new_state) {
+  if (auto* target = target_.load())
+    target->OnConnectionChange(new_state);
+}
+
+void PooledPeerConnectionObserver::OnIceGatheringChange(
+    webrtc::PeerConnectionInterface::IceGatheringState new_state) {
+  if (auto* target = target_.load())
+    target->OnIceGatheringChange(new_state);
+}
+
+void PooledPeerConnectionObserver::OnIceCandidate(
+    const webrtc::IceCandidateInterface* candidate) {
+  if (auto* target = target_.load())
+    target->OnIceCandidate(candidate);
+}
+
+void PooledPeerConnectionObserver::OnIceCandidatesRemoved(
+    const std::vector<cricket::Candidate>& candidates) {
+  if (auto* target = target_.load())
+    target->OnIceCandidatesRemoved(candidates);
+}
+
+void PooledPeerConnectionObserver::OnIceConnectionReceivingChange(
+    bool receiving) {
+  if (auto* target = target_.load())
+    target->OnIceConnectionReceivingChange(receiving);
+}
+
+void PooledPeerConnectionObserver::OnAddTrack(
+    rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
+    const std::vector<rtc::scoped_refptr<webrtc::MediaStreamInterface>>&
+        streams) {
+  if (auto* target = target_.load())
+    target->OnAddTrack(receiver, streams);
+}
+
+void PooledPeerConnectionObserver::OnTrack(
+    rtc::scoped_refptr<webrtc::RtpTransceiverInterface> transceiver) {
+  if (auto* target = target_.load())
+    target->OnTrack(transceiver);
+}
+
+void PooledPeerConnectionObserver::OnRemoveTrack(
+    rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver) {
+  if (auto* target = target_.load())
+    target->OnRemoveTrack(receiver);
+}
+
+PeerConnectionPool::PeerConnectionPool(rtc::Thread* thread,
+                                       CreateFunction create)
+    : thread_(thread),
+      create_(std::move(create)),
+      size_(0),
+      refill_scheduled_(false),
+      hits_(0),
+      misses_(0),
+      create_call_time_ms_(0),
+      head_start_time_ms_(0) {}
+
+PeerConnectionPool::~PeerConnectionPool() {
+  Clear();
+}
+
+webrtc::PeerConnectionInterface::RTCConfiguration
+PeerConnectionPool::PoolConfiguration(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& configuration) {
+  webrtc::PeerConnectionInterface::RTCConfiguration pool_configuration(
+      configuration);
+  if (pool_configuration.ice_candidate_pool_size < 1)
+    pool_configuration.ice_candidate_pool_size = 1;
+  return pool_configuration;
+}
+
+void PeerConnectionPool::Configure(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& configuration,
+    size_t size) {
+  RTC_DCHECK(thread_->IsCurrent());
+  webrtc::PeerConnectionInterface::RTCConfiguration pool_configuration =
+      PoolConfiguration(configuration);
+  if (!(pool_configuration == configuration_))
+    Clear();
+  configuration_ = pool_configuration;
+  size_ = size;
+  while (entries_.size() > size_) {
+    entries_.back().peer_connection->Close();
+    entries_.pop_back();
+  }
+  ScheduleRefill();
+}
+
+rtc::scoped_refptr<webrtc::PeerConnectionInterface> PeerConnectionPool::Take(
+    const webrtc::PeerConnectionInterface::RTCConfiguration& configuration,
+    webrtc::PeerConnectionObserver* observer,
+    std::unique_ptr<PooledPeerConnectionObserver>* pooled_observer) {
+  RTC_DCHECK(thread_->IsCurrent());
+  if (size_ == 0)
+    return nullptr;
+  if (entries_.empty() ||
+      !(PoolConfiguration(configuration) == configuration_)) {
+    misses_++;
+    return nullptr;
+  }
+  Entry entry = std::move(entries_.front());
+  entries_.pop_front();
+  hits_++;
+  create_call_time_ms_ += entry.create_call_time_ms;
+  head_start_time_ms_ += rtc::TimeMillis() - entry.created_ms;
+  entry.observer->SetTarget(observer);
+  *pooled_observer = std::move(entry.observer);
+  ScheduleRefill();
+  return entry.peer_connection;
+}
+
+PeerConnectionPoolStats PeerConnectionPool::GetStats() const {
+  PeerConnectionPoolStats stats;
+  stats.available = static_cast<int>(entries_.size());
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.create_call_time_ms = create_call_time_ms_;
+  stats.head_start_time_ms = head_start_time_ms_;
+  return stats;
+}
+
+void PeerConnectionPool::Clear() {
+  for (auto& entry : entries_)
+    entry.peer_connection->Close();
+  entries_.clear();
+}
+
+void PeerConnectionPool::ScheduleRefill() {
+  if (refill_scheduled_ || entries_.size() >= size_)
+    return;
+  refill_scheduled_ = true;
+  // One PeerConnection per task, so requests queued on |thread_| are not
+  // delayed behind the whole refill.
+  thread_->PostTask(
+      webrtc::ToQueuedTask(task_safety_.flag(), [this] { Refill(); }));
+}
+
+void PeerConnectionPool::Refill() {
+  refill_scheduled_ = false;
+  if (entries_.size() >= size_)
+    return;
+  Entry entry;
+  entry.observer = std::make_unique<PooledPeerConnectionObserver>();
+  int64_t start_ms = rtc::TimeMillis();
+  entry.peer_connection = create_(configuration_, entry.observer.get());
+  entry.created_ms = rtc::TimeMillis();
+  entry.create_call_time_ms = entry.created_ms - start_ms;
+  if (!entry.peer_connection) {
+    RTC_LOG(LS_WARNING) << "Failed to create pooled PeerConnection.";
+    return;
+  }
+  entries_.push_back(std::move(entry));
+  ScheduleRefill();
+}
+}
+}
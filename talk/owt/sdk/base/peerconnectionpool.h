@@ -0,0 +1,120 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_PEERCONNECTIONPOOL_H_
+#define OWT_BASE_PEERCONNECTIONPOOL_H_
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/api/peer_connection_interface.h"
+#include "webrtc/rtc_base/task_utils/pending_task_safety_flag.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// Forwards PeerConnectionObserver events to a target set after creation. A
+// pooled PeerConnection is created before its owner exists, so it observes
+// through this class until it is taken from the pool. Events before that are
+// dropped.
+class PooledPeerConnectionObserver : public webrtc::PeerConnectionObserver {
+ public:
+  PooledPeerConnectionObserver() : target_(nullptr) {}
+  void SetTarget(webrtc::PeerConnectionObserver* target) { target_ = target; }
+
+  // webrtc::PeerConnectionObserver
+  void OnSignalingChange(
+      webrtc::PeerConnectionInterface::SignalingState new_state) override;
+  void OnAddStream(
+      rtc::scoped_refptr<webrtc::MediaStreamInterface> stream) override;
+  void OnRemoveStream(
+      rtc::scoped_refptr<webrtc::MediaStreamInterface> stream) override;
+  void OnDataChannel(
+      rtc::scoped_refptr<webrtc::DataChannelInterface> data_channel) override;
+  void OnRenegotiationNeeded() override;
+  void OnIceConnectionChange(
+      webrtc::PeerConnectionInterface::IceConnectionState new_state) override;
+  void OnStandardizedIceConnectionChange(
+      webrtc::PeerConnectionInterface::IceConnectionState new_state) override;
+  void OnConnectionChange(
+      webrtc::PeerConnectionInterface::PeerConnectionState new_state) override;
+  void OnIceGatheringChange(
+      webrtc::PeerConnectionInterface::IceGatheringState new_state) override;
+  void OnIceCandidate(const webrtc::IceCandidateInterface* candidate) override;
+  void OnIceCandidatesRemoved(
+      const std::vector<cricket::Candidate>& candidates) override;
+  void OnIceConnectionReceivingChange(bool receiving) override;
+  void OnAddTrack(
+      rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver,
+      const std::vector<rtc::scoped_refptr<webrtc::MediaStreamInterface>>&
+          streams) override;
+  void OnTrack(
+      rtc::scoped_refptr<webrtc::RtpTransceiverInterface> transceiver) override;
+  void OnRemoveTrack(
+      rtc::scoped_refptr<webrtc::RtpReceiverInterface> receiver) override;
+
+ private:
+  std::atomic<webrtc::PeerConnectionObserver*> target_;
+};
+
+// Keeps PeerConnections created in advance, so certificate generation and
+// gathering of host and server reflexive candidates are done before a
+// connection is requested. All methods must be called on |thread|.
+class PeerConnectionPool {
+ public:
+  typedef std::function<rtc::scoped_refptr<webrtc::PeerConnectionInterface>(
+      const webrtc::PeerConnectionInterface::RTCConfiguration&,
+      webrtc::PeerConnectionObserver*)>
+      CreateFunction;
+  // |create| creates a PeerConnection on |thread|.
+  PeerConnectionPool(rtc::Thread* thread, CreateFunction create);
+  ~PeerConnectionPool();
+  // Keep |size| PeerConnections created with |configuration|. Pooled
+  // PeerConnections with a different configuration are dropped. Size 0
+  // disables the pool.
+  void Configure(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& configuration,
+      size_t size);
+  // Take a PeerConnection created with |configuration| and direct its events
+  // to |observer|. Returns nullptr if none is available. |pooled_observer|
+  // must outlive the returned PeerConnection.
+  rtc::scoped_refptr<webrtc::PeerConnectionInterface> Take(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& configuration,
+      webrtc::PeerConnectionObserver* observer,
+      std::unique_ptr<PooledPeerConnectionObserver>* pooled_observer);
+  PeerConnectionPoolStats GetStats() const;
+  // Close and drop all pooled PeerConnections.
+  void Clear();
+
+ private:
+  struct Entry {
+    // Declared first to be destroyed after |peer_connection|.
+    std::unique_ptr<PooledPeerConnectionObserver> observer;
+    rtc::scoped_refptr<webrtc::PeerConnectionInterface> peer_connection;
+    // Time spent in CreatePeerConnection.
+    int64_t create_call_time_ms;
+    // rtc::TimeMillis() when CreatePeerConnection returned.
+    int64_t created_ms;
+  };
+  // Pooled PeerConnections start gathering candidates when created.
+  static webrtc::PeerConnectionInterface::RTCConfiguration PoolConfiguration(
+      const webrtc::PeerConnectionInterface::RTCConfiguration& configuration);
+  // Post a task to create one PeerConnection if the pool is not full.
+  void ScheduleRefill();
+  void Refill();
+
+  rtc::Thread* thread_;
+  CreateFunction create_;
+  webrtc::PeerConnectionInterface::RTCConfiguration configuration_;
+  size_t size_;
+  std::deque<Entry> entries_;
+  bool refill_scheduled_;
+  uint64_t hits_;
+  uint64_t misses_;
+  int64_t create_call_time_ms_;
+  int64_t head_start_time_ms_;
+  webrtc::ScopedTaskSafety task_safety_;
+};
+}
+}
+#endif  // OWT_BASE_PEERCONNECTIONPOOL_H_
@@ -0,0 +1,187 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/qualityscorer.h"
+#include <algorithm>
+namespace owt {
+namespace base {
+namespace {
+// Rating without any impairment, G.107 default.
+const double kMaxRating = 93.2;
+// Rating lost per percent of packet loss. Video is protected by NACK and FEC,
+// so a lost packet costs less than a concealed audio packet.
+const double kAudioLossImpairment = 2.5;
+const double kVideoLossImpairment = 1.5;
+// Rating lost per percent of time frozen, and per freeze up to a limit.
+const double kFreezeDurationImpairment = 1.5;
+const double kFreezeCountImpairment = 5;
+const double kMaxFreezeCountImpairment = 30;
+// Rating lost if all received frames fail to decode.
+const double kDecodeImpairment = 50;
+// Rating lost while the encoder is limited.
+const double kBandwidthLimitationImpairment = 15;
+const double kOtherLimitationImpairment = 10;
+
+template <typename T>
+double CounterDelta(T current, T previous) {
+  return current >= previous ? static_cast<double>(current - previous) : 0;
+}
+}
+
+QualityScorer::QualityScorer() : last_timestamp_ms_(0) {}
+
+void QualityScorer::Update(const RTCStatsReport& report,
+                           const RTCCStatsSample& sample,
+                           RTCCQualityScores* scores) {
+  double interval_s =
+      last_timestamp_ms_ > 0
+          ? (sample.timestamp_ms - last_timestamp_ms_) / 1000.0
+          : 0;
+  last_timestamp_ms_ = sample.timestamp_ms;
+  double connection_rtt_ms = GetConnectionRoundTripTime(report);
+  scores->timestamp_ms = sample.timestamp_ms;
+  scores->audio_score = 0;
+  scores->video_score = 0;
+  scores->streams.clear();
+  next_receivers_.clear();
+  for (const auto& stream : sample.streams) {
+    RTCCStreamQualityScore score;
+    score.ssrc = stream.ssrc;
+    score.outbound = stream.outbound;
+    score.video = stream.video;
+    score.loss_fraction = stream.loss_fraction;
+    score.jitter_ms = stream.jitter_ms;
+    score.round_trip_time_ms = stream.round_trip_time_ms > 0
+                                   ? stream.round_trip_time_ms
+                                   : connection_rtt_ms;
+    ReadStreamStats(report, interval_s, &score);
+    score.score = RatingToScore(ComputeRating(score));
+    double& kind_score =
+        score.video ? scores->video_score : scores->audio_score;
+    kind_score =
+        kind_score > 0 ? std::min(kind_score, score.score) : score.score;
+    scores->streams.push_back(score);
+  }
+  // Streams missing from |sample| are removed.
+  receivers_.swap(next_receivers_);
+}
+
+double QualityScorer::RatingToScore(double r) {
+  if (r <= 0)
+    return 1;
+  r = std::min(r, 100.0);
+  double score = 1 + 0.035 * r + 7e-6 * r * (r - 60) * (100 - r);
+  return std::max(1.0, std::min(score, 5.0));
+}
+
+double QualityScorer::GetConnectionRoundTripTime(const RTCStatsReport& report) {
+  for (const RTCStats& stats : report) {
+    if (stats.type != RTCStatsType::kTransport)
+      continue;
+    const RTCStats* pair = report.Get(
+        stats.cast_to<RTCTransportStats>().selected_candidate_pair_id);
+    if (pair != nullptr && pair->type == RTCStatsType::kCandidatePair) {
+      return std::max(
+                 pair->cast_to<RTCIceCandidatePairStats>()
+                     .current_round_trip_time,
+                 0.0) *
+             1000;
+    }
+  }
+  return 0;
+}
+
+void QualityScorer::ReadStreamStats(const RTCStatsReport& report,
+                                    double interval_s,
+                                    RTCCStreamQualityScore* score) {
+  // The sample has one stream per SSRC and direction, so the RTP stats are
+  // looked up by SSRC.
+  for (const RTCStats& stats : report) {
+    if (score->outbound && stats.type == RTCStatsType::kOutboundRTP) {
+      const auto& outbound = stats.cast_to<RTCOutboundRTPStreamStats>();
+      if (outbound.ssrc != score->ssrc)
+        continue;
+      const std::string& reason = outbound.quality_limitation_reason;
+      if (reason == RTCQualityLimitationReason::kCpu)
+        score->quality_limitation_reason = kQualityLimitationCpu;
+      else if (reason == RTCQualityLimitationReason::kBandwidth)
+        score->quality_limitation_reason = kQualityLimitationBandwidth;
+      else if (reason == RTCQualityLimitationReason::kOther)
+        score->quality_limitation_reason = kQualityLimitationOther;
+      return;
+    }
+    if (score->outbound || stats.type != RTCStatsType::kInboundRTP)
+      continue;
+    const auto& inbound = stats.cast_to<RTCInboundRTPStreamStats>();
+    if (inbound.ssrc != score->ssrc)
+      continue;
+    const RTCStats* track = report.Get(inbound.track_id);
+    if (track == nullptr || track->type != RTCStatsType::kTrack)
+      return;
+    const auto& track_stats = track->cast_to<RTCMediaStreamTrackStats>();
+    ReceiverCounters& counters = next_receivers_[score->ssrc];
+    counters.freeze_count = track_stats.freeze_count;
+    counters.total_freezes_duration = track_stats.total_freezes_duration;
+    counters.frames_received = track_stats.frames_received;
+    counters.frames_decoded = track_stats.frames_decoded;
+    counters.total_samples_received = track_stats.total_samples_received;
+    counters.concealed_samples = track_stats.concealed_samples;
+    auto previous = receivers_.find(score->ssrc);
+    if (previous == receivers_.end() || interval_s <= 0)
+      return;
+    const ReceiverCounters& last = previous->second;
+    if (score->video) {
+      score->freeze_count = static_cast<uint32_t>(
+          CounterDelta(counters.freeze_count, last.freeze_count));
+      score->freeze_fraction = std::min(
+          CounterDelta(counters.total_freezes_duration,
+                       last.total_freezes_duration) /
+              interval_s,
+          1.0);
+      double received =
+          CounterDelta(counters.frames_received, last.frames_received);
+      if (received > 0) {
+        score->decode_ratio = std::min(
+            CounterDelta(counters.frames_decoded, last.frames_decoded) /
+                received,
+            1.0);
+      }
+    } else {
+      double samples = CounterDelta(counters.total_samples_received,
+                                    last.total_samples_received);
+      if (samples > 0) {
+        double concealed =
+            CounterDelta(counters.concealed_samples, last.concealed_samples);
+        score->loss_fraction =
+            std::max(score->loss_fraction, std::min(concealed / samples, 1.0));
+      }
+    }
+    return;
+  }
+}
+
+double QualityScorer::ComputeRating(const RTCCStreamQualityScore& score) {
+  // Delay impairment of the simplified E-model. One way delay is half of the
+  // RTT, plus a jitter buffer of twice the jitter and 10 ms of processing.
+  double delay_ms = score.round_trip_time_ms / 2 + 2 * score.jitter_ms + 10;
+  double r = kMaxRating;
+  r -= delay_ms < 160 ? delay_ms / 40 : (delay_ms - 120) / 10;
+  r -= score.loss_fraction * 100 *
+       (score.video ? kVideoLossImpairment : kAudioLossImpairment);
+  if (!score.video)
+    return r;
+  if (score.outbound) {
+    if (score.quality_limitation_reason == kQualityLimitationBandwidth)
+      r -= kBandwidthLimitationImpairment;
+    else if (score.quality_limitation_reason != kQualityLimitationNone)
+      r -= kOtherLimitationImpairment;
+    return r;
+  }
+  r -= score.freeze_fraction * 100 * kFreezeDurationImpairment;
+  r -= std::min(score.freeze_count * kFreezeCountImpairment,
+                kMaxFreezeCountImpairment);
+  r -= (1 - score.decode_ratio) * kDecodeImpairment;
+  return r;
+}
+}
+}
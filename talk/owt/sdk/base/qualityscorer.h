@@ -0,0 +1,52 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_QUALITYSCORER_H_
+#define OWT_BASE_QUALITYSCORER_H_
+#include <map>
+#include "owt/base/RTCClientObserver.h"
+#include "owt/base/connectionstats.h"
+namespace owt {
+namespace base {
+// Estimates a MOS-like score of each stream from consecutive stats samples.
+// Impairments of delay, loss, freezes, decoding and quality limitation are
+// subtracted from the transmission rating factor R of the ITU-T G.107
+// E-model, which is then mapped to 1 to 5. Not thread safe.
+class QualityScorer {
+ public:
+  QualityScorer();
+  // Score the streams of |sample|, built by StatsSampler from |report|.
+  // Counters missing from the sample are read from |report|.
+  void Update(const RTCStatsReport& report,
+              const RTCCStatsSample& sample,
+              RTCCQualityScores* scores);
+
+  // Maps rating factor |r| to a score from 1 to 5.
+  static double RatingToScore(double r);
+
+ private:
+  // Cumulative counters of a received stream, from its track stats.
+  struct ReceiverCounters {
+    uint32_t freeze_count = 0;
+    double total_freezes_duration = 0;
+    uint32_t frames_received = 0;
+    uint32_t frames_decoded = 0;
+    uint64_t total_samples_received = 0;
+    uint64_t concealed_samples = 0;
+  };
+  // Round trip time of the selected candidate pair in ms, 0 if unknown.
+  static double GetConnectionRoundTripTime(const RTCStatsReport& report);
+  // Fill the inputs of |score| which are not in the sample.
+  void ReadStreamStats(const RTCStatsReport& report,
+                       double interval_s,
+                       RTCCStreamQualityScore* score);
+  static double ComputeRating(const RTCCStreamQualityScore& score);
+
+  int64_t last_timestamp_ms_;
+  // Counters of the previous sample, by SSRC of the received stream.
+  std::map<uint32_t, ReceiverCounters> receivers_;
+  std::map<uint32_t, ReceiverCounters> next_receivers_;
+};
+}
+}
+#endif  // OWT_BASE_QUALITYSCORER_H_
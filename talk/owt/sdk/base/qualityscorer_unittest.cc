@@ -0,0 +1,190 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/qualityscorer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+namespace {
+const uint32_t kAudioSsrc = 1111;
+const uint32_t kVideoSsrc = 2222;
+const uint32_t kOutboundVideoSsrc = 3333;
+
+// Cumulative counters of the received streams.
+struct ReceiverState {
+  uint32_t freeze_count = 0;
+  double total_freezes_duration = 0;
+  uint32_t frames_received = 0;
+  uint32_t frames_decoded = 0;
+  uint64_t total_samples_received = 0;
+  uint64_t concealed_samples = 0;
+};
+
+std::unique_ptr<RTCMediaStreamTrackStats> CreateTrack(
+    const std::string& id,
+    const std::string& kind,
+    const ReceiverState& state) {
+  return std::make_unique<RTCMediaStreamTrackStats>(
+      id, 0, id, "", true, false, false, kind, 0, 0, 0, 0, 0, 0, 0,
+      state.frames_received, state.frames_decoded, 0, 0, 0, 0, 0, 0, 0, 0,
+      state.total_samples_received, 0, state.concealed_samples, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, state.freeze_count, 0, state.total_freezes_duration, 0, 0,
+      0);
+}
+
+std::unique_ptr<RTCInboundRTPStreamStats> CreateInbound(
+    const std::string& id,
+    uint32_t ssrc,
+    const std::string& kind,
+    const std::string& track_id) {
+  return std::make_unique<RTCInboundRTPStreamStats>(
+      id, 0, ssrc, false, kind, kind, track_id, "", "", 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "", 0,
+      "");
+}
+
+std::unique_ptr<RTCStatsReport> CreateReport(
+    const ReceiverState& state,
+    const std::string& quality_limitation_reason) {
+  auto report = std::make_unique<RTCStatsReport>();
+  report->AddStats(CreateInbound("inbound-audio", kAudioSsrc,
+                                 RTCMediaStreamTrackKind::kAudio,
+                                 "track-audio"));
+  report->AddStats(
+      CreateTrack("track-audio", RTCMediaStreamTrackKind::kAudio, state));
+  report->AddStats(CreateInbound("inbound-video", kVideoSsrc,
+                                 RTCMediaStreamTrackKind::kVideo,
+                                 "track-video"));
+  report->AddStats(
+      CreateTrack("track-video", RTCMediaStreamTrackKind::kVideo, state));
+  report->AddStats(std::make_unique<RTCOutboundRTPStreamStats>(
+      "outbound-video", 0, kOutboundVideoSsrc, false, "video",
+      RTCMediaStreamTrackKind::kVideo, "", "", "", 0, 0, 0, 0, 0, "", "", 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, quality_limitation_reason, 0, "", ""));
+  return report;
+}
+
+RTCCStreamStatsSample CreateStream(uint32_t ssrc,
+                                   bool outbound,
+                                   bool video,
+                                   double loss_fraction) {
+  RTCCStreamStatsSample stream;
+  stream.ssrc = ssrc;
+  stream.outbound = outbound;
+  stream.video = video;
+  stream.loss_fraction = loss_fraction;
+  stream.jitter_ms = 5;
+  stream.round_trip_time_ms = 40;
+  return stream;
+}
+
+RTCCStatsSample CreateSample(int64_t timestamp_ms, double loss_fraction) {
+  RTCCStatsSample sample;
+  sample.timestamp_ms = timestamp_ms;
+  sample.streams = {CreateStream(kAudioSsrc, false, false, loss_fraction),
+                    CreateStream(kVideoSsrc, false, true, loss_fraction),
+                    CreateStream(kOutboundVideoSsrc, true, true, 0)};
+  return sample;
+}
+
+const RTCCStreamQualityScore* FindScore(const RTCCQualityScores& scores,
+                                        uint32_t ssrc) {
+  for (const auto& score : scores.streams) {
+    if (score.ssrc == ssrc)
+      return &score;
+  }
+  return nullptr;
+}
+}  // namespace
+
+TEST(QualityScorerTest, RatingToScoreRange) {
+  EXPECT_DOUBLE_EQ(1, QualityScorer::RatingToScore(-10));
+  EXPECT_DOUBLE_EQ(1, QualityScorer::RatingToScore(0));
+  EXPECT_NEAR(4.5, QualityScorer::RatingToScore(100), 0.01);
+  EXPECT_LT(QualityScorer::RatingToScore(50),
+            QualityScorer::RatingToScore(80));
+}
+
+TEST(QualityScorerTest, CleanStreamsScoreHigh) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  scorer.Update(
+      *CreateReport(ReceiverState(), RTCQualityLimitationReason::kNone),
+      CreateSample(1000, 0), &scores);
+  EXPECT_EQ(1000, scores.timestamp_ms);
+  ASSERT_EQ(3u, scores.streams.size());
+  EXPECT_GT(scores.audio_score, 4.3);
+  EXPECT_GT(scores.video_score, 4.3);
+}
+
+TEST(QualityScorerTest, LossLowersScore) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  scorer.Update(
+      *CreateReport(ReceiverState(), RTCQualityLimitationReason::kNone),
+      CreateSample(1000, 0.1), &scores);
+  EXPECT_LT(FindScore(scores, kAudioSsrc)->score, 3.5);
+  EXPECT_LT(FindScore(scores, kVideoSsrc)->score,
+            FindScore(scores, kOutboundVideoSsrc)->score);
+  // The worst stream of each kind.
+  EXPECT_DOUBLE_EQ(FindScore(scores, kVideoSsrc)->score, scores.video_score);
+}
+
+TEST(QualityScorerTest, FreezesAndUndecodedFramesLowerVideoScore) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  ReceiverState state;
+  scorer.Update(*CreateReport(state, RTCQualityLimitationReason::kNone),
+                CreateSample(1000, 0), &scores);
+  double clean_score = FindScore(scores, kVideoSsrc)->score;
+  state.freeze_count = 2;
+  state.total_freezes_duration = 0.3;
+  state.frames_received = 30;
+  state.frames_decoded = 24;
+  scorer.Update(*CreateReport(state, RTCQualityLimitationReason::kNone),
+                CreateSample(2000, 0), &scores);
+  const RTCCStreamQualityScore* video = FindScore(scores, kVideoSsrc);
+  EXPECT_EQ(2u, video->freeze_count);
+  EXPECT_DOUBLE_EQ(0.3, video->freeze_fraction);
+  EXPECT_DOUBLE_EQ(0.8, video->decode_ratio);
+  EXPECT_LT(video->score, clean_score - 1);
+}
+
+TEST(QualityScorerTest, ConcealmentCountsAsAudioLoss) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  ReceiverState state;
+  scorer.Update(*CreateReport(state, RTCQualityLimitationReason::kNone),
+                CreateSample(1000, 0), &scores);
+  state.total_samples_received = 48000;
+  state.concealed_samples = 4800;
+  scorer.Update(*CreateReport(state, RTCQualityLimitationReason::kNone),
+                CreateSample(2000, 0.01), &scores);
+  EXPECT_DOUBLE_EQ(0.1, FindScore(scores, kAudioSsrc)->loss_fraction);
+}
+
+TEST(QualityScorerTest, QualityLimitationLowersSenderScore) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  scorer.Update(
+      *CreateReport(ReceiverState(), RTCQualityLimitationReason::kNone),
+      CreateSample(1000, 0), &scores);
+  double unlimited_score = FindScore(scores, kOutboundVideoSsrc)->score;
+  scorer.Update(
+      *CreateReport(ReceiverState(), RTCQualityLimitationReason::kBandwidth),
+      CreateSample(2000, 0), &scores);
+  const RTCCStreamQualityScore* sender = FindScore(scores, kOutboundVideoSsrc);
+  EXPECT_EQ(kQualityLimitationBandwidth, sender->quality_limitation_reason);
+  EXPECT_LT(sender->score, unlimited_score);
+}
+
+TEST(QualityScorerTest, NoStreams) {
+  QualityScorer scorer;
+  RTCCQualityScores scores;
+  scorer.Update(RTCStatsReport(), RTCCStatsSample(), &scores);
+  EXPECT_TRUE(scores.streams.empty());
+  EXPECT_EQ(0, scores.audio_score);
+  EXPECT_EQ(0, scores.video_score);
+}
+}
+}
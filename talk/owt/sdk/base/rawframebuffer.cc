@@ -0,0 +1,203 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/rawframebuffer.h"
+#include "libyuv/convert.h"
+#include "webrtc/common_video/include/video_frame_buffer.h"
+#include "webrtc/rtc_base/ref_counted_object.h"
+namespace owt {
+namespace base {
+WrappedNV12Buffer::WrappedNV12Buffer(int width,
+                                     int height,
+                                     const uint8_t* data_y,
+                                     int stride_y,
+                                     const uint8_t* data_uv,
+                                     int stride_uv,
+                                     std::function<void()> release)
+    : width_(width),
+      height_(height),
+      data_y_(data_y),
+      stride_y_(stride_y),
+      data_uv_(data_uv),
+      stride_uv_(stride_uv),
+      release_(std::move(release)) {}
+
+WrappedNV12Buffer::~WrappedNV12Buffer() {
+  release_();
+}
+
+rtc::scoped_refptr<webrtc::I420BufferInterface> WrappedNV12Buffer::ToI420() {
+  rtc::scoped_refptr<webrtc::I420Buffer> i420 =
+      webrtc::I420Buffer::Create(width_, height_);
+  libyuv::NV12ToI420(data_y_, stride_y_, data_uv_, stride_uv_,
+                     i420->MutableDataY(), i420->StrideY(),
+                     i420->MutableDataU(), i420->StrideU(),
+                     i420->MutableDataV(), i420->StrideV(), width_, height_);
+  return i420;
+}
+
+LazyI420Buffer::LazyI420Buffer(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    const uint8_t* data,
+    int stride,
+    std::function<void()> release)
+    : format_(format),
+      width_(width),
+      height_(height),
+      data_(data),
+      stride_(stride),
+      release_(std::move(release)),
+      converted_(false) {}
+
+LazyI420Buffer::~LazyI420Buffer() {
+  release_();
+}
+
+const uint8_t* LazyI420Buffer::DataY() const {
+  return Convert()->DataY();
+}
+
+const uint8_t* LazyI420Buffer::DataU() const {
+  return Convert()->DataU();
+}
+
+const uint8_t* LazyI420Buffer::DataV() const {
+  return Convert()->DataV();
+}
+
+// Strides are those of webrtc::I420Buffer::Create(width, height), so they are
+// known before conversion.
+int LazyI420Buffer::StrideY() const {
+  return width_;
+}
+
+int LazyI420Buffer::StrideU() const {
+  return (width_ + 1) / 2;
+}
+
+int LazyI420Buffer::StrideV() const {
+  return (width_ + 1) / 2;
+}
+
+bool LazyI420Buffer::IsConverted() const {
+  return converted_;
+}
+
+const webrtc::I420BufferInterface* LazyI420Buffer::Convert() const {
+  std::call_once(convert_once_, [this] {
+    i420_ = webrtc::I420Buffer::Create(width_, height_);
+    auto convert = format_ == VideoFrameGeneratorInterface::BGRA
+                       ? libyuv::BGRAToI420
+                       : libyuv::ARGBToI420;
+    convert(data_, stride_, i420_->MutableDataY(), i420_->StrideY(),
+            i420_->MutableDataU(), i420_->StrideU(), i420_->MutableDataV(),
+            i420_->StrideV(), width_, height_);
+    converted_ = true;
+  });
+  return i420_.get();
+}
+
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> WrapRawFrameBuffer(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    const uint8_t* const data[3],
+    const int stride[3],
+    std::function<void()> release) {
+  if (width <= 0 || height <= 0 || !data[0])
+    return nullptr;
+  if (!release)
+    release = [] {};
+  int chroma_width = (width + 1) / 2;
+  switch (format) {
+    case VideoFrameGeneratorInterface::I420:
+      if (!data[1] || !data[2] || stride[0] < width ||
+          stride[1] < chroma_width || stride[2] < chroma_width)
+        return nullptr;
+      return webrtc::WrapI420Buffer(width, height, data[0], stride[0],
+                                    data[1], stride[1], data[2], stride[2],
+                                    std::move(release));
+    case VideoFrameGeneratorInterface::I444:
+      if (!data[1] || !data[2] || stride[0] < width || stride[1] < width ||
+          stride[2] < width)
+        return nullptr;
+      return webrtc::WrapI444Buffer(width, height, data[0], stride[0],
+                                    data[1], stride[1], data[2], stride[2],
+                                    std::move(release));
+    case VideoFrameGeneratorInterface::NV12:
+      if (!data[1] || stride[0] < width || stride[1] < chroma_width * 2)
+        return nullptr;
+      return new rtc::RefCountedObject<WrappedNV12Buffer>(
+          width, height, data[0], stride[0], data[1], stride[1],
+          std::move(release));
+    case VideoFrameGeneratorInterface::ARGB:
+    case VideoFrameGeneratorInterface::BGRA:
+      if (stride[0] < width * 4)
+        return nullptr;
+      return new rtc::RefCountedObject<LazyI420Buffer>(
+          format, width, height, data[0], stride[0], std::move(release));
+    default:
+      return nullptr;
+  }
+}
+
+uint32_t PackedRawFrameSize(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height) {
+  uint32_t luma_size = width * height;
+  uint32_t chroma_size = ((width + 1) / 2) * ((height + 1) / 2);
+  switch (format) {
+    case VideoFrameGeneratorInterface::I420:
+    case VideoFrameGeneratorInterface::NV12:
+      return luma_size + chroma_size * 2;
+    case VideoFrameGeneratorInterface::I444:
+      return luma_size * 3;
+    case VideoFrameGeneratorInterface::ARGB:
+    case VideoFrameGeneratorInterface::BGRA:
+      return luma_size * 4;
+    default:
+      return 0;
+  }
+}
+
+void GetPackedRawFramePlanes(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    const uint8_t* buffer,
+    const uint8_t* data[3],
+    int stride[3]) {
+  int chroma_width = (width + 1) / 2;
+  int chroma_height = (height + 1) / 2;
+  data[0] = buffer;
+  data[1] = data[2] = nullptr;
+  stride[0] = width;
+  stride[1] = stride[2] = 0;
+  switch (format) {
+    case VideoFrameGeneratorInterface::I420:
+      data[1] = buffer + width * height;
+      data[2] = data[1] + chroma_width * chroma_height;
+      stride[1] = stride[2] = chroma_width;
+      break;
+    case VideoFrameGeneratorInterface::NV12:
+      data[1] = buffer + width * height;
+      stride[1] = chroma_width * 2;
+      break;
+    case VideoFrameGeneratorInterface::I444:
+      data[1] = buffer + width * height;
+      data[2] = data[1] + width * height;
+      stride[1] = stride[2] = width;
+      break;
+    case VideoFrameGeneratorInterface::ARGB:
+    case VideoFrameGeneratorInterface::BGRA:
+      stride[0] = width * 4;
+      break;
+    default:
+      break;
+  }
+}
+}
+}
@@ -0,0 +1,111 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_RAWFRAMEBUFFER_H_
+#define OWT_BASE_RAWFRAMEBUFFER_H_
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "owt/base/framegeneratorinterface.h"
+#include "webrtc/api/scoped_refptr.h"
+#include "webrtc/api/video/i420_buffer.h"
+#include "webrtc/api/video/video_frame_buffer.h"
+namespace owt {
+namespace base {
+// NV12 planes owned by someone else. |release| is invoked on destruction.
+class WrappedNV12Buffer : public webrtc::NV12BufferInterface {
+ public:
+  WrappedNV12Buffer(int width,
+                    int height,
+                    const uint8_t* data_y,
+                    int stride_y,
+                    const uint8_t* data_uv,
+                    int stride_uv,
+                    std::function<void()> release);
+  ~WrappedNV12Buffer() override;
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+  const uint8_t* DataY() const override { return data_y_; }
+  const uint8_t* DataUV() const override { return data_uv_; }
+  int StrideY() const override { return stride_y_; }
+  int StrideUV() const override { return stride_uv_; }
+  rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override;
+
+ private:
+  const int width_;
+  const int height_;
+  const uint8_t* const data_y_;
+  const int stride_y_;
+  const uint8_t* const data_uv_;
+  const int stride_uv_;
+  std::function<void()> release_;
+};
+
+// I420 view of ARGB or BGRA pixels owned by someone else. The pixels are
+// converted when planes are first read, so frames dropped or consumed as
+// native buffers are never converted. |release| is invoked on destruction.
+// Thread safe.
+class LazyI420Buffer : public webrtc::I420BufferInterface {
+ public:
+  LazyI420Buffer(VideoFrameGeneratorInterface::VideoFrameCodec format,
+                 int width,
+                 int height,
+                 const uint8_t* data,
+                 int stride,
+                 std::function<void()> release);
+  ~LazyI420Buffer() override;
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+  const uint8_t* DataY() const override;
+  const uint8_t* DataU() const override;
+  const uint8_t* DataV() const override;
+  int StrideY() const override;
+  int StrideU() const override;
+  int StrideV() const override;
+  // Whether the pixels have been converted.
+  bool IsConverted() const;
+
+ private:
+  const webrtc::I420BufferInterface* Convert() const;
+
+  const VideoFrameGeneratorInterface::VideoFrameCodec format_;
+  const int width_;
+  const int height_;
+  const uint8_t* const data_;
+  const int stride_;
+  std::function<void()> release_;
+  mutable std::once_flag convert_once_;
+  mutable std::atomic<bool> converted_;
+  mutable rtc::scoped_refptr<webrtc::I420Buffer> i420_;
+};
+
+// Wrap planes of a raw |format| frame without copy. I420 and I444 frames are
+// wrapped as such, NV12 as WrappedNV12Buffer, and ARGB and BGRA as
+// LazyI420Buffer. |release| is invoked once the buffer is destroyed. Returns
+// nullptr, without invoking |release|, if the format or planes are invalid.
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> WrapRawFrameBuffer(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    const uint8_t* const data[3],
+    const int stride[3],
+    std::function<void()> release);
+
+// Size of a raw |format| frame with planes packed without padding, as written
+// by VideoFrameGeneratorInterface. 0 if |format| is not raw.
+uint32_t PackedRawFrameSize(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height);
+
+// Planes of a packed raw |format| frame starting at |buffer|.
+void GetPackedRawFramePlanes(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    const uint8_t* buffer,
+    const uint8_t* data[3],
+    int stride[3]);
+}
+}
+#endif  // OWT_BASE_RAWFRAMEBUFFER_H_
@@ -0,0 +1,184 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/rawframebuffer.h"
+#include <iostream>
+#include <vector>
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const int kWidth = 64;
+const int kHeight = 48;
+
+// Frame of |format| packed in |memory|. Each plane is filled with its value of
+// |plane_values|, ARGB and BGRA pixels with its 4 bytes.
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> CreatePackedBuffer(
+    VideoFrameGeneratorInterface::VideoFrameCodec format,
+    int width,
+    int height,
+    std::vector<uint8_t>* memory,
+    const std::vector<uint8_t>& plane_values,
+    std::function<void()> release = nullptr) {
+  memory->resize(PackedRawFrameSize(format, width, height));
+  const uint8_t* data[3];
+  int stride[3];
+  GetPackedRawFramePlanes(format, width, height, memory->data(), data, stride);
+  for (size_t i = 0; i < memory->size(); i++) {
+    if (format == VideoFrameGeneratorInterface::ARGB ||
+        format == VideoFrameGeneratorInterface::BGRA) {
+      (*memory)[i] = plane_values[i % 4];
+    } else if (format == VideoFrameGeneratorInterface::NV12 &&
+               memory->data() + i >= data[1]) {
+      (*memory)[i] = plane_values[1 + (memory->data() + i - data[1]) % 2];
+    } else {
+      int plane = 0;
+      if (data[1] && memory->data() + i >= data[1])
+        plane = 1;
+      if (data[2] && memory->data() + i >= data[2])
+        plane = 2;
+      (*memory)[i] = plane_values[plane];
+    }
+  }
+  return WrapRawFrameBuffer(format, width, height, data, stride,
+                            std::move(release));
+}
+
+void ExpectI420(const webrtc::I420BufferInterface& buffer,
+                int y,
+                int u,
+                int v) {
+  EXPECT_NEAR(y, buffer.DataY()[0], 1);
+  EXPECT_NEAR(y, buffer.DataY()[buffer.StrideY() * (kHeight - 1) + kWidth - 1],
+              1);
+  EXPECT_NEAR(u, buffer.DataU()[0], 1);
+  EXPECT_NEAR(v, buffer.DataV()[0], 1);
+}
+}  // namespace
+
+TEST(RawFrameBufferTest, PacksPlanesWithoutPadding) {
+  EXPECT_EQ(5u * 3 + 3 * 2 * 2,
+            PackedRawFrameSize(VideoFrameGeneratorInterface::I420, 5, 3));
+  EXPECT_EQ(5u * 3 + 3 * 2 * 2,
+            PackedRawFrameSize(VideoFrameGeneratorInterface::NV12, 5, 3));
+  EXPECT_EQ(5u * 3 * 3,
+            PackedRawFrameSize(VideoFrameGeneratorInterface::I444, 5, 3));
+  EXPECT_EQ(5u * 3 * 4,
+            PackedRawFrameSize(VideoFrameGeneratorInterface::BGRA, 5, 3));
+  EXPECT_EQ(0u, PackedRawFrameSize(VideoFrameGeneratorInterface::VP8, 5, 3));
+  uint8_t buffer[5 * 3 * 3];
+  const uint8_t* data[3];
+  int stride[3];
+  GetPackedRawFramePlanes(VideoFrameGeneratorInterface::NV12, 5, 3, buffer,
+                          data, stride);
+  EXPECT_EQ(buffer + 15, data[1]);
+  EXPECT_EQ(6, stride[1]);
+  GetPackedRawFramePlanes(VideoFrameGeneratorInterface::I420, 5, 3, buffer,
+                          data, stride);
+  EXPECT_EQ(buffer + 15 + 6, data[2]);
+  EXPECT_EQ(3, stride[2]);
+}
+
+TEST(RawFrameBufferTest, WrapsNV12WithoutConversion) {
+  std::vector<uint8_t> memory;
+  int released = 0;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      CreatePackedBuffer(VideoFrameGeneratorInterface::NV12, kWidth, kHeight,
+                         &memory, {50, 100, 200}, [&released] { released++; });
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(webrtc::VideoFrameBuffer::Type::kNV12, buffer->type());
+  EXPECT_EQ(memory.data(), buffer->GetNV12()->DataY());
+  ExpectI420(*buffer->ToI420(), 50, 100, 200);
+  EXPECT_EQ(0, released);
+  buffer = nullptr;
+  EXPECT_EQ(1, released);
+}
+
+TEST(RawFrameBufferTest, WrapsI444WithoutConversion) {
+  std::vector<uint8_t> memory;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      CreatePackedBuffer(VideoFrameGeneratorInterface::I444, kWidth, kHeight,
+                         &memory, {50, 100, 200});
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(webrtc::VideoFrameBuffer::Type::kI444, buffer->type());
+  ExpectI420(*buffer->ToI420(), 50, 100, 200);
+}
+
+TEST(RawFrameBufferTest, ConvertsArgbWhenPlanesAreRead) {
+  // Red, as B, G, R, A bytes.
+  std::vector<uint8_t> memory;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      CreatePackedBuffer(VideoFrameGeneratorInterface::ARGB, kWidth, kHeight,
+                         &memory, {0, 0, 255, 255});
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(webrtc::VideoFrameBuffer::Type::kI420, buffer->type());
+  const LazyI420Buffer* lazy =
+      static_cast<const LazyI420Buffer*>(buffer->GetI420());
+  EXPECT_EQ(kWidth, lazy->width());
+  EXPECT_EQ(kWidth, lazy->StrideY());
+  EXPECT_FALSE(lazy->IsConverted());
+  ExpectI420(*lazy, 82, 90, 240);
+  EXPECT_TRUE(lazy->IsConverted());
+}
+
+TEST(RawFrameBufferTest, ConvertsBgraWhenPlanesAreRead) {
+  // Red, as A, R, G, B bytes.
+  std::vector<uint8_t> memory;
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+      CreatePackedBuffer(VideoFrameGeneratorInterface::BGRA, kWidth, kHeight,
+                         &memory, {255, 255, 0, 0});
+  ASSERT_TRUE(buffer);
+  ExpectI420(*buffer->ToI420(), 82, 90, 240);
+}
+
+TEST(RawFrameBufferTest, RejectsInvalidPlanes) {
+  uint8_t memory[kWidth * kHeight * 4];
+  const uint8_t* data[3] = {memory, nullptr, nullptr};
+  int stride[3] = {kWidth * 4 - 1, 0, 0};
+  int released = 0;
+  auto release = [&released] { released++; };
+  EXPECT_FALSE(WrapRawFrameBuffer(VideoFrameGeneratorInterface::ARGB, kWidth,
+                                  kHeight, data, stride, release));
+  stride[0] = kWidth;
+  EXPECT_FALSE(WrapRawFrameBuffer(VideoFrameGeneratorInterface::NV12, kWidth,
+                                  kHeight, data, stride, release));
+  EXPECT_FALSE(WrapRawFrameBuffer(VideoFrameGeneratorInterface::H264, kWidth,
+                                  kHeight, data, stride, release));
+  EXPECT_EQ(0, released);
+}
+
+TEST(RawFrameBufferTest, DISABLED_BenchmarkToI420) {
+  const int kConversions = 50;
+  const VideoFrameGeneratorInterface::VideoFrameCodec kFormats[] = {
+      VideoFrameGeneratorInterface::NV12, VideoFrameGeneratorInterface::I444,
+      VideoFrameGeneratorInterface::ARGB, VideoFrameGeneratorInterface::BGRA};
+  const char* kFormatNames[] = {"NV12", "I444", "ARGB", "BGRA"};
+  for (auto resolution : {std::make_pair(1920, 1080),
+                          std::make_pair(3840, 2160)}) {
+    for (size_t i = 0; i < sizeof(kFormats) / sizeof(kFormats[0]); i++) {
+      std::vector<uint8_t> memory;
+      CreatePackedBuffer(kFormats[i], resolution.first, resolution.second,
+                         &memory, {16, 128, 128, 0});
+      const uint8_t* data[3];
+      int stride[3];
+      GetPackedRawFramePlanes(kFormats[i], resolution.first, resolution.second,
+                              memory.data(), data, stride);
+      int64_t elapsed_us = 0;
+      for (int n = 0; n < kConversions; n++) {
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer =
+            WrapRawFrameBuffer(kFormats[i], resolution.first,
+                               resolution.second, data, stride, nullptr);
+        int64_t start_us = rtc::TimeMicros();
+        // Read a plane, so lazy buffers are converted.
+        EXPECT_NE(nullptr, buffer->ToI420()->DataY());
+        elapsed_us += rtc::TimeMicros() - start_us;
+      }
+      std::cout << kFormatNames[i] << " " << resolution.first << "x"
+                << resolution.second << " to I420: "
+                << elapsed_us / 1000.0 / kConversions << " ms." << std::endl;
+    }
+  }
+}
+}
+}
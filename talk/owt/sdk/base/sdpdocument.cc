@@ -0,0 +1,255 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/sdpdocument.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+#include "webrtc/rtc_base/logging.h"
+namespace owt {
+namespace base {
+namespace {
+const char kLineBreak[] = "\r\n";
+const char kRtpMapPrefix[] = "a=rtpmap:";
+const char kFmtpPrefix[] = "a=fmtp:";
+const char kRtcpFbPrefix[] = "a=rtcp-fb:";
+const char kConnectionPrefix[] = "c=IN ";
+// FEC related codecs which are kept for video when |keep_fec| is set. FlexFEC
+// does not involve RTX.
+const char* const kFecCodecNames[] = {"RED", "ULPFEC", "FLEXFEC-03"};
+
+bool StartsWith(const std::string& str, const char* prefix, size_t length) {
+  return str.compare(0, length, prefix) == 0;
+}
+
+std::string ToUpper(std::string str) {
+  std::transform(str.begin(), str.end(), str.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+  return str;
+}
+
+// Returns the payload type of a=<attribute>:<pt> <value> lines.
+std::string ExtractPayloadType(const std::string& line, size_t prefix_length) {
+  size_t space = line.find(' ', prefix_length);
+  if (space == std::string::npos)
+    return line.substr(prefix_length);
+  return line.substr(prefix_length, space - prefix_length);
+}
+
+std::vector<std::string> SplitFields(const std::string& line) {
+  std::vector<std::string> fields;
+  size_t begin = 0;
+  while (begin <= line.size()) {
+    size_t end = line.find(' ', begin);
+    if (end == std::string::npos)
+      end = line.size();
+    if (end > begin)
+      fields.emplace_back(line, begin, end - begin);
+    begin = end + 1;
+  }
+  return fields;
+}
+}  // namespace
+
+SdpLine SdpDocument::ParseLine(std::string line) {
+  if (StartsWith(line, kRtpMapPrefix, sizeof(kRtpMapPrefix) - 1)) {
+    std::string pt = ExtractPayloadType(line, sizeof(kRtpMapPrefix) - 1);
+    return SdpLine(SdpLine::Type::kRtpMap, std::move(line), std::move(pt));
+  }
+  if (StartsWith(line, kFmtpPrefix, sizeof(kFmtpPrefix) - 1)) {
+    std::string pt = ExtractPayloadType(line, sizeof(kFmtpPrefix) - 1);
+    return SdpLine(SdpLine::Type::kFmtp, std::move(line), std::move(pt));
+  }
+  if (StartsWith(line, kRtcpFbPrefix, sizeof(kRtcpFbPrefix) - 1)) {
+    std::string pt = ExtractPayloadType(line, sizeof(kRtcpFbPrefix) - 1);
+    return SdpLine(SdpLine::Type::kRtcpFb, std::move(line), std::move(pt));
+  }
+  if (StartsWith(line, kConnectionPrefix, sizeof(kConnectionPrefix) - 1)) {
+    return SdpLine(SdpLine::Type::kConnection, std::move(line), "");
+  }
+  return SdpLine(SdpLine::Type::kOther, std::move(line), "");
+}
+
+bool SdpDocument::Parse(const std::string& sdp) {
+  session_lines_.clear();
+  media_sections_.clear();
+  size_t begin = 0;
+  while (begin < sdp.size()) {
+    size_t end = sdp.find('\n', begin);
+    if (end == std::string::npos)
+      end = sdp.size();
+    size_t length = end - begin;
+    if (length > 0 && sdp[end - 1] == '\r')
+      length--;
+    if (length > 0) {
+      std::string line(sdp, begin, length);
+      if (line.compare(0, 2, "m=") == 0) {
+        SdpMediaSection section;
+        section.m_line_fields = SplitFields(line.substr(2));
+        if (!section.m_line_fields.empty())
+          section.media = section.m_line_fields[0];
+        media_sections_.push_back(std::move(section));
+      } else if (media_sections_.empty()) {
+        session_lines_.push_back(ParseLine(std::move(line)));
+      } else {
+        media_sections_.back().lines.push_back(ParseLine(std::move(line)));
+      }
+    }
+    begin = end + 1;
+  }
+  return !media_sections_.empty();
+}
+
+std::string SdpDocument::ToString() const {
+  size_t size = 0;
+  for (const auto& line : session_lines_)
+    size += line.text.size() + 2;
+  for (const auto& section : media_sections_) {
+    size += 4;
+    for (const auto& field : section.m_line_fields)
+      size += field.size() + 1;
+    for (const auto& line : section.lines)
+      size += line.text.size() + 2;
+  }
+  std::string sdp;
+  sdp.reserve(size);
+  for (const auto& line : session_lines_) {
+    sdp += line.text;
+    sdp += kLineBreak;
+  }
+  for (const auto& section : media_sections_) {
+    sdp += "m=";
+    for (size_t i = 0; i < section.m_line_fields.size(); i++) {
+      if (i > 0)
+        sdp += ' ';
+      sdp += section.m_line_fields[i];
+    }
+    sdp += kLineBreak;
+    for (const auto& line : section.lines) {
+      sdp += line.text;
+      sdp += kLineBreak;
+    }
+  }
+  return sdp;
+}
+
+int SdpDocument::SetPreferredCodecs(const std::string& media,
+                                    const std::vector<std::string>& codec_names,
+                                    bool keep_fec) {
+  if (codec_names.empty())
+    return 0;
+  std::vector<std::string> preferred_names;
+  preferred_names.reserve(codec_names.size());
+  for (const auto& name : codec_names)
+    preferred_names.push_back(ToUpper(name));
+  int modified = 0;
+  for (auto& section : media_sections_) {
+    if (section.media != media)
+      continue;
+    if (section.m_line_fields.size() < 3) {
+      RTC_LOG(LS_WARNING) << "Wrong SDP format description for m=" << media;
+      continue;
+    }
+    // Key is the payload type, value is the upper case codec name.
+    std::unordered_map<std::string, std::string> codecs;
+    // Key is the rtx payload type, value is the original payload type.
+    std::unordered_map<std::string, std::string> rtx_maps;
+    for (const auto& line : section.lines) {
+      // Position of <value> in a=<attribute>:<pt> <value>.
+      size_t value_pos = line.payload_type.size() + 1;
+      if (line.type == SdpLine::Type::kRtpMap) {
+        value_pos += sizeof(kRtpMapPrefix) - 1;
+        if (value_pos >= line.text.size())
+          continue;
+        size_t slash = line.text.find('/', value_pos);
+        codecs[line.payload_type] = ToUpper(line.text.substr(
+            value_pos, slash == std::string::npos ? std::string::npos
+                                                  : slash - value_pos));
+      } else if (line.type == SdpLine::Type::kFmtp) {
+        value_pos += sizeof(kFmtpPrefix) - 1;
+        if (value_pos >= line.text.size())
+          continue;
+        // Parameters are separated by ';'. RTX uses "apt=<pt>".
+        size_t apt = line.text.find("apt=", value_pos);
+        if (apt == std::string::npos ||
+            (apt != value_pos && line.text[apt - 1] != ';' &&
+             line.text[apt - 1] != ' '))
+          continue;
+        apt += 4;
+        size_t apt_end = line.text.find(';', apt);
+        rtx_maps[line.payload_type] = line.text.substr(
+            apt, apt_end == std::string::npos ? std::string::npos
+                                              : apt_end - apt);
+      }
+    }
+    const std::vector<std::string> payload_types(
+        section.m_line_fields.begin() + 3, section.m_line_fields.end());
+    std::vector<std::string> kept;
+    kept.reserve(payload_types.size());
+    auto keep_codec = [&](const std::string& name) {
+      for (const auto& pt : payload_types) {
+        auto codec = codecs.find(pt);
+        if (codec != codecs.end() && codec->second == name &&
+            std::find(kept.begin(), kept.end(), pt) == kept.end()) {
+          kept.push_back(pt);
+        }
+      }
+    };
+    for (const auto& name : preferred_names)
+      keep_codec(name);
+    if (kept.empty()) {
+      RTC_LOG(LS_WARNING) << "None of the preferred codecs is found in m="
+                          << media << " section.";
+      continue;
+    }
+    if (keep_fec) {
+      // Keeping red and ulpfec, assuming the binding to original codec is
+      // out-of-bound.
+      for (const char* name : kFecCodecNames)
+        keep_codec(name);
+    }
+    // Keep corresponding rtx payloads.
+    const size_t primary_count = kept.size();
+    for (size_t i = 0; i < primary_count; i++) {
+      for (const auto& pt : payload_types) {
+        auto rtx = rtx_maps.find(pt);
+        if (rtx != rtx_maps.end() && rtx->second == kept[i])
+          kept.push_back(pt);
+      }
+    }
+    std::unordered_set<std::string> kept_set(kept.begin(), kept.end());
+    section.lines.erase(
+        std::remove_if(section.lines.begin(), section.lines.end(),
+                       [&kept_set](const SdpLine& line) {
+                         return !line.payload_type.empty() &&
+                                line.payload_type != "*" &&
+                                kept_set.find(line.payload_type) ==
+                                    kept_set.end();
+                       }),
+        section.lines.end());
+    section.m_line_fields.resize(3);
+    section.m_line_fields.insert(section.m_line_fields.end(), kept.begin(),
+                                 kept.end());
+    modified++;
+  }
+  return modified;
+}
+
+void SdpDocument::AddQualityAttribute(int quality) {
+  const std::string attribute = "a=quality:" + std::to_string(quality);
+  InsertAfterConnectionLines(session_lines_, attribute);
+  for (auto& section : media_sections_)
+    InsertAfterConnectionLines(section.lines, attribute);
+}
+
+void SdpDocument::InsertAfterConnectionLines(std::vector<SdpLine>& lines,
+                                             const std::string& text) {
+  for (auto it = lines.begin(); it != lines.end(); ++it) {
+    if (it->type == SdpLine::Type::kConnection) {
+      it = lines.insert(it + 1, SdpLine(SdpLine::Type::kOther, text, ""));
+    }
+  }
+}
+}
+}
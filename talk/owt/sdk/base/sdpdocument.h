@@ -0,0 +1,77 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_SDPDOCUMENT_H_
+#define OWT_BASE_SDPDOCUMENT_H_
+#include <string>
+#include <utility>
+#include <vector>
+namespace owt {
+namespace base {
+/// A single SDP line with the payload type pre-extracted for codec attributes.
+struct SdpLine {
+  enum class Type { kOther, kConnection, kRtpMap, kFmtp, kRtcpFb };
+  SdpLine(Type type, std::string text, std::string payload_type)
+      : type(type), text(std::move(text)), payload_type(payload_type) {}
+  Type type;
+  // Full line without the trailing CRLF.
+  std::string text;
+  // Payload type of a=rtpmap, a=fmtp and a=rtcp-fb lines. Empty otherwise.
+  std::string payload_type;
+};
+/// An m-section: the m-line split into fields, and all lines up to the next
+/// m-line.
+struct SdpMediaSection {
+  // "audio", "video", "application"...
+  std::string media;
+  // All fields of the m-line. Fields from index 3 on are the payload types.
+  std::vector<std::string> m_line_fields;
+  std::vector<SdpLine> lines;
+};
+/**
+ @brief Structured session description used for in-place SDP editing.
+ @details The SDP is split into session-level lines and m-sections once by
+ Parse(). Edits are applied on the parsed lines across all m-sections and the
+ result is serialized once by ToString(). This avoids building and running a
+ regular expression for every line that needs to be modified.
+ */
+class SdpDocument {
+ public:
+  SdpDocument() {}
+  /// Parse |sdp|. Returns false if no m-line could be parsed.
+  bool Parse(const std::string& sdp);
+  /// Serialize the document using CRLF line endings.
+  std::string ToString() const;
+  /**
+   @brief Keep only preferred codecs in every m-section of |media|.
+   @details Payload types of |codec_names| are placed at the beginning of the
+   m-line in the given order. RTX payload types associated with kept payload
+   types are kept. If |keep_fec| is true, RED, ULPFEC and FlexFEC are kept as
+   well. a=rtpmap, a=fmtp and a=rtcp-fb lines of removed payload types are
+   stripped. Sections without any preferred codec are left untouched.
+   @param media Media type of the m-sections to modify.
+   @param codec_names Codec names ordered by preference, highest first.
+   Comparison is case-insensitive.
+   @param keep_fec Whether RED/ULPFEC/FlexFEC payloads are kept.
+   @return Number of m-sections modified.
+   */
+  int SetPreferredCodecs(const std::string& media,
+                         const std::vector<std::string>& codec_names,
+                         bool keep_fec);
+  /// Insert "a=quality:|quality|" after every c= line.
+  void AddQualityAttribute(int quality);
+  const std::vector<SdpLine>& session_lines() const { return session_lines_; }
+  const std::vector<SdpMediaSection>& media_sections() const {
+    return media_sections_;
+  }
+
+ private:
+  static SdpLine ParseLine(std::string line);
+  static void InsertAfterConnectionLines(std::vector<SdpLine>& lines,
+                                         const std::string& text);
+  std::vector<SdpLine> session_lines_;
+  std::vector<SdpMediaSection> media_sections_;
+};
+}
+}
+#endif  // OWT_BASE_SDPDOCUMENT_H_
@@ -15,21 +15,25 @@ class SdpUtils {
                                          std::vector<AudioCodec>& codec);
   static std::string SetPreferVideoCodecs(const std::string& sdp,
                                          std::vector<VideoCodec>& codec, bool qos_mode = false);
- private:
   /**
-   @brief Replace SDP for preferred codec.
+   @brief Replace SDP for preferred audio and video codecs.
+   @details The SDP is parsed once, all audio and video m-sections are updated
+   and the result is serialized once.
    @param sdp Original SDP.
-   @param codec_names Codec names in SDP.
-   @param is_audio True if prefer audio codec, false if prefer video codec.
-   @param set_quality If true will configure the a=quality SDP line for all codecs. This
+   @param audio_codecs Preferred audio codecs, highest priority first.
+   @param video_codecs Preferred video codecs, highest priority first.
+   @param qos_mode If true will configure the a=quality SDP line for all codecs. This
    is used to differentiate a track for higher QoS.
    */
   static std::string SetPreferCodecs(const std::string& sdp,
-                                     std::vector<std::string>& codec_name,
-                                     bool is_audio, bool qos_mode = false);
-  static std::vector<std::string> GetCodecValues(const std::string& sdp,
-                                                 std::string& codec_name,
-                                                 bool is_audio);
+                                     const std::vector<AudioCodec>& audio_codecs,
+                                     const std::vector<VideoCodec>& video_codecs,
+                                     bool qos_mode = false);
+ private:
+  static std::vector<std::string> GetCodecNames(
+      const std::vector<AudioCodec>& codecs);
+  static std::vector<std::string> GetCodecNames(
+      const std::vector<VideoCodec>& codecs);
 };
 }
 }
@@ -0,0 +1,250 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <unordered_map>
+#include "talk/owt/sdk/base/sdpdocument.h"
+#include "talk/owt/sdk/base/sdputils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+namespace owt {
+namespace base {
+namespace {
+const char kOffer[] =
+    "v=0\r\n"
+    "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1 2\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 103 9 0 8 126\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:103 ISAC/16000\r\n"
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:126 telephone-event/8000\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 102 121 127 116 117 118\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtpmap:98 VP9/90000\r\n"
+    "a=rtcp-fb:98 nack\r\n"
+    "a=rtpmap:99 rtx/90000\r\n"
+    "a=fmtp:99 apt=98\r\n"
+    "a=rtpmap:102 H264/90000\r\n"
+    "a=rtcp-fb:102 nack\r\n"
+    "a=fmtp:102 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42001f\r\n"
+    "a=rtpmap:121 rtx/90000\r\n"
+    "a=fmtp:121 apt=102\r\n"
+    "a=rtpmap:127 H264/90000\r\n"
+    "a=fmtp:127 level-asymmetry-allowed=1;packetization-mode=0;profile-level-id=42001f\r\n"
+    "a=rtpmap:116 red/90000\r\n"
+    "a=rtpmap:117 rtx/90000\r\n"
+    "a=fmtp:117 apt=116\r\n"
+    "a=rtpmap:118 ulpfec/90000\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 102 121\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:2\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtpmap:102 H264/90000\r\n"
+    "a=rtpmap:121 rtx/90000\r\n"
+    "a=fmtp:121 apt=102\r\n";
+
+std::vector<std::string> MLine(const SdpDocument& document, size_t index) {
+  return document.media_sections()[index].m_line_fields;
+}
+
+// The std::regex based implementation SdpUtils used before SdpDocument was
+// introduced. Only kept here as the baseline of the benchmark below.
+std::string RegexSetPreferCodecs(const std::string& sdp,
+                                 std::vector<std::string>& codec_names,
+                                 bool is_audio) {
+  std::regex reg_fmtp_apt("a=fmtp:(\\d+) apt=(\\d+)(?=[\r]?[\n]?)",
+                          std::regex_constants::icase);
+  std::smatch rtx_map_match;
+  std::unordered_map<std::string, std::string> rtx_maps;
+  std::string current_sdp = sdp;
+  while (std::regex_search(current_sdp, rtx_map_match, reg_fmtp_apt)) {
+    rtx_maps.insert({rtx_map_match.str(1), rtx_map_match.str(2)});
+    current_sdp = rtx_map_match.suffix();
+  }
+  std::vector<std::string> kept_codec_values;
+  if (!is_audio) {
+    for (const char* fec : {"red", "ulpfec", "flexfec-03"}) {
+      std::regex reg_fec_map(
+          std::string("a=rtpmap:(\\d+) ") + fec + "\\/\\d+(?=[\r]?[\n]?)",
+          std::regex_constants::icase);
+      std::smatch fec_map_match;
+      if (std::regex_search(sdp, fec_map_match, reg_fec_map)) {
+        kept_codec_values.push_back(fec_map_match[1]);
+        for (auto& rtx_value : rtx_maps) {
+          if (rtx_value.second == fec_map_match.str(1))
+            kept_codec_values.push_back(rtx_value.first);
+        }
+      }
+    }
+  }
+  for (auto& codec_name : codec_names) {
+    std::regex reg_rtp_map(
+        "a=rtpmap:(\\d+) " + codec_name + "\\/\\d+(?=[\r]?[\n]?)",
+        std::regex_constants::icase);
+    std::smatch rtp_map_match;
+    std::string sdp_current(sdp);
+    while (std::regex_search(sdp_current, rtp_map_match, reg_rtp_map)) {
+      std::string value = rtp_map_match[1];
+      kept_codec_values.insert(kept_codec_values.begin(), value);
+      for (auto& rtx_value : rtx_maps) {
+        if (rtx_value.second == value)
+          kept_codec_values.push_back(rtx_value.first);
+      }
+      sdp_current = rtp_map_match.suffix();
+    }
+  }
+  std::regex reg_m_line(std::string("m=") + (is_audio ? "audio" : "video") +
+                        ".*(?=[\r]?[\n]?)");
+  std::smatch m_line_match;
+  if (!std::regex_search(sdp, m_line_match, reg_m_line))
+    return sdp;
+  std::vector<std::string> m_line_vector;
+  std::stringstream original_m_line_stream(m_line_match.str(0));
+  std::string item;
+  while (std::getline(original_m_line_stream, item, ' '))
+    m_line_vector.push_back(item);
+  std::stringstream m_line_stream;
+  m_line_stream << m_line_vector[0] << " " << m_line_vector[1] << " "
+                << m_line_vector[2];
+  for (auto& codec_value : kept_codec_values)
+    m_line_stream << " " << codec_value;
+  std::string result = std::regex_replace(sdp, reg_m_line, m_line_stream.str());
+  for (size_t i = 3; i < m_line_vector.size(); i++) {
+    if (std::find(kept_codec_values.begin(), kept_codec_values.end(),
+                  m_line_vector[i]) != kept_codec_values.end())
+      continue;
+    for (const char* attribute : {"a=rtpmap:", "a=fmtp:", "a=rtcp-fb:"}) {
+      std::regex reg_xx_map(attribute + m_line_vector[i] + " .*\\r\\n",
+                            std::regex_constants::icase);
+      result = std::regex_replace(result, reg_xx_map, "");
+    }
+  }
+  return result;
+}
+}  // namespace
+
+TEST(SdpDocumentTest, ParseAndSerializeRoundTrip) {
+  SdpDocument document;
+  ASSERT_TRUE(document.Parse(kOffer));
+  EXPECT_EQ(5u, document.session_lines().size());
+  ASSERT_EQ(3u, document.media_sections().size());
+  EXPECT_EQ("audio", document.media_sections()[0].media);
+  EXPECT_EQ("video", document.media_sections()[1].media);
+  EXPECT_EQ(kOffer, document.ToString());
+}
+
+TEST(SdpDocumentTest, ParseAcceptsLfLineEndings) {
+  SdpDocument document;
+  ASSERT_TRUE(document.Parse("v=0\nm=audio 9 RTP/AVP 0\na=rtpmap:0 PCMU/8000\n"));
+  EXPECT_EQ("v=0\r\nm=audio 9 RTP/AVP 0\r\na=rtpmap:0 PCMU/8000\r\n",
+            document.ToString());
+}
+
+TEST(SdpDocumentTest, ParseFailsWithoutMLine) {
+  SdpDocument document;
+  EXPECT_FALSE(document.Parse("v=0\r\ns=-\r\n"));
+}
+
+TEST(SdpDocumentTest, PreferredVideoCodecKeepsRtxAndFecInAllSections) {
+  SdpDocument document;
+  ASSERT_TRUE(document.Parse(kOffer));
+  EXPECT_EQ(2, document.SetPreferredCodecs("video", {"h264", "VP8"}, true));
+  EXPECT_THAT(MLine(document, 1),
+              ::testing::ElementsAre("video", "9", "UDP/TLS/RTP/SAVPF", "102",
+                                     "127", "96", "116", "118", "121", "97",
+                                     "117"));
+  EXPECT_THAT(MLine(document, 2),
+              ::testing::ElementsAre("video", "9", "UDP/TLS/RTP/SAVPF", "102",
+                                     "96", "121", "97"));
+  std::string sdp = document.ToString();
+  EXPECT_EQ(std::string::npos, sdp.find("a=rtpmap:98 "));
+  EXPECT_EQ(std::string::npos, sdp.find("a=rtcp-fb:98 "));
+  EXPECT_EQ(std::string::npos, sdp.find("a=fmtp:99 "));
+  EXPECT_NE(std::string::npos, sdp.find("a=fmtp:117 apt=116\r\n"));
+  // Audio section is not touched.
+  EXPECT_NE(std::string::npos, sdp.find("a=rtpmap:126 telephone-event/8000"));
+}
+
+TEST(SdpDocumentTest, SectionWithoutPreferredCodecIsUntouched) {
+  SdpDocument document;
+  ASSERT_TRUE(document.Parse(kOffer));
+  EXPECT_EQ(1, document.SetPreferredCodecs("video", {"VP9"}, true));
+  EXPECT_THAT(MLine(document, 2),
+              ::testing::ElementsAre("video", "9", "UDP/TLS/RTP/SAVPF", "96",
+                                     "97", "102", "121"));
+}
+
+TEST(SdpUtilsTest, SetPreferCodecsUpdatesAudioAndVideo) {
+  std::vector<AudioCodec> audio_codecs = {AudioCodec::kPcmu, AudioCodec::kOpus};
+  std::vector<VideoCodec> video_codecs = {VideoCodec::kVp9};
+  SdpDocument document;
+  ASSERT_TRUE(document.Parse(
+      SdpUtils::SetPreferCodecs(kOffer, audio_codecs, video_codecs, true)));
+  EXPECT_THAT(MLine(document, 0),
+              ::testing::ElementsAre("audio", "9", "UDP/TLS/RTP/SAVPF", "0",
+                                     "111"));
+  EXPECT_THAT(MLine(document, 1),
+              ::testing::ElementsAre("video", "9", "UDP/TLS/RTP/SAVPF", "98",
+                                     "116", "118", "99", "117"));
+  for (const auto& section : document.media_sections()) {
+    ASSERT_GE(section.lines.size(), 2u);
+    EXPECT_EQ("a=quality:10", section.lines[1].text);
+  }
+}
+
+TEST(SdpUtilsTest, NoPreferenceReturnsOriginalSdp) {
+  std::vector<VideoCodec> video_codecs;
+  EXPECT_EQ(kOffer, SdpUtils::SetPreferVideoCodecs(kOffer, video_codecs));
+}
+
+// Compares SdpDocument with the previous std::regex implementation. Run with
+// --gtest_also_run_disabled_tests.
+TEST(SdpUtilsTest, DISABLED_BenchmarkAgainstRegex) {
+  const int kIterations = 200;
+  std::vector<AudioCodec> audio_codecs = {AudioCodec::kOpus};
+  std::vector<VideoCodec> video_codecs = {VideoCodec::kH264, VideoCodec::kVp8};
+  std::vector<std::string> audio_names = {"OPUS"};
+  // The regex implementation takes codec names in reverse order.
+  std::vector<std::string> video_names = {"VP8", "H264"};
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    std::string sdp = RegexSetPreferCodecs(kOffer, audio_names, true);
+    sdp = RegexSetPreferCodecs(sdp, video_names, false);
+  }
+  auto regex_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    SdpUtils::SetPreferCodecs(kOffer, audio_codecs, video_codecs);
+  }
+  auto document_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  std::cout << "std::regex: " << static_cast<double>(regex_us) / kIterations
+            << " us/offer, SdpDocument: "
+            << static_cast<double>(document_us) / kIterations << " us/offer"
+            << std::endl;
+  EXPECT_LT(document_us, regex_us);
+}
+}
+}
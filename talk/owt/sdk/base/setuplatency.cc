@@ -0,0 +1,113 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/setuplatency.h"
+#include <algorithm>
+namespace owt {
+namespace base {
+namespace {
+const int kPhaseCount = static_cast<int>(SetupPhase::kCount);
+// Names and fields of each phase, in the order of SetupPhase.
+const char* const kPhaseNames[kPhaseCount] = {
+    "create_offer_start",    "create_offer_end",
+    "set_local_description", "first_local_candidate",
+    "ice_gathering_complete", "set_remote_description",
+    "ice_checking",          "ice_connected",
+    "dtls_connected",        "first_packet_received",
+    "first_frame_delivered", "first_frame_render_estimate"};
+int64_t RTCCSetupLatency::*const kPhaseFields[kPhaseCount] = {
+    &RTCCSetupLatency::create_offer_start_ms,
+    &RTCCSetupLatency::create_offer_end_ms,
+    &RTCCSetupLatency::set_local_description_ms,
+    &RTCCSetupLatency::first_local_candidate_ms,
+    &RTCCSetupLatency::ice_gathering_complete_ms,
+    &RTCCSetupLatency::set_remote_description_ms,
+    &RTCCSetupLatency::ice_checking_ms,
+    &RTCCSetupLatency::ice_connected_ms,
+    &RTCCSetupLatency::dtls_connected_ms,
+    &RTCCSetupLatency::first_packet_received_ms,
+    &RTCCSetupLatency::first_frame_delivered_ms,
+    &RTCCSetupLatency::first_frame_render_estimate_ms};
+const std::vector<int64_t> kBucketBoundsMs = {10,  25,  50,   100,  200,
+                                              400, 800, 1600, 3200, 6400};
+}
+
+SetupLatencyHistograms* SetupLatencyHistograms::Get() {
+  static SetupLatencyHistograms* histograms = new SetupLatencyHistograms();
+  return histograms;
+}
+
+SetupLatencyHistograms::SetupLatencyHistograms() {
+  for (int i = 0; i < kPhaseCount; i++)
+    histograms_[i].phase = kPhaseNames[i];
+  Reset();
+}
+
+void SetupLatencyHistograms::Add(SetupPhase phase, int64_t latency_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RTCCSetupLatencyHistogram& histogram =
+      histograms_[static_cast<int>(phase)];
+  size_t bucket =
+      std::lower_bound(kBucketBoundsMs.begin(), kBucketBoundsMs.end(),
+                       latency_ms) -
+      kBucketBoundsMs.begin();
+  histogram.bucket_counts[bucket]++;
+  histogram.count++;
+  histogram.sum_ms += latency_ms;
+}
+
+std::vector<RTCCSetupLatencyHistogram> SetupLatencyHistograms::GetHistograms()
+    const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<RTCCSetupLatencyHistogram>(histograms_.begin(),
+                                                histograms_.end());
+}
+
+void SetupLatencyHistograms::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& histogram : histograms_) {
+    histogram.bucket_bounds_ms = kBucketBoundsMs;
+    histogram.bucket_counts.assign(kBucketBoundsMs.size() + 1, 0);
+    histogram.count = 0;
+    histogram.sum_ms = 0;
+  }
+}
+
+SetupLatencyTracker::SetupLatencyTracker(SetupLatencyHistograms* histograms)
+    : start_time_ms_(-1), histograms_(histograms) {
+  phases_ms_.fill(-1);
+}
+
+void SetupLatencyTracker::Start(int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (start_time_ms_ < 0)
+    start_time_ms_ = now_ms;
+}
+
+bool SetupLatencyTracker::Mark(SetupPhase phase, int64_t now_ms) {
+  int64_t latency_ms;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t& phase_ms = phases_ms_[static_cast<int>(phase)];
+    if (phase_ms >= 0)
+      return false;
+    if (start_time_ms_ < 0)
+      start_time_ms_ = now_ms;
+    latency_ms = std::max<int64_t>(now_ms - start_time_ms_, 0);
+    phase_ms = latency_ms;
+  }
+  if (histograms_ != nullptr)
+    histograms_->Add(phase, latency_ms);
+  return true;
+}
+
+RTCCSetupLatency SetupLatencyTracker::GetLatency() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RTCCSetupLatency latency;
+  latency.start_time_ms = start_time_ms_;
+  for (int i = 0; i < kPhaseCount; i++)
+    latency.*kPhaseFields[i] = phases_ms_[i];
+  return latency;
+}
+}
+}
@@ -0,0 +1,67 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_SETUPLATENCY_H_
+#define OWT_BASE_SETUPLATENCY_H_
+#include <array>
+#include <mutex>
+#include <vector>
+#include "owt/base/RTCClientObserver.h"
+namespace owt {
+namespace base {
+// Phases of a connection setup, in the order of RTCCSetupLatency fields.
+enum class SetupPhase : int {
+  kCreateOfferStart,
+  kCreateOfferEnd,
+  kSetLocalDescription,
+  kFirstLocalCandidate,
+  kIceGatheringComplete,
+  kSetRemoteDescription,
+  kIceChecking,
+  kIceConnected,
+  kDtlsConnected,
+  kFirstPacketReceived,
+  kFirstFrameDelivered,
+  kFirstFrameRenderEstimate,
+  kCount,
+};
+
+// Histograms of each setup phase, across connections. Thread safe.
+class SetupLatencyHistograms {
+ public:
+  // Returns the process wide histograms.
+  static SetupLatencyHistograms* Get();
+  SetupLatencyHistograms();
+  void Add(SetupPhase phase, int64_t latency_ms);
+  // Histograms of all phases, in the order of SetupPhase.
+  std::vector<RTCCSetupLatencyHistogram> GetHistograms() const;
+  void Reset();
+
+ private:
+  mutable std::mutex mutex_;
+  std::array<RTCCSetupLatencyHistogram, static_cast<int>(SetupPhase::kCount)>
+      histograms_;
+};
+
+// Records when each phase of a connection setup first happens, relative to
+// the setup start. Phases can be marked on any thread.
+class SetupLatencyTracker {
+ public:
+  // Each phase is also added to |histograms| if it is not null.
+  explicit SetupLatencyTracker(SetupLatencyHistograms* histograms);
+  // Start the setup at |now_ms|, unless it is started.
+  void Start(int64_t now_ms);
+  // Record |phase| at |now_ms|, starting the setup if needed. Returns false if
+  // |phase| is recorded before.
+  bool Mark(SetupPhase phase, int64_t now_ms);
+  RTCCSetupLatency GetLatency() const;
+
+ private:
+  mutable std::mutex mutex_;
+  int64_t start_time_ms_;
+  std::array<int64_t, static_cast<int>(SetupPhase::kCount)> phases_ms_;
+  SetupLatencyHistograms* histograms_;
+};
+}
+}
+#endif  // OWT_BASE_SETUPLATENCY_H_
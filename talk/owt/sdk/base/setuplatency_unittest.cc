@@ -0,0 +1,75 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/setuplatency.h"
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+TEST(SetupLatencyTrackerTest, RecordsPhasesRelativeToStart) {
+  SetupLatencyTracker tracker(nullptr);
+  EXPECT_EQ(-1, tracker.GetLatency().start_time_ms);
+  tracker.Start(1000);
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kCreateOfferStart, 1000));
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kCreateOfferEnd, 1005));
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kDtlsConnected, 1250));
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kFirstFrameRenderEstimate, 1400));
+  RTCCSetupLatency latency = tracker.GetLatency();
+  EXPECT_EQ(1000, latency.start_time_ms);
+  EXPECT_EQ(0, latency.create_offer_start_ms);
+  EXPECT_EQ(5, latency.create_offer_end_ms);
+  EXPECT_EQ(250, latency.dtls_connected_ms);
+  EXPECT_EQ(400, latency.first_frame_render_estimate_ms);
+  EXPECT_EQ(-1, latency.set_remote_description_ms);
+  EXPECT_EQ(-1, latency.first_frame_delivered_ms);
+}
+
+TEST(SetupLatencyTrackerTest, KeepsFirstOccurrence) {
+  SetupLatencyTracker tracker(nullptr);
+  tracker.Start(100);
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kIceChecking, 120));
+  EXPECT_FALSE(tracker.Mark(SetupPhase::kIceChecking, 300));
+  // A later start does not move the origin.
+  tracker.Start(200);
+  EXPECT_EQ(20, tracker.GetLatency().ice_checking_ms);
+}
+
+TEST(SetupLatencyTrackerTest, FirstMarkStarts) {
+  SetupLatencyTracker tracker(nullptr);
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kSetRemoteDescription, 500));
+  EXPECT_TRUE(tracker.Mark(SetupPhase::kCreateOfferStart, 510));
+  RTCCSetupLatency latency = tracker.GetLatency();
+  EXPECT_EQ(500, latency.start_time_ms);
+  EXPECT_EQ(0, latency.set_remote_description_ms);
+  EXPECT_EQ(10, latency.create_offer_start_ms);
+}
+
+TEST(SetupLatencyHistogramsTest, AddsMarkedPhases) {
+  SetupLatencyHistograms histograms;
+  SetupLatencyTracker first(&histograms);
+  first.Start(0);
+  first.Mark(SetupPhase::kIceConnected, 30);
+  first.Mark(SetupPhase::kIceConnected, 60);
+  SetupLatencyTracker second(&histograms);
+  second.Start(0);
+  second.Mark(SetupPhase::kIceConnected, 10000);
+  std::vector<RTCCSetupLatencyHistogram> all = histograms.GetHistograms();
+  ASSERT_EQ(static_cast<size_t>(SetupPhase::kCount), all.size());
+  const RTCCSetupLatencyHistogram& ice_connected =
+      all[static_cast<int>(SetupPhase::kIceConnected)];
+  EXPECT_EQ("ice_connected", ice_connected.phase);
+  EXPECT_EQ(2u, ice_connected.count);
+  EXPECT_EQ(10030, ice_connected.sum_ms);
+  ASSERT_EQ(ice_connected.bucket_bounds_ms.size() + 1,
+            ice_connected.bucket_counts.size());
+  // 30 ms is in the (25, 50] bucket, 10 s in the unbounded one.
+  EXPECT_EQ(1u, ice_connected.bucket_counts[2]);
+  EXPECT_EQ(1u, ice_connected.bucket_counts.back());
+  EXPECT_EQ(0u, all[static_cast<int>(SetupPhase::kIceChecking)].count);
+
+  histograms.Reset();
+  EXPECT_EQ(0u, histograms.GetHistograms()[static_cast<int>(
+                                              SetupPhase::kIceConnected)]
+                    .count);
+}
+}
+}
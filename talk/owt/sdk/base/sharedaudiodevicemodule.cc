@@ -0,0 +1,490 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/sharedaudiodevicemodule.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "webrtc/api/task_queue/default_task_queue_factory.h"
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/ref_counted_object.h"
+namespace owt {
+namespace base {
+namespace {
+// Adds |count| samples of |source| to |destination| with saturation.
+void MixSamples(const int16_t* source, int16_t* destination, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    int32_t sum = static_cast<int32_t>(destination[i]) + source[i];
+    destination[i] = static_cast<int16_t>(
+        std::min<int32_t>(std::numeric_limits<int16_t>::max(),
+                          std::max<int32_t>(std::numeric_limits<int16_t>::min(),
+                                            sum)));
+  }
+}
+}  // namespace
+
+AudioTransportFanout::AudioTransportFanout() {}
+
+AudioTransportFanout::~AudioTransportFanout() {}
+
+void AudioTransportFanout::ReplaceTransport(
+    webrtc::AudioTransport* old_transport,
+    webrtc::AudioTransport* new_transport) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (old_transport != nullptr) {
+    transports_.erase(
+        std::remove(transports_.begin(), transports_.end(), old_transport),
+        transports_.end());
+  }
+  if (new_transport != nullptr &&
+      std::find(transports_.begin(), transports_.end(), new_transport) ==
+          transports_.end()) {
+    transports_.push_back(new_transport);
+  }
+}
+
+size_t AudioTransportFanout::TransportCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return transports_.size();
+}
+
+int32_t AudioTransportFanout::RecordedDataIsAvailable(
+    const void* audio_samples,
+    const size_t samples_per_channel,
+    const size_t bytes_per_sample,
+    const size_t channels,
+    const uint32_t samples_per_sec,
+    const uint32_t total_delay_ms,
+    const int32_t clock_drift,
+    const uint32_t current_mic_level,
+    const bool key_pressed,
+    uint32_t& new_mic_level) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int32_t result = 0;
+  new_mic_level = 0;
+  for (size_t i = 0; i < transports_.size(); i++) {
+    uint32_t mic_level = 0;
+    int32_t transport_result = transports_[i]->RecordedDataIsAvailable(
+        audio_samples, samples_per_channel, bytes_per_sample, channels,
+        samples_per_sec, total_delay_ms, clock_drift, current_mic_level,
+        key_pressed, mic_level);
+    // Analog gain control of the first shard drives the microphone.
+    if (i == 0)
+      new_mic_level = mic_level;
+    if (transport_result != 0)
+      result = transport_result;
+  }
+  return result;
+}
+
+int32_t AudioTransportFanout::NeedMorePlayData(
+    const size_t samples_per_channel,
+    const size_t bytes_per_sample,
+    const size_t channels,
+    const uint32_t samples_per_sec,
+    void* audio_samples,
+    size_t& samples_per_channel_out,
+    int64_t* elapsed_time_ms,
+    int64_t* ntp_time_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Only 16-bit interleaved audio is mixed, otherwise the first transport
+  // plays alone.
+  bool mixable = bytes_per_sample == channels * sizeof(int16_t);
+  if (transports_.size() == 1 || (!transports_.empty() && !mixable)) {
+    return transports_[0]->NeedMorePlayData(
+        samples_per_channel, bytes_per_sample, channels, samples_per_sec,
+        audio_samples, samples_per_channel_out, elapsed_time_ms, ntp_time_ms);
+  }
+  std::memset(audio_samples, 0, samples_per_channel * bytes_per_sample);
+  samples_per_channel_out = samples_per_channel;
+  *elapsed_time_ms = -1;
+  *ntp_time_ms = -1;
+  size_t sample_count = samples_per_channel * channels;
+  mix_buffer_.resize(sample_count);
+  int32_t result = 0;
+  for (size_t i = 0; i < transports_.size(); i++) {
+    size_t samples_out = 0;
+    int64_t elapsed = -1;
+    int64_t ntp = -1;
+    int32_t transport_result = transports_[i]->NeedMorePlayData(
+        samples_per_channel, bytes_per_sample, channels, samples_per_sec,
+        mix_buffer_.data(), samples_out, &elapsed, &ntp);
+    if (transport_result != 0) {
+      result = transport_result;
+      continue;
+    }
+    MixSamples(mix_buffer_.data(), static_cast<int16_t*>(audio_samples),
+               std::min(samples_out, samples_per_channel) * channels);
+    if (i == 0) {
+      *elapsed_time_ms = elapsed;
+      *ntp_time_ms = ntp;
+    }
+  }
+  return result;
+}
+
+void AudioTransportFanout::PullRenderData(int bits_per_sample,
+                                          int sample_rate,
+                                          size_t number_of_channels,
+                                          size_t number_of_frames,
+                                          void* audio_data,
+                                          int64_t* elapsed_time_ms,
+                                          int64_t* ntp_time_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (transports_.size() == 1 ||
+      (!transports_.empty() && bits_per_sample != 16)) {
+    transports_[0]->PullRenderData(bits_per_sample, sample_rate,
+                                   number_of_channels, number_of_frames,
+                                   audio_data, elapsed_time_ms, ntp_time_ms);
+    return;
+  }
+  size_t sample_count = number_of_frames * number_of_channels;
+  std::memset(audio_data, 0, sample_count * sizeof(int16_t));
+  *elapsed_time_ms = -1;
+  *ntp_time_ms = -1;
+  mix_buffer_.resize(sample_count);
+  for (size_t i = 0; i < transports_.size(); i++) {
+    int64_t elapsed = -1;
+    int64_t ntp = -1;
+    transports_[i]->PullRenderData(bits_per_sample, sample_rate,
+                                   number_of_channels, number_of_frames,
+                                   mix_buffer_.data(), &elapsed, &ntp);
+    MixSamples(mix_buffer_.data(), static_cast<int16_t*>(audio_data),
+               sample_count);
+    if (i == 0) {
+      *elapsed_time_ms = elapsed;
+      *ntp_time_ms = ntp;
+    }
+  }
+}
+
+// Module of one factory shard. Calls are forwarded to the shared module on the
+// thread of SharedAudioDevice. Initialization, playout and recording are
+// tracked per shard, so stopping one shard does not stop the device for the
+// others.
+class ShardAudioDeviceModule : public webrtc::AudioDeviceModule {
+ public:
+  explicit ShardAudioDeviceModule(std::shared_ptr<SharedAudioDevice> device)
+      : device_(device),
+        adm_(device->adm_),
+        transport_(nullptr),
+        initialized_(false),
+        playing_(false),
+        recording_(false) {}
+  ~ShardAudioDeviceModule() override {
+    Call([this] {
+      if (recording_)
+        StopRecordingOnDeviceThread();
+      if (playing_)
+        StopPlayoutOnDeviceThread();
+      if (initialized_)
+        TerminateOnDeviceThread();
+      return 0;
+    });
+    device_->fanout_.ReplaceTransport(transport_, nullptr);
+  }
+
+  int32_t ActiveAudioLayer(AudioLayer* audio_layer) const override {
+    return Call([&] { return adm_->ActiveAudioLayer(audio_layer); });
+  }
+  int32_t RegisterAudioCallback(
+      webrtc::AudioTransport* audio_callback) override {
+    device_->fanout_.ReplaceTransport(transport_, audio_callback);
+    transport_ = audio_callback;
+    return 0;
+  }
+  int32_t Init() override {
+    return Call([this] {
+      if (initialized_)
+        return 0;
+      if (device_->initialized_shards_ == 0 && adm_->Init() != 0)
+        return -1;
+      initialized_ = true;
+      device_->initialized_shards_++;
+      return 0;
+    });
+  }
+  int32_t Terminate() override {
+    return Call([this] { return TerminateOnDeviceThread(); });
+  }
+  bool Initialized() const override {
+    return Call([this] { return initialized_; });
+  }
+  int16_t PlayoutDevices() override {
+    return Call([&] { return adm_->PlayoutDevices(); });
+  }
+  int16_t RecordingDevices() override {
+    return Call([&] { return adm_->RecordingDevices(); });
+  }
+  int32_t PlayoutDeviceName(uint16_t index,
+                            char name[webrtc::kAdmMaxDeviceNameSize],
+                            char guid[webrtc::kAdmMaxGuidSize]) override {
+    return Call([&] { return adm_->PlayoutDeviceName(index, name, guid); });
+  }
+  int32_t RecordingDeviceName(uint16_t index,
+                              char name[webrtc::kAdmMaxDeviceNameSize],
+                              char guid[webrtc::kAdmMaxGuidSize]) override {
+    return Call([&] { return adm_->RecordingDeviceName(index, name, guid); });
+  }
+  int32_t SetPlayoutDevice(uint16_t index) override {
+    return Call([&] { return adm_->SetPlayoutDevice(index); });
+  }
+  int32_t SetPlayoutDevice(WindowsDeviceType device) override {
+    return Call([&] { return adm_->SetPlayoutDevice(device); });
+  }
+  int32_t SetRecordingDevice(uint16_t index) override {
+    return Call([&] { return adm_->SetRecordingDevice(index); });
+  }
+  int32_t SetRecordingDevice(WindowsDeviceType device) override {
+    return Call([&] { return adm_->SetRecordingDevice(device); });
+  }
+  int32_t PlayoutIsAvailable(bool* available) override {
+    return Call([&] { return adm_->PlayoutIsAvailable(available); });
+  }
+  int32_t InitPlayout() override {
+    return Call([&] { return adm_->Playing() ? 0 : adm_->InitPlayout(); });
+  }
+  bool PlayoutIsInitialized() const override {
+    return Call([&] { return adm_->PlayoutIsInitialized(); });
+  }
+  int32_t RecordingIsAvailable(bool* available) override {
+    return Call([&] { return adm_->RecordingIsAvailable(available); });
+  }
+  int32_t InitRecording() override {
+    return Call([&] { return adm_->Recording() ? 0 : adm_->InitRecording(); });
+  }
+  bool RecordingIsInitialized() const override {
+    return Call([&] { return adm_->RecordingIsInitialized(); });
+  }
+  int32_t StartPlayout() override {
+    return Call([this] {
+      if (playing_)
+        return 0;
+      if (!adm_->Playing() && adm_->StartPlayout() != 0)
+        return -1;
+      playing_ = true;
+      device_->playing_shards_++;
+      return 0;
+    });
+  }
+  int32_t StopPlayout() override {
+    return Call([this] { return StopPlayoutOnDeviceThread(); });
+  }
+  bool Playing() const override {
+    return Call([this] { return playing_; });
+  }
+  int32_t StartRecording() override {
+    return Call([this] {
+      if (recording_)
+        return 0;
+      if (!adm_->Recording() && adm_->StartRecording() != 0)
+        return -1;
+      recording_ = true;
+      device_->recording_shards_++;
+      return 0;
+    });
+  }
+  int32_t StopRecording() override {
+    return Call([this] { return StopRecordingOnDeviceThread(); });
+  }
+  bool Recording() const override {
+    return Call([this] { return recording_; });
+  }
+  int32_t InitSpeaker() override {
+    return Call([&] { return adm_->InitSpeaker(); });
+  }
+  bool SpeakerIsInitialized() const override {
+    return Call([&] { return adm_->SpeakerIsInitialized(); });
+  }
+  int32_t InitMicrophone() override {
+    return Call([&] { return adm_->InitMicrophone(); });
+  }
+  bool MicrophoneIsInitialized() const override {
+    return Call([&] { return adm_->MicrophoneIsInitialized(); });
+  }
+  int32_t SpeakerVolumeIsAvailable(bool* available) override {
+    return Call([&] { return adm_->SpeakerVolumeIsAvailable(available); });
+  }
+  int32_t SetSpeakerVolume(uint32_t volume) override {
+    return Call([&] { return adm_->SetSpeakerVolume(volume); });
+  }
+  int32_t SpeakerVolume(uint32_t* volume) const override {
+    return Call([&] { return adm_->SpeakerVolume(volume); });
+  }
+  int32_t MaxSpeakerVolume(uint32_t* max_volume) const override {
+    return Call([&] { return adm_->MaxSpeakerVolume(max_volume); });
+  }
+  int32_t MinSpeakerVolume(uint32_t* min_volume) const override {
+    return Call([&] { return adm_->MinSpeakerVolume(min_volume); });
+  }
+  int32_t MicrophoneVolumeIsAvailable(bool* available) override {
+    return Call([&] { return adm_->MicrophoneVolumeIsAvailable(available); });
+  }
+  int32_t SetMicrophoneVolume(uint32_t volume) override {
+    return Call([&] { return adm_->SetMicrophoneVolume(volume); });
+  }
+  int32_t MicrophoneVolume(uint32_t* volume) const override {
+    return Call([&] { return adm_->MicrophoneVolume(volume); });
+  }
+  int32_t MaxMicrophoneVolume(uint32_t* max_volume) const override {
+    return Call([&] { return adm_->MaxMicrophoneVolume(max_volume); });
+  }
+  int32_t MinMicrophoneVolume(uint32_t* min_volume) const override {
+    return Call([&] { return adm_->MinMicrophoneVolume(min_volume); });
+  }
+  int32_t SpeakerMuteIsAvailable(bool* available) override {
+    return Call([&] { return adm_->SpeakerMuteIsAvailable(available); });
+  }
+  int32_t SetSpeakerMute(bool enable) override {
+    return Call([&] { return adm_->SetSpeakerMute(enable); });
+  }
+  int32_t SpeakerMute(bool* enabled) const override {
+    return Call([&] { return adm_->SpeakerMute(enabled); });
+  }
+  int32_t MicrophoneMuteIsAvailable(bool* available) override {
+    return Call([&] { return adm_->MicrophoneMuteIsAvailable(available); });
+  }
+  int32_t SetMicrophoneMute(bool enable) override {
+    return Call([&] { return adm_->SetMicrophoneMute(enable); });
+  }
+  int32_t MicrophoneMute(bool* enabled) const override {
+    return Call([&] { return adm_->MicrophoneMute(enabled); });
+  }
+  int32_t StereoPlayoutIsAvailable(bool* available) const override {
+    return Call([&] { return adm_->StereoPlayoutIsAvailable(available); });
+  }
+  int32_t SetStereoPlayout(bool enable) override {
+    return Call([&] { return adm_->SetStereoPlayout(enable); });
+  }
+  int32_t StereoPlayout(bool* enabled) const override {
+    return Call([&] { return adm_->StereoPlayout(enabled); });
+  }
+  int32_t StereoRecordingIsAvailable(bool* available) const override {
+    return Call([&] { return adm_->StereoRecordingIsAvailable(available); });
+  }
+  int32_t SetStereoRecording(bool enable) override {
+    return Call([&] { return adm_->SetStereoRecording(enable); });
+  }
+  int32_t StereoRecording(bool* enabled) const override {
+    return Call([&] { return adm_->StereoRecording(enabled); });
+  }
+  int32_t PlayoutDelay(uint16_t* delay_ms) const override {
+    return Call([&] { return adm_->PlayoutDelay(delay_ms); });
+  }
+  bool BuiltInAECIsAvailable() const override {
+    return Call([&] { return adm_->BuiltInAECIsAvailable(); });
+  }
+  bool BuiltInAGCIsAvailable() const override {
+    return Call([&] { return adm_->BuiltInAGCIsAvailable(); });
+  }
+  bool BuiltInNSIsAvailable() const override {
+    return Call([&] { return adm_->BuiltInNSIsAvailable(); });
+  }
+  int32_t EnableBuiltInAEC(bool enable) override {
+    return Call([&] { return adm_->EnableBuiltInAEC(enable); });
+  }
+  int32_t EnableBuiltInAGC(bool enable) override {
+    return Call([&] { return adm_->EnableBuiltInAGC(enable); });
+  }
+  int32_t EnableBuiltInNS(bool enable) override {
+    return Call([&] { return adm_->EnableBuiltInNS(enable); });
+  }
+#if defined(WEBRTC_IOS)
+  int GetPlayoutAudioParameters(
+      webrtc::AudioParameters* params) const override {
+    return Call([&] { return adm_->GetPlayoutAudioParameters(params); });
+  }
+  int GetRecordAudioParameters(
+      webrtc::AudioParameters* params) const override {
+    return Call([&] { return adm_->GetRecordAudioParameters(params); });
+  }
+#endif  // WEBRTC_IOS
+
+ private:
+  template <typename Functor>
+  auto Call(Functor&& functor) const -> decltype(functor()) {
+    return device_->thread()->Invoke<decltype(functor())>(
+        RTC_FROM_HERE, std::forward<Functor>(functor));
+  }
+  int32_t TerminateOnDeviceThread() {
+    if (!initialized_)
+      return 0;
+    initialized_ = false;
+    if (--device_->initialized_shards_ == 0)
+      return adm_->Terminate();
+    return 0;
+  }
+  int32_t StopPlayoutOnDeviceThread() {
+    if (!playing_)
+      return 0;
+    playing_ = false;
+    if (--device_->playing_shards_ == 0)
+      return adm_->StopPlayout();
+    return 0;
+  }
+  int32_t StopRecordingOnDeviceThread() {
+    if (!recording_)
+      return 0;
+    recording_ = false;
+    if (--device_->recording_shards_ == 0)
+      return adm_->StopRecording();
+    return 0;
+  }
+
+  std::shared_ptr<SharedAudioDevice> device_;
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> adm_;
+  webrtc::AudioTransport* transport_;
+  // Accessed on the thread of |device_|.
+  bool initialized_;
+  bool playing_;
+  bool recording_;
+};
+
+SharedAudioDevice::SharedAudioDevice()
+    : thread_(rtc::Thread::Create()),
+      initialized_shards_(0),
+      playing_shards_(0),
+      recording_shards_(0) {
+  thread_->SetName("shared_audio_device_thread", nullptr);
+  thread_->Start();
+}
+
+SharedAudioDevice::~SharedAudioDevice() {
+  RTC_DCHECK(!thread_->IsCurrent());
+  thread_->Invoke<void>(RTC_FROM_HERE, [this] {
+    if (adm_ != nullptr) {
+      adm_->RegisterAudioCallback(nullptr);
+      adm_ = nullptr;
+    }
+  });
+  thread_->Stop();
+}
+
+bool SharedAudioDevice::SetDeviceModule(
+    rtc::scoped_refptr<webrtc::AudioDeviceModule> adm) {
+  return thread_->Invoke<bool>(RTC_FROM_HERE, [this, adm] {
+    RTC_DCHECK(adm_ == nullptr);
+    adm_ = adm;
+    if (adm_ == nullptr) {
+      task_queue_factory_ = webrtc::CreateDefaultTaskQueueFactory();
+      adm_ = webrtc::AudioDeviceModule::Create(
+          webrtc::AudioDeviceModule::kPlatformDefaultAudio,
+          task_queue_factory_.get());
+    }
+    if (adm_ == nullptr) {
+      RTC_LOG(LS_ERROR) << "Failed to create shared audio device module.";
+      return false;
+    }
+    adm_->RegisterAudioCallback(&fanout_);
+    return true;
+  });
+}
+
+rtc::scoped_refptr<webrtc::AudioDeviceModule>
+SharedAudioDevice::CreateShardModule() {
+  RTC_DCHECK(adm_ != nullptr);
+  return new rtc::RefCountedObject<ShardAudioDeviceModule>(shared_from_this());
+}
+}
+}
@@ -0,0 +1,96 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_SHAREDAUDIODEVICEMODULE_H_
+#define OWT_BASE_SHAREDAUDIODEVICEMODULE_H_
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "webrtc/api/scoped_refptr.h"
+#include "webrtc/api/task_queue/task_queue_factory.h"
+#include "webrtc/modules/audio_device/include/audio_device.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// AudioTransport delivering recorded audio to every added transport and mixing
+// the 16-bit playout of all of them. Thread safe.
+class AudioTransportFanout : public webrtc::AudioTransport {
+ public:
+  AudioTransportFanout();
+  ~AudioTransportFanout() override;
+  // Replaces |old_transport| with |new_transport|. Either may be null. When
+  // this returns, |old_transport| is no longer called.
+  void ReplaceTransport(webrtc::AudioTransport* old_transport,
+                        webrtc::AudioTransport* new_transport);
+  size_t TransportCount() const;
+  // webrtc::AudioTransport
+  int32_t RecordedDataIsAvailable(const void* audio_samples,
+                                  const size_t samples_per_channel,
+                                  const size_t bytes_per_sample,
+                                  const size_t channels,
+                                  const uint32_t samples_per_sec,
+                                  const uint32_t total_delay_ms,
+                                  const int32_t clock_drift,
+                                  const uint32_t current_mic_level,
+                                  const bool key_pressed,
+                                  uint32_t& new_mic_level) override;
+  int32_t NeedMorePlayData(const size_t samples_per_channel,
+                           const size_t bytes_per_sample,
+                           const size_t channels,
+                           const uint32_t samples_per_sec,
+                           void* audio_samples,
+                           size_t& samples_per_channel_out,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override;
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override;
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<webrtc::AudioTransport*> transports_;
+  // Playout of one transport before it is mixed. Guarded by |mutex_|.
+  std::vector<int16_t> mix_buffer_;
+};
+
+// Audio device module shared by all PeerConnectionFactory shards. A device
+// module accepts a single AudioTransport, so every shard gets its own module
+// from CreateShardModule() which registers the shard's transport with a
+// fanout, and starts or stops the shared device only for the first or last
+// shard using it. All calls to the shared module are made on a thread owned
+// by this object.
+class SharedAudioDevice
+    : public std::enable_shared_from_this<SharedAudioDevice> {
+ public:
+  SharedAudioDevice();
+  ~SharedAudioDevice();
+  // Thread the shared module must be created and used on.
+  rtc::Thread* thread() const { return thread_.get(); }
+  // Sets the module shared by all shards. If |adm| is null, the platform
+  // default module is created. Returns false if no module is available.
+  bool SetDeviceModule(rtc::scoped_refptr<webrtc::AudioDeviceModule> adm);
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> DeviceModule() const {
+    return adm_;
+  }
+  // Creates the module passed to the PeerConnectionFactory of one shard.
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> CreateShardModule();
+
+ private:
+  friend class ShardAudioDeviceModule;
+  std::unique_ptr<rtc::Thread> thread_;
+  std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_;
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> adm_;
+  AudioTransportFanout fanout_;
+  // Number of shard modules initialized, playing and recording. Accessed on
+  // |thread_|.
+  int initialized_shards_;
+  int playing_shards_;
+  int recording_shards_;
+};
+}
+}
+#endif  // OWT_BASE_SHAREDAUDIODEVICEMODULE_H_
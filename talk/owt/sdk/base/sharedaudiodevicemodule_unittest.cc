@@ -0,0 +1,162 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/sharedaudiodevicemodule.h"
+#include <limits>
+#include <vector>
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_device/include/mock_audio_device.h"
+namespace owt {
+namespace base {
+namespace {
+const size_t kSamplesPerChannel = 480;
+const size_t kChannels = 2;
+const size_t kBytesPerSample = kChannels * sizeof(int16_t);
+const uint32_t kSampleRate = 48000;
+
+// Plays a constant sample and counts recorded frames.
+class FakeTransport : public webrtc::AudioTransport {
+ public:
+  explicit FakeTransport(int16_t sample) : sample_(sample) {}
+  int32_t RecordedDataIsAvailable(const void* audio_samples,
+                                  const size_t samples_per_channel,
+                                  const size_t bytes_per_sample,
+                                  const size_t channels,
+                                  const uint32_t samples_per_sec,
+                                  const uint32_t total_delay_ms,
+                                  const int32_t clock_drift,
+                                  const uint32_t current_mic_level,
+                                  const bool key_pressed,
+                                  uint32_t& new_mic_level) override {
+    recorded_frames_++;
+    new_mic_level = current_mic_level + sample_;
+    return 0;
+  }
+  int32_t NeedMorePlayData(const size_t samples_per_channel,
+                           const size_t bytes_per_sample,
+                           const size_t channels,
+                           const uint32_t samples_per_sec,
+                           void* audio_samples,
+                           size_t& samples_per_channel_out,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override {
+    int16_t* samples = static_cast<int16_t*>(audio_samples);
+    for (size_t i = 0; i < samples_per_channel * channels; i++)
+      samples[i] = sample_;
+    samples_per_channel_out = samples_per_channel;
+    *elapsed_time_ms = sample_;
+    *ntp_time_ms = sample_;
+    return 0;
+  }
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override {}
+
+  int recorded_frames_ = 0;
+
+ private:
+  const int16_t sample_;
+};
+
+std::vector<int16_t> PlayOut(AudioTransportFanout& fanout) {
+  std::vector<int16_t> samples(kSamplesPerChannel * kChannels, 1);
+  size_t samples_out = 0;
+  int64_t elapsed_time_ms = 0;
+  int64_t ntp_time_ms = 0;
+  EXPECT_EQ(0, fanout.NeedMorePlayData(kSamplesPerChannel, kBytesPerSample,
+                                       kChannels, kSampleRate, samples.data(),
+                                       samples_out, &elapsed_time_ms,
+                                       &ntp_time_ms));
+  EXPECT_EQ(kSamplesPerChannel, samples_out);
+  return samples;
+}
+
+void Record(AudioTransportFanout& fanout, uint32_t* new_mic_level) {
+  std::vector<int16_t> samples(kSamplesPerChannel * kChannels, 0);
+  EXPECT_EQ(0, fanout.RecordedDataIsAvailable(
+                   samples.data(), kSamplesPerChannel, kBytesPerSample,
+                   kChannels, kSampleRate, 0, 0, 10, false, *new_mic_level));
+}
+}  // namespace
+
+TEST(AudioTransportFanoutTest, DeliversRecordedAudioToAllTransports) {
+  AudioTransportFanout fanout;
+  FakeTransport first(1);
+  FakeTransport second(2);
+  fanout.ReplaceTransport(nullptr, &first);
+  fanout.ReplaceTransport(nullptr, &second);
+  uint32_t new_mic_level = 0;
+  Record(fanout, &new_mic_level);
+  EXPECT_EQ(1, first.recorded_frames_);
+  EXPECT_EQ(1, second.recorded_frames_);
+  // Gain control of the first transport drives the microphone.
+  EXPECT_EQ(11u, new_mic_level);
+}
+
+TEST(AudioTransportFanoutTest, MixesPlayoutWithSaturation) {
+  AudioTransportFanout fanout;
+  EXPECT_EQ(0, PlayOut(fanout)[0]);
+  FakeTransport first(100);
+  FakeTransport second(-30);
+  fanout.ReplaceTransport(nullptr, &first);
+  EXPECT_EQ(100, PlayOut(fanout)[0]);
+  fanout.ReplaceTransport(nullptr, &second);
+  std::vector<int16_t> mixed = PlayOut(fanout);
+  EXPECT_EQ(70, mixed.front());
+  EXPECT_EQ(70, mixed.back());
+
+  FakeTransport loud(std::numeric_limits<int16_t>::max());
+  fanout.ReplaceTransport(&second, &loud);
+  EXPECT_EQ(std::numeric_limits<int16_t>::max(), PlayOut(fanout)[0]);
+}
+
+TEST(AudioTransportFanoutTest, StopsCallingReplacedTransport) {
+  AudioTransportFanout fanout;
+  FakeTransport first(1);
+  FakeTransport second(2);
+  fanout.ReplaceTransport(nullptr, &first);
+  fanout.ReplaceTransport(&first, &second);
+  EXPECT_EQ(1u, fanout.TransportCount());
+  uint32_t new_mic_level = 0;
+  Record(fanout, &new_mic_level);
+  EXPECT_EQ(0, first.recorded_frames_);
+  EXPECT_EQ(1, second.recorded_frames_);
+  fanout.ReplaceTransport(&second, nullptr);
+  EXPECT_EQ(0u, fanout.TransportCount());
+}
+
+TEST(SharedAudioDeviceTest, RecordsUntilLastShardStops) {
+  rtc::scoped_refptr<webrtc::test::MockAudioDeviceModule> adm =
+      webrtc::test::MockAudioDeviceModule::CreateNice();
+  EXPECT_CALL(*adm, Init()).WillOnce(testing::Return(0));
+  EXPECT_CALL(*adm, StartRecording()).WillOnce(testing::Return(0));
+  EXPECT_CALL(*adm, StopRecording()).Times(0);
+  auto device = std::make_shared<SharedAudioDevice>();
+  ASSERT_TRUE(device->SetDeviceModule(adm));
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> first =
+      device->CreateShardModule();
+  rtc::scoped_refptr<webrtc::AudioDeviceModule> second =
+      device->CreateShardModule();
+  EXPECT_EQ(0, first->Init());
+  EXPECT_EQ(0, second->Init());
+  EXPECT_EQ(0, first->StartRecording());
+  EXPECT_CALL(*adm, Recording()).WillRepeatedly(testing::Return(true));
+  EXPECT_EQ(0, second->StartRecording());
+  EXPECT_TRUE(second->Recording());
+  EXPECT_EQ(0, first->StopRecording());
+  EXPECT_FALSE(first->Recording());
+  testing::Mock::VerifyAndClearExpectations(adm.get());
+
+  EXPECT_CALL(*adm, StopRecording()).WillOnce(testing::Return(0));
+  EXPECT_CALL(*adm, Terminate()).WillOnce(testing::Return(0));
+  EXPECT_EQ(0, second->StopRecording());
+  EXPECT_EQ(0, first->Terminate());
+  EXPECT_EQ(0, second->Terminate());
+}
+}
+}
@@ -0,0 +1,295 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/statsaggregator.h"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#endif
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/string_utils.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const char* const kIceStateNames[AggregatedStats::kIceStateCount] = {
+    "new",    "checking",     "connected", "completed",
+    "failed", "disconnected", "closed"};
+const std::vector<double> kRoundTripTimeBucketsMs = {10,  25,  50,  100,
+                                                     200, 400, 800, 1600};
+const std::vector<double> kJitterBucketsMs = {1, 5, 10, 20, 50, 100, 200};
+// Significant digits of numbers in the output, enough for bitrates in bps.
+const int kOutputPrecision = 12;
+
+// Nearest-rank percentile of sorted |values|.
+double Percentile(const std::vector<double>& values, double percentile) {
+  if (values.empty())
+    return 0;
+  size_t rank =
+      static_cast<size_t>(std::ceil(percentile * values.size() / 100));
+  rank = std::min(std::max<size_t>(rank, 1), values.size());
+  return values[rank - 1];
+}
+
+// |total| is written as a histogram, percentiles of |latest| as gauges.
+void WritePrometheusDistribution(std::ostringstream& out,
+                                 const std::string& name,
+                                 const std::string& help,
+                                 const StatsDistribution& latest,
+                                 const StatsDistribution& total) {
+  out << "# HELP " << name << " " << help << "\n";
+  out << "# TYPE " << name << " histogram\n";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < total.bucket_bounds.size(); i++) {
+    cumulative += total.bucket_counts[i];
+    out << name << "_bucket{le=\"" << total.bucket_bounds[i] << "\"} "
+        << cumulative << "\n";
+  }
+  out << name << "_bucket{le=\"+Inf\"} " << total.count << "\n";
+  out << name << "_sum " << total.sum << "\n";
+  out << name << "_count " << total.count << "\n";
+  out << "# HELP " << name << "_quantile " << help
+      << ", percentiles of the latest aggregation.\n";
+  out << "# TYPE " << name << "_quantile gauge\n";
+  out << name << "_quantile{quantile=\"0.5\"} " << latest.p50 << "\n";
+  out << name << "_quantile{quantile=\"0.99\"} " << latest.p99 << "\n";
+}
+
+void WriteJsonDistribution(std::ostringstream& out,
+                           const StatsDistribution& distribution) {
+  out << "{\"count\":" << distribution.count << ",\"sum\":" << distribution.sum
+      << ",\"p50\":" << distribution.p50 << ",\"p99\":" << distribution.p99
+      << ",\"buckets\":[";
+  for (size_t i = 0; i < distribution.bucket_counts.size(); i++)
+    out << (i ? "," : "") << distribution.bucket_counts[i];
+  out << "]}";
+}
+}
+
+std::unique_ptr<StatsAggregator> StatsAggregator::aggregator_instance_;
+std::mutex StatsAggregator::aggregator_instance_mutex_;
+
+StatsAggregator* StatsAggregator::Get() {
+  const StatsAggregatorConfiguration& config =
+      GlobalConfiguration::GetStatsAggregatorConfiguration();
+  if (!config.enabled)
+    return nullptr;
+  std::lock_guard<std::mutex> lock(aggregator_instance_mutex_);
+  if (!aggregator_instance_)
+    aggregator_instance_.reset(new StatsAggregator(config));
+  return aggregator_instance_.get();
+}
+
+StatsAggregator::StatsAggregator(const StatsAggregatorConfiguration& config)
+    : config_(config) {
+  if (config_.interval_ms <= 0)
+    return;
+  thread_ = rtc::Thread::Create();
+  thread_->SetName("stats_aggregator_thread", nullptr);
+  thread_->Start();
+  ScheduleExport();
+}
+
+StatsAggregator::~StatsAggregator() {
+  // Pending exports are dropped.
+  if (thread_)
+    thread_->Stop();
+}
+
+void StatsAggregator::AddSource(StatsAggregatorSource* source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  sources_.insert(source);
+}
+
+void StatsAggregator::RemoveSource(StatsAggregatorSource* source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  sources_.erase(source);
+}
+
+AggregatedStats StatsAggregator::Aggregate() {
+  std::vector<StatsAggregatorInput> inputs;
+  {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    inputs.resize(sources_.size());
+    size_t i = 0;
+    for (auto* source : sources_)
+      source->GetStatsAggregatorInput(&inputs[i++]);
+  }
+  AggregatedStats stats = Aggregate(inputs, rtc::TimeMillis());
+  std::lock_guard<std::mutex> lock(totals_mutex_);
+  AddToTotal(stats.round_trip_time_ms, &round_trip_time_ms_total_);
+  AddToTotal(stats.jitter_ms, &jitter_ms_total_);
+  stats.round_trip_time_ms_total = round_trip_time_ms_total_;
+  stats.jitter_ms_total = jitter_ms_total_;
+  return stats;
+}
+
+AggregatedStats StatsAggregator::Aggregate(
+    const std::vector<StatsAggregatorInput>& inputs,
+    int64_t timestamp_ms) {
+  AggregatedStats stats;
+  stats.timestamp_ms = timestamp_ms;
+  stats.round_trip_time_ms.bucket_bounds = kRoundTripTimeBucketsMs;
+  stats.jitter_ms.bucket_bounds = kJitterBucketsMs;
+  std::vector<double> round_trip_times;
+  std::vector<double> jitters;
+  for (const auto& input : inputs) {
+    stats.connections++;
+    if (input.ice_connection_state >= 0 &&
+        input.ice_connection_state < AggregatedStats::kIceStateCount) {
+      stats.connections_by_ice_state[input.ice_connection_state]++;
+    }
+    if (!input.has_sample)
+      continue;
+    for (const auto& stream : input.sample.streams) {
+      if (stream.outbound) {
+        stats.send_bitrate_bps += stream.bitrate_bps;
+        if (stream.round_trip_time_ms > 0)
+          round_trip_times.push_back(stream.round_trip_time_ms);
+      } else {
+        stats.receive_bitrate_bps += stream.bitrate_bps;
+      }
+      if (stream.jitter_ms > 0)
+        jitters.push_back(stream.jitter_ms);
+    }
+  }
+  AddToDistribution(&round_trip_times, &stats.round_trip_time_ms);
+  AddToDistribution(&jitters, &stats.jitter_ms);
+  AddToTotal(stats.round_trip_time_ms, &stats.round_trip_time_ms_total);
+  AddToTotal(stats.jitter_ms, &stats.jitter_ms_total);
+  return stats;
+}
+
+void StatsAggregator::AddToDistribution(std::vector<double>* values,
+                                        StatsDistribution* distribution) {
+  std::sort(values->begin(), values->end());
+  distribution->bucket_counts.assign(distribution->bucket_bounds.size() + 1,
+                                     0);
+  for (double value : *values) {
+    size_t bucket = std::lower_bound(distribution->bucket_bounds.begin(),
+                                     distribution->bucket_bounds.end(),
+                                     value) -
+                    distribution->bucket_bounds.begin();
+    distribution->bucket_counts[bucket]++;
+    distribution->sum += value;
+  }
+  distribution->count = values->size();
+  distribution->p50 = Percentile(*values, 50);
+  distribution->p99 = Percentile(*values, 99);
+}
+
+void StatsAggregator::AddToTotal(const StatsDistribution& distribution,
+                                 StatsDistribution* total) {
+  if (total->bucket_counts.empty()) {
+    total->bucket_bounds = distribution.bucket_bounds;
+    total->bucket_counts.assign(distribution.bucket_counts.size(), 0);
+  }
+  for (size_t i = 0; i < distribution.bucket_counts.size(); i++)
+    total->bucket_counts[i] += distribution.bucket_counts[i];
+  total->count += distribution.count;
+  total->sum += distribution.sum;
+}
+
+std::string StatsAggregator::ToPrometheus(const AggregatedStats& stats) {
+  std::ostringstream out;
+  out.precision(kOutputPrecision);
+  out << "# HELP owt_connections Number of connections by ICE connection "
+         "state.\n";
+  out << "# TYPE owt_connections gauge\n";
+  for (int i = 0; i < AggregatedStats::kIceStateCount; i++) {
+    out << "owt_connections{ice_state=\"" << kIceStateNames[i] << "\"} "
+        << stats.connections_by_ice_state[i] << "\n";
+  }
+  out << "# HELP owt_send_bitrate_bps Total send bitrate of all "
+         "connections.\n";
+  out << "# TYPE owt_send_bitrate_bps gauge\n";
+  out << "owt_send_bitrate_bps " << stats.send_bitrate_bps << "\n";
+  out << "# HELP owt_receive_bitrate_bps Total receive bitrate of all "
+         "connections.\n";
+  out << "# TYPE owt_receive_bitrate_bps gauge\n";
+  out << "owt_receive_bitrate_bps " << stats.receive_bitrate_bps << "\n";
+  WritePrometheusDistribution(out, "owt_round_trip_time_ms",
+                              "Round trip time of sent streams",
+                              stats.round_trip_time_ms,
+                              stats.round_trip_time_ms_total);
+  WritePrometheusDistribution(out, "owt_jitter_ms", "Jitter of all streams",
+                              stats.jitter_ms, stats.jitter_ms_total);
+  return out.str();
+}
+
+std::string StatsAggregator::ToJson(const AggregatedStats& stats) {
+  std::ostringstream out;
+  out.precision(kOutputPrecision);
+  out << "{\"timestamp_ms\":" << stats.timestamp_ms
+      << ",\"connections\":" << stats.connections << ",\"ice_states\":{";
+  for (int i = 0; i < AggregatedStats::kIceStateCount; i++) {
+    out << (i ? "," : "") << "\"" << kIceStateNames[i]
+        << "\":" << stats.connections_by_ice_state[i];
+  }
+  out << "},\"send_bitrate_bps\":" << stats.send_bitrate_bps
+      << ",\"receive_bitrate_bps\":" << stats.receive_bitrate_bps
+      << ",\"round_trip_time_ms\":";
+  WriteJsonDistribution(out, stats.round_trip_time_ms);
+  out << ",\"jitter_ms\":";
+  WriteJsonDistribution(out, stats.jitter_ms);
+  out << "}";
+  return out.str();
+}
+
+void StatsAggregator::ScheduleExport() {
+  thread_->PostDelayedTask(webrtc::ToQueuedTask([this] {
+                             Export();
+                             ScheduleExport();
+                           }),
+                           config_.interval_ms);
+}
+
+void StatsAggregator::Export() {
+  AggregatedStats stats = Aggregate();
+  std::string output = config_.format == StatsExportFormat::kJsonLines
+                           ? ToJson(stats) + "\n"
+                           : ToPrometheus(stats);
+  WriteOutput(output);
+  if (config_.on_export)
+    config_.on_export(output);
+}
+
+void StatsAggregator::WriteOutput(const std::string& output) {
+  if (config_.output_path.empty())
+    return;
+  if (config_.format == StatsExportFormat::kJsonLines) {
+    std::ofstream file(config_.output_path, std::ios::app);
+    file << output;
+    if (!file)
+      RTC_LOG(LS_WARNING) << "Failed to write " << config_.output_path;
+    return;
+  }
+  // Replace the file at once, so readers never see a partial exposition.
+  std::string temp_path = config_.output_path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    file << output;
+    if (!file) {
+      RTC_LOG(LS_WARNING) << "Failed to write " << temp_path;
+      return;
+    }
+  }
+#if defined(WEBRTC_WIN)
+  // rename() fails on Windows if the output exists.
+  bool replaced = MoveFileExW(rtc::ToUtf16(temp_path).c_str(),
+                              rtc::ToUtf16(config_.output_path).c_str(),
+                              MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  bool replaced =
+      rename(temp_path.c_str(), config_.output_path.c_str()) == 0;
+#endif
+  if (!replaced)
+    RTC_LOG(LS_WARNING) << "Failed to replace " << config_.output_path;
+}
+}
+}
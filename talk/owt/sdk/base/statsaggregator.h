@@ -0,0 +1,117 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_STATSAGGREGATOR_H_
+#define OWT_BASE_STATSAGGREGATOR_H_
+#include <array>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "owt/base/RTCClientObserver.h"
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// What a connection contributes to the aggregated stats.
+struct StatsAggregatorInput {
+  // webrtc::PeerConnectionInterface::IceConnectionState.
+  int ice_connection_state = 0;
+  // False if the connection has not sampled its stats yet.
+  bool has_sample = false;
+  RTCCStatsSample sample;
+};
+
+// A connection registered with StatsAggregator.
+class StatsAggregatorSource {
+ public:
+  // Called on the aggregator thread.
+  virtual void GetStatsAggregatorInput(StatsAggregatorInput* input) = 0;
+
+ protected:
+  virtual ~StatsAggregatorSource() {}
+};
+
+// Distribution of a per-stream metric.
+struct StatsDistribution {
+  // Upper bounds of histogram buckets, the last bucket is unbounded.
+  std::vector<double> bucket_bounds;
+  // Counts of values in each bucket, not cumulative. Has one more element than
+  // |bucket_bounds|.
+  std::vector<uint64_t> bucket_counts;
+  uint64_t count = 0;
+  double sum = 0;
+  double p50 = 0;
+  double p99 = 0;
+};
+
+struct AggregatedStats {
+  // Number of webrtc::PeerConnectionInterface::IceConnectionState values.
+  static const int kIceStateCount = 7;
+  int64_t timestamp_ms = 0;
+  int connections = 0;
+  std::array<int, kIceStateCount> connections_by_ice_state = {};
+  double send_bitrate_bps = 0;
+  double receive_bitrate_bps = 0;
+  // Round trip time of sent streams, in milliseconds.
+  StatsDistribution round_trip_time_ms;
+  // Jitter of all streams, in milliseconds.
+  StatsDistribution jitter_ms;
+  // Distributions of all aggregations of an aggregator, so counts never
+  // decrease. Exported as Prometheus histograms. Percentiles are not set.
+  StatsDistribution round_trip_time_ms_total;
+  StatsDistribution jitter_ms_total;
+};
+
+// Process wide registry of connections, which aggregates their latest stats
+// samples on one timer and exports the result. Sources are not queried by the
+// aggregator, they sample their own stats, see StatsSampler.
+class StatsAggregator {
+ public:
+  // Returns the process wide aggregator, or nullptr if it is disabled by
+  // GlobalConfiguration::SetStatsAggregatorConfiguration().
+  static StatsAggregator* Get();
+  // Exports every |config.interval_ms| on a thread owned by this aggregator.
+  // No timer is started if the interval is not positive.
+  explicit StatsAggregator(const StatsAggregatorConfiguration& config);
+  ~StatsAggregator();
+  int interval_ms() const { return config_.interval_ms; }
+  // Can be called on any thread. A source must be removed before it is
+  // destroyed, RemoveSource() waits for an aggregation in progress.
+  void AddSource(StatsAggregatorSource* source);
+  void RemoveSource(StatsAggregatorSource* source);
+  // Aggregate the latest inputs of all sources. Their round trip times and
+  // jitters are added to the totals of this aggregator.
+  AggregatedStats Aggregate();
+
+  // Aggregate |inputs|. Totals only have values of |inputs|.
+  static AggregatedStats Aggregate(
+      const std::vector<StatsAggregatorInput>& inputs,
+      int64_t timestamp_ms);
+  static std::string ToPrometheus(const AggregatedStats& stats);
+  static std::string ToJson(const AggregatedStats& stats);
+
+ private:
+  static void AddToDistribution(std::vector<double>* values,
+                                StatsDistribution* distribution);
+  // Add counts and sum of |distribution| to |total|.
+  static void AddToTotal(const StatsDistribution& distribution,
+                         StatsDistribution* total);
+  void ScheduleExport();
+  void Export();
+  void WriteOutput(const std::string& output);
+
+  const StatsAggregatorConfiguration config_;
+  std::mutex sources_mutex_;
+  std::set<StatsAggregatorSource*> sources_;
+  std::mutex totals_mutex_;
+  StatsDistribution round_trip_time_ms_total_;
+  StatsDistribution jitter_ms_total_;
+  std::unique_ptr<rtc::Thread> thread_;
+  static std::unique_ptr<StatsAggregator> aggregator_instance_;
+  static std::mutex aggregator_instance_mutex_;
+};
+}
+}
+#endif  // OWT_BASE_STATSAGGREGATOR_H_
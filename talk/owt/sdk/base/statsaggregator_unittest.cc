@@ -0,0 +1,185 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/statsaggregator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/api/peer_connection_interface.h"
+#include "webrtc/rtc_base/event.h"
+namespace owt {
+namespace base {
+namespace {
+const int kExportTimeoutMs = 5000;
+
+StatsAggregatorInput CreateInput(int ice_connection_state,
+                                 double send_bitrate_bps,
+                                 double receive_bitrate_bps,
+                                 double round_trip_time_ms,
+                                 double jitter_ms) {
+  StatsAggregatorInput input;
+  input.ice_connection_state = ice_connection_state;
+  input.has_sample = true;
+  RTCCStreamStatsSample outbound;
+  outbound.outbound = true;
+  outbound.bitrate_bps = send_bitrate_bps;
+  outbound.round_trip_time_ms = round_trip_time_ms;
+  RTCCStreamStatsSample inbound;
+  inbound.bitrate_bps = receive_bitrate_bps;
+  inbound.jitter_ms = jitter_ms;
+  input.sample.streams = {outbound, inbound};
+  return input;
+}
+
+class FakeSource : public StatsAggregatorSource {
+ public:
+  explicit FakeSource(const StatsAggregatorInput& input) : input_(input) {}
+  void GetStatsAggregatorInput(StatsAggregatorInput* input) override {
+    *input = input_;
+  }
+
+ private:
+  StatsAggregatorInput input_;
+};
+}  // namespace
+
+TEST(StatsAggregatorTest, AggregatesTotalsAndStates) {
+  std::vector<StatsAggregatorInput> inputs = {
+      CreateInput(webrtc::PeerConnectionInterface::kIceConnectionConnected,
+                  1000000, 500000, 20, 5),
+      CreateInput(webrtc::PeerConnectionInterface::kIceConnectionConnected,
+                  2000000, 1500000, 80, 30),
+      CreateInput(webrtc::PeerConnectionInterface::kIceConnectionChecking, 0,
+                  0, 0, 0)};
+  inputs.push_back(StatsAggregatorInput());
+  AggregatedStats stats = StatsAggregator::Aggregate(inputs, 1234);
+  EXPECT_EQ(1234, stats.timestamp_ms);
+  EXPECT_EQ(4, stats.connections);
+  EXPECT_EQ(2, stats.connections_by_ice_state
+                   [webrtc::PeerConnectionInterface::kIceConnectionConnected]);
+  EXPECT_EQ(1, stats.connections_by_ice_state
+                   [webrtc::PeerConnectionInterface::kIceConnectionChecking]);
+  EXPECT_EQ(1, stats.connections_by_ice_state
+                   [webrtc::PeerConnectionInterface::kIceConnectionNew]);
+  EXPECT_DOUBLE_EQ(3000000, stats.send_bitrate_bps);
+  EXPECT_DOUBLE_EQ(2000000, stats.receive_bitrate_bps);
+  // Streams without RTT or jitter are not counted.
+  EXPECT_EQ(2u, stats.round_trip_time_ms.count);
+  EXPECT_DOUBLE_EQ(100, stats.round_trip_time_ms.sum);
+  EXPECT_EQ(2u, stats.jitter_ms.count);
+}
+
+TEST(StatsAggregatorTest, ComputesPercentilesAndHistogram) {
+  std::vector<StatsAggregatorInput> inputs;
+  for (int i = 100; i >= 1; i--) {
+    inputs.push_back(CreateInput(
+        webrtc::PeerConnectionInterface::kIceConnectionConnected, 0, 0, i, 0));
+  }
+  AggregatedStats stats = StatsAggregator::Aggregate(inputs, 0);
+  const StatsDistribution& rtt = stats.round_trip_time_ms;
+  EXPECT_DOUBLE_EQ(50, rtt.p50);
+  EXPECT_DOUBLE_EQ(99, rtt.p99);
+  ASSERT_EQ(rtt.bucket_bounds.size() + 1, rtt.bucket_counts.size());
+  uint64_t total = 0;
+  for (uint64_t count : rtt.bucket_counts)
+    total += count;
+  EXPECT_EQ(100u, total);
+  // Values 1 to 10 are in the first bucket, bounds are inclusive.
+  EXPECT_EQ(10u, rtt.bucket_counts[0]);
+}
+
+TEST(StatsAggregatorTest, EmptyDistribution) {
+  AggregatedStats stats = StatsAggregator::Aggregate({}, 0);
+  EXPECT_EQ(0, stats.connections);
+  EXPECT_EQ(0u, stats.jitter_ms.count);
+  EXPECT_EQ(0, stats.jitter_ms.p99);
+}
+
+TEST(StatsAggregatorTest, ExportsPrometheusText) {
+  AggregatedStats stats = StatsAggregator::Aggregate(
+      {CreateInput(webrtc::PeerConnectionInterface::kIceConnectionConnected,
+                   1500000, 0, 30, 0)},
+      0);
+  std::string text = StatsAggregator::ToPrometheus(stats);
+  EXPECT_NE(std::string::npos,
+            text.find("owt_connections{ice_state=\"connected\"} 1\n"));
+  EXPECT_NE(std::string::npos, text.find("owt_send_bitrate_bps 1500000\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("# TYPE owt_round_trip_time_ms histogram\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_bucket{le=\"25\"} 0\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_bucket{le=\"50\"} 1\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_bucket{le=\"+Inf\"} 1\n"));
+}
+
+TEST(StatsAggregatorTest, ExportsJsonLine) {
+  AggregatedStats stats = StatsAggregator::Aggregate(
+      {CreateInput(webrtc::PeerConnectionInterface::kIceConnectionFailed, 0, 0,
+                   0, 0)},
+      42);
+  std::string json = StatsAggregator::ToJson(stats);
+  EXPECT_EQ(std::string::npos, json.find('\n'));
+  EXPECT_EQ(0u, json.find("{\"timestamp_ms\":42,\"connections\":1,"));
+  EXPECT_NE(std::string::npos, json.find("\"failed\":1"));
+}
+
+TEST(StatsAggregatorTest, AggregatesRegisteredSources) {
+  StatsAggregatorConfiguration config;
+  config.interval_ms = 0;
+  StatsAggregator aggregator(config);
+  FakeSource connected(CreateInput(
+      webrtc::PeerConnectionInterface::kIceConnectionConnected, 100, 0, 0, 0));
+  FakeSource checking(CreateInput(
+      webrtc::PeerConnectionInterface::kIceConnectionChecking, 10, 0, 0, 0));
+  aggregator.AddSource(&connected);
+  aggregator.AddSource(&checking);
+  EXPECT_EQ(2, aggregator.Aggregate().connections);
+  aggregator.RemoveSource(&checking);
+  AggregatedStats stats = aggregator.Aggregate();
+  EXPECT_EQ(1, stats.connections);
+  EXPECT_DOUBLE_EQ(100, stats.send_bitrate_bps);
+}
+
+TEST(StatsAggregatorTest, AccumulatesHistogramAcrossAggregations) {
+  StatsAggregatorConfiguration config;
+  config.interval_ms = 0;
+  StatsAggregator aggregator(config);
+  FakeSource source(CreateInput(
+      webrtc::PeerConnectionInterface::kIceConnectionConnected, 0, 0, 30, 0));
+  aggregator.AddSource(&source);
+  aggregator.Aggregate();
+  AggregatedStats stats = aggregator.Aggregate();
+  EXPECT_EQ(1u, stats.round_trip_time_ms.count);
+  EXPECT_EQ(2u, stats.round_trip_time_ms_total.count);
+  EXPECT_DOUBLE_EQ(60, stats.round_trip_time_ms_total.sum);
+  std::string text = StatsAggregator::ToPrometheus(stats);
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_bucket{le=\"50\"} 2\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_count 2\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("owt_round_trip_time_ms_quantile{quantile=\"0.5\"} "
+                      "30\n"));
+  aggregator.RemoveSource(&source);
+  EXPECT_EQ(2u, aggregator.Aggregate().round_trip_time_ms_total.count);
+}
+
+TEST(StatsAggregatorTest, ExportsOnTimer) {
+  rtc::Event exported;
+  std::string output;
+  StatsAggregatorConfiguration config;
+  config.interval_ms = 10;
+  config.format = StatsExportFormat::kJsonLines;
+  config.on_export = [&exported, &output](const std::string& text) {
+    if (output.empty()) {
+      output = text;
+      exported.Set();
+    }
+  };
+  StatsAggregator aggregator(config);
+  ASSERT_TRUE(exported.Wait(kExportTimeoutMs));
+  EXPECT_EQ('\n', output.back());
+  EXPECT_EQ(0u, output.find("{\"timestamp_ms\":"));
+}
+}
+}
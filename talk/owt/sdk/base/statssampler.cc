@@ -0,0 +1,139 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/statssampler.h"
+#include <algorithm>
+namespace owt {
+namespace base {
+namespace {
+// Difference of two cumulative counters, 0 if the counter is reset.
+template <typename T>
+double CounterDelta(T current, T previous) {
+  return current >= previous ? static_cast<double>(current - previous) : 0;
+}
+
+const RTCCStreamStatsSample* FindStream(const RTCCStatsSample& sample,
+                                        uint32_t ssrc,
+                                        bool outbound) {
+  for (const auto& stream : sample.streams) {
+    if (stream.ssrc == ssrc && stream.outbound == outbound)
+      return &stream;
+  }
+  return nullptr;
+}
+}
+
+StatsSampler::StatsSampler(size_t history_size)
+    : history_size_(std::max<size_t>(history_size, 1)),
+      samples_(history_size_ + 1),
+      head_(0),
+      count_(0) {}
+
+void StatsSampler::AddReport(const RTCStatsReport& report,
+                             int64_t timestamp_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t index = count_ == 0 ? 0 : (head_ + 1) % samples_.size();
+  RTCCStatsSample& sample = samples_[index];
+  sample.timestamp_ms = timestamp_ms;
+  sample.streams.clear();
+  CollectStreams(report, &sample);
+  if (count_ > 0)
+    ComputeRates(samples_[head_], &sample);
+  head_ = index;
+  count_ = std::min(count_ + 1, history_size_);
+}
+
+bool StatsSampler::GetLatest(RTCCStatsSample* sample) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (count_ == 0)
+    return false;
+  *sample = samples_[head_];
+  return true;
+}
+
+std::vector<RTCCStatsSample> StatsSampler::GetHistory() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<RTCCStatsSample> history;
+  history.reserve(count_);
+  size_t oldest = (head_ + samples_.size() + 1 - count_) % samples_.size();
+  for (size_t i = 0; i < count_; i++)
+    history.push_back(samples_[(oldest + i) % samples_.size()]);
+  return history;
+}
+
+void StatsSampler::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  head_ = 0;
+  count_ = 0;
+}
+
+void StatsSampler::CollectStreams(const RTCStatsReport& report,
+                                  RTCCStatsSample* sample) {
+  for (const RTCStats& stats : report) {
+    if (stats.type == RTCStatsType::kInboundRTP) {
+      const auto& inbound = stats.cast_to<RTCInboundRTPStreamStats>();
+      RTCCStreamStatsSample stream;
+      stream.ssrc = inbound.ssrc;
+      stream.outbound = false;
+      stream.video = inbound.kind == RTCMediaStreamTrackKind::kVideo;
+      stream.bytes = inbound.bytes_received;
+      stream.packets = inbound.packets_received;
+      stream.packets_lost = inbound.packets_lost;
+      stream.frames = inbound.frames_decoded;
+      stream.qp_sum = inbound.qp_sum;
+      stream.jitter_ms = inbound.jitter * 1000;
+      stream.round_trip_time_ms = std::max(inbound.round_trip_time, 0.0) * 1000;
+      sample->streams.push_back(stream);
+    } else if (stats.type == RTCStatsType::kOutboundRTP) {
+      const auto& outbound = stats.cast_to<RTCOutboundRTPStreamStats>();
+      RTCCStreamStatsSample stream;
+      stream.ssrc = outbound.ssrc;
+      stream.outbound = true;
+      stream.video = outbound.kind == RTCMediaStreamTrackKind::kVideo;
+      stream.bytes = outbound.bytes_sent;
+      stream.packets = outbound.packets_sent;
+      stream.frames = outbound.frames_encoded;
+      stream.qp_sum = outbound.qp_sum;
+      sample->streams.push_back(stream);
+    }
+  }
+  // Loss, jitter and RTT of sent streams are reported by the remote side.
+  for (const RTCStats& stats : report) {
+    if (stats.type != RTCStatsType::kRemoteInboundRTP)
+      continue;
+    const auto& remote = stats.cast_to<RTCRemoteInboundRtpStreamStats>();
+    for (auto& stream : sample->streams) {
+      if (stream.outbound && stream.ssrc == remote.ssrc) {
+        stream.packets_lost = remote.packets_lost;
+        stream.jitter_ms = remote.jitter * 1000;
+        stream.round_trip_time_ms = std::max(remote.round_trip_time, 0.0) * 1000;
+      }
+    }
+  }
+}
+
+void StatsSampler::ComputeRates(const RTCCStatsSample& previous,
+                                RTCCStatsSample* sample) {
+  double interval_s = (sample->timestamp_ms - previous.timestamp_ms) / 1000.0;
+  if (interval_s <= 0)
+    return;
+  for (auto& stream : sample->streams) {
+    const RTCCStreamStatsSample* last =
+        FindStream(previous, stream.ssrc, stream.outbound);
+    if (last == nullptr)
+      continue;
+    double packets = CounterDelta(stream.packets, last->packets);
+    double lost = CounterDelta(stream.packets_lost, last->packets_lost);
+    double frames = CounterDelta(stream.frames, last->frames);
+    stream.bitrate_bps = CounterDelta(stream.bytes, last->bytes) * 8 / interval_s;
+    stream.packet_rate = packets / interval_s;
+    stream.frame_rate = frames / interval_s;
+    // Sent packets include the lost ones, received packets do not.
+    double expected = stream.outbound ? packets : packets + lost;
+    stream.loss_fraction = expected > 0 ? std::min(lost / expected, 1.0) : 0;
+    stream.average_qp =
+        frames > 0 ? CounterDelta(stream.qp_sum, last->qp_sum) / frames : 0;
+  }
+}
+}
+}
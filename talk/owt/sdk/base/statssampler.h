@@ -0,0 +1,48 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_STATSSAMPLER_H_
+#define OWT_BASE_STATSSAMPLER_H_
+#include <mutex>
+#include <vector>
+#include "owt/base/RTCClientObserver.h"
+#include "owt/base/connectionstats.h"
+namespace owt {
+namespace base {
+// Converts periodic stats reports of one connection into compact per-stream
+// samples, and keeps the last |history_size| of them in a ring buffer. Rates
+// are computed against the previous sample, so each report is processed once.
+// AddReport() is called on one thread, readers may be on any thread.
+class StatsSampler {
+ public:
+  explicit StatsSampler(size_t history_size);
+  // Add a sample built from |report|, taken at |timestamp_ms|.
+  void AddReport(const RTCStatsReport& report, int64_t timestamp_ms);
+  // Returns false if no sample is taken yet.
+  bool GetLatest(RTCCStatsSample* sample) const;
+  // Samples from the oldest to the latest.
+  std::vector<RTCCStatsSample> GetHistory() const;
+  // Drop all samples, rates of the next sample are 0.
+  void Clear();
+
+ private:
+  // Fill cumulative counters of |sample| from |report|.
+  static void CollectStreams(const RTCStatsReport& report,
+                             RTCCStatsSample* sample);
+  // Compute rates of |sample| against |previous|.
+  static void ComputeRates(const RTCCStatsSample& previous,
+                           RTCCStatsSample* sample);
+
+  mutable std::mutex mutex_;
+  const size_t history_size_;
+  // Preallocated, so stream vectors are reused once the buffer wraps. It has
+  // a slot more than the history, so a new sample never overwrites the
+  // previous one it is compared with.
+  std::vector<RTCCStatsSample> samples_;
+  // Index of the latest sample.
+  size_t head_;
+  size_t count_;
+};
+}
+}
+#endif  // OWT_BASE_STATSSAMPLER_H_
@@ -0,0 +1,148 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/statssampler.h"
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+namespace {
+const uint32_t kInboundSsrc = 1111;
+const uint32_t kOutboundSsrc = 2222;
+
+std::unique_ptr<RTCInboundRTPStreamStats> CreateInbound(uint64_t bytes,
+                                                        uint32_t packets,
+                                                        int32_t lost,
+                                                        uint32_t frames,
+                                                        uint64_t qp_sum) {
+  return std::make_unique<RTCInboundRTPStreamStats>(
+      "inbound", 0, kInboundSsrc, false, "video",
+      RTCMediaStreamTrackKind::kVideo, "", "", "", 0, 0, 0, 0, qp_sum, packets,
+      0, 0, bytes, 0, lost, 0, 0.02, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, frames,
+      0, 0, 0, 0, 0, "", 0, "");
+}
+
+std::unique_ptr<RTCOutboundRTPStreamStats> CreateOutbound(uint64_t bytes,
+                                                          uint32_t packets) {
+  return std::make_unique<RTCOutboundRTPStreamStats>(
+      "outbound", 0, kOutboundSsrc, false, "audio",
+      RTCMediaStreamTrackKind::kAudio, "", "", "", 0, 0, 0, 0, 0, "",
+      "remote-inbound", packets, 0, bytes, 0, 0, 0, 0, 0, 0, 0, 0, "", 0, "",
+      "");
+}
+
+std::unique_ptr<RTCRemoteInboundRtpStreamStats> CreateRemoteInbound(
+    int32_t lost,
+    double round_trip_time) {
+  return std::make_unique<RTCRemoteInboundRtpStreamStats>(
+      "remote-inbound", 0, kOutboundSsrc, RTCMediaStreamTrackKind::kAudio, "",
+      "", lost, 0.01, "outbound", round_trip_time);
+}
+
+std::unique_ptr<RTCStatsReport> CreateReport(uint64_t bytes,
+                                             uint32_t packets,
+                                             int32_t lost,
+                                             uint32_t frames,
+                                             uint64_t qp_sum) {
+  auto report = std::make_unique<RTCStatsReport>();
+  report->AddStats(CreateInbound(bytes, packets, lost, frames, qp_sum));
+  report->AddStats(CreateOutbound(bytes, packets));
+  report->AddStats(CreateRemoteInbound(lost, 0.05));
+  return report;
+}
+}  // namespace
+
+TEST(StatsSamplerTest, NoSampleBeforeFirstReport) {
+  StatsSampler sampler(4);
+  RTCCStatsSample sample;
+  EXPECT_FALSE(sampler.GetLatest(&sample));
+  EXPECT_TRUE(sampler.GetHistory().empty());
+}
+
+TEST(StatsSamplerTest, FirstSampleHasCountersWithoutRates) {
+  StatsSampler sampler(4);
+  sampler.AddReport(*CreateReport(1000, 10, 0, 5, 100), 1000);
+  RTCCStatsSample sample;
+  ASSERT_TRUE(sampler.GetLatest(&sample));
+  EXPECT_EQ(1000, sample.timestamp_ms);
+  ASSERT_EQ(2u, sample.streams.size());
+  for (const auto& stream : sample.streams) {
+    EXPECT_EQ(1000u, stream.bytes);
+    EXPECT_EQ(0, stream.bitrate_bps);
+  }
+}
+
+TEST(StatsSamplerTest, ComputesRatesAgainstPreviousSample) {
+  StatsSampler sampler(4);
+  sampler.AddReport(*CreateReport(1000, 10, 0, 5, 100), 1000);
+  sampler.AddReport(*CreateReport(3000, 100, 10, 35, 700), 3000);
+  RTCCStatsSample sample;
+  ASSERT_TRUE(sampler.GetLatest(&sample));
+  ASSERT_EQ(2u, sample.streams.size());
+  for (const auto& stream : sample.streams) {
+    EXPECT_DOUBLE_EQ(8000, stream.bitrate_bps);
+    EXPECT_DOUBLE_EQ(45, stream.packet_rate);
+    if (stream.outbound) {
+      EXPECT_EQ(kOutboundSsrc, stream.ssrc);
+      EXPECT_FALSE(stream.video);
+      EXPECT_DOUBLE_EQ(50, stream.round_trip_time_ms);
+      EXPECT_DOUBLE_EQ(10, stream.jitter_ms);
+      EXPECT_DOUBLE_EQ(10.0 / 90, stream.loss_fraction);
+    } else {
+      EXPECT_EQ(kInboundSsrc, stream.ssrc);
+      EXPECT_TRUE(stream.video);
+      EXPECT_DOUBLE_EQ(15, stream.frame_rate);
+      EXPECT_DOUBLE_EQ(20, stream.average_qp);
+      EXPECT_DOUBLE_EQ(20, stream.jitter_ms);
+      EXPECT_DOUBLE_EQ(0.1, stream.loss_fraction);
+    }
+  }
+}
+
+TEST(StatsSamplerTest, CounterResetGivesZeroRate) {
+  StatsSampler sampler(4);
+  sampler.AddReport(*CreateReport(3000, 100, 0, 30, 0), 1000);
+  sampler.AddReport(*CreateReport(1000, 10, 0, 5, 0), 2000);
+  RTCCStatsSample sample;
+  ASSERT_TRUE(sampler.GetLatest(&sample));
+  for (const auto& stream : sample.streams)
+    EXPECT_EQ(0, stream.bitrate_bps);
+}
+
+TEST(StatsSamplerTest, HistoryKeepsLatestSamplesInOrder) {
+  StatsSampler sampler(3);
+  for (int i = 1; i <= 5; i++)
+    sampler.AddReport(*CreateReport(i * 1000, i * 10, 0, i, 0), i * 1000);
+  std::vector<RTCCStatsSample> history = sampler.GetHistory();
+  ASSERT_EQ(3u, history.size());
+  EXPECT_EQ(3000, history[0].timestamp_ms);
+  EXPECT_EQ(4000, history[1].timestamp_ms);
+  EXPECT_EQ(5000, history[2].timestamp_ms);
+  for (const auto& stream : history[2].streams)
+    EXPECT_DOUBLE_EQ(8000, stream.bitrate_bps);
+}
+
+TEST(StatsSamplerTest, SingleSampleHistoryComputesRates) {
+  StatsSampler sampler(1);
+  sampler.AddReport(*CreateReport(1000, 10, 0, 5, 100), 1000);
+  sampler.AddReport(*CreateReport(3000, 100, 10, 35, 700), 3000);
+  std::vector<RTCCStatsSample> history = sampler.GetHistory();
+  ASSERT_EQ(1u, history.size());
+  EXPECT_EQ(3000, history[0].timestamp_ms);
+  ASSERT_EQ(2u, history[0].streams.size());
+  for (const auto& stream : history[0].streams)
+    EXPECT_DOUBLE_EQ(8000, stream.bitrate_bps);
+}
+
+TEST(StatsSamplerTest, ClearDropsSamples) {
+  StatsSampler sampler(3);
+  sampler.AddReport(*CreateReport(1000, 10, 0, 5, 0), 1000);
+  sampler.Clear();
+  RTCCStatsSample sample;
+  EXPECT_FALSE(sampler.GetLatest(&sample));
+  sampler.AddReport(*CreateReport(3000, 30, 0, 15, 0), 2000);
+  ASSERT_TRUE(sampler.GetLatest(&sample));
+  for (const auto& stream : sample.streams)
+    EXPECT_EQ(0, stream.bitrate_bps);
+}
+}
+}
@@ -477,6 +477,10 @@ LocalStream::LocalStream(MediaStreamInterface* media_stream,
 #endif
 LocalStream::~LocalStream() {
   RTC_LOG(LS_INFO) << "Destroy LocalCameraStream.";
+#if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
+  if (pushed_frame_source_ != nullptr)
+    pushed_frame_source_->Release();
+#endif
   if (media_stream_ != nullptr) {
     // Remove all tracks before dispose stream.
     auto audio_tracks = media_stream_->GetAudioTracks();
@@ -535,6 +539,11 @@ std::shared_ptr<LocalStream> LocalStream::Create(
   std::shared_ptr<LocalStream> stream(new LocalStream(parameters, encoder));
   return stream;
 }
+std::shared_ptr<LocalStream> LocalStream::Create(
+    std::shared_ptr<LocalCustomizedStreamParameters> parameters) {
+  std::shared_ptr<LocalStream> stream(new LocalStream(parameters));
+  return stream;
+}
 #endif
 
 #ifdef OWT_ENABLE_QUIC
@@ -682,6 +691,7 @@ LocalStream::LocalStream(
         LocalDesktopCaptureTrackSource::Create(parameters, std::move(observer));
     if (video_device) {
       std::string video_track_id("VideoTrack-" + rtc::CreateRandomUuid());
+      video_device->SetTrackId(video_track_id);
       rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
           factory->CreateLocalVideoTrack(video_track_id, video_device);
       stream->AddTrack(video_track);
@@ -719,6 +729,7 @@ LocalStream::LocalStream(
         LocalRawCaptureTrackSource::Create(parameters, std::move(framer));
     if (video_device) {
       std::string video_track_id("VideoTrack-" + rtc::CreateRandomUuid());
+      video_device->SetTrackId(video_track_id);
       rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
           pcd_factory->CreateLocalVideoTrack(video_track_id, video_device);
       stream->AddTrack(video_track);
@@ -752,6 +763,7 @@ LocalStream::LocalStream(
         LocalEncodedCaptureTrackSource::Create(parameters, encoder);
     if (video_device) {
       std::string video_track_id("VideoTrack-" + rtc::CreateRandomUuid());
+      video_device->SetTrackId(video_track_id);
       rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
           pcd_factory->CreateLocalVideoTrack(video_track_id, video_device);
       stream->AddTrack(video_track);
@@ -767,6 +779,45 @@ LocalStream::LocalStream(
   media_stream_->AddRef();
 }
 
+LocalStream::LocalStream(
+    std::shared_ptr<LocalCustomizedStreamParameters> parameters) {
+  if (!parameters->VideoEnabled() && !parameters->AudioEnabled()) {
+    RTC_LOG(LS_WARNING) << "Create LocalStream without video and audio.";
+  }
+  scoped_refptr<PeerConnectionDependencyFactory> pcd_factory =
+      PeerConnectionDependencyFactory::Get();
+  std::string media_stream_id("MediaStream-" + rtc::CreateRandomUuid());
+  Id(media_stream_id);
+  scoped_refptr<MediaStreamInterface> stream =
+      pcd_factory->CreateLocalMediaStream(media_stream_id);
+  if (parameters->VideoEnabled()) {
+    rtc::scoped_refptr<LocalPushedFrameTrackSource> video_device =
+        LocalPushedFrameTrackSource::Create();
+    std::string video_track_id("VideoTrack-" + rtc::CreateRandomUuid());
+    video_device->SetTrackId(video_track_id);
+    rtc::scoped_refptr<webrtc::VideoTrackInterface> video_track =
+        pcd_factory->CreateLocalVideoTrack(video_track_id, video_device);
+    stream->AddTrack(video_track);
+    pushed_frame_source_ = video_device.release();
+  }
+  if (parameters->AudioEnabled()) {
+    std::string audio_track_id("AudioTrack-" + rtc::CreateRandomUuid());
+    scoped_refptr<AudioTrackInterface> audio_track =
+        pcd_factory->CreateLocalAudioTrack(audio_track_id);
+    stream->AddTrack(audio_track);
+  }
+  media_stream_ = stream;
+  media_stream_->AddRef();
+}
+
+bool LocalStream::PushVideoFrame(const PushedVideoFrame& frame) {
+  if (pushed_frame_source_ == nullptr) {
+    RTC_LOG(LS_ERROR) << "Stream is not created for pushed video frames.";
+    return false;
+  }
+  return pushed_frame_source_->PushFrame(frame);
+}
+
 void LocalStream::SelectRecordingDevice(int index) {
   scoped_refptr<PeerConnectionDependencyFactory> pcd_factory =
       PeerConnectionDependencyFactory::Get();
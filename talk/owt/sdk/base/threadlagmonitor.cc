@@ -0,0 +1,168 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/threadlagmonitor.h"
+#include <algorithm>
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+const std::vector<int64_t> kLagBucketsUs = {100,   500,    1000,   5000,
+                                            10000, 50000,  100000, 500000,
+                                            1000000};
+
+void AddToHistogram(int64_t lag_us, ThreadLagHistogram* histogram) {
+  size_t bucket = std::lower_bound(histogram->bucket_bounds_us.begin(),
+                                   histogram->bucket_bounds_us.end(), lag_us) -
+                  histogram->bucket_bounds_us.begin();
+  histogram->bucket_counts[bucket]++;
+  histogram->count++;
+  histogram->sum_us += lag_us;
+  histogram->max_us = std::max(histogram->max_us, lag_us);
+}
+}
+
+ThreadLagMonitor* ThreadLagMonitor::Get() {
+  const ThreadLagMonitorConfiguration& config =
+      GlobalConfiguration::GetThreadLagMonitorConfiguration();
+  if (!config.enabled)
+    return nullptr;
+  // Leaked, so it outlives factories destroyed by static destructors.
+  static ThreadLagMonitor* monitor = new ThreadLagMonitor(config);
+  return monitor;
+}
+
+ThreadLagMonitor::ThreadLagMonitor(const ThreadLagMonitorConfiguration& config)
+    : config_(config), state_(std::make_shared<State>()) {
+  if (config_.interval_ms <= 0)
+    return;
+  thread_ = rtc::Thread::Create();
+  thread_->SetName("thread_lag_monitor_thread", nullptr);
+  thread_->Start();
+  ScheduleProbe();
+}
+
+ThreadLagMonitor::~ThreadLagMonitor() {
+  // Pending probes are ignored when they run.
+  if (thread_)
+    thread_->Stop();
+}
+
+void ThreadLagMonitor::AddThread(rtc::Thread* thread,
+                                 const std::string& name) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  Target& target = state_->targets[thread];
+  target.name = name;
+  target.histogram.thread_name = name;
+  target.histogram.bucket_bounds_us = kLagBucketsUs;
+  target.histogram.bucket_counts.assign(kLagBucketsUs.size() + 1, 0);
+}
+
+void ThreadLagMonitor::RemoveThread(rtc::Thread* thread) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->targets.erase(thread);
+}
+
+void ThreadLagMonitor::Probe() {
+  const int64_t threshold_us =
+      static_cast<int64_t>(config_.stall_threshold_ms) * 1000;
+  std::vector<ThreadStall> stalls;
+  std::vector<std::pair<rtc::Thread*, uint64_t>> probes;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    stalls.swap(state_->completed_stalls);
+    int64_t now_us = rtc::TimeMicros();
+    for (auto& entry : state_->targets) {
+      Target& target = entry.second;
+      if (target.probe_id == 0) {
+        target.probe_id = state_->next_probe_id++;
+        target.probe_posted_us = now_us;
+        target.blocked_reported = false;
+        probes.push_back(std::make_pair(entry.first, target.probe_id));
+        continue;
+      }
+      int64_t waited_us = now_us - target.probe_posted_us;
+      if (!target.blocked_reported && waited_us >= threshold_us) {
+        target.blocked_reported = true;
+        ThreadStall stall;
+        stall.thread_name = target.name;
+        stall.lag_us = waited_us;
+        stalls.push_back(stall);
+      }
+    }
+    // Posting while holding the lock keeps threads from being removed and
+    // destroyed meanwhile.
+    std::shared_ptr<State> state = state_;
+    for (const auto& probe : probes) {
+      rtc::Thread* thread = probe.first;
+      uint64_t probe_id = probe.second;
+      thread->PostTask(
+          webrtc::ToQueuedTask([state, thread, probe_id, threshold_us] {
+            OnProbeRun(state, thread, probe_id, threshold_us);
+          }));
+    }
+  }
+  for (const auto& stall : stalls)
+    ReportStall(stall);
+}
+
+void ThreadLagMonitor::OnProbeRun(const std::shared_ptr<State>& state,
+                                  rtc::Thread* thread,
+                                  uint64_t probe_id,
+                                  int64_t threshold_us) {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  auto it = state->targets.find(thread);
+  // The thread is removed, possibly added again, since the probe is posted.
+  if (it == state->targets.end() || it->second.probe_id != probe_id)
+    return;
+  Target& target = it->second;
+  int64_t lag_us = rtc::TimeMicros() - target.probe_posted_us;
+  target.probe_id = 0;
+  AddToHistogram(lag_us, &target.histogram);
+  if (lag_us >= threshold_us) {
+    ThreadStall stall;
+    stall.thread_name = target.name;
+    stall.lag_us = lag_us;
+    stall.completed = true;
+    state->completed_stalls.push_back(stall);
+  }
+}
+
+void ThreadLagMonitor::ReportStall(const ThreadStall& stall) {
+  if (stall.completed) {
+    RTC_LOG(LS_WARNING) << "Thread " << stall.thread_name << " stalled, a task "
+                        << "waited " << stall.lag_us / 1000 << " ms.";
+  } else {
+    RTC_LOG(LS_WARNING) << "Thread " << stall.thread_name << " is blocked, a "
+                        << "task has waited " << stall.lag_us / 1000
+                        << " ms.";
+  }
+  if (config_.on_stall)
+    config_.on_stall(stall);
+}
+
+std::vector<ThreadLagHistogram> ThreadLagMonitor::GetHistograms() const {
+  std::vector<ThreadLagHistogram> histograms;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (const auto& entry : state_->targets)
+      histograms.push_back(entry.second.histogram);
+  }
+  std::sort(histograms.begin(), histograms.end(),
+            [](const ThreadLagHistogram& a, const ThreadLagHistogram& b) {
+              return a.thread_name < b.thread_name;
+            });
+  return histograms;
+}
+
+void ThreadLagMonitor::ScheduleProbe() {
+  thread_->PostDelayedTask(webrtc::ToQueuedTask([this] {
+                             Probe();
+                             ScheduleProbe();
+                           }),
+                           config_.interval_ms);
+}
+}
+}
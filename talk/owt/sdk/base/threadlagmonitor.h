@@ -0,0 +1,67 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_THREADLAGMONITOR_H_
+#define OWT_BASE_THREADLAGMONITOR_H_
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "owt/base/globalconfiguration.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+// Measures how long tasks wait in the queues of registered threads, by
+// posting a probe task to each of them periodically. A thread has at most one
+// probe pending, so a blocked thread is not flooded with probes.
+class ThreadLagMonitor {
+ public:
+  // Returns the process wide monitor, or nullptr if it is disabled by
+  // GlobalConfiguration::SetThreadLagMonitorConfiguration().
+  static ThreadLagMonitor* Get();
+  // Probes every |config.interval_ms| on a thread owned by this monitor. No
+  // timer is started if the interval is not positive.
+  explicit ThreadLagMonitor(const ThreadLagMonitorConfiguration& config);
+  ~ThreadLagMonitor();
+  // Can be called on any thread. A thread must be removed before it is
+  // destroyed. Its pending probe is ignored once it is removed.
+  void AddThread(rtc::Thread* thread, const std::string& name);
+  void RemoveThread(rtc::Thread* thread);
+  // Report stalls found since last call, and post a probe to each thread
+  // without one pending.
+  void Probe();
+  std::vector<ThreadLagHistogram> GetHistograms() const;
+
+ private:
+  struct Target {
+    std::string name;
+    ThreadLagHistogram histogram;
+    // Id of the pending probe, 0 if none.
+    uint64_t probe_id = 0;
+    int64_t probe_posted_us = 0;
+    // Set if the pending probe is reported as blocked.
+    bool blocked_reported = false;
+  };
+  // Shared with probe tasks, which may run after the monitor is destroyed.
+  struct State {
+    std::mutex mutex;
+    std::map<rtc::Thread*, Target> targets;
+    // Stalls of completed probes, reported by next Probe().
+    std::vector<ThreadStall> completed_stalls;
+    uint64_t next_probe_id = 1;
+  };
+  static void OnProbeRun(const std::shared_ptr<State>& state,
+                         rtc::Thread* thread,
+                         uint64_t probe_id,
+                         int64_t threshold_us);
+  void ReportStall(const ThreadStall& stall);
+  void ScheduleProbe();
+
+  const ThreadLagMonitorConfiguration config_;
+  std::shared_ptr<State> state_;
+  std::unique_ptr<rtc::Thread> thread_;
+};
+}
+}
+#endif  // OWT_BASE_THREADLAGMONITOR_H_
@@ -0,0 +1,126 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/threadlagmonitor.h"
+#include <chrono>
+#include <thread>
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/rtc_base/event.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+namespace owt {
+namespace base {
+namespace {
+const int kTimeoutMs = 5000;
+const int kStallThresholdMs = 20;
+
+class ThreadLagMonitorTest : public testing::Test {
+ protected:
+  ThreadLagMonitorTest() {
+    ThreadLagMonitorConfiguration config;
+    config.enabled = true;
+    // Probes are triggered by the tests.
+    config.interval_ms = 0;
+    config.stall_threshold_ms = kStallThresholdMs;
+    config.on_stall = [this](const ThreadStall& stall) {
+      stalls_.push_back(stall);
+    };
+    monitor_.reset(new ThreadLagMonitor(config));
+    thread_ = rtc::Thread::Create();
+    thread_->Start();
+  }
+
+  ~ThreadLagMonitorTest() override {
+    monitor_->RemoveThread(thread_.get());
+    thread_->Stop();
+  }
+
+  // Wait until tasks posted to |thread| so far have run.
+  static void Flush(rtc::Thread* thread) {
+    rtc::Event done;
+    thread->PostTask(webrtc::ToQueuedTask([&done] { done.Set(); }));
+    ASSERT_TRUE(done.Wait(kTimeoutMs));
+  }
+
+  // Block |thread_| until |release| is set.
+  void Block(rtc::Event* release) {
+    thread_->PostTask(
+        webrtc::ToQueuedTask([release] { release->Wait(kTimeoutMs); }));
+  }
+
+  // Invoked on the test thread by Probe().
+  std::vector<ThreadStall> stalls_;
+  std::unique_ptr<ThreadLagMonitor> monitor_;
+  std::unique_ptr<rtc::Thread> thread_;
+};
+}  // namespace
+
+TEST_F(ThreadLagMonitorTest, RecordsLagOfEachThread) {
+  std::unique_ptr<rtc::Thread> other = rtc::Thread::Create();
+  other->Start();
+  monitor_->AddThread(thread_.get(), "b_thread");
+  monitor_->AddThread(other.get(), "a_thread");
+  monitor_->Probe();
+  Flush(thread_.get());
+  Flush(other.get());
+  std::vector<ThreadLagHistogram> histograms = monitor_->GetHistograms();
+  ASSERT_EQ(2u, histograms.size());
+  EXPECT_EQ("a_thread", histograms[0].thread_name);
+  EXPECT_EQ("b_thread", histograms[1].thread_name);
+  for (const auto& histogram : histograms) {
+    EXPECT_EQ(1u, histogram.count);
+    ASSERT_EQ(histogram.bucket_bounds_us.size() + 1,
+              histogram.bucket_counts.size());
+  }
+  EXPECT_TRUE(stalls_.empty());
+  monitor_->RemoveThread(other.get());
+}
+
+TEST_F(ThreadLagMonitorTest, ReportsBlockedThreadOnceThenCompletion) {
+  monitor_->AddThread(thread_.get(), "blocked_thread");
+  rtc::Event release;
+  Block(&release);
+  monitor_->Probe();
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(kStallThresholdMs * 2));
+  monitor_->Probe();
+  ASSERT_EQ(1u, stalls_.size());
+  EXPECT_EQ("blocked_thread", stalls_[0].thread_name);
+  EXPECT_FALSE(stalls_[0].completed);
+  EXPECT_GE(stalls_[0].lag_us, kStallThresholdMs * 1000);
+  // Still blocked, it is not reported again.
+  monitor_->Probe();
+  EXPECT_EQ(1u, stalls_.size());
+
+  release.Set();
+  Flush(thread_.get());
+  ThreadLagHistogram histogram = monitor_->GetHistograms()[0];
+  // Only one probe is pending at a time.
+  EXPECT_EQ(1u, histogram.count);
+  EXPECT_EQ(histogram.sum_us, histogram.max_us);
+  // Completed stalls are reported by next probe.
+  monitor_->Probe();
+  ASSERT_EQ(2u, stalls_.size());
+  EXPECT_TRUE(stalls_[1].completed);
+  EXPECT_GE(stalls_[1].lag_us, stalls_[0].lag_us);
+  EXPECT_EQ(histogram.max_us, stalls_[1].lag_us);
+}
+
+TEST_F(ThreadLagMonitorTest, IgnoresProbeOfRemovedThread) {
+  monitor_->AddThread(thread_.get(), "removed_thread");
+  rtc::Event release;
+  Block(&release);
+  monitor_->Probe();
+  monitor_->RemoveThread(thread_.get());
+  monitor_->AddThread(thread_.get(), "added_thread");
+  release.Set();
+  Flush(thread_.get());
+  std::vector<ThreadLagHistogram> histograms = monitor_->GetHistograms();
+  ASSERT_EQ(1u, histograms.size());
+  EXPECT_EQ("added_thread", histograms[0].thread_name);
+  EXPECT_EQ(0u, histograms[0].count);
+  monitor_->Probe();
+  Flush(thread_.get());
+  EXPECT_EQ(1u, monitor_->GetHistograms()[0].count);
+}
+}
+}
@@ -0,0 +1,108 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/threadutils.h"
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#elif defined(WEBRTC_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(WEBRTC_POSIX)
+#include <time.h>
+#endif
+#include "webrtc/rtc_base/logging.h"
+namespace owt {
+namespace base {
+namespace {
+bool ApplyAffinity(const std::vector<int>& cpus) {
+  if (cpus.empty())
+    return true;
+#if defined(WEBRTC_WIN)
+  DWORD_PTR mask = 0;
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+      mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+  return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(WEBRTC_LINUX)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &cpu_set);
+  }
+  // sched_setaffinity with a thread id also works on Android, which does not
+  // have pthread_setaffinity_np.
+  pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+  return CPU_COUNT(&cpu_set) > 0 &&
+         sched_setaffinity(tid, sizeof(cpu_set), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+bool ApplyPriority(ThreadPriority priority) {
+  if (priority == ThreadPriority::kNormal)
+    return true;
+#if defined(WEBRTC_WIN)
+  return SetThreadPriority(GetCurrentThread(),
+                           priority == ThreadPriority::kRealtime
+                               ? THREAD_PRIORITY_TIME_CRITICAL
+                               : THREAD_PRIORITY_HIGHEST) != 0;
+#elif defined(WEBRTC_LINUX)
+  if (priority == ThreadPriority::kRealtime) {
+    // Stay at the low end of realtime priorities so kernel threads and audio
+    // threads of the application are not starved.
+    sched_param param;
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+  }
+  pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+  return setpriority(PRIO_PROCESS, tid, -10) == 0;
+#else
+  return false;
+#endif
+}
+}  // namespace
+
+bool ApplyCurrentThreadSettings(const ThreadSettings& settings) {
+  bool result = true;
+  if (!ApplyAffinity(settings.cpu_affinity)) {
+    RTC_LOG(LS_WARNING) << "Failed to set CPU affinity of current thread.";
+    result = false;
+  }
+  if (!ApplyPriority(settings.priority)) {
+    RTC_LOG(LS_WARNING) << "Failed to set priority of current thread.";
+    result = false;
+  }
+  return result;
+}
+
+int64_t CurrentThreadCpuTimeUs() {
+#if defined(WEBRTC_WIN)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                      &kernel_time, &user_time))
+    return -1;
+  ULARGE_INTEGER kernel, user;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+  // FILETIME is in 100-nanosecond units.
+  return static_cast<int64_t>((kernel.QuadPart + user.QuadPart) / 10);
+#elif defined(WEBRTC_POSIX)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return -1;
+  return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+  return -1;
+#endif
+}
+}
+}
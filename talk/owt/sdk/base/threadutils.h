@@ -0,0 +1,18 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_THREADUTILS_H_
+#define OWT_BASE_THREADUTILS_H_
+#include <stdint.h>
+#include "owt/base/globalconfiguration.h"
+namespace owt {
+namespace base {
+// Apply CPU affinity and priority in |settings| to the calling thread. Returns
+// false if any of them cannot be applied.
+bool ApplyCurrentThreadSettings(const ThreadSettings& settings);
+// Returns CPU time consumed by the calling thread in microseconds, or -1 if it
+// is not supported on current platform.
+int64_t CurrentThreadCpuTimeUs();
+}
+}
+#endif  // OWT_BASE_THREADUTILS_H_
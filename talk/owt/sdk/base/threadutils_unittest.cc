@@ -0,0 +1,81 @@
+// Copyright (C) <2018> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/threadutils.h"
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#elif defined(WEBRTC_LINUX)
+#include <sched.h>
+#endif
+#include <thread>
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+namespace owt {
+namespace base {
+namespace {
+#if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
+// Returns the first CPU the process may run on, which is not necessarily CPU 0
+// in containers or restricted cpusets. Returns -1 on failure.
+int FirstAllowedCpu() {
+#if defined(WEBRTC_WIN)
+  DWORD_PTR process_mask = 0;
+  DWORD_PTR system_mask = 0;
+  if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask,
+                              &system_mask)) {
+    return -1;
+  }
+  for (int cpu = 0; cpu < static_cast<int>(sizeof(DWORD_PTR) * 8); cpu++) {
+    if (process_mask & (static_cast<DWORD_PTR>(1) << cpu))
+      return cpu;
+  }
+#else
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+    return -1;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &cpu_set))
+      return cpu;
+  }
+#endif
+  return -1;
+}
+#endif
+}  // namespace
+
+TEST(ThreadUtilsTest, DefaultSettingsAreAlwaysApplied) {
+  EXPECT_TRUE(ApplyCurrentThreadSettings(ThreadSettings()));
+}
+
+#if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
+TEST(ThreadUtilsTest, PinToFirstAllowedCore) {
+  int cpu = FirstAllowedCpu();
+  ASSERT_GE(cpu, 0);
+  bool result = false;
+  // Use a separate thread so affinity of the test runner is not changed.
+  std::thread thread([&result, cpu] {
+    ThreadSettings settings;
+    settings.cpu_affinity.push_back(cpu);
+    result = ApplyCurrentThreadSettings(settings);
+  });
+  thread.join();
+  EXPECT_TRUE(result);
+}
+#endif
+
+#if defined(WEBRTC_WIN) || defined(WEBRTC_POSIX)
+TEST(ThreadUtilsTest, CpuTimeIncreasesWithWork) {
+  int64_t begin = CurrentThreadCpuTimeUs();
+  ASSERT_GE(begin, 0);
+  volatile uint64_t sum = 0;
+  int64_t end = begin;
+  for (int i = 0; end <= begin && i < 1000; i++) {
+    for (int j = 0; j < 1000000; j++)
+      sum = sum + j;
+    end = CurrentThreadCpuTimeUs();
+  }
+  EXPECT_GT(end, begin);
+}
+#endif
+}
+}
@@ -0,0 +1,336 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/tracing.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/platform_thread_types.h"
+#include "webrtc/rtc_base/thread.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+namespace {
+// Events kept per thread.
+const size_t kTraceBufferSize = 16384;
+const char kTraceCategory[] = "owt";
+
+// Ring buffer written by its thread only. Fields are atomic so the collecting
+// thread can read them while the buffer is written, entries overwritten during
+// the read are dropped.
+class TraceBuffer {
+ public:
+  TraceBuffer(int64_t thread_id, const std::string& thread_name)
+      : thread_id_(thread_id),
+        thread_name_(thread_name),
+        entries_(kTraceBufferSize),
+        write_index_(0),
+        start_index_(0) {}
+
+  void Add(const char* name, int64_t begin_us, int64_t duration_us) {
+    uint64_t index = write_index_.load(std::memory_order_relaxed);
+    Entry& entry = entries_[index % kTraceBufferSize];
+    entry.name.store(name, std::memory_order_relaxed);
+    entry.begin_us.store(begin_us, std::memory_order_relaxed);
+    entry.duration_us.store(duration_us, std::memory_order_relaxed);
+    write_index_.store(index + 1, std::memory_order_release);
+  }
+
+  // Discard current events. Called with the registry locked.
+  void Clear() { start_index_ = write_index_.load(std::memory_order_acquire); }
+
+  // Called with the registry locked.
+  TraceThread Read() const {
+    TraceThread thread;
+    thread.thread_id = thread_id_;
+    thread.thread_name = thread_name_;
+    uint64_t end = write_index_.load(std::memory_order_acquire);
+    uint64_t begin = std::max(
+        start_index_, end > kTraceBufferSize ? end - kTraceBufferSize : 0);
+    for (uint64_t i = begin; i < end; i++) {
+      const Entry& entry = entries_[i % kTraceBufferSize];
+      TraceEvent event;
+      event.name = entry.name.load(std::memory_order_relaxed);
+      event.begin_us = entry.begin_us.load(std::memory_order_relaxed);
+      event.duration_us = entry.duration_us.load(std::memory_order_relaxed);
+      thread.events.push_back(event);
+    }
+    // Drop entries the writer may have overwritten while they were read,
+    // including the one it may be writing now.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t valid_begin =
+        write_index_.load(std::memory_order_relaxed) + 1;
+    valid_begin = valid_begin > kTraceBufferSize
+                      ? valid_begin - kTraceBufferSize
+                      : 0;
+    if (valid_begin > begin) {
+      size_t dropped = static_cast<size_t>(
+          std::min<uint64_t>(valid_begin - begin, thread.events.size()));
+      thread.events.erase(thread.events.begin(),
+                          thread.events.begin() + dropped);
+    }
+    return thread;
+  }
+
+ private:
+  struct Entry {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> begin_us{0};
+    std::atomic<int64_t> duration_us{0};
+  };
+  const int64_t thread_id_;
+  const std::string thread_name_;
+  std::vector<Entry> entries_;
+  std::atomic<uint64_t> write_index_;
+  // First event since Tracing::Start().
+  uint64_t start_index_;
+};
+
+// Buffers of all threads which recorded an event. They are kept after their
+// threads exit, so events of short lived threads are collected.
+std::mutex& RegistryMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::vector<std::shared_ptr<TraceBuffer>>& Registry() {
+  static auto* buffers = new std::vector<std::shared_ptr<TraceBuffer>>();
+  return *buffers;
+}
+
+TraceBuffer* CurrentThreadBuffer() {
+  thread_local TraceBuffer* buffer = nullptr;
+  if (buffer != nullptr)
+    return buffer;
+  int64_t thread_id = static_cast<int64_t>(rtc::CurrentThreadId());
+  rtc::Thread* thread = rtc::Thread::Current();
+  std::string name = thread != nullptr && !thread->name().empty()
+                         ? thread->name()
+                         : "thread_" + std::to_string(thread_id);
+  auto created = std::make_shared<TraceBuffer>(thread_id, name);
+  std::lock_guard<std::mutex> lock(RegistryMutex());
+  Registry().push_back(created);
+  buffer = created.get();
+  return buffer;
+}
+
+int64_t ProcessId() {
+#if defined(WEBRTC_WIN)
+  return static_cast<int64_t>(GetCurrentProcessId());
+#else
+  return static_cast<int64_t>(getpid());
+#endif
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped += c;
+  }
+  return escaped;
+}
+
+// Minimal protobuf encoder for the Perfetto trace.
+class ProtoWriter {
+ public:
+  void WriteVarint(uint32_t field, uint64_t value) {
+    WriteRawVarint(static_cast<uint64_t>(field) << 3);
+    WriteRawVarint(value);
+  }
+  void WriteBytes(uint32_t field, const std::string& value) {
+    WriteRawVarint((static_cast<uint64_t>(field) << 3) | 2);
+    WriteRawVarint(value.size());
+    data_ += value;
+  }
+  const std::string& data() const { return data_; }
+
+ private:
+  void WriteRawVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_ += static_cast<char>((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    data_ += static_cast<char>(value);
+  }
+  std::string data_;
+};
+
+// Field numbers of perfetto/trace/trace_packet.proto and related messages.
+const uint32_t kTracePacketField = 1;
+const uint32_t kPacketTimestampField = 8;
+const uint32_t kPacketSequenceIdField = 10;
+const uint32_t kPacketTrackEventField = 11;
+const uint32_t kPacketTrackDescriptorField = 60;
+const uint32_t kTrackDescriptorUuidField = 1;
+const uint32_t kTrackDescriptorThreadField = 4;
+const uint32_t kThreadDescriptorPidField = 1;
+const uint32_t kThreadDescriptorTidField = 2;
+const uint32_t kThreadDescriptorNameField = 5;
+const uint32_t kTrackEventTypeField = 9;
+const uint32_t kTrackEventTrackUuidField = 11;
+const uint32_t kTrackEventCategoriesField = 22;
+const uint32_t kTrackEventNameField = 23;
+const uint64_t kTrackEventSliceBegin = 1;
+const uint64_t kTrackEventSliceEnd = 2;
+const uint32_t kSequenceId = 1;
+
+void WritePacket(ProtoWriter* trace, const ProtoWriter& packet) {
+  trace->WriteBytes(kTracePacketField, packet.data());
+}
+
+void WriteSlice(ProtoWriter* trace,
+                uint64_t track_uuid,
+                int64_t timestamp_us,
+                const char* name) {
+  ProtoWriter track_event;
+  track_event.WriteVarint(kTrackEventTypeField,
+                          name ? kTrackEventSliceBegin : kTrackEventSliceEnd);
+  track_event.WriteVarint(kTrackEventTrackUuidField, track_uuid);
+  if (name != nullptr) {
+    track_event.WriteBytes(kTrackEventCategoriesField, kTraceCategory);
+    track_event.WriteBytes(kTrackEventNameField, name);
+  }
+  ProtoWriter packet;
+  packet.WriteVarint(kPacketTimestampField,
+                     static_cast<uint64_t>(timestamp_us) * 1000);
+  packet.WriteVarint(kPacketSequenceIdField, kSequenceId);
+  packet.WriteBytes(kPacketTrackEventField, track_event.data());
+  WritePacket(trace, packet);
+}
+}
+
+std::atomic<bool> Tracing::enabled_(false);
+
+void Tracing::Start() {
+  {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    for (const auto& buffer : Registry())
+      buffer->Clear();
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracing::Stop() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracing::AddEvent(const char* name, int64_t begin_us, int64_t end_us) {
+  CurrentThreadBuffer()->Add(name, begin_us, end_us - begin_us);
+}
+
+std::vector<TraceThread> Tracing::Collect() {
+  std::vector<TraceThread> threads;
+  std::lock_guard<std::mutex> lock(RegistryMutex());
+  for (const auto& buffer : Registry()) {
+    TraceThread thread = buffer->Read();
+    if (!thread.events.empty())
+      threads.push_back(std::move(thread));
+  }
+  return threads;
+}
+
+std::string Tracing::ToChromeJson(const std::vector<TraceThread>& threads) {
+  int64_t pid = ProcessId();
+  std::ostringstream out;
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& thread : threads) {
+    out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\","
+        << "\"pid\":" << pid << ",\"tid\":" << thread.thread_id
+        << ",\"args\":{\"name\":\"" << EscapeJson(thread.thread_name)
+        << "\"}}";
+    first = false;
+    for (const auto& event : thread.events) {
+      out << ",{\"name\":\"" << EscapeJson(event.name) << "\",\"cat\":\""
+          << kTraceCategory << "\",\"ph\":\"X\",\"ts\":" << event.begin_us
+          << ",\"dur\":" << event.duration_us << ",\"pid\":" << pid
+          << ",\"tid\":" << thread.thread_id << "}";
+    }
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}";
+  return out.str();
+}
+
+std::string Tracing::ToPerfetto(const std::vector<TraceThread>& threads) {
+  int64_t pid = ProcessId();
+  ProtoWriter trace;
+  for (size_t i = 0; i < threads.size(); i++) {
+    const TraceThread& thread = threads[i];
+    uint64_t track_uuid = i + 1;
+    ProtoWriter thread_descriptor;
+    thread_descriptor.WriteVarint(kThreadDescriptorPidField,
+                                  static_cast<uint64_t>(pid));
+    thread_descriptor.WriteVarint(kThreadDescriptorTidField,
+                                  static_cast<uint64_t>(thread.thread_id));
+    thread_descriptor.WriteBytes(kThreadDescriptorNameField,
+                                 thread.thread_name);
+    ProtoWriter track_descriptor;
+    track_descriptor.WriteVarint(kTrackDescriptorUuidField, track_uuid);
+    track_descriptor.WriteBytes(kTrackDescriptorThreadField,
+                                thread_descriptor.data());
+    ProtoWriter packet;
+    packet.WriteVarint(kPacketSequenceIdField, kSequenceId);
+    packet.WriteBytes(kPacketTrackDescriptorField, track_descriptor.data());
+    WritePacket(&trace, packet);
+
+    // Events are recorded when they end, so nested events are recorded before
+    // the enclosing one. Slices are emitted in order of their begin time,
+    // enclosing ones first.
+    std::vector<TraceEvent> events = thread.events;
+    std::stable_sort(events.begin(), events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) {
+                       if (a.begin_us != b.begin_us)
+                         return a.begin_us < b.begin_us;
+                       return a.duration_us > b.duration_us;
+                     });
+    std::vector<int64_t> open_slice_ends;
+    for (const auto& event : events) {
+      while (!open_slice_ends.empty() &&
+             open_slice_ends.back() <= event.begin_us) {
+        WriteSlice(&trace, track_uuid, open_slice_ends.back(), nullptr);
+        open_slice_ends.pop_back();
+      }
+      WriteSlice(&trace, track_uuid, event.begin_us, event.name);
+      open_slice_ends.push_back(event.begin_us + event.duration_us);
+    }
+    while (!open_slice_ends.empty()) {
+      WriteSlice(&trace, track_uuid, open_slice_ends.back(), nullptr);
+      open_slice_ends.pop_back();
+    }
+  }
+  return trace.data();
+}
+
+bool Tracing::StopAndWrite(const std::string& path, TraceFormat format) {
+  Stop();
+  std::vector<TraceThread> threads = Collect();
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    RTC_LOG(LS_ERROR) << "Failed to open trace file " << path;
+    return false;
+  }
+  file << (format == TraceFormat::kPerfetto ? ToPerfetto(threads)
+                                            : ToChromeJson(threads));
+  return file.good();
+}
+
+ScopedTraceEvent::ScopedTraceEvent(const char* name)
+    : name_(name), begin_us_(Tracing::IsEnabled() ? rtc::TimeMicros() : 0) {}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+  if (begin_us_ != 0)
+    Tracing::AddEvent(name_, begin_us_, rtc::TimeMicros());
+}
+}
+}
@@ -0,0 +1,73 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_TRACING_H_
+#define OWT_BASE_TRACING_H_
+#include <atomic>
+#include <string>
+#include <vector>
+#include "owt/base/globalconfiguration.h"
+namespace owt {
+namespace base {
+// A completed trace event.
+struct TraceEvent {
+  // Must be a string literal, only the pointer is stored.
+  const char* name = nullptr;
+  int64_t begin_us = 0;
+  int64_t duration_us = 0;
+};
+
+// Trace events recorded by one thread, oldest first.
+struct TraceThread {
+  int64_t thread_id = 0;
+  std::string thread_name;
+  std::vector<TraceEvent> events;
+};
+
+// Records trace events of SDK hot paths while tracing is started. Each thread
+// writes to its own ring buffer without locking, and only the newest events
+// are kept if a buffer overflows. Events are collected when tracing stops.
+class Tracing {
+ public:
+  // Start recording. Events recorded before are discarded.
+  static void Start();
+  static void Stop();
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  // Record an event of current thread. |name| must be a string literal.
+  static void AddEvent(const char* name, int64_t begin_us, int64_t end_us);
+  // Events recorded since Start(), of threads with any.
+  static std::vector<TraceThread> Collect();
+  // Trace Event Format of Chrome's about://tracing, also read by Perfetto UI.
+  static std::string ToChromeJson(const std::vector<TraceThread>& threads);
+  // Binary perfetto.protos.Trace with a track per thread.
+  static std::string ToPerfetto(const std::vector<TraceThread>& threads);
+  // Stop recording and write collected events to |path|. Returns false if the
+  // file cannot be written.
+  static bool StopAndWrite(const std::string& path, TraceFormat format);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+// Records an event from its construction to its destruction, if tracing is
+// enabled when it is constructed.
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* name);
+  ~ScopedTraceEvent();
+
+ private:
+  const char* name_;
+  // 0 if tracing is disabled.
+  int64_t begin_us_;
+};
+}
+}
+
+#define OWT_TRACE_CONCAT_INNER(a, b) a##b
+#define OWT_TRACE_CONCAT(a, b) OWT_TRACE_CONCAT_INNER(a, b)
+// Trace current scope as |name|, which must be a string literal.
+#define OWT_TRACE_EVENT(name)                                      \
+  ::owt::base::ScopedTraceEvent OWT_TRACE_CONCAT(owt_trace_event_, \
+                                                 __LINE__)(name)
+#endif  // OWT_BASE_TRACING_H_
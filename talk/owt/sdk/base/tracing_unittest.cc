@@ -0,0 +1,115 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/tracing.h"
+#include <thread>
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+namespace {
+// Events named |name| among |threads|.
+std::vector<TraceEvent> EventsNamed(const std::vector<TraceThread>& threads,
+                                    const std::string& name) {
+  std::vector<TraceEvent> events;
+  for (const auto& thread : threads) {
+    for (const auto& event : thread.events) {
+      if (name == event.name)
+        events.push_back(event);
+    }
+  }
+  return events;
+}
+}  // namespace
+
+TEST(TracingTest, RecordsScopedEventsOnlyWhenEnabled) {
+  Tracing::Stop();
+  { OWT_TRACE_EVENT("TracingTest.Disabled"); }
+  Tracing::Start();
+  { OWT_TRACE_EVENT("TracingTest.Enabled"); }
+  std::thread([] { OWT_TRACE_EVENT("TracingTest.OtherThread"); }).join();
+  Tracing::Stop();
+  { OWT_TRACE_EVENT("TracingTest.Stopped"); }
+  std::vector<TraceThread> threads = Tracing::Collect();
+  EXPECT_TRUE(EventsNamed(threads, "TracingTest.Disabled").empty());
+  EXPECT_TRUE(EventsNamed(threads, "TracingTest.Stopped").empty());
+  ASSERT_EQ(1u, EventsNamed(threads, "TracingTest.Enabled").size());
+  EXPECT_GE(EventsNamed(threads, "TracingTest.Enabled")[0].duration_us, 0);
+  EXPECT_EQ(1u, EventsNamed(threads, "TracingTest.OtherThread").size());
+  // Events of the exited thread are kept.
+  EXPECT_GE(threads.size(), 2u);
+}
+
+TEST(TracingTest, StartDiscardsPreviousEvents) {
+  Tracing::Start();
+  Tracing::AddEvent("TracingTest.Previous", 10, 20);
+  Tracing::Start();
+  Tracing::AddEvent("TracingTest.Current", 30, 40);
+  Tracing::Stop();
+  std::vector<TraceThread> threads = Tracing::Collect();
+  EXPECT_TRUE(EventsNamed(threads, "TracingTest.Previous").empty());
+  EXPECT_EQ(1u, EventsNamed(threads, "TracingTest.Current").size());
+}
+
+TEST(TracingTest, KeepsNewestEventsWhenBufferOverflows) {
+  Tracing::Start();
+  Tracing::AddEvent("TracingTest.First", 0, 1);
+  for (int i = 0; i < 100000; i++)
+    Tracing::AddEvent("TracingTest.Overflow", i + 1, i + 2);
+  Tracing::Stop();
+  std::vector<TraceThread> threads = Tracing::Collect();
+  EXPECT_TRUE(EventsNamed(threads, "TracingTest.First").empty());
+  std::vector<TraceEvent> events =
+      EventsNamed(threads, "TracingTest.Overflow");
+  ASSERT_FALSE(events.empty());
+  EXPECT_LT(events.size(), 100000u);
+  EXPECT_EQ(100000, events.back().begin_us);
+}
+
+TEST(TracingTest, ToChromeJson) {
+  TraceThread thread;
+  thread.thread_id = 7;
+  thread.thread_name = "worker_thread";
+  TraceEvent event;
+  event.name = "Encode";
+  event.begin_us = 1000;
+  event.duration_us = 250;
+  thread.events.push_back(event);
+  std::string json = Tracing::ToChromeJson({thread});
+  EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos,
+            json.find("\"args\":{\"name\":\"worker_thread\"}"));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\":\"Encode\",\"cat\":\"owt\",\"ph\":\"X\","
+                      "\"ts\":1000,\"dur\":250,"));
+  EXPECT_NE(std::string::npos, json.find("\"tid\":7}"));
+}
+
+TEST(TracingTest, ToPerfettoNestsSlices) {
+  TraceThread thread;
+  thread.thread_id = 7;
+  thread.thread_name = "worker_thread";
+  // Recorded in order of their end.
+  TraceEvent inner;
+  inner.name = "Inner";
+  inner.begin_us = 110;
+  inner.duration_us = 10;
+  TraceEvent outer;
+  outer.name = "Outer";
+  outer.begin_us = 100;
+  outer.duration_us = 50;
+  thread.events = {inner, outer};
+  std::string trace = Tracing::ToPerfetto({thread});
+  ASSERT_FALSE(trace.empty());
+  // Each packet is field 1 of perfetto.protos.Trace.
+  EXPECT_EQ('\x0a', trace[0]);
+  size_t thread_name = trace.find("worker_thread");
+  size_t outer_name = trace.find("Outer");
+  size_t inner_name = trace.find("Inner");
+  ASSERT_NE(std::string::npos, thread_name);
+  ASSERT_NE(std::string::npos, outer_name);
+  ASSERT_NE(std::string::npos, inner_name);
+  EXPECT_LT(thread_name, outer_name);
+  EXPECT_LT(outer_name, inner_name);
+}
+}
+}
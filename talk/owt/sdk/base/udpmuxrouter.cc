@@ -0,0 +1,69 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/udpmuxrouter.h"
+namespace owt {
+namespace base {
+namespace {
+const size_t kStunHeaderSize = 20;
+const uint32_t kStunMagicCookie = 0x2112A442;
+const uint16_t kStunAttributeUsername = 0x0006;
+
+uint16_t ReadUint16(const char* data) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+uint32_t ReadUint32(const char* data) {
+  return (static_cast<uint32_t>(ReadUint16(data)) << 16) |
+         ReadUint16(data + 2);
+}
+}  // namespace
+
+bool StunPacketInfo::Parse(const char* data,
+                           size_t size,
+                           StunPacketInfo* info) {
+  // RFC 5389: the two most significant bits are zero, and the magic cookie
+  // tells STUN from RTP/RTCP, DTLS and TURN ChannelData.
+  if (size < kStunHeaderSize || (data[0] & 0xC0) != 0 ||
+      ReadUint32(data + 4) != kStunMagicCookie)
+    return false;
+  uint16_t type = ReadUint16(data);
+  size_t length = ReadUint16(data + 2);
+  if (length % 4 != 0 || kStunHeaderSize + length > size)
+    return false;
+  switch (type & 0x0110) {
+    case 0x0000:
+      info->message_class = Class::kRequest;
+      break;
+    case 0x0010:
+      info->message_class = Class::kIndication;
+      break;
+    case 0x0100:
+      info->message_class = Class::kSuccessResponse;
+      break;
+    default:
+      info->message_class = Class::kErrorResponse;
+      break;
+  }
+  info->transaction_id.assign(data + 8, 12);
+  info->username.clear();
+  size_t offset = kStunHeaderSize;
+  const size_t end = kStunHeaderSize + length;
+  while (offset + 4 <= end) {
+    uint16_t attribute_type = ReadUint16(data + offset);
+    size_t attribute_length = ReadUint16(data + offset + 2);
+    offset += 4;
+    if (offset + attribute_length > end)
+      return false;
+    if (attribute_type == kStunAttributeUsername) {
+      info->username.assign(data + offset, attribute_length);
+      break;
+    }
+    // Attributes are padded to 4 bytes.
+    offset += (attribute_length + 3) & ~static_cast<size_t>(3);
+  }
+  return true;
+}
+}
+}
@@ -0,0 +1,197 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_UDPMUXROUTER_H_
+#define OWT_BASE_UDPMUXROUTER_H_
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+namespace owt {
+namespace base {
+// Minimal STUN header parsing needed to demultiplex a shared UDP socket.
+struct StunPacketInfo {
+  enum class Class { kRequest, kIndication, kSuccessResponse, kErrorResponse };
+  Class message_class;
+  // 12 bytes transaction ID.
+  std::string transaction_id;
+  // Value of USERNAME attribute. Empty if absent.
+  std::string username;
+  // Parse |data| as a STUN message. Returns false if it is not STUN.
+  static bool Parse(const char* data, size_t size, StunPacketInfo* info);
+};
+
+/**
+ @brief Routes datagrams received on a shared UDP socket to the ICE ports
+ using it.
+ @details Sinks are the per-port virtual sockets. The router learns from
+ outgoing traffic of each sink:
+ - transaction IDs of STUN requests, so responses are routed back to the
+   sender even if several sinks talk to the same STUN server;
+ - local ICE ufrag from USERNAME of connectivity checks, so checks from a
+   remote peer are routed by the ufrag in their USERNAME;
+ - remote addresses, which route all other packets like DTLS, RTP and RTCP.
+ A remote address belongs to the first sink sending to it. Packets without a
+ ufrag cannot tell two sinks talking to the same remote address apart, so
+ OnSend() reports a conflict when another sink sends to an address already
+ taken, and that sink must use a dedicated socket for the address.
+ Connectivity checks for a ufrag not learned yet are kept, and handed over by
+ TakePendingPackets() once a sink sends its first check with that ufrag.
+ Address must be copyable and ordered.
+ */
+template <typename Address, typename Sink>
+class UdpMuxRouter {
+ public:
+  struct PendingPacket {
+    std::vector<char> data;
+    Address remote_address;
+  };
+  static const size_t kMaxTransactions = 4096;
+  static const size_t kMaxPendingPackets = 64;
+  enum class SendResult {
+    // Routes are learned, the datagram can be sent on the shared socket.
+    kShared,
+    // Same as kShared, and a new local ufrag is learned.
+    // TakePendingPackets() should be called.
+    kNewUfrag,
+    // |remote_address| belongs to another sink. Nothing is learned, the
+    // datagram must be sent on a dedicated socket.
+    kAddressConflict,
+  };
+
+  // Learn routes from a datagram sent by |sink|.
+  SendResult OnSend(Sink* sink,
+                    const char* data,
+                    size_t size,
+                    const Address& remote_address) {
+    StunPacketInfo stun;
+    bool is_request = StunPacketInfo::Parse(data, size, &stun) &&
+                      stun.message_class == StunPacketInfo::Class::kRequest;
+    // Requests without USERNAME go to STUN servers, whose responses are
+    // routed by transaction ID, so any number of sinks may share a server.
+    if (!is_request || !stun.username.empty()) {
+      auto route = address_routes_.emplace(remote_address, sink).first;
+      if (route->second != sink)
+        return SendResult::kAddressConflict;
+    }
+    if (!is_request)
+      return SendResult::kShared;
+    AddTransaction(stun.transaction_id, sink);
+    // USERNAME of an outgoing check is "<remote ufrag>:<local ufrag>".
+    size_t colon = stun.username.find(':');
+    if (colon == std::string::npos)
+      return SendResult::kShared;
+    std::string local_ufrag = stun.username.substr(colon + 1);
+    auto it = ufrag_routes_.find(local_ufrag);
+    if (it != ufrag_routes_.end() && it->second == sink)
+      return SendResult::kShared;
+    ufrag_routes_[local_ufrag] = sink;
+    return SendResult::kNewUfrag;
+  }
+
+  // Returns the sink of a received datagram, or nullptr if unknown.
+  // Connectivity checks with an unknown ufrag are kept as pending packets.
+  Sink* Route(const char* data, size_t size, const Address& remote_address) {
+    StunPacketInfo stun;
+    if (StunPacketInfo::Parse(data, size, &stun)) {
+      if (stun.message_class == StunPacketInfo::Class::kSuccessResponse ||
+          stun.message_class == StunPacketInfo::Class::kErrorResponse) {
+        auto it = transactions_.find(stun.transaction_id);
+        if (it != transactions_.end())
+          return it->second;
+      } else if (stun.message_class == StunPacketInfo::Class::kRequest &&
+                 !stun.username.empty()) {
+        // USERNAME of an incoming check is "<local ufrag>:<remote ufrag>".
+        std::string local_ufrag =
+            stun.username.substr(0, stun.username.find(':'));
+        auto it = ufrag_routes_.find(local_ufrag);
+        if (it != ufrag_routes_.end()) {
+          // Remote peer may use an address not signaled yet (peer reflexive).
+          // An address taken by another sink is kept by that sink.
+          address_routes_.emplace(remote_address, it->second);
+          return it->second;
+        }
+        AddPendingPacket(local_ufrag, data, size, remote_address);
+        return nullptr;
+      }
+    }
+    auto it = address_routes_.find(remote_address);
+    return it == address_routes_.end() ? nullptr : it->second;
+  }
+
+  // Returns connectivity checks received before |sink| learned its ufrag.
+  std::vector<PendingPacket> TakePendingPackets(Sink* sink) {
+    std::vector<PendingPacket> packets;
+    for (auto it = pending_packets_.begin(); it != pending_packets_.end();) {
+      auto route = ufrag_routes_.find(it->first);
+      if (route != ufrag_routes_.end() && route->second == sink) {
+        address_routes_.emplace(it->second.remote_address, sink);
+        packets.push_back(std::move(it->second));
+        it = pending_packets_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return packets;
+  }
+
+  // Forget all routes to |sink|.
+  void RemoveSink(Sink* sink) {
+    for (auto it = address_routes_.begin(); it != address_routes_.end();) {
+      if (it->second == sink)
+        it = address_routes_.erase(it);
+      else
+        ++it;
+    }
+    for (auto it = ufrag_routes_.begin(); it != ufrag_routes_.end();) {
+      if (it->second == sink)
+        it = ufrag_routes_.erase(it);
+      else
+        ++it;
+    }
+    for (auto it = transactions_.begin(); it != transactions_.end();) {
+      if (it->second == sink)
+        it = transactions_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  size_t pending_packet_count() const { return pending_packets_.size(); }
+
+ private:
+  void AddTransaction(const std::string& transaction_id, Sink* sink) {
+    if (transactions_.emplace(transaction_id, sink).second) {
+      transaction_order_.push_back(transaction_id);
+      // Retransmissions reuse the ID, so old IDs are dropped in FIFO order.
+      while (transaction_order_.size() > kMaxTransactions) {
+        transactions_.erase(transaction_order_.front());
+        transaction_order_.pop_front();
+      }
+    }
+  }
+
+  void AddPendingPacket(const std::string& local_ufrag,
+                        const char* data,
+                        size_t size,
+                        const Address& remote_address) {
+    if (pending_packets_.size() >= kMaxPendingPackets)
+      pending_packets_.erase(pending_packets_.begin());
+    PendingPacket packet;
+    packet.data.assign(data, data + size);
+    packet.remote_address = remote_address;
+    pending_packets_.emplace_back(local_ufrag, std::move(packet));
+  }
+
+  std::map<Address, Sink*> address_routes_;
+  std::unordered_map<std::string, Sink*> ufrag_routes_;
+  std::unordered_map<std::string, Sink*> transactions_;
+  std::deque<std::string> transaction_order_;
+  std::deque<std::pair<std::string, PendingPacket>> pending_packets_;
+};
+}
+}
+#endif  // OWT_BASE_UDPMUXROUTER_H_
@@ -0,0 +1,157 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/udpmuxrouter.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/gmock/include/gmock/gmock.h"
+namespace owt {
+namespace base {
+namespace {
+struct FakeSink {};
+typedef UdpMuxRouter<std::string, FakeSink> Router;
+
+void AppendUint16(std::string* packet, uint16_t value) {
+  packet->push_back(static_cast<char>(value >> 8));
+  packet->push_back(static_cast<char>(value & 0xFF));
+}
+
+// Build a STUN message of |type| with an optional USERNAME attribute.
+std::string BuildStun(uint16_t type,
+                      const std::string& transaction_id,
+                      const std::string& username) {
+  std::string attributes;
+  if (!username.empty()) {
+    AppendUint16(&attributes, 0x0006);
+    AppendUint16(&attributes, static_cast<uint16_t>(username.size()));
+    attributes += username;
+    while (attributes.size() % 4 != 0)
+      attributes.push_back(0);
+  }
+  std::string packet;
+  AppendUint16(&packet, type);
+  AppendUint16(&packet, static_cast<uint16_t>(attributes.size()));
+  packet += std::string("\x21\x12\xA4\x42", 4);
+  packet += transaction_id;
+  packet += attributes;
+  return packet;
+}
+
+const uint16_t kBindingRequest = 0x0001;
+const uint16_t kBindingResponse = 0x0101;
+}  // namespace
+
+TEST(UdpMuxRouterTest, ParseStunBindingRequest) {
+  std::string packet = BuildStun(kBindingRequest, "abcdefghijkl", "rem:loc");
+  StunPacketInfo info;
+  ASSERT_TRUE(StunPacketInfo::Parse(packet.data(), packet.size(), &info));
+  EXPECT_EQ(StunPacketInfo::Class::kRequest, info.message_class);
+  EXPECT_EQ("abcdefghijkl", info.transaction_id);
+  EXPECT_EQ("rem:loc", info.username);
+}
+
+TEST(UdpMuxRouterTest, ParseRejectsNonStun) {
+  // An RTP header with version 2.
+  std::string rtp(40, 0);
+  rtp[0] = static_cast<char>(0x80);
+  StunPacketInfo info;
+  EXPECT_FALSE(StunPacketInfo::Parse(rtp.data(), rtp.size(), &info));
+  // Truncated STUN message.
+  std::string packet = BuildStun(kBindingRequest, "abcdefghijkl", "rem:loc");
+  EXPECT_FALSE(StunPacketInfo::Parse(packet.data(), packet.size() - 4, &info));
+}
+
+TEST(UdpMuxRouterTest, RouteResponsesByTransactionId) {
+  Router router;
+  FakeSink sink1, sink2;
+  // Both sinks query the same STUN server.
+  std::string request1 = BuildStun(kBindingRequest, "transaction1", "");
+  std::string request2 = BuildStun(kBindingRequest, "transaction2", "");
+  EXPECT_EQ(Router::SendResult::kShared,
+            router.OnSend(&sink1, request1.data(), request1.size(),
+                          "stun:3478"));
+  EXPECT_EQ(Router::SendResult::kShared,
+            router.OnSend(&sink2, request2.data(), request2.size(),
+                          "stun:3478"));
+  std::string response1 = BuildStun(kBindingResponse, "transaction1", "");
+  std::string response2 = BuildStun(kBindingResponse, "transaction2", "");
+  EXPECT_EQ(&sink1,
+            router.Route(response1.data(), response1.size(), "stun:3478"));
+  EXPECT_EQ(&sink2,
+            router.Route(response2.data(), response2.size(), "stun:3478"));
+}
+
+TEST(UdpMuxRouterTest, RouteChecksByUfragAndMediaByAddress) {
+  Router router;
+  FakeSink sink1, sink2;
+  std::string check1 = BuildStun(kBindingRequest, "transaction1", "r1:l1");
+  std::string check2 = BuildStun(kBindingRequest, "transaction2", "r2:l2");
+  EXPECT_EQ(Router::SendResult::kNewUfrag,
+            router.OnSend(&sink1, check1.data(), check1.size(), "peer1"));
+  EXPECT_EQ(Router::SendResult::kNewUfrag,
+            router.OnSend(&sink2, check2.data(), check2.size(), "peer2"));
+  // Remote peer 2 checks from a new address.
+  std::string incoming = BuildStun(kBindingRequest, "transaction3", "l2:r2");
+  EXPECT_EQ(&sink2,
+            router.Route(incoming.data(), incoming.size(), "peer2-prflx"));
+  std::string rtp(40, 0);
+  rtp[0] = static_cast<char>(0x80);
+  EXPECT_EQ(&sink1, router.Route(rtp.data(), rtp.size(), "peer1"));
+  EXPECT_EQ(&sink2, router.Route(rtp.data(), rtp.size(), "peer2-prflx"));
+  EXPECT_EQ(nullptr, router.Route(rtp.data(), rtp.size(), "unknown"));
+}
+
+TEST(UdpMuxRouterTest, AddressOfAnotherSinkConflicts) {
+  Router router;
+  FakeSink sink1, sink2;
+  // Two connections to the same SFU address.
+  std::string check1 = BuildStun(kBindingRequest, "transaction1", "r1:l1");
+  std::string check2 = BuildStun(kBindingRequest, "transaction2", "r2:l2");
+  EXPECT_EQ(Router::SendResult::kNewUfrag,
+            router.OnSend(&sink1, check1.data(), check1.size(), "sfu"));
+  EXPECT_EQ(Router::SendResult::kAddressConflict,
+            router.OnSend(&sink2, check2.data(), check2.size(), "sfu"));
+  std::string rtp(40, 0);
+  rtp[0] = static_cast<char>(0x80);
+  EXPECT_EQ(Router::SendResult::kAddressConflict,
+            router.OnSend(&sink2, rtp.data(), rtp.size(), "sfu"));
+  // Media from the SFU keeps going to the first sink.
+  EXPECT_EQ(&sink1, router.Route(rtp.data(), rtp.size(), "sfu"));
+  router.RemoveSink(&sink1);
+  EXPECT_EQ(Router::SendResult::kNewUfrag,
+            router.OnSend(&sink2, check2.data(), check2.size(), "sfu"));
+  EXPECT_EQ(&sink2, router.Route(rtp.data(), rtp.size(), "sfu"));
+}
+
+TEST(UdpMuxRouterTest, ChecksBeforeUfragIsLearnedArePending) {
+  Router router;
+  FakeSink sink;
+  std::string incoming = BuildStun(kBindingRequest, "transaction1", "l1:r1");
+  EXPECT_EQ(nullptr, router.Route(incoming.data(), incoming.size(), "peer"));
+  EXPECT_EQ(1u, router.pending_packet_count());
+  std::string check = BuildStun(kBindingRequest, "transaction2", "r1:l1");
+  EXPECT_EQ(Router::SendResult::kNewUfrag,
+            router.OnSend(&sink, check.data(), check.size(), "peer"));
+  // Same ufrag again is not new.
+  EXPECT_EQ(Router::SendResult::kShared,
+            router.OnSend(&sink, check.data(), check.size(), "peer"));
+  std::vector<Router::PendingPacket> pending = router.TakePendingPackets(&sink);
+  ASSERT_EQ(1u, pending.size());
+  EXPECT_EQ(incoming, std::string(pending[0].data.begin(),
+                                  pending[0].data.end()));
+  EXPECT_EQ("peer", pending[0].remote_address);
+  EXPECT_EQ(0u, router.pending_packet_count());
+}
+
+TEST(UdpMuxRouterTest, RemovedSinkIsNotRouted) {
+  Router router;
+  FakeSink sink;
+  std::string check = BuildStun(kBindingRequest, "transaction1", "r1:l1");
+  router.OnSend(&sink, check.data(), check.size(), "peer");
+  router.RemoveSink(&sink);
+  std::string response = BuildStun(kBindingResponse, "transaction1", "");
+  EXPECT_EQ(nullptr, router.Route(response.data(), response.size(), "peer"));
+  std::string incoming = BuildStun(kBindingRequest, "transaction2", "l1:r1");
+  EXPECT_EQ(nullptr, router.Route(incoming.data(), incoming.size(), "peer"));
+}
+}
+}
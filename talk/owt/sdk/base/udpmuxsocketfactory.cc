@@ -0,0 +1,302 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/udpmuxsocketfactory.h"
+#include <errno.h>
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/rtc_base/logging.h"
+#include "webrtc/rtc_base/task_utils/to_queued_task.h"
+#include "webrtc/rtc_base/time_utils.h"
+namespace owt {
+namespace base {
+SharedUdpSocket::SharedUdpSocket(rtc::Thread* thread,
+                                 rtc::AsyncPacketSocket* socket,
+                                 SocketCreator create_dedicated_socket)
+    : thread_(thread),
+      socket_(socket),
+      create_dedicated_socket_(std::move(create_dedicated_socket)) {
+  socket_->SignalReadPacket.connect(this, &SharedUdpSocket::OnReadPacket);
+  socket_->SignalReadyToSend.connect(this, &SharedUdpSocket::OnReadyToSend);
+}
+
+SharedUdpSocket::~SharedUdpSocket() {
+  RTC_DCHECK(virtual_sockets_.empty());
+}
+
+void SharedUdpSocket::AddVirtualSocket(UdpMuxVirtualSocket* socket) {
+  virtual_sockets_.insert(socket);
+}
+
+void SharedUdpSocket::RemoveVirtualSocket(UdpMuxVirtualSocket* socket) {
+  virtual_sockets_.erase(socket);
+  router_.RemoveSink(socket);
+}
+
+int SharedUdpSocket::SendTo(UdpMuxVirtualSocket* sender,
+                            const void* data,
+                            size_t size,
+                            const rtc::SocketAddress& address,
+                            const rtc::PacketOptions& options,
+                            bool* address_conflict) {
+  using SendResult =
+      UdpMuxRouter<rtc::SocketAddress, UdpMuxVirtualSocket>::SendResult;
+  *address_conflict = false;
+  SendResult result =
+      router_.OnSend(sender, static_cast<const char*>(data), size, address);
+  if (result == SendResult::kAddressConflict) {
+    *address_conflict = true;
+    return -1;
+  }
+  if (result == SendResult::kNewUfrag) {
+    // Not delivered synchronously, the port is in the middle of sending.
+    thread_->PostTask(
+        webrtc::ToQueuedTask(task_safety_.flag(), [this, sender] {
+          DeliverPendingPackets(sender);
+        }));
+  }
+  return socket_->SendTo(data, size, address, options);
+}
+
+void SharedUdpSocket::DeliverPendingPackets(UdpMuxVirtualSocket* socket) {
+  if (virtual_sockets_.count(socket) == 0)
+    return;
+  for (const auto& packet : router_.TakePendingPackets(socket)) {
+    socket->DeliverPacket(packet.data.data(), packet.data.size(),
+                          packet.remote_address, rtc::TimeMicros());
+    // The socket may be closed by the handler.
+    if (virtual_sockets_.count(socket) == 0)
+      return;
+  }
+}
+
+void SharedUdpSocket::OnReadPacket(rtc::AsyncPacketSocket* socket,
+                                   const char* data,
+                                   size_t size,
+                                   const rtc::SocketAddress& remote_address,
+                                   const int64_t& packet_time_us) {
+  UdpMuxVirtualSocket* target = router_.Route(data, size, remote_address);
+  if (target == nullptr) {
+    RTC_LOG(LS_VERBOSE) << "No route for UDP datagram from "
+                        << remote_address.ToSensitiveString();
+    return;
+  }
+  target->DeliverPacket(data, size, remote_address, packet_time_us);
+}
+
+void SharedUdpSocket::OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+  // Copy since handlers may close their sockets.
+  std::set<UdpMuxVirtualSocket*> sockets = virtual_sockets_;
+  for (auto* virtual_socket : sockets) {
+    if (virtual_sockets_.count(virtual_socket))
+      virtual_socket->DeliverReadyToSend();
+  }
+}
+
+UdpMuxVirtualSocket::UdpMuxVirtualSocket(
+    std::shared_ptr<SharedUdpSocket> shared_socket)
+    : shared_socket_(std::move(shared_socket)), error_(0) {
+  shared_socket_->AddVirtualSocket(this);
+}
+
+UdpMuxVirtualSocket::~UdpMuxVirtualSocket() {
+  Close();
+}
+
+rtc::SocketAddress UdpMuxVirtualSocket::GetLocalAddress() const {
+  return shared_socket_ ? shared_socket_->socket()->GetLocalAddress()
+                        : rtc::SocketAddress();
+}
+
+rtc::SocketAddress UdpMuxVirtualSocket::GetRemoteAddress() const {
+  return rtc::SocketAddress();
+}
+
+int UdpMuxVirtualSocket::Send(const void* pv,
+                              size_t cb,
+                              const rtc::PacketOptions& options) {
+  error_ = ENOTCONN;
+  return -1;
+}
+
+int UdpMuxVirtualSocket::SendTo(const void* pv,
+                                size_t cb,
+                                const rtc::SocketAddress& addr,
+                                const rtc::PacketOptions& options) {
+  if (!shared_socket_) {
+    error_ = EBADF;
+    return -1;
+  }
+  int result;
+  if (dedicated_addresses_.count(addr) != 0) {
+    result = SendToDedicatedSocket(pv, cb, addr, options);
+  } else {
+    bool address_conflict = false;
+    result =
+        shared_socket_->SendTo(this, pv, cb, addr, options, &address_conflict);
+    if (address_conflict) {
+      RTC_LOG(LS_INFO) << "Remote address " << addr.ToSensitiveString()
+                       << " is used by another connection on the shared UDP "
+                          "socket, switching to a dedicated socket.";
+      dedicated_addresses_.insert(addr);
+      result = SendToDedicatedSocket(pv, cb, addr, options);
+    } else if (result < 0) {
+      error_ = shared_socket_->socket()->GetError();
+    }
+  }
+  if (result < 0)
+    return result;
+  // Sent packet notification of the shared socket cannot tell the sender, so
+  // it is raised here.
+  rtc::SentPacket sent_packet(options.packet_id, rtc::TimeMillis(),
+                              options.info_signaled_after_sent);
+  CopySocketInformationToPacketInfo(cb, *this, true, &sent_packet.info);
+  SignalSentPacket(this, sent_packet);
+  return result;
+}
+
+int UdpMuxVirtualSocket::SendToDedicatedSocket(
+    const void* pv,
+    size_t cb,
+    const rtc::SocketAddress& addr,
+    const rtc::PacketOptions& options) {
+  if (!dedicated_socket_) {
+    dedicated_socket_.reset(shared_socket_->CreateDedicatedSocket());
+    if (!dedicated_socket_) {
+      error_ = EADDRINUSE;
+      return -1;
+    }
+    dedicated_socket_->SignalReadPacket.connect(
+        this, &UdpMuxVirtualSocket::OnDedicatedReadPacket);
+    dedicated_socket_->SignalReadyToSend.connect(
+        this, &UdpMuxVirtualSocket::OnDedicatedReadyToSend);
+    for (const auto& option : options_)
+      dedicated_socket_->SetOption(option.first, option.second);
+  }
+  int result = dedicated_socket_->SendTo(pv, cb, addr, options);
+  if (result < 0)
+    error_ = dedicated_socket_->GetError();
+  return result;
+}
+
+void UdpMuxVirtualSocket::OnDedicatedReadPacket(
+    rtc::AsyncPacketSocket* socket,
+    const char* data,
+    size_t size,
+    const rtc::SocketAddress& remote_address,
+    const int64_t& packet_time_us) {
+  DeliverPacket(data, size, remote_address, packet_time_us);
+}
+
+void UdpMuxVirtualSocket::OnDedicatedReadyToSend(
+    rtc::AsyncPacketSocket* socket) {
+  DeliverReadyToSend();
+}
+
+int UdpMuxVirtualSocket::Close() {
+  dedicated_socket_.reset();
+  dedicated_addresses_.clear();
+  if (shared_socket_) {
+    shared_socket_->RemoveVirtualSocket(this);
+    shared_socket_.reset();
+  }
+  return 0;
+}
+
+rtc::AsyncPacketSocket::State UdpMuxVirtualSocket::GetState() const {
+  return shared_socket_ ? STATE_BOUND : STATE_CLOSED;
+}
+
+int UdpMuxVirtualSocket::GetOption(rtc::Socket::Option opt, int* value) {
+  if (!shared_socket_) {
+    error_ = EBADF;
+    return -1;
+  }
+  return shared_socket_->socket()->GetOption(opt, value);
+}
+
+int UdpMuxVirtualSocket::SetOption(rtc::Socket::Option opt, int value) {
+  if (!shared_socket_) {
+    error_ = EBADF;
+    return -1;
+  }
+  options_[opt] = value;
+  if (dedicated_socket_)
+    dedicated_socket_->SetOption(opt, value);
+  // Options apply to all connections sharing the socket. PeerConnections
+  // created by the same factory use the same options, e.g. DSCP and buffer
+  // sizes.
+  return shared_socket_->socket()->SetOption(opt, value);
+}
+
+int UdpMuxVirtualSocket::GetError() const {
+  return error_;
+}
+
+void UdpMuxVirtualSocket::SetError(int error) {
+  error_ = error;
+}
+
+void UdpMuxVirtualSocket::DeliverPacket(
+    const char* data,
+    size_t size,
+    const rtc::SocketAddress& remote_address,
+    int64_t packet_time_us) {
+  SignalReadPacket(this, data, size, remote_address, packet_time_us);
+}
+
+void UdpMuxVirtualSocket::DeliverReadyToSend() {
+  SignalReadyToSend(this);
+}
+
+UdpMuxSocketFactory::UdpMuxSocketFactory(
+    rtc::Thread* thread,
+    uint16_t port,
+    std::unique_ptr<rtc::PacketSocketFactory> udp_socket_factory)
+    : rtc::BasicPacketSocketFactory(thread),
+      thread_(thread),
+      port_(port),
+      udp_socket_factory_(std::move(udp_socket_factory)) {}
+
+UdpMuxSocketFactory::~UdpMuxSocketFactory() {}
+
+rtc::AsyncPacketSocket* UdpMuxSocketFactory::CreateUdpSocket(
+    const rtc::SocketAddress& address,
+    uint16_t min_port,
+    uint16_t max_port) {
+  std::shared_ptr<SharedUdpSocket> shared_socket =
+      shared_sockets_[address.ipaddr()].lock();
+  if (!shared_socket) {
+    // Dedicated sockets use port range of the allocator.
+    SharedUdpSocket::SocketCreator create_dedicated_socket =
+        [this, address, min_port, max_port] {
+          return CreateSocket(address, min_port, max_port);
+        };
+    // A fixed mux port overrides port range of the allocator.
+    if (port_ != 0) {
+      min_port = port_;
+      max_port = port_;
+    }
+    rtc::AsyncPacketSocket* socket = CreateSocket(address, min_port, max_port);
+    if (!socket)
+      return nullptr;
+    RTC_LOG(LS_INFO) << "Created shared UDP socket "
+                     << socket->GetLocalAddress().ToSensitiveString();
+    shared_socket = std::make_shared<SharedUdpSocket>(
+        thread_, socket, std::move(create_dedicated_socket));
+    shared_sockets_[address.ipaddr()] = shared_socket;
+  }
+  return new UdpMuxVirtualSocket(shared_socket);
+}
+
+rtc::AsyncPacketSocket* UdpMuxSocketFactory::CreateSocket(
+    const rtc::SocketAddress& address,
+    uint16_t min_port,
+    uint16_t max_port) {
+  return udp_socket_factory_
+             ? udp_socket_factory_->CreateUdpSocket(address, min_port,
+                                                    max_port)
+             : rtc::BasicPacketSocketFactory::CreateUdpSocket(
+                   address, min_port, max_port);
+}
+}
+}
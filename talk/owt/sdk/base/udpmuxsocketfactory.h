@@ -0,0 +1,148 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_UDPMUXSOCKETFACTORY_H_
+#define OWT_BASE_UDPMUXSOCKETFACTORY_H_
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include "talk/owt/sdk/base/udpmuxrouter.h"
+#include "webrtc/p2p/base/basic_packet_socket_factory.h"
+#include "webrtc/rtc_base/async_packet_socket.h"
+#include "webrtc/rtc_base/ip_address.h"
+#include "webrtc/rtc_base/socket_address.h"
+#include "webrtc/rtc_base/task_utils/pending_task_safety_flag.h"
+#include "webrtc/rtc_base/third_party/sigslot/sigslot.h"
+#include "webrtc/rtc_base/thread.h"
+namespace owt {
+namespace base {
+class UdpMuxVirtualSocket;
+
+// A UDP socket shared by all ICE ports bound to the same local IP. Received
+// datagrams are dispatched to virtual sockets by UdpMuxRouter.
+class SharedUdpSocket : public sigslot::has_slots<> {
+ public:
+  using SocketCreator = std::function<rtc::AsyncPacketSocket*()>;
+  // Takes ownership of |socket|. |thread| is the thread |socket| runs on.
+  // |create_dedicated_socket| creates a UDP socket on the same IP for virtual
+  // sockets which cannot share |socket| with a remote address.
+  SharedUdpSocket(rtc::Thread* thread,
+                  rtc::AsyncPacketSocket* socket,
+                  SocketCreator create_dedicated_socket);
+  ~SharedUdpSocket() override;
+  void AddVirtualSocket(UdpMuxVirtualSocket* socket);
+  void RemoveVirtualSocket(UdpMuxVirtualSocket* socket);
+  // Nothing is sent and |*address_conflict| is set to true if |address| is
+  // routed to another virtual socket.
+  int SendTo(UdpMuxVirtualSocket* sender,
+             const void* data,
+             size_t size,
+             const rtc::SocketAddress& address,
+             const rtc::PacketOptions& options,
+             bool* address_conflict);
+  rtc::AsyncPacketSocket* socket() { return socket_.get(); }
+  rtc::AsyncPacketSocket* CreateDedicatedSocket() {
+    return create_dedicated_socket_();
+  }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_address,
+                    const int64_t& packet_time_us);
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket);
+  // Deliver checks received before |socket| learned its ufrag.
+  void DeliverPendingPackets(UdpMuxVirtualSocket* socket);
+  rtc::Thread* thread_;
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  SocketCreator create_dedicated_socket_;
+  std::set<UdpMuxVirtualSocket*> virtual_sockets_;
+  UdpMuxRouter<rtc::SocketAddress, UdpMuxVirtualSocket> router_;
+  webrtc::ScopedTaskSafety task_safety_;
+};
+
+// The socket returned to an ICE port. It sends through and receives from a
+// SharedUdpSocket. Remote addresses already used by another virtual socket
+// are served by a dedicated socket of this virtual socket, since datagrams
+// from them could not be routed on the shared socket.
+class UdpMuxVirtualSocket : public rtc::AsyncPacketSocket {
+ public:
+  explicit UdpMuxVirtualSocket(std::shared_ptr<SharedUdpSocket> shared_socket);
+  ~UdpMuxVirtualSocket() override;
+
+  // rtc::AsyncPacketSocket
+  rtc::SocketAddress GetLocalAddress() const override;
+  rtc::SocketAddress GetRemoteAddress() const override;
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override;
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override;
+  int Close() override;
+  State GetState() const override;
+  int GetOption(rtc::Socket::Option opt, int* value) override;
+  int SetOption(rtc::Socket::Option opt, int value) override;
+  int GetError() const override;
+  void SetError(int error) override;
+
+  // Called by SharedUdpSocket.
+  void DeliverPacket(const char* data,
+                     size_t size,
+                     const rtc::SocketAddress& remote_address,
+                     int64_t packet_time_us);
+  void DeliverReadyToSend();
+
+ private:
+  int SendToDedicatedSocket(const void* pv,
+                            size_t cb,
+                            const rtc::SocketAddress& addr,
+                            const rtc::PacketOptions& options);
+  void OnDedicatedReadPacket(rtc::AsyncPacketSocket* socket,
+                             const char* data,
+                             size_t size,
+                             const rtc::SocketAddress& remote_address,
+                             const int64_t& packet_time_us);
+  void OnDedicatedReadyToSend(rtc::AsyncPacketSocket* socket);
+  std::shared_ptr<SharedUdpSocket> shared_socket_;
+  // Created on the first address conflict.
+  std::unique_ptr<rtc::AsyncPacketSocket> dedicated_socket_;
+  std::set<rtc::SocketAddress> dedicated_addresses_;
+  // Options set on this socket, applied to |dedicated_socket_| when it is
+  // created.
+  std::map<rtc::Socket::Option, int> options_;
+  int error_;
+};
+
+// A packet socket factory which makes all UDP sockets bound to the same local
+// IP share one UDP socket. TCP sockets are not shared.
+class UdpMuxSocketFactory : public rtc::BasicPacketSocketFactory {
+ public:
+  // |thread| is the network thread. Shared sockets are bound to |port|, or an
+  // ephemeral port if |port| is 0. If |udp_socket_factory| is not null, shared
+  // sockets are created by it.
+  UdpMuxSocketFactory(
+      rtc::Thread* thread,
+      uint16_t port,
+      std::unique_ptr<rtc::PacketSocketFactory> udp_socket_factory);
+  ~UdpMuxSocketFactory() override;
+  rtc::AsyncPacketSocket* CreateUdpSocket(const rtc::SocketAddress& address,
+                                          uint16_t min_port,
+                                          uint16_t max_port) override;
+
+ private:
+  rtc::AsyncPacketSocket* CreateSocket(const rtc::SocketAddress& address,
+                                       uint16_t min_port,
+                                       uint16_t max_port);
+  rtc::Thread* thread_;
+  const uint16_t port_;
+  std::unique_ptr<rtc::PacketSocketFactory> udp_socket_factory_;
+  // Shared sockets are alive as long as any virtual socket uses them.
+  std::map<rtc::IPAddress, std::weak_ptr<SharedUdpSocket>> shared_sockets_;
+};
+}
+}
+#endif  // OWT_BASE_UDPMUXSOCKETFACTORY_H_
@@ -0,0 +1,82 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/videoadaptationnotifier.h"
+#include <algorithm>
+namespace owt {
+namespace base {
+namespace {
+// Calls in progress on the current thread.
+thread_local int notifications_on_thread = 0;
+}  // namespace
+
+VideoAdaptationNotifier* VideoAdaptationNotifier::Get() {
+  static VideoAdaptationNotifier* notifier = new VideoAdaptationNotifier();
+  return notifier;
+}
+
+VideoAdaptationNotifier::VideoAdaptationNotifier() : notifications_(0) {}
+
+void VideoAdaptationNotifier::AddObserver(VideoAdaptationObserver* observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (std::find(observers_.begin(), observers_.end(), observer) ==
+      observers_.end())
+    observers_.push_back(observer);
+}
+
+void VideoAdaptationNotifier::RemoveObserver(
+    VideoAdaptationObserver* observer) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  observers_.erase(std::remove(observers_.begin(), observers_.end(), observer),
+                   observers_.end());
+  // Calls in progress on this thread are below us in the stack, so they are
+  // not waited for.
+  notifications_done_.wait(
+      lock, [this] { return notifications_ == notifications_on_thread; });
+}
+
+void VideoAdaptationNotifier::NotifyVideoSourceAdapted(
+    const std::string& track_id,
+    int width,
+    int height,
+    int max_fps) {
+  Notify([&](VideoAdaptationObserver* observer) {
+    observer->OnVideoSourceAdapted(track_id, width, height, max_fps);
+  });
+}
+
+void VideoAdaptationNotifier::NotifyVideoEncoderBitrateChanged(
+    const std::string& track_id,
+    uint64_t bitrate_bps) {
+  Notify([&](VideoAdaptationObserver* observer) {
+    observer->OnVideoEncoderBitrateChanged(track_id, bitrate_bps);
+  });
+}
+
+void VideoAdaptationNotifier::Notify(
+    const std::function<void(VideoAdaptationObserver*)>& notify) {
+  std::vector<VideoAdaptationObserver*> observers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    observers = observers_;
+    notifications_++;
+    notifications_on_thread++;
+  }
+  for (auto* observer : observers) {
+    // An earlier observer may have removed it. Removing on other threads
+    // waits for this call, so it stays valid once checked.
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (std::find(observers_.begin(), observers_.end(), observer) ==
+          observers_.end())
+        continue;
+    }
+    notify(observer);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  notifications_--;
+  notifications_on_thread--;
+  notifications_done_.notify_all();
+}
+}
+}
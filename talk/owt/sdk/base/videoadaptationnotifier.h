@@ -0,0 +1,60 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#ifndef OWT_BASE_VIDEOADAPTATIONNOTIFIER_H_
+#define OWT_BASE_VIDEOADAPTATIONNOTIFIER_H_
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+namespace owt {
+namespace base {
+// Adaptation of local video tracks, pushed by their sources and encoders.
+class VideoAdaptationObserver {
+ public:
+  // Frames of |track_id| are adapted to |width|x|height| and at most |max_fps|
+  // frames per second, 0 if the frame rate is not limited.
+  virtual void OnVideoSourceAdapted(const std::string& track_id,
+                                    int width,
+                                    int height,
+                                    int max_fps) = 0;
+  // An encoder of |track_id| is allocated |bitrate_bps|.
+  virtual void OnVideoEncoderBitrateChanged(const std::string& track_id,
+                                            uint64_t bitrate_bps) = 0;
+
+ protected:
+  virtual ~VideoAdaptationObserver() {}
+};
+
+// Process wide dispatcher of VideoAdaptationObserver calls. Observers are
+// called on the thread of the source or encoder without the notifier locked.
+// RemoveObserver() waits for calls in progress on other threads, so an
+// observer can be destroyed once it returns, including from its own callback.
+class VideoAdaptationNotifier {
+ public:
+  static VideoAdaptationNotifier* Get();
+  VideoAdaptationNotifier();
+  void AddObserver(VideoAdaptationObserver* observer);
+  void RemoveObserver(VideoAdaptationObserver* observer);
+  void NotifyVideoSourceAdapted(const std::string& track_id,
+                                int width,
+                                int height,
+                                int max_fps);
+  void NotifyVideoEncoderBitrateChanged(const std::string& track_id,
+                                        uint64_t bitrate_bps);
+
+ private:
+  // Run |notify| for each observer which is still added when its turn comes.
+  void Notify(const std::function<void(VideoAdaptationObserver*)>& notify);
+
+  std::mutex mutex_;
+  std::condition_variable notifications_done_;
+  std::vector<VideoAdaptationObserver*> observers_;
+  // Calls in progress on all threads.
+  int notifications_;
+};
+}
+}
+#endif  // OWT_BASE_VIDEOADAPTATIONNOTIFIER_H_
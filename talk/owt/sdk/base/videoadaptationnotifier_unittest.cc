@@ -0,0 +1,90 @@
+// Copyright (C) <2020> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+#include "talk/owt/sdk/base/videoadaptationnotifier.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "testing/gtest/include/gtest/gtest.h"
+namespace owt {
+namespace base {
+namespace {
+class CallbackObserver : public VideoAdaptationObserver {
+ public:
+  explicit CallbackObserver(std::function<void()> callback)
+      : callback_(callback), calls_(0) {}
+  ~CallbackObserver() override {}
+  void OnVideoSourceAdapted(const std::string& track_id,
+                            int width,
+                            int height,
+                            int max_fps) override {
+    calls_++;
+    if (callback_)
+      callback_();
+  }
+  void OnVideoEncoderBitrateChanged(const std::string& track_id,
+                                    uint64_t bitrate_bps) override {
+    calls_++;
+    if (callback_)
+      callback_();
+  }
+  int calls() const { return calls_; }
+
+ private:
+  std::function<void()> callback_;
+  std::atomic<int> calls_;
+};
+}  // namespace
+
+TEST(VideoAdaptationNotifierTest, ObserverCanRemoveItselfAndOthers) {
+  VideoAdaptationNotifier notifier;
+  std::unique_ptr<CallbackObserver> second;
+  CallbackObserver first([&] {
+    notifier.RemoveObserver(&first);
+    notifier.RemoveObserver(second.get());
+    second.reset();
+  });
+  second.reset(new CallbackObserver(nullptr));
+  notifier.AddObserver(&first);
+  notifier.AddObserver(second.get());
+  notifier.NotifyVideoSourceAdapted("track", 640, 360, 30);
+  EXPECT_EQ(1, first.calls());
+  EXPECT_EQ(nullptr, second);
+  notifier.NotifyVideoEncoderBitrateChanged("track", 1000000);
+  EXPECT_EQ(1, first.calls());
+}
+
+TEST(VideoAdaptationNotifierTest, ObserverCanNotifyAgain) {
+  VideoAdaptationNotifier notifier;
+  CallbackObserver observer([&] {
+    if (observer.calls() == 1)
+      notifier.NotifyVideoEncoderBitrateChanged("track", 1000000);
+  });
+  notifier.AddObserver(&observer);
+  notifier.NotifyVideoSourceAdapted("track", 640, 360, 30);
+  EXPECT_EQ(2, observer.calls());
+  notifier.RemoveObserver(&observer);
+}
+
+TEST(VideoAdaptationNotifierTest, RemoveWaitsForCallOnOtherThread) {
+  VideoAdaptationNotifier notifier;
+  std::atomic<bool> entered(false);
+  std::atomic<bool> finished(false);
+  CallbackObserver observer([&] {
+    entered = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+  });
+  notifier.AddObserver(&observer);
+  std::thread notifying_thread(
+      [&] { notifier.NotifyVideoSourceAdapted("track", 640, 360, 30); });
+  while (!entered)
+    std::this_thread::yield();
+  notifier.RemoveObserver(&observer);
+  EXPECT_TRUE(finished);
+  notifying_thread.join();
+}
+}
+}
@@ -10,6 +10,7 @@
 #include <dxva2api.h>
 #endif
 #include "talk/owt/sdk/base/webrtcvideorendererimpl.h"
+#include "talk/owt/sdk/base/tracing.h"
 #if defined(WEBRTC_WIN)
 #include "talk/owt/sdk/base/win/d3dnativeframe.h"
 #endif
@@ -18,6 +19,7 @@
 namespace owt {
 namespace base {
 void WebrtcVideoRendererImpl::OnFrame(const webrtc::VideoFrame& frame) {
+  OWT_TRACE_EVENT("WebrtcVideoRendererImpl::OnFrame");
   if (frame.video_frame_buffer()->type() ==
           webrtc::VideoFrameBuffer::Type::kNative) {
     return;
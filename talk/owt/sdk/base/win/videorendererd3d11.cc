@@ -774,6 +774,15 @@ void WebrtcVideoRendererD3D11Impl::RenderI420Frame_DX11(const webrtc::VideoFrame
     return;
   }
 
+  // Raw frames of other formats, e.g. NV12 or I444, have no I420 view and are
+  // converted.
+  rtc::scoped_refptr<webrtc::I420BufferInterface> i420_buffer =
+      video_frame.video_frame_buffer()->ToI420();
+  if (!i420_buffer) {
+    RTC_LOG(LS_ERROR) << "Failed to convert frame to I420.";
+    return;
+  }
+
   HRESULT hr = S_OK;
   p_mt->Enter();
   D3D11_MAPPED_SUBRESOURCE sub_resource = {0};
@@ -783,16 +792,12 @@ void WebrtcVideoRendererD3D11Impl::RenderI420Frame_DX11(const webrtc::VideoFrame
     return;
   }
 
-  libyuv::I420ToARGB(video_frame.video_frame_buffer()->GetI420()->DataY(),
-                     video_frame.video_frame_buffer()->GetI420()->StrideY(),
-                     video_frame.video_frame_buffer()->GetI420()->DataU(),
-                     video_frame.video_frame_buffer()->GetI420()->StrideU(),
-                     video_frame.video_frame_buffer()->GetI420()->DataV(),
-                     video_frame.video_frame_buffer()->GetI420()->StrideV(),
+  libyuv::I420ToARGB(i420_buffer->DataY(), i420_buffer->StrideY(),
+                     i420_buffer->DataU(), i420_buffer->StrideU(),
+                     i420_buffer->DataV(), i420_buffer->StrideV(),
                      static_cast<uint8_t*>(sub_resource.pData),
-                     sub_resource.RowPitch,
-                     video_frame.video_frame_buffer()->width(),
-                     video_frame.video_frame_buffer()->height());
+                     sub_resource.RowPitch, i420_buffer->width(),
+                     i420_buffer->height());
   d3d11_device_context_->Unmap(d3d11_staging_texture_, 0);
 
   D3D11_TEXTURE2D_DESC desc = {0};
@@ -1,4 +1,8 @@
 ﻿#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include "owt/base/globalconfiguration.h"
 #include "owt/base/RTCClientObserver.h"
 
 namespace owt
@@ -50,8 +54,30 @@ namespace owt
                 RTCClientObserver* observer);
             virtual ~RTCClient();
          
+            /**
+            @brief 异步创建 RTCClient.
+            @details 不阻塞调用线程, 可同时创建多个 RTCClient. PeerConnection 在内部线程创建完成后回调 `on_created`,
+            创建失败时回调 nullptr. 回调在内部线程执行, 请勿在回调中进行耗时操作.
+            @param config `RTCClientConfiguration` 配置 RTCClient.
+            @param id `RTCClient` 的唯一标识, 用于区别多个 RTCClient 实例.
+            @param observer 需要实现 `RTCClientObserver` 接口.
+            @param on_created 创建完成回调.
+            @return void.
+             */
+            static void CreateAsync(RTCClientConfiguration config,
+                const std::string& id,
+                RTCClientObserver* observer,
+                std::function<void(std::shared_ptr<RTCClient>)> on_created);
+
             /// 关闭 RTCClient 的一切活动
             void Close();
+            /**
+            @brief 异步关闭 RTCClient.
+            @details 不阻塞调用线程, 关闭完成后在内部线程回调 `on_closed`.
+            @param on_closed 关闭完成回调, 可为空.
+            @return void.
+             */
+            void CloseAsync(std::function<void()> on_closed);
 
             /**
             @brief 创建 Offer
@@ -85,6 +111,15 @@ namespace owt
              */
             void SetRemoteICECandidate(const std::string& sdp, const std::string& sdp_mid, int sdp_mline_index);
 
+            /**
+            @brief 批量设置远端传过来的 ICE candidate.
+            @details 与逐个调用 `SetRemoteICECandidate()` 效果相同, 但只进行一次线程切换. 远端 SDP 设置之前收到的
+            Candidate 将被缓存, 数量上限请见 `RTCClientConfiguration::max_pending_remote_candidates`.
+            @param candidates `RTCCIceCandidate` 列表.
+            @return void.
+             */
+            void SetRemoteICECandidates(const std::vector<RTCCIceCandidate>& candidates);
+
             /**
             @brief 发布本地媒体流数据(screen/camera).
             @details 此方法添加本地数据(MediaTrack)之后将自动调用 `CreateOffer()`.
@@ -102,6 +137,86 @@ namespace owt
             */
             void GetConnectionStats();
 
+            /**
+            @brief 获取连接统计, 结果为连续存储的定长结构.
+            @details 内容与 `GetConnectionStats()` 相同, 但统计存入每个 `RTCClient` 复用的缓冲区, 适合高频查询.
+            回调的执行线程与 `RTCClientObserver` 回调相同, `stats` 仅在回调内有效, 需要保留时请复制.
+            @param on_complete 获取完成时的回调.
+            @return void.
+            */
+            void GetFlatConnectionStats(std::function<void(const FlatConnectionStats& stats)> on_complete);
+
+            /**
+            @brief 获取符合 W3C 规范的连接统计.
+            @details 统计由 WebRTC 标准统计收集器生成, 包括 codec, inbound-rtp/outbound-rtp/remote-inbound-rtp,
+            transport, candidate-pair 与 local/remote candidate 等. 回调的执行线程与 `RTCClientObserver` 回调相同.
+            @param on_success 获取成功时的回调.
+            @param on_failure 获取失败时的回调.
+            @return void.
+            */
+            void GetStats(std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+
+            /**
+            @brief 获取指定类型的连接统计.
+            @details 仅转换并回调 `type_mask` 中的统计类型, 其余类型直接跳过, 适合高频的健康检查.
+            例如 `RTCStatsTypeMask::kInboundRTP | RTCStatsTypeMask::kCandidatePair`.
+            回调的执行线程与 `RTCClientObserver` 回调相同.
+            @param type_mask `RTCStatsTypeMask` 的组合.
+            @param on_success 获取成功时的回调.
+            @param on_failure 获取失败时的回调.
+            @return void.
+            */
+            void GetStats(uint32_t type_mask,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+
+            /**
+            @brief 获取指定本地媒体轨道发送端的统计.
+            @details 仅收集该发送端相关的统计, 开销小于 `GetStats()`, 适合定期查询.
+            @param track_id 本地媒体轨道(MediaTrack)的 id.
+            @param on_success 获取成功时的回调.
+            @param on_failure 未找到对应的发送端或获取失败时的回调.
+            @return void.
+            */
+            void GetSenderStats(const std::string& track_id,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+
+            /**
+            @brief 获取指定远端媒体轨道接收端的统计.
+            @details 仅收集该接收端相关的统计, 开销小于 `GetStats()`, 适合定期查询.
+            @param track_id 远端媒体轨道(MediaTrack)的 id.
+            @param on_success 获取成功时的回调.
+            @param on_failure 未找到对应的接收端或获取失败时的回调.
+            @return void.
+            */
+            void GetReceiverStats(const std::string& track_id,
+                std::function<void(std::shared_ptr<RTCStatsReport>)> on_success,
+                std::function<void(std::unique_ptr<Exception>)> on_failure);
+
+            /**
+            @brief 获取最近一次后台统计采样.
+            @details 需设置 `RTCClientConfiguration::stats_sampling_interval_ms`. 此方法不会查询 WebRTC, 可频繁调用.
+            @param sample 输出的采样, 包括各 RTP 流的累计值与码率/帧率/丢包率等.
+            @return 尚无采样或未启用采样时返回 false.
+            */
+            bool GetLatestStatsSample(RTCCStatsSample* sample) const;
+
+            /**
+            @brief 获取保留的后台统计采样.
+            @details 最多 `RTCClientConfiguration::stats_history_size` 个, 此方法不会查询 WebRTC.
+            @return 按时间从早到晚排列的采样.
+            */
+            std::vector<RTCCStatsSample> GetStatsSampleHistory() const;
+
+            /**
+            @brief 获取连接建立各阶段的耗时.
+            @details 与 `RTCClientObserver::OnSetupLatency()` 回调的内容相同, 可在连接建立前调用查看已完成的阶段.
+            @return 各阶段相对于建立开始的耗时, 尚未发生的阶段为 -1.
+            */
+            RTCCSetupLatency GetSetupLatency() const;
+
             /**
             @brief 重置 `PeerConnectionFactory` 单实例.
             @details 此方法目的为重置创建内部 MediaEncoder/Decoder 的方式, 如: 是否使用硬件加速编解码功能, 
@@ -117,13 +232,113 @@ namespace owt
             */
             static void SetRTCLogLevel(RTCCLogLevel level);
 
+            /**
+            @brief 获取各 `PeerConnectionFactory` 分片的负载.
+            @details 分片数量与分配策略请见 `GlobalConfiguration::SetPeerConnectionFactoryShards()`.
+            未启用分片时仅返回默认实例的负载.
+            @return 每个已创建分片的当前连接数与累计连接数.
+            */
+            static std::vector<FactoryShardLoad> GetFactoryShardLoads();
+
+            /**
+            @brief 获取 SDK 内部线程的 CPU 占用时间.
+            @details 包括各 `PeerConnectionFactory` 分片的 PeerConnection/signaling/worker/network 线程.
+            线程模型请见 `GlobalConfiguration::SetThreadModelConfiguration()`. 此方法会等待各线程处理查询, 请勿在回调中调用.
+            @return 每个线程的名称与 CPU 时间(微秒).
+            */
+            static std::vector<ThreadCpuTime> GetThreadCpuTimes();
+
+            /**
+            @brief 预先创建 PeerConnection 并放入连接池.
+            @details 池中的 PeerConnection 在创建时即生成证书并开始收集 host/srflx 候选, 之后以相同 `config`
+            创建的 `RTCClient` 直接从池中取用, 缩短建立连接的时间. 每个 `PeerConnectionFactory` 分片各自维护一个池,
+            被取走后在后台补充. 以不同 `config` 再次调用会替换池中的 PeerConnection.
+            @param config 之后创建 `RTCClient` 时使用的配置.
+            @param size 每个分片池中保持的 PeerConnection 数量, 0 为关闭连接池.
+            @return void.
+            */
+            static void WarmUpPeerConnectionPool(RTCClientConfiguration config, int size);
+
+            /**
+            @brief 获取连接池的统计.
+            @details 为所有 `PeerConnectionFactory` 分片的合计. 此方法会等待各线程处理查询, 请勿在回调中调用.
+            @return 可用数量, 命中与未命中次数, 命中节省的同步创建时间, 以及命中前在池中预热的时间.
+            */
+            static PeerConnectionPoolStats GetPeerConnectionPoolStats();
+
+            /**
+            @brief 在调用线程执行队列中的 `RTCClientObserver` 回调.
+            @details 仅在 `GlobalConfiguration::SetObserverEventDispatchMode()` 设置为
+            `ObserverEventDispatchMode::kApplication` 时有效, 应由应用的同一线程定期调用. 同一 `RTCClient` 的回调按发生顺序执行.
+            @return 本次执行的回调数量.
+            */
+            static size_t DispatchObserverEvents();
+
+            /**
+            @brief 获取 `RTCClientObserver` 回调队列的统计.
+            @details 包括队列长度, 最长回调执行时间与最长排队时间. 回调直接执行时返回全 0.
+            @return 回调队列统计.
+            */
+            static ObserverEventQueueStats GetObserverEventQueueStats();
+
+            /**
+            @brief 立即汇总进程内所有 `RTCClient` 的统计.
+            @details 需启用 `GlobalConfiguration::SetStatsAggregatorConfiguration()`. 汇总结果与定时导出的内容相同,
+            包括总码率, 各 ICE 状态的连接数以及 RTT/抖动的分位数与直方图.
+            @param format 输出格式.
+            @return 汇总结果, 未启用时返回空字符串.
+            */
+            static std::string ExportAggregatedStats(StatsExportFormat format);
+
+            /**
+            @brief 获取进程内所有 `RTCClient` 连接建立各阶段耗时的直方图.
+            @return 每个阶段一个直方图, 顺序与 `RTCCSetupLatency` 的字段相同.
+            */
+            static std::vector<RTCCSetupLatencyHistogram> GetSetupLatencyHistograms();
+
+            /**
+            @brief 获取 SDK 内部线程任务排队延迟的直方图.
+            @details 需启用 `GlobalConfiguration::SetThreadLagMonitorConfiguration()`. 包括各 `PeerConnectionFactory`
+            分片的 PeerConnection/signaling/worker/network 线程, 超过阈值的延迟另由日志与 `on_stall` 回调报告.
+            @return 按线程名称排列的直方图, 未启用时返回空.
+            */
+            static std::vector<ThreadLagHistogram> GetThreadLagHistograms();
+
+            /**
+            @brief 开始记录 SDK 关键路径的 trace 事件.
+            @details 包括采集, 编码, 解码, 渲染以及 SDP/ICE 处理. 各线程将事件写入自己的环形缓冲区,
+            缓冲区满时只保留最新的事件. 再次调用会丢弃之前记录的事件.
+            @return void.
+            */
+            static void StartTracing();
+
+            /**
+            @brief 停止记录 trace 事件并写入文件.
+            @param output_path 输出文件路径.
+            @param format 输出格式, Chrome JSON 可由 chrome://tracing 或 Perfetto UI 打开.
+            @return 无法写入文件时返回 false.
+            */
+            static bool StopTracing(const std::string& output_path, TraceFormat format);
+
+            /**
+            @brief 获取自定义视频采集帧缓冲池的统计.
+            @details 为进程内所有 `CustomizedFramesCapturer` 的合计, 不包括视频源缩放帧使用的缓冲池. 每帧使用独立的缓冲区, 下游释放后回收复用.
+            @return 复用与新分配的次数, 以及池中缓冲区数量.
+            */
+            static FrameBufferPoolStats GetFrameBufferPoolStats();
+
         private:
+            RTCClient(RTCClientConfiguration config,
+                const std::string& id,
+                RTCClientObserver* observer,
+                bool initialize_peer_connection);
             // PeerConnection
             std::shared_ptr<RTCConnectionChannel> pcc_;
             // RTCConfigs
             RTCClientConfiguration rtc_config_;
             // help method
-            PeerConnectionChannelConfiguration GetPeerConnectionChannelConfiguration();
+            static PeerConnectionChannelConfiguration GetPeerConnectionChannelConfiguration(
+                const RTCClientConfiguration& rtc_config);
         };
     }
 }
@@ -54,6 +54,167 @@ namespace owt
         struct RTCClientConfiguration : owt::base::ClientConfiguration {
             std::vector<AudioEncodingParameters> audio_encodings;
             std::vector<VideoEncodingParameters> video_encodings;
+            /// 本地 ICE Candidate 合并回调的时间窗口(毫秒). 窗口内收集到的 Candidate 通过
+            /// `RTCClientObserver::OnDiscoverLocalCandidates()` 一次回调, 收集完成时立即回调.
+            /// 0 为不合并, 每个 Candidate 通过 `RTCClientObserver::OnDiscoverLocalCandidate()` 单独回调.
+            int candidate_batch_window_ms = 0;
+            /// 设置远端 SDP 之前缓存的远端 ICE Candidate 数量上限, 超出部分将被丢弃.
+            size_t max_pending_remote_candidates = 100;
+            /// 后台统计采样间隔(毫秒), ICE 连接建立后开始采样. 0 为不采样.
+            /// 采样结果见 `RTCClient::GetLatestStatsSample()`.
+            int stats_sampling_interval_ms = 0;
+            /// 保留的统计采样数量, 超出后覆盖最早的采样.
+            size_t stats_history_size = 60;
+            /// 带宽估计与编码自适应的检测间隔(毫秒), ICE 连接建立后开始检测. 0 为不检测.
+            /// 自定义帧生成器, 外部编码器及推送帧的视频流由采集和编码线程直接推送变化, 其余通过统计检测;
+            /// `stats_sampling_interval_ms` 大于 0 时复用统计采样, 按采样间隔检测.
+            /// 检测到的变化通过 `RTCClientObserver::OnTargetBitrateChanged()`,
+            /// `RTCClientObserver::OnQualityLimitationChanged()` 和
+            /// `RTCClientObserver::OnVideoAdaptationChanged()` 回调.
+            int adaptation_monitor_interval_ms = 0;
+            /// 是否根据每次统计采样计算媒体质量评分, 需要 `stats_sampling_interval_ms` 大于 0.
+            /// 评分通过 `RTCClientObserver::OnQualityScoresUpdated()` 回调.
+            bool quality_scoring_enabled = false;
+        };
+
+        /// 视频发送质量受限的原因.
+        enum RTCCQualityLimitationReason {
+            kQualityLimitationNone,
+            kQualityLimitationCpu,
+            kQualityLimitationBandwidth,
+            kQualityLimitationOther,
+        };
+
+        /// 视频发送流的编码自适应状态.
+        struct RTCCVideoSenderAdaptation
+        {
+            uint32_t ssrc = 0;
+            /// 本地视频轨道的 id.
+            std::string track_id;
+            RTCCQualityLimitationReason quality_limitation_reason = kQualityLimitationNone;
+            /// 因质量受限而改变分辨率的累计次数.
+            uint32_t resolution_changes = 0;
+            /// 发送的分辨率.
+            uint32_t frame_width = 0;
+            uint32_t frame_height = 0;
+            /// 发送的帧率. 由视频源推送的变化为请求的帧率上限, 不限制时为 0.
+            double frame_rate = 0;
+            /// 编码器的目标码率(bps), 未知时为 0.
+            double target_bitrate_bps = 0;
+        };
+
+        /// 单个 RTP 流的统计采样. 累计值与 WebRTC 统计相同, 速率为相对上一次采样的计算值.
+        struct RTCCStreamStatsSample
+        {
+            uint32_t ssrc = 0;
+            /// 是否为发送流.
+            bool outbound = false;
+            /// 是否为视频流.
+            bool video = false;
+            /// 累计发送/接收字节数.
+            uint64_t bytes = 0;
+            /// 累计发送/接收包数.
+            uint64_t packets = 0;
+            /// 累计丢包数, 发送流为远端报告的值.
+            int32_t packets_lost = 0;
+            /// 累计编码/解码帧数.
+            uint32_t frames = 0;
+            /// 累计 QP.
+            uint64_t qp_sum = 0;
+            /// 往返时延(毫秒), 接收流可能为 0.
+            double round_trip_time_ms = 0;
+            /// 抖动(毫秒), 发送流为远端报告的值.
+            double jitter_ms = 0;
+            double bitrate_bps = 0;
+            double packet_rate = 0;
+            double frame_rate = 0;
+            /// 采样间隔内的丢包率, 0 至 1.
+            double loss_fraction = 0;
+            /// 采样间隔内每帧的平均 QP.
+            double average_qp = 0;
+        };
+
+        /// 一次统计采样.
+        struct RTCCStatsSample
+        {
+            /// 采样时间(毫秒, 单调时钟).
+            int64_t timestamp_ms = 0;
+            std::vector<RTCCStreamStatsSample> streams;
+        };
+
+        /// 单个 RTP 流的质量评分及其依据.
+        struct RTCCStreamQualityScore
+        {
+            uint32_t ssrc = 0;
+            /// 是否为发送流.
+            bool outbound = false;
+            /// 是否为视频流.
+            bool video = false;
+            /// 类 MOS 评分, 1(差) 至 5(优).
+            double score = 0;
+            /// 采样间隔内的丢包率, 0 至 1. 接收音频为丢包率与丢包隐藏比例中的较大值.
+            double loss_fraction = 0;
+            double jitter_ms = 0;
+            double round_trip_time_ms = 0;
+            /// 采样间隔内的卡顿次数, 仅接收视频.
+            uint32_t freeze_count = 0;
+            /// 采样间隔内卡顿时长的占比, 0 至 1, 仅接收视频.
+            double freeze_fraction = 0;
+            /// 解码帧率与接收帧率之比, 0 至 1, 仅接收视频.
+            double decode_ratio = 1;
+            /// 仅发送视频.
+            RTCCQualityLimitationReason quality_limitation_reason = kQualityLimitationNone;
+        };
+
+        /// 一次统计采样的质量评分.
+        struct RTCCQualityScores
+        {
+            /// 采样时间(毫秒, 单调时钟).
+            int64_t timestamp_ms = 0;
+            /// 所有音频流中最低的评分, 没有音频流时为 0.
+            double audio_score = 0;
+            /// 所有视频流中最低的评分, 没有视频流时为 0.
+            double video_score = 0;
+            std::vector<RTCCStreamQualityScore> streams;
+        };
+
+        /// 连接建立各阶段的耗时(毫秒), 相对于建立开始的时间, 即第一次创建 offer 或设置远端 SDP.
+        /// 尚未发生的阶段为 -1.
+        struct RTCCSetupLatency
+        {
+            /// 建立开始的时间(毫秒, 单调时钟), 尚未开始时为 -1.
+            int64_t start_time_ms = -1;
+            /// 开始创建本地 SDP(offer 或 answer).
+            int64_t create_offer_start_ms = -1;
+            /// 本地 SDP 创建完成.
+            int64_t create_offer_end_ms = -1;
+            int64_t set_local_description_ms = -1;
+            int64_t first_local_candidate_ms = -1;
+            int64_t ice_gathering_complete_ms = -1;
+            int64_t set_remote_description_ms = -1;
+            int64_t ice_checking_ms = -1;
+            int64_t ice_connected_ms = -1;
+            /// ICE 与 DTLS 均已连接, 即连接建立.
+            int64_t dtls_connected_ms = -1;
+            int64_t first_packet_received_ms = -1;
+            /// 第一帧远端视频交付给视频轨道的时间, 即解码完成后首次回调 sink 的时间, 不是解码器记录的时间戳.
+            int64_t first_frame_delivered_ms = -1;
+            /// 第一帧远端视频渲染时间的估计值, 为 WebRTC jitter buffer 设定的渲染时间与交付时间中的较大者.
+            /// 不是渲染器实际显示该帧的时间.
+            int64_t first_frame_render_estimate_ms = -1;
+        };
+
+        /// 所有连接中某个建立阶段耗时的直方图.
+        struct RTCCSetupLatencyHistogram
+        {
+            /// 阶段名称, 与 `RTCCSetupLatency` 中去掉 `_ms` 后的字段名相同.
+            std::string phase;
+            /// 各桶的上限(毫秒, 包含), 最后一个桶没有上限.
+            std::vector<int64_t> bucket_bounds_ms;
+            /// 各桶的计数, 比 `bucket_bounds_ms` 多一个元素.
+            std::vector<uint64_t> bucket_counts;
+            uint64_t count = 0;
+            int64_t sum_ms = 0;
         };
 
         /// RTCClient 的各种观察回调接口.
@@ -95,6 +256,22 @@ namespace owt
             */
             virtual void OnDiscoverLocalCandidate(const std::string& id, const RTCCIceCandidate& candidate) = 0;
 
+            /**
+            @brief 批量发现本地的 ICE Candidate.
+            @details `RTCClientConfiguration::candidate_batch_window_ms` 大于 0 时, 时间窗口内收集到的 Candidate
+            通过此方法一次回调, 以减少信令消息数量. 默认实现为对每个 Candidate 调用 `OnDiscoverLocalCandidate()`.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param candidates `RTCCIceCandidate` 列表, 按收集顺序排列.
+            @return void.
+            */
+            virtual void OnDiscoverLocalCandidates(const std::string& id, const std::vector<RTCCIceCandidate>& candidates)
+            {
+                for (const auto& candidate : candidates)
+                {
+                    OnDiscoverLocalCandidate(id, candidate);
+                }
+            }
+
             /**
             @brief 成功生成本地 SDP.
             @details 此回调方法将在执行创建本地 SDP 之后触发.
@@ -121,6 +298,58 @@ namespace owt
             virtual void OnDidGetConnectionStats(
                 const std::string& id,
                 const ConnectionStats& stats) = 0;
+
+            /**
+            @brief 带宽估计的目标发送码率改变.
+            @details 首次估计及变化超过 10% 时回调, 可据此调整外部编码器或帧生成器的码率.
+            需要 `RTCClientConfiguration::adaptation_monitor_interval_ms` 大于 0. 默认实现为空.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param target_bitrate_bps `uint64_t` 外部编码器的视频流为分配给编码器的码率(bps),
+            其余为连接所有发送流可用的总码率(bps).
+            @return void.
+            */
+            virtual void OnTargetBitrateChanged(const std::string& id, uint64_t target_bitrate_bps) {}
+
+            /**
+            @brief 视频发送流质量受限的原因改变.
+            @details 例如因 CPU 或带宽不足而降低分辨率/帧率时回调. 默认实现为空.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param adaptation `RTCCVideoSenderAdaptation` 视频发送流的当前状态.
+            @return void.
+            */
+            virtual void OnQualityLimitationChanged(const std::string& id,
+                const RTCCVideoSenderAdaptation& adaptation) {}
+
+            /**
+            @brief 视频发送流的分辨率或帧率因自适应而改变.
+            @details 分辨率改变或帧率变化超过 20% 时回调, 由视频源推送时在分辨率或帧率上限改变时回调.
+            默认实现为空.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param adaptation `RTCCVideoSenderAdaptation` 视频发送流的当前状态.
+            @return void.
+            */
+            virtual void OnVideoAdaptationChanged(const std::string& id,
+                const RTCCVideoSenderAdaptation& adaptation) {}
+
+            /**
+            @brief 媒体质量评分更新.
+            @details 每次统计采样后回调, 需要 `RTCClientConfiguration::quality_scoring_enabled` 为 true.
+            默认实现为空.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param scores `RTCCQualityScores` 各媒体流的评分.
+            @return void.
+            */
+            virtual void OnQualityScoresUpdated(const std::string& id, const RTCCQualityScores& scores) {}
+
+            /**
+            @brief 连接建立各阶段的耗时.
+            @details 连接建立(ICE 与 DTLS 均已连接)时回调; 收到远端视频时, 第一帧解码后再次回调,
+            此时包括媒体相关的阶段. 默认实现为空.
+            @param id `std::string` RTCClient 实例的唯一标识.
+            @param latency `RTCCSetupLatency` 各阶段的耗时.
+            @return void.
+            */
+            virtual void OnSetupLatency(const std::string& id, const RTCCSetupLatency& latency) {}
         };
     }
 }
\ No newline at end of file
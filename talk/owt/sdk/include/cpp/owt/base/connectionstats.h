@@ -109,6 +109,24 @@ struct RTCStatsType {
   static const char* const kIceServer;
 };
 
+/// Bit masks of stats types, to select the stats delivered by a query. Only
+/// types converted from WebRTC stats have a mask.
+struct RTCStatsTypeMask {
+  static constexpr uint32_t kCodec = 1 << 0;
+  static constexpr uint32_t kInboundRTP = 1 << 1;
+  static constexpr uint32_t kOutboundRTP = 1 << 2;
+  static constexpr uint32_t kRemoteInboundRTP = 1 << 3;
+  static constexpr uint32_t kDataChannel = 1 << 4;
+  static constexpr uint32_t kTrack = 1 << 5;
+  static constexpr uint32_t kTransport = 1 << 6;
+  static constexpr uint32_t kCandidatePair = 1 << 7;
+  static constexpr uint32_t kLocalCandidate = 1 << 8;
+  static constexpr uint32_t kRemoteCandidate = 1 << 9;
+  static constexpr uint32_t kAll = 0xffffffff;
+  /// Returns the mask of |type|, one of RTCStatsType, or 0 if it has none.
+  static uint32_t FromType(const char* type);
+};
+
 /*!
  * \sa https://w3c.github.io/webrtc-stats/#idl-def-rtcstats*
  */
@@ -441,7 +459,7 @@ class RTCIceCandidateStats : public RTCStats {
 /*!
  * \sa https://w3c.github.io/webrtc-stats/#rtcstatstype-str*
  */
-class RTCLocalIceCandidateStats final : RTCIceCandidateStats {
+class RTCLocalIceCandidateStats final : public RTCIceCandidateStats {
  public:
   RTCLocalIceCandidateStats(const std::string& id,
                             int64_t timestamp,
@@ -1208,6 +1226,130 @@ struct ConnectionStats {
   /// ICE candidate pair reports
   IceCandidatePairReports ice_candidate_pair_reports;
 };
+
+/// Index of a codec name in FlatConnectionStats::codec_names, -1 if unknown.
+typedef int32_t FlatCodecIndex;
+/// Audio sender report of FlatConnectionStats, see AudioSenderReport.
+struct FlatAudioSenderReport {
+  uint32_t ssrc;
+  int64_t bytes_sent;
+  int32_t packets_sent;
+  int32_t packets_lost;
+  /// Unit: millisecond
+  int64_t round_trip_time;
+  FlatCodecIndex codec;
+};
+/// Audio receiver report of FlatConnectionStats, see AudioReceiverReport.
+struct FlatAudioReceiverReport {
+  uint32_t ssrc;
+  int64_t bytes_rcvd;
+  int32_t packets_rcvd;
+  int32_t packets_lost;
+  /// Unit: millisecond
+  int32_t estimated_delay;
+  FlatCodecIndex codec;
+};
+/// Video sender report of FlatConnectionStats, see VideoSenderReport.
+struct FlatVideoSenderReport {
+  uint32_t ssrc;
+  int64_t bytes_sent;
+  int32_t packets_sent;
+  int32_t packets_lost;
+  int32_t fir_count;
+  int32_t pli_count;
+  int32_t nack_count;
+  int32_t frame_width_sent;
+  int32_t frame_height_sent;
+  int32_t framerate_sent;
+  /// Bitmask of VideoSenderReport::AdaptReason
+  int32_t last_adapt_reason;
+  int32_t adapt_changes;
+  /// Unit: millisecond
+  int64_t round_trip_time;
+  FlatCodecIndex codec;
+};
+/// Video receiver report of FlatConnectionStats, see VideoReceiverReport.
+struct FlatVideoReceiverReport {
+  uint32_t ssrc;
+  int64_t bytes_rcvd;
+  int32_t packets_rcvd;
+  int32_t packets_lost;
+  int32_t fir_count;
+  int32_t pli_count;
+  int32_t nack_count;
+  int32_t frame_width_rcvd;
+  int32_t frame_height_rcvd;
+  int32_t framerate_rcvd;
+  int32_t framerate_output;
+  /// Unit: millisecond
+  int32_t delay;
+  /// Unit: millisecond
+  int32_t jitter;
+  FlatCodecIndex codec;
+};
+/// Index of a candidate in FlatConnectionStats::local_ice_candidate_reports or
+/// remote_ice_candidate_reports, -1 if unknown.
+typedef int32_t FlatCandidateIndex;
+/// ICE candidate report of FlatConnectionStats, see IceCandidateReport.
+struct FlatIceCandidateReport {
+  /// The ID of this report, truncated to fit.
+  char id[32];
+  /// The IP address of the candidate, truncated to fit.
+  char ip[46];
+  uint16_t port;
+  TransportProtocolType protocol;
+  IceCandidateType candidate_type;
+  int32_t priority;
+};
+/// ICE candidate pair report of FlatConnectionStats, see
+/// IceCandidatePairReport.
+struct FlatIceCandidatePairReport {
+  /// Indicate whether transport is active.
+  bool is_active;
+  FlatCandidateIndex local_ice_candidate;
+  FlatCandidateIndex remote_ice_candidate;
+  int64_t bytes_sent;
+  int64_t bytes_rcvd;
+  /// Unit: millisecond
+  int64_t round_trip_time;
+};
+/// Connection statistics with fixed-size reports stored contiguously. Filling
+/// a FlatConnectionStats again reuses its storage, so polling it does not
+/// allocate once the numbers of streams and codecs are stable.
+struct FlatConnectionStats {
+  /// Remove all reports, keeping storage and interned codec names.
+  void Clear() {
+    audio_sender_reports.clear();
+    audio_receiver_reports.clear();
+    video_sender_reports.clear();
+    video_receiver_reports.clear();
+    local_ice_candidate_reports.clear();
+    remote_ice_candidate_reports.clear();
+    ice_candidate_pair_reports.clear();
+    video_bandwidth_stats = VideoBandwidthStats();
+  }
+  /// Returns the codec name of |codec|, or an empty string if unknown.
+  const std::string& codec_name(FlatCodecIndex codec) const {
+    static const std::string kEmpty;
+    return codec >= 0 && static_cast<size_t>(codec) < codec_names.size()
+               ? codec_names[codec]
+               : kEmpty;
+  }
+  /// Time stamp of connection statistics generation
+  std::chrono::system_clock::time_point time_stamp;
+  VideoBandwidthStats video_bandwidth_stats;
+  std::vector<FlatAudioSenderReport> audio_sender_reports;
+  std::vector<FlatAudioReceiverReport> audio_receiver_reports;
+  std::vector<FlatVideoSenderReport> video_sender_reports;
+  std::vector<FlatVideoReceiverReport> video_receiver_reports;
+  std::vector<FlatIceCandidateReport> local_ice_candidate_reports;
+  std::vector<FlatIceCandidateReport> remote_ice_candidate_reports;
+  std::vector<FlatIceCandidatePairReport> ice_candidate_pair_reports;
+  /// Codec names referred by reports. Names are kept across fills, so the
+  /// index of a codec does not change, and a name is only allocated the first
+  /// time it is seen.
+  std::vector<std::string> codec_names;
+};
 } // namespace base
 } // namespace owt
 #endif  // OWT_BASE_CONNECTIONSTATS_H_
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef OWT_BASE_FRAMEGENERATORINTERFACE_H_
 #define OWT_BASE_FRAMEGENERATORINTERFACE_H_
+#include <functional>
 #include "stdint.h"
 namespace owt {
 namespace base {
@@ -36,10 +37,22 @@ class AudioFrameGeneratorInterface {
 */
 class VideoFrameGeneratorInterface {
  public:
+  /**
+   @brief Format of generated frames.
+   @details Raw frames are generated with planes packed without padding, in
+   order Y, U, V for I420 and I444, and Y, UV for NV12. ARGB and BGRA follow
+   libyuv naming of 32 bit little-endian pixels, i.e. ARGB is B, G, R, A bytes
+   in memory, and BGRA is A, R, G, B bytes. Frames other than I420 are passed
+   to encoders as they are, or converted to I420 only when a consumer needs it.
+   */
   enum VideoFrameCodec {
     I420,
     VP8,
     H264,
+    NV12,
+    I444,
+    ARGB,
+    BGRA,
   };
   /**
    @brief This function generates one frame data.
@@ -70,6 +83,15 @@ class VideoFrameGeneratorInterface {
    @brief This function gets the fps of video frame generator.
    */
   virtual int GetFps() = 0;
+  /**
+   @brief This function gets the frame rate as a fraction, e.g. 30000 / 1001
+   for 29.97 fps. Frames are read at this rate. Default implementation returns
+   GetFps() / 1 for backwards compatibility.
+   */
+  virtual void GetFrameRate(int* numerator, int* denominator) {
+    *numerator = GetFps();
+    *denominator = 1;
+  }
   /**
    @brief This function gets the video frame type of video frame generator.
    */
@@ -79,6 +101,41 @@ class VideoFrameGeneratorInterface {
    GenerateNextFrame(). Default implementation provided for backwards compatibility.
    */
   virtual void Cleanup() {}
+  /**
+   @brief This function is called when consumers of the stream, e.g. encoder
+   under CPU overuse or bandwidth limitation, request smaller or fewer frames.
+   @details SDK drops or scales raw frames exceeding the request anyway.
+   Generators may produce frames within it to save the work. It is not called
+   concurrently with GenerateNextFrame(). Default implementation provided for
+   backwards compatibility.
+   @param max_pixel_count Maximum pixels of a frame, INT_MAX if not limited.
+   @param max_fps Maximum frame rate, INT_MAX if not limited.
+   */
+  virtual void OnAdaptationChanged(int max_pixel_count, int max_fps) {}
+};
+/**
+ @brief Raw video frame in memory owned by application, pushed with
+ LocalStream::PushVideoFrame().
+ @details Planes are not copied. They must stay valid and unchanged until
+ |release_callback| is invoked, which happens on an arbitrary thread once the
+ last consumer, e.g. encoder or renderer, drops the frame.
+*/
+struct PushedVideoFrame {
+  /// One of the raw formats I420, NV12, I444, ARGB and BGRA.
+  VideoFrameGeneratorInterface::VideoFrameCodec format =
+      VideoFrameGeneratorInterface::I420;
+  int width = 0;
+  int height = 0;
+  /// Y, U and V planes of I420 and I444, Y and UV planes of NV12, or the only
+  /// plane of ARGB and BGRA. Unused planes are ignored.
+  const uint8_t* data[3] = {nullptr, nullptr, nullptr};
+  /// Strides of planes in bytes.
+  int stride[3] = {0, 0, 0};
+  /// Capture time in microseconds on the monotonic clock of rtc::TimeMicros().
+  /// 0 means the time the frame is pushed.
+  int64_t timestamp_us = 0;
+  /// Invoked when the SDK no longer refers to the planes.
+  std::function<void()> release_callback;
 };
 } // namespace base
 } // namespace owt
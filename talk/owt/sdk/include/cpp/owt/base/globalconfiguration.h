@@ -3,7 +3,10 @@
 // SPDX-License-Identifier: Apache-2.0
 #ifndef OWT_BASE_GLOBALCONFIGURATION_H_
 #define OWT_BASE_GLOBALCONFIGURATION_H_
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 #include "owt/base/framegeneratorinterface.h"
 #include "owt/base/videodecoderinterface.h"
 #if defined(WEBRTC_WIN)
@@ -72,12 +75,267 @@ struct IcePortRanges {
   IcePortRange data;
 };
 
+/// Policy of assigning new connections to PeerConnectionFactory shards.
+enum class FactoryShardPolicy : int {
+  /// Assign connections to shards in turn.
+  kRoundRobin = 0,
+  /// Assign a connection to the shard with the fewest active connections.
+  kLeastLoaded,
+};
+
+/// Load counters of a PeerConnectionFactory shard.
+struct FactoryShardLoad {
+  /// Index of the shard. Shard 0 also creates local streams.
+  int shard_index;
+  /// Number of connections currently assigned to this shard.
+  int active_connections;
+  /// Number of connections ever assigned to this shard.
+  uint64_t total_connections;
+};
+
+/// Counters of the pre-created PeerConnection pool.
+struct PeerConnectionPoolStats {
+  /// Number of PeerConnections ready to be taken.
+  int available = 0;
+  /// Number of connections which got a pre-created PeerConnection.
+  uint64_t hits = 0;
+  /// Number of connections which created a new PeerConnection while the pool
+  /// was enabled, because it was empty or configured differently.
+  uint64_t misses = 0;
+  /**
+   @brief Sum of time hits skipped in the synchronous PeerConnection creation
+   call, in milliseconds.
+   @details Certificate generation and candidate gathering continue after the
+   call and are not included.
+  */
+  int64_t create_call_time_ms = 0;
+  /**
+   @brief Sum of time hits spent in the pool before they were taken, in
+   milliseconds.
+   @details Certificate generation and candidate gathering of a pooled
+   PeerConnection run during this time, so a hit saves up to this time on
+   call setup, at most the time they take.
+  */
+  int64_t head_start_time_ms = 0;
+};
+
+/// Counters of I420 buffer pools of customized video capturers.
+struct FrameBufferPoolStats {
+  /// Frames which reused a released buffer.
+  uint64_t hits = 0;
+  /// Frames which allocated a buffer, because every pooled buffer of their
+  /// resolution was still in use.
+  uint64_t misses = 0;
+  /// Buffers kept by the pools, in use or not.
+  int64_t pooled_buffers = 0;
+};
+
+/// Key type of DTLS certificates.
+enum class CertificateKeyType : int {
+  /// ECDSA with curve P-256.
+  kEcdsa = 0,
+  /// RSA with 2048 bit modulus.
+  kRsa,
+};
+
+/// Settings of the DTLS certificate cache.
+struct CertificateCacheConfiguration {
+  /**
+   @brief Share pre-generated DTLS certificates among PeerConnections.
+   @details Disabled by default, in which case every PeerConnection generates
+   its own certificate.
+  */
+  bool enabled = false;
+  CertificateKeyType key_type = CertificateKeyType::kEcdsa;
+  /// Validity period of generated certificates, in milliseconds.
+  int64_t lifetime_ms = 30LL * 24 * 60 * 60 * 1000;
+  /**
+   @brief Age after which the cached certificate is replaced by a new one, in
+   milliseconds.
+   @details Connections created afterwards use the new certificate. Existing
+   connections keep the old one, so this should be smaller than |lifetime_ms|
+   by at least the longest expected session.
+  */
+  int64_t rotation_interval_ms = 24LL * 60 * 60 * 1000;
+};
+
+/// Thread RTCClientObserver callbacks are invoked on.
+enum class ObserverEventDispatchMode : int {
+  /// Invoke callbacks on WebRTC signaling thread. A slow callback delays
+  /// negotiation of all connections on the same PeerConnectionFactory.
+  kDirect = 0,
+  /// Queue callbacks and invoke them on a thread created by SDK.
+  kDispatcherThread,
+  /// Queue callbacks and invoke them when application calls
+  /// RTCClient::DispatchObserverEvents().
+  kApplication,
+};
+
+/// Counters of the RTCClientObserver event queue.
+struct ObserverEventQueueStats {
+  /// Number of events waiting to be dispatched.
+  int64_t depth = 0;
+  /// Longest time spent in a callback, in microseconds.
+  int64_t max_handler_latency_us = 0;
+  /// Longest time an event waited in the queue, in microseconds.
+  int64_t max_queue_delay_us = 0;
+  /// Number of events dispatched.
+  uint64_t dispatched_events = 0;
+};
+
+/// Output format of the stats aggregator.
+enum class StatsExportFormat : int {
+  /// Prometheus text exposition format. The output file is replaced on each
+  /// export, so it can be read by a textfile collector.
+  kPrometheus = 0,
+  /// One JSON object per export. Lines are appended to the output file.
+  kJsonLines,
+};
+
+/// Output format of SDK traces.
+enum class TraceFormat : int {
+  /// JSON Trace Event Format, loaded by chrome://tracing and Perfetto UI.
+  kChromeJson = 0,
+  /// Perfetto protobuf trace.
+  kPerfetto,
+};
+
+/// Settings of the process wide stats aggregator.
+struct StatsAggregatorConfiguration {
+  /**
+   @brief Aggregate stats of all RTCClients in the process. Disabled by
+   default.
+  */
+  bool enabled = false;
+  /**
+   @brief Aggregation interval, in milliseconds.
+   @details RTCClients with RTCClientConfiguration::stats_sampling_interval_ms
+   unset sample their stats at this interval.
+  */
+  int interval_ms = 1000;
+  StatsExportFormat format = StatsExportFormat::kPrometheus;
+  /// File the output is written to. Empty for no file.
+  std::string output_path;
+  /// Invoked on the aggregator thread with the output of each interval.
+  std::function<void(const std::string& output)> on_export;
+};
+
+/// Scheduling priority of an SDK thread.
+enum class ThreadPriority : int {
+  /// Default priority of the OS.
+  kNormal = 0,
+  /// Raised priority within the normal scheduling class.
+  kHigh,
+  /// Realtime scheduling. SCHED_FIFO on Linux, which requires CAP_SYS_NICE or
+  /// a suitable RLIMIT_RTPRIO.
+  kRealtime,
+};
+
+/// Affinity and priority of an SDK thread.
+struct ThreadSettings {
+  /// Indexes of CPU cores the thread is pinned to. Empty means no pinning.
+  std::vector<int> cpu_affinity;
+  ThreadPriority priority = ThreadPriority::kNormal;
+};
+
+/// Threads created by PeerConnectionFactory and how they are set up.
+struct ThreadModelConfiguration {
+  /**
+   @brief Run WebRTC signaling on the SDK's own PeerConnection thread instead
+   of a dedicated signaling thread. Saves one thread and a thread hop for every
+   PeerConnection operation. Disabled by default.
+  */
+  bool merge_signaling_thread = false;
+  ThreadSettings network_thread;
+  ThreadSettings worker_thread;
+  /// Ignored if |merge_signaling_thread| is true.
+  ThreadSettings signaling_thread;
+};
+
+/// What the customized frame capturer does when it falls behind schedule.
+enum class FramePacingLatePolicy : int {
+  /// Read the latest missed frame immediately and drop older ones, keeping
+  /// the schedule. Default.
+  kSkip = 0,
+  /// Read missed frames back to back to keep the average frame rate. Frames
+  /// more than a second behind are still dropped.
+  kCatchUp,
+};
+
+/// Pacing of frames read from a VideoFrameGeneratorInterface or
+/// VideoEncoderInterface.
+struct FramePacingConfiguration {
+  FramePacingLatePolicy late_policy = FramePacingLatePolicy::kSkip;
+  /// The capture thread sleeps until this many microseconds before a
+  /// deadline, and yields in a loop for the rest. A longer window takes more
+  /// CPU time but absorbs late wake-ups, e.g. of a coarse OS timer resolution.
+  int spin_us = 200;
+  /// Affinity and priority of the capture thread. Use
+  /// ThreadPriority::kRealtime for the least jitter.
+  ThreadSettings thread;
+};
+
+/// CPU time consumed by an SDK thread.
+struct ThreadCpuTime {
+  std::string thread_name;
+  /// User and kernel CPU time in microseconds. -1 if not supported.
+  int64_t cpu_time_us;
+};
+
+/// A probe task of the thread lag monitor which waited longer than the stall
+/// threshold.
+struct ThreadStall {
+  std::string thread_name;
+  /// Time the probe waited in the thread's queue, in microseconds. If it has
+  /// not run yet, the time it has waited so far.
+  int64_t lag_us = 0;
+  /// False if the probe has not run yet, i.e. the thread is still blocked.
+  bool completed = false;
+};
+
+/// Queueing delay of probe tasks posted to an SDK thread.
+struct ThreadLagHistogram {
+  std::string thread_name;
+  /// Upper bounds of histogram buckets in microseconds, the last bucket is
+  /// unbounded.
+  std::vector<int64_t> bucket_bounds_us;
+  /// Counts of probes in each bucket, not cumulative. Has one more element
+  /// than |bucket_bounds_us|.
+  std::vector<uint64_t> bucket_counts;
+  uint64_t count = 0;
+  int64_t sum_us = 0;
+  int64_t max_us = 0;
+};
+
+/// Settings of the thread lag monitor.
+struct ThreadLagMonitorConfiguration {
+  /**
+   @brief Measure the queueing delay of PeerConnection, signaling, worker and
+   network threads. Disabled by default.
+  */
+  bool enabled = false;
+  /// Interval between probes of each thread, in milliseconds.
+  int interval_ms = 500;
+  /// Probes waiting longer than this are logged and reported as stalls.
+  int stall_threshold_ms = 100;
+  /**
+   @brief Invoked on the monitor thread for each stall. A blocked thread is
+   reported once when its probe exceeds the threshold, and again when the
+   probe eventually runs.
+  */
+  std::function<void(const ThreadStall& stall)> on_stall;
+};
+
 /**
  @brief configuration of global using.
  GlobalConfiguration class of setting for encoded frame and hardware accecleartion configuration.
 */
 class GlobalConfiguration {
   friend class PeerConnectionDependencyFactory;
+  friend class ObserverEventQueue;
+  friend class StatsAggregator;
+  friend class ThreadLagMonitor;
+  friend class CustomizedFramesCapturer;
  public:
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
   /**
@@ -96,6 +354,44 @@ class GlobalConfiguration {
   }
 #endif
 
+  /**
+   @brief This function enables UDP muxing for ICE.
+   @details When enabled, UDP candidates of all PeerConnections share one UDP
+   socket per local IP, instead of one socket per PeerConnection and network
+   interface. Received datagrams are dispatched to PeerConnections by STUN
+   transaction ID, ICE ufrag of connectivity checks, and remote address. File
+   descriptor count therefore does not grow with connection count. Because
+   routing of non-STUN packets relies on remote address, a remote address is
+   served on the shared socket for the first connection using it only. Other
+   connections to the same remote address, e.g. to the same SFU or TURN
+   server over UDP, fall back to a socket of their own. Disabled by default. This must be called before any
+   connection is created, or before RTCClient::ResetPeerConnectionFactory().
+   @param enabled Enable UDP muxing or not.
+   @param port Local port of shared sockets. 0 to pick a port from
+   IcePortRanges, or an ephemeral port if no range is set. With sharded
+   factories, shard N uses |port| + N.
+  */
+  static void SetUdpMuxEnabled(bool enabled, uint16_t port) {
+    udp_mux_enabled_ = enabled;
+    udp_mux_port_ = port;
+  }
+
+#if defined(WEBRTC_LINUX)
+  /**
+   @brief This function enables batched UDP sockets for ICE.
+   @details When enabled, UDP sockets read all pending datagrams with one
+   recvmmsg call, and datagrams sent in the same network thread task are sent
+   with one sendmmsg call, using UDP GSO if the kernel supports it. This reduces
+   system calls on the network thread at high packet rates. Disabled by
+   default. This must be called before any connection is created, or before
+   RTCClient::ResetPeerConnectionFactory().
+   @param enabled Enable batched UDP sockets or not.
+  */
+  static void SetBatchedUdpSocketEnabled(bool enabled) {
+    batched_udp_socket_enabled_ = enabled;
+  }
+#endif
+
 #if defined(WEBRTC_WIN)
   /**
    @brief Enable driver-based super resolution(SR) for video rendering if underlying
@@ -166,6 +462,111 @@ class GlobalConfiguration {
     ice_port_ranges_.data.max = ice_port_ranges.data.max;
   }
 
+  /**
+   @brief This function enables sharded PeerConnectionFactory mode.
+   @details By default all connections share one PeerConnectionFactory with a
+   single worker, signaling and network thread. When |shards| is greater than
+   1, SDK creates up to |shards| factories, each with its own threads, and
+   assigns every new connection to one of them according to |policy|. Local
+   streams are created by shard 0 before a connection is assigned. When one
+   is published on a connection of another shard, its tracks are created
+   again on that shard over the same sources, and follow the enabled state of
+   the stream's tracks. Sinks of video sources are still added on the worker
+   thread of shard 0. All shards share the audio device module of shard 0, so
+   audio is captured once and delivered to every shard, and playout of all
+   shards is mixed. This must be called before any connection is created.
+   @param shards Number of factories. Values smaller than 1 are treated as 1.
+   @param policy Policy of assigning new connections to shards.
+  */
+  static void SetPeerConnectionFactoryShards(int shards,
+                                             FactoryShardPolicy policy) {
+    factory_shards_ = shards < 1 ? 1 : shards;
+    factory_shard_policy_ = policy;
+  }
+
+  /**
+   @brief This function sets the thread model of PeerConnectionFactory.
+   @details Settings that cannot be applied, for example realtime priority
+   without permission, are logged and ignored. This must be called before any
+   connection or local stream is created, or before
+   RTCClient::ResetPeerConnectionFactory().
+   @param config Thread model configuration.
+  */
+  static void SetThreadModelConfiguration(
+      const ThreadModelConfiguration& config) {
+    thread_model_configuration_ = config;
+  }
+
+  /**
+   @brief This function sets the thread RTCClientObserver callbacks are
+   invoked on.
+   @details In queued modes, events of all RTCClients are posted to one
+   lock-free queue and callbacks never run on WebRTC threads. Callbacks of the
+   same RTCClient are invoked in order. Callbacks of a destroyed RTCClient are
+   dropped. Default is ObserverEventDispatchMode::kDirect. This must be called
+   before any RTCClient is created.
+   @param mode Dispatch mode.
+  */
+  static void SetObserverEventDispatchMode(ObserverEventDispatchMode mode) {
+    observer_event_dispatch_mode_ = mode;
+  }
+
+  /**
+   @brief This function sets the process wide stats aggregator.
+   @details When enabled, every RTCClient registers with the aggregator, which
+   computes total bitrates, connection counts by ICE state and RTT/jitter
+   percentiles and histograms on one timer, and exports them in |format|.
+   Prometheus histograms count RTT/jitter values of all exports, so they only
+   increase. Percentiles are of the latest export.
+   This must be called before any RTCClient is created.
+   @param config Stats aggregator configuration.
+  */
+  static void SetStatsAggregatorConfiguration(
+      const StatsAggregatorConfiguration& config) {
+    stats_aggregator_configuration_ = config;
+  }
+
+  /**
+   @brief This function sets how customized video frames are paced.
+   @details Frames are read on absolute deadlines of a monotonic clock, so
+   time spent reading a frame does not delay the next one. Applied to
+   captures started afterwards.
+   @param config Frame pacing configuration.
+  */
+  static void SetFramePacingConfiguration(
+      const FramePacingConfiguration& config) {
+    frame_pacing_configuration_ = config;
+  }
+
+  /**
+   @brief This function sets the thread lag monitor.
+   @details When enabled, a probe task is posted to each PeerConnection,
+   signaling, worker and network thread every |interval_ms|, and the time it
+   waits before running is recorded in a histogram per thread. Histograms are
+   available from RTCClient::GetThreadLagHistograms(). This must be called
+   before any RTCClient is created.
+   @param config Thread lag monitor configuration.
+  */
+  static void SetThreadLagMonitorConfiguration(
+      const ThreadLagMonitorConfiguration& config) {
+    thread_lag_monitor_configuration_ = config;
+  }
+
+  /**
+   @brief This function sets the DTLS certificate cache.
+   @details When enabled, a certificate is generated in background when the
+   PeerConnectionFactory is created, and is used by all PeerConnections,
+   instead of generating one for each PeerConnection. PeerConnections created
+   before the first certificate is ready generate their own. This must be
+   called before any connection is created, or before
+   RTCClient::ResetPeerConnectionFactory().
+   @param config Certificate cache configuration.
+  */
+  static void SetCertificateCacheConfiguration(
+      const CertificateCacheConfiguration& config) {
+    certificate_cache_configuration_ = config;
+  }
+
   /**
    @brief This function enables stream dump before decoder to
    application's current working directory. This API is for debugging
@@ -243,6 +644,12 @@ class GlobalConfiguration {
   virtual ~GlobalConfiguration() {}
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
   static bool hardware_acceleration_enabled_;
+#endif
+#if defined(WEBRTC_LINUX)
+  static bool GetBatchedUdpSocketEnabled() {
+    return batched_udp_socket_enabled_;
+  }
+  static bool batched_udp_socket_enabled_;
 #endif
   /**
    @brief This function gets H.264 temporal layer settings.
@@ -285,6 +692,67 @@ class GlobalConfiguration {
 
   static IcePortRanges ice_port_ranges_;
 
+  static int GetPeerConnectionFactoryShards() {
+    return factory_shards_;
+  }
+
+  static FactoryShardPolicy GetPeerConnectionFactoryShardPolicy() {
+    return factory_shard_policy_;
+  }
+
+  static int factory_shards_;
+  static FactoryShardPolicy factory_shard_policy_;
+
+  static bool GetUdpMuxEnabled() {
+    return udp_mux_enabled_;
+  }
+
+  static uint16_t GetUdpMuxPort() {
+    return udp_mux_port_;
+  }
+
+  static bool udp_mux_enabled_;
+  static uint16_t udp_mux_port_;
+
+  static const ThreadModelConfiguration& GetThreadModelConfiguration() {
+    return thread_model_configuration_;
+  }
+
+  static ThreadModelConfiguration thread_model_configuration_;
+
+  static const CertificateCacheConfiguration&
+  GetCertificateCacheConfiguration() {
+    return certificate_cache_configuration_;
+  }
+
+  static CertificateCacheConfiguration certificate_cache_configuration_;
+
+  static ObserverEventDispatchMode GetObserverEventDispatchMode() {
+    return observer_event_dispatch_mode_;
+  }
+
+  static ObserverEventDispatchMode observer_event_dispatch_mode_;
+
+  static const StatsAggregatorConfiguration&
+  GetStatsAggregatorConfiguration() {
+    return stats_aggregator_configuration_;
+  }
+
+  static StatsAggregatorConfiguration stats_aggregator_configuration_;
+
+  static const ThreadLagMonitorConfiguration&
+  GetThreadLagMonitorConfiguration() {
+    return thread_lag_monitor_configuration_;
+  }
+
+  static ThreadLagMonitorConfiguration thread_lag_monitor_configuration_;
+
+  static const FramePacingConfiguration& GetFramePacingConfiguration() {
+    return frame_pacing_configuration_;
+  }
+
+  static FramePacingConfiguration frame_pacing_configuration_;
+
   /**
    @brief This function enables dumping of bitstream before decoding.
   */
@@ -32,6 +32,8 @@ class MediaConstraintsImpl;
 class CustomizedFramesCapturer;
 class BasicDesktopCapturer;
 class VideoFrameGeneratorInterface;
+class LocalPushedFrameTrackSource;
+struct PushedVideoFrame;
 #if defined(WEBRTC_MAC)
 class ObjcVideoCapturerInterface;
 #endif
@@ -368,6 +370,28 @@ class LocalStream : public Stream {
   static std::shared_ptr<LocalStream> Create(
       std::shared_ptr<LocalCustomizedStreamParameters> parameters,
       VideoEncoderInterface* encoder);
+  /**
+    @brief Initialize a local customized stream whose video frames are pushed
+    by application with PushVideoFrame().
+    @details Frames are delivered on the pushing thread as they are pushed,
+    without copy or SDK timer. Resolution and frame rate of |parameters| are
+    not used, each frame carries its own resolution.
+    @param parameters Parameters for creating the stream. The stream will not
+    be impacted if changing parameters after it is created.
+    @return Pointer to created LocalStream.
+  */
+  static std::shared_ptr<LocalStream> Create(
+      std::shared_ptr<LocalCustomizedStreamParameters> parameters);
+  /**
+    @brief Push a video frame to a stream created with Create(parameters).
+    @details The frame refers to application's memory until its
+    |release_callback| is invoked. It is released immediately if the stream has
+    no consumer, e.g. not published or closed.
+    @param frame The frame to deliver.
+    @return false if the stream does not accept pushed frames or |frame| is
+    invalid. |release_callback| is not invoked in this case.
+  */
+  bool PushVideoFrame(const PushedVideoFrame& frame);
 #endif
 
 #if defined(WEBRTC_WIN)
@@ -412,6 +436,8 @@ class LocalStream : public Stream {
   explicit LocalStream(
       std::shared_ptr<LocalCustomizedStreamParameters> parameters,
       VideoEncoderInterface* encoder);
+  explicit LocalStream(
+      std::shared_ptr<LocalCustomizedStreamParameters> parameters);
 #endif
 #if defined(WEBRTC_WIN)
   explicit LocalStream(std::shared_ptr<LocalDesktopStreamParameters> parameters,
@@ -423,6 +449,8 @@ class LocalStream : public Stream {
  private:
 #if defined(WEBRTC_WIN) || defined(WEBRTC_LINUX)
   bool encoded_ = false;
+  // Referenced source of a stream created for pushed frames.
+  LocalPushedFrameTrackSource* pushed_frame_source_ = nullptr;
 #endif
 #ifdef OWT_ENABLE_QUIC
   std::shared_ptr<owt::base::QuicStream> quic_stream_;